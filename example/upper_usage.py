@@ -0,0 +1,1070 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+ESP32-RemoteController 上位机示例
+
+ESP32 默认工作在 TCP 客户端模式，会主动连接上位机的 2233 端口。
+本脚本在上位机上监听该端口，并同时解析两种遥测格式：
+  - JSON 文本行:  ENCODER:{...}\\n / JOYSTICK:{...}\\n
+  - 二进制帧:     见 lib/Telemetry/README.md
+
+加 --serial 时改为通过串口使用机器模式 (lib/UARTParser/uart_machine.h)：
+发送 machine_mode 后以流水线方式连续发送请求, 按请求ID 匹配响应。
+需要安装 pyserial。
+
+加 --bench 时进入压测模式：接收指定秒数的遥测, 按消息类型统计帧率/字节率、
+由帧序号统计丢包与乱序、由设备时间戳估算单向延迟, 最后输出 JSON 报告。
+设备端用串口命令 `bench both 500 10` 生成合成流量 (lib/Bench), 同时给出
+--serial 时由本脚本通过串口发送该命令。
+
+加 --download 时下载设备 flash 中的飞行记录 (lib/Recorder) 保存为文件:
+默认等待设备连接后发送 `recorder dump net`, 给出 --serial 时改为串口发送
+`recorder dump uart`。记录文件就是二进制遥测帧的序列, --replay 用同一个
+TelemetryDecoder 回放。
+
+加 --hil 时把记录文件中的编码器/摇杆样本按时间戳逐条下发给设备的 `hal sim`
+命令 (lib/Hal), 设备上的驱动、DataPlatform 和遥测链路处理的是与记录时相同的
+输入 (硬件在环测试)。默认等待设备连接后经 TCP 发送, 给出 --serial 时经串口发送。
+同时给出 --hil-dump 时不连接设备, 把同样的命令连同相对时间戳写成文本轨迹,
+供主机测试回放 (lib/NativeHost, test/traces)。
+
+用法:
+    python upper_usage.py                 # TCP 服务器, 监听 0.0.0.0:2233
+    python upper_usage.py --port 2233
+    python upper_usage.py --udp --port 2233
+    python upper_usage.py --udp --multicast 239.255.0.1   # 组播发现 (设备 remote_host 为组播地址)
+    python upper_usage.py --command get_sys_info --command "sampler encoder 200"
+    python upper_usage.py --serial /dev/ttyUSB0
+    python upper_usage.py --bench 10 --report bench.json
+    python upper_usage.py --bench 10 --serial /dev/ttyUSB0 --bench-start "both 500 10"
+    python upper_usage.py --download flight.bin                      # 经 TCP 下载飞行记录
+    python upper_usage.py --download flight.bin --serial /dev/ttyUSB0
+    python upper_usage.py --replay flight.bin
+    python upper_usage.py --hil flight.bin --hil-center 1893,1911     # 回放到设备的模拟输入
+    python upper_usage.py --hil flight.bin --hil-dump ../test/traces/flight.trace   # 转换为主机测试轨迹
+"""
+
+import argparse
+import json
+import socket
+import struct
+import time
+
+# ---------------------------------------------------------------------------
+# 帧格式定义 (与 lib/Telemetry/telemetry_frame.h 保持一致)
+# ---------------------------------------------------------------------------
+
+FRAME_SYNC = 0xA5
+FRAME_HEADER_SIZE = 5  # sync + type + len + seq
+FRAME_CRC_SIZE = 2
+
+FRAME_ENCODER = 0x01
+FRAME_JOYSTICK = 0x02
+FRAME_SERVO = 0x03
+FRAME_KEYPAD = 0x04
+FRAME_PROFILE = 0x10
+FRAME_LATENCY = 0x11
+FRAME_RECORD = 0x12
+FRAME_SESSION = 0x13
+FRAME_REQUEST = 0x20
+FRAME_RESPONSE = 0x21
+
+ENCODER_FLAG_BUTTON = 1 << 0
+JOYSTICK_FLAG_BUTTON = 1 << 0
+JOYSTICK_FLAG_DEADZONE = 1 << 1
+KEYPAD_FLAG_PRESSED = 1 << 0
+
+# 传感器样本帧: 实例号大于 0 的通道在载荷后多一个实例号字节 (与 lib/Telemetry/telemetry_frame.h 保持一致)
+SAMPLE_FRAMES = (FRAME_ENCODER, FRAME_JOYSTICK, FRAME_KEYPAD)
+
+# 机器模式命令ID 与状态码 (与 lib/UARTParser/uart_machine.h 保持一致)
+CMD_PING = 0x00
+CMD_EXIT = 0x01
+CMD_GET_SYS_INFO = 0x02
+CMD_GET_ENCODER = 0x03
+CMD_GET_JOYSTICK = 0x04
+CMD_GET_NETWORK_TX = 0x05
+CMD_GET_SAMPLER = 0x06
+CMD_SET_SAMPLER_RATE = 0x07
+CMD_SET_TELEMETRY_FMT = 0x08
+CMD_GET_STATS = 0x09
+
+STATUS_NAMES = ["OK", "UNKNOWN_CMD", "BAD_LENGTH", "BAD_ARG", "FAILED"]
+
+# 文本行的最大长度, 超过则认为流已错位并丢弃
+MAX_TEXT_LINE = 512
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """CRC16-CCITT-FALSE (多项式 0x1021, 初值 0xFFFF)"""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF
+            else:
+                crc = (crc << 1) & 0xFFFF
+    return crc
+
+
+def _decode_encoder(payload):
+    position, delta, flags, ts = struct.unpack("<iiBI", payload)
+    return {
+        "pos": position,
+        "delta": delta,
+        "btn": bool(flags & ENCODER_FLAG_BUTTON),
+        "ts": ts,
+    }
+
+
+def _decode_joystick(payload):
+    x, y, mag_q15, angle_cdeg, flags, ts = struct.unpack("<hhHHBI", payload)
+    return {
+        "x": x,
+        "y": y,
+        "mag": mag_q15 / 32767.0,
+        "ang": angle_cdeg / 100.0,
+        "btn": bool(flags & JOYSTICK_FLAG_BUTTON),
+        "dz": bool(flags & JOYSTICK_FLAG_DEADZONE),
+        "ts": ts,
+    }
+
+
+def _decode_keypad(payload):
+    key, flags, ts = struct.unpack("<BBI", payload)
+    return {"key": key, "pressed": bool(flags & KEYPAD_FLAG_PRESSED), "ts": ts}
+
+
+def _decode_servo(payload):
+    servo_id, flags, temp, position, target, voltage_mv, timeouts, ts = struct.unpack("<BBhhhHII", payload)
+    return {
+        "id": servo_id,
+        "flags": flags,
+        "temp": temp,
+        "pos": position / 100.0,
+        "target": target / 100.0,
+        "voltage": voltage_mv / 1000.0,
+        "timeouts": timeouts,
+        "ts": ts,
+    }
+
+
+def _decode_record(payload):
+    offset = struct.unpack_from("<I", payload)[0]
+    return {"offset": offset, "data": bytes(payload[4:])}
+
+
+def _decode_session(payload):
+    session, ts, reset_reason, version = struct.unpack("<IIBB", payload)
+    return {"session": session, "ts": ts, "reset_reason": reset_reason, "version": version}
+
+
+PROFILE_HEADER = struct.Struct("<HHHIIBB")
+PROFILE_TASK = struct.Struct("<10sBBHH")
+
+
+def _decode_profile(payload):
+    window_ms, load0, load1, heap_free, heap_min, flags, count = PROFILE_HEADER.unpack_from(payload)
+    tasks = []
+    for i in range(count):
+        name, core, prio, cpu, stack_free = PROFILE_TASK.unpack_from(
+            payload, PROFILE_HEADER.size + i * PROFILE_TASK.size)
+        tasks.append({
+            "name": name.rstrip(b"\0").decode("utf-8", errors="replace"),
+            "core": None if core == 0xFF else core,
+            "prio": prio,
+            "cpu": cpu / 10.0,
+            "stack_free": stack_free,
+        })
+    return {
+        "win": window_ms,
+        "load": [load0 / 10.0, load1 / 10.0],
+        "heap": heap_free,
+        "heap_min": heap_min,
+        "cpu_valid": bool(flags & 0x01),
+        "tasks": tasks,
+    }
+
+
+# 延迟直方图 (与 lib/Latency/latency_stats.h 保持一致)
+LATENCY_STAGES = ["sample->publish", "publish->wake", "wake->wire", "sample->wire"]
+LATENCY_BUCKET_BOUNDS_US = [50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000]
+
+
+def _decode_latency(payload):
+    stage_count, bucket_count = struct.unpack_from("<BB", payload)
+    stage = struct.Struct("<III%dI" % bucket_count)
+    stages = {}
+    for i in range(stage_count):
+        fields = stage.unpack_from(payload, 2 + i * stage.size)
+        name = LATENCY_STAGES[i] if i < len(LATENCY_STAGES) else str(i)
+        stages[name] = {"n": fields[0], "max": fields[1], "mean": fields[2],
+                        "buckets": list(fields[3:])}
+    return {"stages": stages, "bounds_us": LATENCY_BUCKET_BOUNDS_US[:bucket_count - 1]}
+
+
+# 帧类型 -> (名称, 载荷长度 (None = 变长), 解码函数)
+FRAME_TYPES = {
+    FRAME_ENCODER: ("ENCODER", 13, _decode_encoder),
+    FRAME_JOYSTICK: ("JOYSTICK", 13, _decode_joystick),
+    FRAME_SERVO: ("SERVO", 18, _decode_servo),
+    FRAME_KEYPAD: ("KEYPAD", 6, _decode_keypad),
+    FRAME_PROFILE: ("PROFILE", None, _decode_profile),
+    FRAME_LATENCY: ("LATENCY", None, _decode_latency),
+    FRAME_RECORD: ("RECORD", None, _decode_record),
+    FRAME_SESSION: ("SESSION", 10, _decode_session),
+}
+
+
+def _decode_versioned(decode):
+    def wrapper(data):
+        msg = decode(data[4:])
+        msg["version"] = struct.unpack_from("<I", data)[0]
+        return msg
+    return wrapper
+
+
+def _unpack_fields(fmt, names):
+    def decode(data):
+        return dict(zip(names, struct.unpack(fmt, data)))
+    return decode
+
+
+# 机器模式命令ID -> (名称, 响应数据解码函数)
+RESPONSE_TYPES = {
+    CMD_PING: ("PING", lambda data: {"echo": data.hex()}),
+    CMD_EXIT: ("EXIT", None),
+    CMD_GET_SYS_INFO: ("SYS_INFO", _unpack_fields(
+        "<IIHBB", ("uptime_ms", "free_heap", "cpu_mhz", "wifi", "network"))),
+    CMD_GET_ENCODER: ("ENCODER", _decode_versioned(_decode_encoder)),
+    CMD_GET_JOYSTICK: ("JOYSTICK", _decode_versioned(_decode_joystick)),
+    CMD_GET_NETWORK_TX: ("NETWORK_TX", _unpack_fields(
+        "<IIIIIIHB", ("frames_sent", "flushes", "bytes_sent", "send_failures",
+                      "pool_exhausted", "client_drops", "flush_interval_ms", "clients"))),
+    CMD_GET_SAMPLER: ("SAMPLER", _unpack_fields(
+        "<BHIIIIII", ("id", "rate_hz", "samples", "min_us", "max_us", "mean_us",
+                      "exec_us", "missed"))),
+    CMD_SET_SAMPLER_RATE: ("SET_SAMPLER_RATE", None),
+    CMD_SET_TELEMETRY_FMT: ("SET_TELEMETRY_FMT", None),
+    CMD_GET_STATS: ("MACHINE_STATS", _unpack_fields(
+        "<III", ("requests", "crc_errors", "bytes_dropped"))),
+}
+
+
+def build_request(req_id, cmd_id, args=b""):
+    """构造机器模式请求帧, req_id 放在 seq 字段"""
+    body = struct.pack("<BBHB", FRAME_REQUEST, len(args) + 1, req_id & 0xFFFF, cmd_id) + bytes(args)
+    return bytes([FRAME_SYNC]) + body + struct.pack("<H", crc16_ccitt(body))
+
+
+def _decode_response(payload):
+    req_id, cmd_id, status = struct.unpack_from("<HBB", payload)
+    data = payload[4:]
+    name, decode = RESPONSE_TYPES.get(cmd_id, ("0x%02X" % cmd_id, None))
+    msg = {}
+    if status == 0 and decode is not None:
+        try:
+            msg = decode(data)
+        except struct.error:
+            msg = {"data": data.hex()}
+    msg.update({
+        "type": "RESPONSE",
+        "cmd": name,
+        "req_id": req_id,
+        "status": STATUS_NAMES[status] if status < len(STATUS_NAMES) else status,
+    })
+    return msg
+
+
+class TelemetryDecoder:
+    """
+    流式遥测解码器。
+
+    调用 feed() 送入任意长度的字节, 返回解析出的消息列表。
+    每条消息为 dict, 至少包含:
+      - "type":   "ENCODER" / "JOYSTICK" / "KEYPAD" / "TEXT" / 未知帧为 "0xNN"
+      - "format": "binary" / "json" / "text"
+      - "size":   该消息在流中占用的字节数
+    二进制帧额外包含 "seq" 字段; 实例号大于 0 的传感器通道 (如第二个编码器) 额外包含 "ch" 字段。
+    """
+
+    def __init__(self):
+        self._buf = bytearray()
+        self.crc_errors = 0
+        self.bytes_dropped = 0
+
+    def feed(self, data):
+        self._buf.extend(data)
+        messages = []
+        while self._buf:
+            if self._buf[0] == FRAME_SYNC:
+                if len(self._buf) < FRAME_HEADER_SIZE:
+                    break
+                payload_len = self._buf[2]
+                frame_len = FRAME_HEADER_SIZE + payload_len + FRAME_CRC_SIZE
+                if len(self._buf) < frame_len:
+                    break
+                frame = bytes(self._buf[:frame_len])
+                crc_rx = struct.unpack_from("<H", frame, frame_len - FRAME_CRC_SIZE)[0]
+                if crc16_ccitt(frame[1:frame_len - FRAME_CRC_SIZE]) != crc_rx:
+                    # 校验失败: 丢弃同步字节后重新寻找帧头
+                    self.crc_errors += 1
+                    self.bytes_dropped += 1
+                    del self._buf[0]
+                    continue
+                del self._buf[:frame_len]
+                msg = self._decode_frame(frame)
+                msg["size"] = frame_len
+                messages.append(msg)
+            else:
+                newline = self._buf.find(b"\n")
+                sync = self._buf.find(bytes([FRAME_SYNC]))
+                if newline < 0 or (0 <= sync < newline):
+                    if sync > 0:
+                        # 文本被二进制帧打断, 丢弃残缺的文本
+                        self.bytes_dropped += sync
+                        del self._buf[:sync]
+                        continue
+                    if len(self._buf) > MAX_TEXT_LINE:
+                        self.bytes_dropped += len(self._buf)
+                        self._buf.clear()
+                    break
+                line = bytes(self._buf[:newline]).decode("utf-8", errors="replace").strip()
+                del self._buf[:newline + 1]
+                if line:
+                    msg = self._decode_text(line)
+                    msg["size"] = newline + 1
+                    messages.append(msg)
+        return messages
+
+    @staticmethod
+    def _decode_frame(frame):
+        frame_type = frame[1]
+        payload_len = frame[2]
+        seq = struct.unpack_from("<H", frame, 3)[0]
+        payload = frame[FRAME_HEADER_SIZE:FRAME_HEADER_SIZE + payload_len]
+        if frame_type == FRAME_RESPONSE and payload_len >= 4:
+            msg = _decode_response(payload)
+            msg.update({"format": "binary", "seq": seq})
+            return msg
+        info = FRAME_TYPES.get(frame_type)
+        instance = None
+        if info is not None and frame_type in SAMPLE_FRAMES and payload_len == info[1] + 1:
+            instance = payload[-1]
+            payload = payload[:-1]
+        elif info is None or (info[1] is not None and info[1] != payload_len):
+            return {"type": "0x%02X" % frame_type, "format": "binary", "seq": seq,
+                    "payload": payload.hex()}
+        name, _, decode = info
+        try:
+            msg = decode(payload)
+        except struct.error:
+            return {"type": name, "format": "binary", "seq": seq, "payload": payload.hex()}
+        msg.update({"type": name, "format": "binary", "seq": seq})
+        if instance is not None:
+            msg["ch"] = instance
+        return msg
+
+    @staticmethod
+    def _decode_text(line):
+        prefix, sep, body = line.partition(":")
+        if sep and body.startswith("{"):
+            try:
+                msg = json.loads(body)
+                msg.update({"type": prefix, "format": "json"})
+                return msg
+            except ValueError:
+                pass
+        return {"type": "TEXT", "format": "text", "text": line}
+
+
+def print_message(msg):
+    print(msg)
+
+
+def run_tcp_server(host, port, commands=()):
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind((host, port))
+    server.listen(1)
+    print("TCP server listening on %s:%d, waiting for ESP32..." % (host, port))
+    while True:
+        conn, addr = server.accept()
+        print("ESP32 connected from %s:%d" % addr)
+        decoder = TelemetryDecoder()
+        with conn:
+            # 下行命令: 与串口命令相同, 回复从同一连接返回 (夹在遥测之间)
+            for command in commands:
+                conn.sendall(command.encode() + b"\n")
+            while True:
+                data = conn.recv(4096)
+                if not data:
+                    break
+                for msg in decoder.feed(data):
+                    print_message(msg)
+        print("ESP32 disconnected (crc errors: %d, dropped bytes: %d)"
+              % (decoder.crc_errors, decoder.bytes_dropped))
+
+
+# UDP 地面站发现 (与 lib/Wifi/wifi_task.h 中的 NETWORK_UDP_DISCOVERY_* 保持一致)
+UDP_DISCOVERY_BEACON = b"RC_DISCOVER"
+UDP_DISCOVERY_REPLY = b"RC_HERE\n"
+
+
+def _open_udp(host, port, multicast=None):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind((host, port))
+    if multicast:
+        mreq = struct.pack("4s4s", socket.inet_aton(multicast), socket.inet_aton("0.0.0.0"))
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+    return sock
+
+
+def _answer_discovery(sock, data, addr):
+    """设备在发现模式下广播/组播信标, 回复后设备把本机作为遥测目标。返回 True 表示是信标。"""
+    if not data.startswith(UDP_DISCOVERY_BEACON):
+        return False
+    sock.sendto(UDP_DISCOVERY_REPLY, addr)
+    print("Discovery beacon from %s:%d, replied" % addr)
+    return True
+
+
+def run_udp(host, port, multicast=None, commands=()):
+    sock = _open_udp(host, port, multicast)
+    print("UDP listening on %s:%d%s" % (host, port, " (group %s)" % multicast if multicast else ""))
+    decoder = TelemetryDecoder()
+    pending = list(commands)
+    while True:
+        data, addr = sock.recvfrom(2048)
+        if _answer_discovery(sock, data, addr):
+            continue
+        # 收到第一个遥测报文后才知道设备的地址, 每条命令一个报文
+        while pending:
+            sock.sendto(pending.pop(0).encode() + b"\n", addr)
+        for msg in decoder.feed(data):
+            print_message(msg)
+
+
+def run_serial(port, baudrate, count):
+    """
+    机器模式示例: 一次性发出一批查询 (不等待逐条响应), 再按 req_id 收集结果。
+    串口上夹杂的日志文本由 TelemetryDecoder 按同步字节 + CRC 跳过。
+    """
+    import serial  # pyserial
+
+    queries = [
+        (CMD_GET_SYS_INFO, b""),
+        (CMD_GET_ENCODER, b""),
+        (CMD_GET_JOYSTICK, b""),
+        (CMD_GET_NETWORK_TX, b""),
+        (CMD_GET_SAMPLER, b"\x00"),
+    ]
+
+    with serial.Serial(port, baudrate, timeout=0.05) as ser:
+        decoder = TelemetryDecoder()
+        ser.write(b"\rmachine_mode\r")
+        deadline = time.time() + 2.0
+        entered = False
+        while not entered and time.time() < deadline:
+            for msg in decoder.feed(ser.read(256)):
+                if msg.get("text", "").endswith("Machine mode on."):
+                    entered = True
+        if not entered:
+            print("Device did not enter machine mode")
+            return
+
+        pending = {}
+        start = time.time()
+        for i in range(count):
+            cmd_id, args = queries[i % len(queries)]
+            pending[i] = cmd_id
+            ser.write(build_request(i, cmd_id, args))
+
+        deadline = time.time() + 2.0
+        while pending and time.time() < deadline:
+            for msg in decoder.feed(ser.read(4096)):
+                if msg.get("type") == "RESPONSE" and pending.pop(msg["req_id"], None) is not None:
+                    print_message(msg)
+        elapsed = time.time() - start
+        print("%d/%d responses in %.1f ms (crc errors: %d, dropped bytes: %d)"
+              % (count - len(pending), count, elapsed * 1000.0,
+                 decoder.crc_errors, decoder.bytes_dropped))
+
+        ser.write(build_request(0xFFFF, CMD_EXIT))
+
+
+# ---------------------------------------------------------------------------
+# 飞行记录下载与回放 (配合设备端 recorder 命令, 见 lib/Recorder/README.md)
+# ---------------------------------------------------------------------------
+
+class RecordWriter:
+    """把 RECORD 分块按偏移写入文件, 不带数据的分块表示下载结束"""
+
+    def __init__(self, f):
+        self._file = f
+        self.expected = 0
+        self.gaps = 0
+        self.done = False
+
+    def add(self, msg):
+        offset, data = msg["offset"], msg["data"]
+        if not data:
+            self.done = True
+            return
+        if offset != self.expected:
+            # 设备在下载过程中覆盖了最早的扇区, 缺口保持为 0 (回放时作为无效字节跳过)
+            self.gaps += 1
+        self._file.seek(offset)
+        self._file.write(data)
+        self.expected = offset + len(data)
+
+
+def _download(read, path, decoder):
+    start = time.time()
+    with open(path, "wb") as f:
+        writer = RecordWriter(f)
+        while not writer.done:
+            data = read()
+            if data is None:
+                break
+            for msg in decoder.feed(data):
+                if msg["type"] == "RECORD":
+                    writer.add(msg)
+                elif msg["type"] == "TEXT":
+                    print(msg["text"])
+    print("%s: %d bytes in %.1f s%s (gaps: %d, crc errors: %d)"
+          % (path, writer.expected, time.time() - start, "" if writer.done else ", incomplete",
+             writer.gaps, decoder.crc_errors))
+
+
+def run_download(host, port, path, serial_port=None, baudrate=115200):
+    decoder = TelemetryDecoder()
+    if serial_port:
+        import serial  # pyserial
+        with serial.Serial(serial_port, baudrate, timeout=5.0) as ser:
+            ser.write(b"\rrecorder dump uart\r")
+            _download(lambda: ser.read(4096) or None, path, decoder)
+        return
+
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind((host, port))
+    server.listen(1)
+    print("TCP server listening on %s:%d, waiting for ESP32..." % (host, port))
+    conn, addr = server.accept()
+    print("ESP32 connected from %s:%d, downloading recording" % addr)
+    with conn:
+        # 实时遥测照常发送, 只保存 RECORD 分块
+        conn.sendall(b"recorder dump net\n")
+        _download(lambda: conn.recv(4096) or None, path, decoder)
+
+
+def run_replay(path):
+    """用与实时遥测相同的解码器回放记录文件 (页尾填充的 0xFF 作为无效字节跳过)"""
+    decoder = TelemetryDecoder()
+    counts = {}
+    with open(path, "rb") as f:
+        while True:
+            data = f.read(4096)
+            if not data:
+                break
+            for msg in decoder.feed(data):
+                if msg["type"] == "TEXT":
+                    continue
+                counts[msg["type"]] = counts.get(msg["type"], 0) + 1
+                print_message(msg)
+    print("Replayed %s: %s (crc errors: %d)"
+          % (path, ", ".join("%s %d" % item for item in sorted(counts.items())), decoder.crc_errors))
+
+
+class HilMapper:
+    """把记录中的样本换算为 hal sim 命令 (摇杆按驱动的分段线性映射反算 ADC 原始值)"""
+
+    ADC_MAX = 4095
+
+    def __init__(self, pins, center, invert, button_pin, steps):
+        self.pin_x, self.pin_y = pins
+        self.center = center
+        self.invert = invert
+        self.button_pin = button_pin
+        self.steps = steps
+        self._button = None
+
+    def _raw(self, value, center, invert):
+        if invert:
+            value = -value
+        span = self.ADC_MAX - center if value >= 0 else center
+        return max(0, min(self.ADC_MAX, center + int(round(value * span / 512.0))))
+
+    def commands(self, msg):
+        # 只回放实例 0 (模拟输入接在默认通道的驱动上)
+        if msg.get("ch", 0) != 0:
+            return []
+        if msg["type"] == "ENCODER":
+            return ["hal sim encoder %d" % (msg["pos"] * self.steps)]
+        if msg["type"] != "JOYSTICK":
+            return []
+        commands = ["hal sim adc %d %d %d %d" % (
+            self.pin_x, self._raw(msg["x"], self.center[0], self.invert[0]),
+            self.pin_y, self._raw(msg["y"], self.center[1], self.invert[1]))]
+        if self.button_pin is not None and msg["btn"] != self._button:
+            # 按钮上拉, 按下为低电平
+            commands.append("hal sim gpio %d %d" % (self.button_pin, 0 if msg["btn"] else 1))
+            self._button = msg["btn"]
+        return commands
+
+
+def _hil_replay(path, mapper, send, drain):
+    """按记录中的设备时间戳 (毫秒) 的间隔发送; SESSION 帧 (设备重启) 之后重新对齐时间"""
+    decoder = TelemetryDecoder()
+    sent = 0
+    base = None
+    with open(path, "rb") as f:
+        data = f.read()
+    for msg in decoder.feed(data):
+        if msg["type"] == "SESSION":
+            base = None
+            continue
+        commands = mapper.commands(msg)
+        if not commands:
+            continue
+        if base is None:
+            base = (msg["ts"], time.time())
+        delay = base[1] + (msg["ts"] - base[0]) / 1000.0 - time.time()
+        if delay > 0:
+            time.sleep(delay)
+        for command in commands:
+            send(command)
+            sent += 1
+        drain()
+    send("hal off")
+    time.sleep(0.2)
+    drain()
+    print("HIL replay of %s: %d commands (crc errors: %d)" % (path, sent, decoder.crc_errors))
+
+
+def run_hil_dump(path, mapper, out_path):
+    """把 --hil 下发的命令写成 "<t_ms> <命令>" 轨迹; SESSION 帧 (设备重启) 之后从上一条的时间继续"""
+    decoder = TelemetryDecoder()
+    lines = 0
+    base = None
+    last_ms = 0
+    with open(path, "rb") as f:
+        data = f.read()
+    with open(out_path, "w") as out:
+        out.write("# %s 的 HIL 命令 (upper_usage.py --hil-dump)\n" % path)
+        for msg in decoder.feed(data):
+            if msg["type"] == "SESSION":
+                base = None
+                continue
+            commands = mapper.commands(msg)
+            if not commands:
+                continue
+            if base is None:
+                base = msg["ts"] - last_ms
+            last_ms = max(last_ms, msg["ts"] - base)
+            for command in commands:
+                out.write("%d %s\n" % (last_ms, command))
+                lines += 1
+        out.write("%d hal off\n" % last_ms)
+    print("HIL trace of %s: %d commands -> %s (crc errors: %d)" % (path, lines, out_path, decoder.crc_errors))
+
+
+def run_hil(host, port, path, mapper, serial_port=None, baudrate=115200):
+    if serial_port:
+        import serial  # pyserial
+
+        # 先拉低 DTR/RTS 再打开串口, 避免开发板自动复位
+        ser = serial.Serial(baudrate=baudrate, timeout=0)
+        ser.port = serial_port
+        ser.dtr = False
+        ser.rts = False
+        ser.open()
+        with ser:
+            ser.write(b"\r")
+            _hil_replay(path, mapper, lambda command: ser.write(command.encode("ascii") + b"\r"),
+                        lambda: ser.read(4096))
+        return
+
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind((host, port))
+    server.listen(1)
+    print("TCP server listening on %s:%d, waiting for ESP32..." % (host, port))
+    conn, addr = server.accept()
+    print("ESP32 connected from %s:%d, replaying %s into simulated inputs" % (addr + (path,)))
+    conn.setblocking(False)
+
+    def drain():
+        # 丢弃命令回复和实时遥测, 避免设备端发送阻塞
+        try:
+            while conn.recv(4096):
+                pass
+        except BlockingIOError:
+            pass
+
+    with conn:
+        _hil_replay(path, mapper, lambda command: conn.sendall(command.encode("ascii") + b"\n"), drain)
+
+
+def _int_pair(text):
+    first, second = text.split(",")
+    return int(first), int(second)
+
+
+# ---------------------------------------------------------------------------
+# 压测 (配合设备端 bench 命令, 见 lib/Bench/README.md)
+# ---------------------------------------------------------------------------
+
+# 合成样本中的递增计数字段: 类型 -> (字段, 取模)
+BENCH_COUNTERS = {
+    "ENCODER": ("pos", None),
+    "JOYSTICK": ("x", 1024),
+}
+
+# 估算时钟偏移时每个窗口的长度 (秒)
+OFFSET_WINDOW_S = 1.0
+
+
+def _percentile(sorted_values, percent):
+    if not sorted_values:
+        return None
+    index = min(len(sorted_values) - 1, max(0, int(round(percent / 100.0 * len(sorted_values))) - 1))
+    return sorted_values[index]
+
+
+def _bucket_percentile(buckets, bounds, percent):
+    """由设备直方图估算百分位 (返回所在桶的上界, 最后一个桶返回 None)"""
+    total = sum(buckets)
+    if total == 0:
+        return None
+    target = (total * percent + 99) // 100
+    cumulative = 0
+    for i, count in enumerate(buckets):
+        cumulative += count
+        if cumulative >= target:
+            return bounds[i] if i < len(bounds) else None
+    return None
+
+
+class StreamStats:
+    """单个消息类型的吞吐、序号与延迟统计"""
+
+    def __init__(self, fmt):
+        self.format = fmt
+        self.frames = 0
+        self.bytes = 0
+        self.first_time = None
+        self.last_time = None
+        # 帧序号 (仅二进制帧)
+        self.last_seq = None
+        self.seq_lost = 0
+        self.reordered = 0
+        self.duplicates = 0
+        # 合成样本计数字段
+        self.last_counter = None
+        self.counter_gaps = 0
+        # (接收时刻, 接收时刻 - 设备时间戳) 单位毫秒
+        self.offsets = []
+
+    def add(self, msg, recv_time, counter_field):
+        self.frames += 1
+        self.bytes += msg.get("size", 0)
+        if self.first_time is None:
+            self.first_time = recv_time
+        self.last_time = recv_time
+
+        in_order = True
+        if "seq" in msg:
+            in_order = self._track_seq(msg["seq"])
+        if counter_field is not None and counter_field[0] in msg:
+            if in_order:
+                self._track_counter(msg[counter_field[0]], counter_field[1])
+            elif in_order is False and self.counter_gaps > 0:
+                # 迟到的帧填补了之前计入的计数跳变
+                self.counter_gaps -= 1
+        if "ts" in msg:
+            self.offsets.append((recv_time * 1000.0, recv_time * 1000.0 - msg["ts"]))
+
+    def _track_seq(self, seq):
+        """返回 True 按序到达, False 迟到 (乱序), None 重复"""
+        if self.last_seq is None:
+            self.last_seq = seq
+            return True
+        diff = (seq - self.last_seq) & 0xFFFF
+        if diff == 0:
+            self.duplicates += 1
+            return None
+        if diff < 0x8000:
+            self.seq_lost += diff - 1
+            self.last_seq = seq
+            return True
+        # 比已经收到的序号更早: 之前被计为丢失的帧迟到了
+        self.reordered += 1
+        if self.seq_lost > 0:
+            self.seq_lost -= 1
+        return False
+
+    def _track_counter(self, value, modulo):
+        if self.last_counter is not None:
+            diff = value - self.last_counter
+            if modulo is not None:
+                diff %= modulo
+            if diff > 1:
+                self.counter_gaps += diff - 1
+        self.last_counter = value
+
+    def latency(self):
+        """
+        单向延迟估算。设备时间戳为 FreeRTOS tick (毫秒), 与上位机时钟的偏移未知:
+        每个窗口取 (接收时刻 - 设备时间戳) 的最小值, 对窗口最小值做线性拟合得到
+        随时间漂移的偏移基线, 每帧的延迟为其与基线之差。
+        结果是相对于最快样本的延迟 (不含固定的最小链路延迟)。
+        """
+        if len(self.offsets) < 2:
+            return None
+        start = self.offsets[0][0]
+        windows = {}
+        for t, d in self.offsets:
+            key = int((t - start) / (OFFSET_WINDOW_S * 1000.0))
+            if key not in windows or d < windows[key][1]:
+                windows[key] = (t, d)
+        points = sorted(windows.values())
+        if len(points) >= 2:
+            n = float(len(points))
+            mean_t = sum(p[0] for p in points) / n
+            mean_d = sum(p[1] for p in points) / n
+            var_t = sum((p[0] - mean_t) ** 2 for p in points)
+            slope = sum((p[0] - mean_t) * (p[1] - mean_d) for p in points) / var_t if var_t else 0.0
+        else:
+            mean_t, mean_d, slope = points[0][0], points[0][1], 0.0
+        intercept = mean_d - slope * mean_t
+        # 拟合线可能略高于个别窗口的最小值, 平移到所有样本的下方
+        floor = min(d - (slope * t + intercept) for t, d in self.offsets)
+        values = sorted(d - (slope * t + intercept) - floor for t, d in self.offsets)
+        return {
+            "samples": len(values),
+            "clock_offset_ms": round(intercept + floor + slope * start, 3),
+            "clock_drift_ppm": round(slope * 1e6, 1),
+            "p50_ms": round(_percentile(values, 50), 3),
+            "p90_ms": round(_percentile(values, 90), 3),
+            "p99_ms": round(_percentile(values, 99), 3),
+            "max_ms": round(values[-1], 3),
+        }
+
+    def report(self, duration):
+        expected = self.frames + self.seq_lost
+        result = {
+            "format": self.format,
+            "frames": self.frames,
+            "bytes": self.bytes,
+            "frames_per_s": round(self.frames / duration, 1) if duration > 0 else 0.0,
+            "bytes_per_s": round(self.bytes / duration, 1) if duration > 0 else 0.0,
+        }
+        if self.last_seq is not None:
+            result.update({
+                "seq_lost": self.seq_lost,
+                "loss_pct": round(100.0 * self.seq_lost / expected, 3) if expected else 0.0,
+                "reordered": self.reordered,
+                "duplicates": self.duplicates,
+            })
+        if self.last_counter is not None:
+            # 计数字段的跳变包含网络丢失, 差值即设备端丢弃 (环形缓冲区/帧池)
+            result["counter_gaps"] = self.counter_gaps
+            result["device_dropped"] = max(0, self.counter_gaps - self.seq_lost)
+        latency = self.latency()
+        if latency is not None:
+            result["latency"] = latency
+        return result
+
+
+class BenchStats:
+    """按消息类型汇总压测结果"""
+
+    def __init__(self, transport):
+        self.transport = transport
+        self.streams = {}
+        self.start = None
+        self.end = None
+        self.rx_bytes = 0
+        self.device_latency = None
+
+    def add_bytes(self, count, recv_time):
+        if self.start is None:
+            self.start = recv_time
+        self.end = recv_time
+        self.rx_bytes += count
+
+    def add(self, msg, recv_time):
+        msg_type = msg.get("type")
+        if msg_type == "LATENCY":
+            self.device_latency = msg
+        stream = self.streams.get(msg_type)
+        if stream is None:
+            stream = self.streams[msg_type] = StreamStats(msg.get("format"))
+        stream.add(msg, recv_time, BENCH_COUNTERS.get(msg_type))
+
+    def report(self, decoder):
+        duration = (self.end - self.start) if self.start is not None else 0.0
+        frames = sum(s.frames for s in self.streams.values())
+        result = {
+            "transport": self.transport,
+            "duration_s": round(duration, 3),
+            "total": {
+                "frames": frames,
+                "bytes": self.rx_bytes,
+                "frames_per_s": round(frames / duration, 1) if duration > 0 else 0.0,
+                "bytes_per_s": round(self.rx_bytes / duration, 1) if duration > 0 else 0.0,
+            },
+            "crc_errors": decoder.crc_errors,
+            "bytes_dropped": decoder.bytes_dropped,
+            "streams": dict((name, s.report(duration)) for name, s in sorted(self.streams.items())),
+        }
+        if self.device_latency is not None:
+            # 设备端最近一次导出的阶段直方图 (latency export on)
+            bounds = self.device_latency["bounds_us"]
+            stages = {}
+            for name, stage in self.device_latency["stages"].items():
+                stages[name] = {
+                    "n": stage["n"],
+                    "mean_us": stage["mean"],
+                    "max_us": stage["max"],
+                    "p50_us": _bucket_percentile(stage["buckets"], bounds, 50),
+                    "p99_us": _bucket_percentile(stage["buckets"], bounds, 99),
+                }
+            result["device_latency"] = stages
+        return result
+
+
+def _start_device_bench(port, baudrate, command):
+    """通过串口 CLI 发送 bench 命令 (设备处于文本模式)"""
+    import serial  # pyserial
+
+    # 先拉低 DTR/RTS 再打开串口, 避免开发板自动复位断开网络连接
+    ser = serial.Serial(baudrate=baudrate, timeout=0.2)
+    ser.port = port
+    ser.dtr = False
+    ser.rts = False
+    ser.open()
+    with ser:
+        ser.write(("\rbench %s\r" % command).encode("ascii"))
+        time.sleep(0.3)
+        reply = ser.read(512).decode("utf-8", errors="replace")
+    if "Bench started." not in reply:
+        raise RuntimeError("device did not start bench: %r" % reply.strip())
+    print("Device bench started: bench %s" % command)
+
+
+def run_bench(host, port, udp, seconds, report_path, serial_port=None, baudrate=115200, bench_command=None,
+              multicast=None):
+    """
+    接收 seconds 秒的遥测后输出报告。计时从收到第一个字节开始。
+    TCP 模式下等待 ESP32 连接 (只统计第一个连接)。
+    """
+    if udp:
+        sock = _open_udp(host, port, multicast)
+        conn = sock
+        print("Bench: UDP listening on %s:%d" % (host, port))
+    else:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        sock.bind((host, port))
+        sock.listen(1)
+        print("Bench: TCP server listening on %s:%d, waiting for ESP32..." % (host, port))
+        conn, addr = sock.accept()
+        print("ESP32 connected from %s:%d" % addr)
+    conn.settimeout(0.2)
+
+    if serial_port and bench_command:
+        _start_device_bench(serial_port, baudrate, bench_command)
+
+    stats = BenchStats("udp" if udp else "tcp")
+    decoder = TelemetryDecoder()
+    try:
+        while stats.start is None or time.time() - stats.start < seconds:
+            try:
+                if udp:
+                    data, addr = conn.recvfrom(4096)
+                    if _answer_discovery(conn, data, addr):
+                        continue
+                else:
+                    data = conn.recv(4096)
+            except socket.timeout:
+                continue
+            if not data:
+                print("ESP32 disconnected")
+                break
+            now = time.time()
+            stats.add_bytes(len(data), now)
+            for msg in decoder.feed(data):
+                stats.add(msg, now)
+    finally:
+        if conn is not sock:
+            conn.close()
+        sock.close()
+
+    report = json.dumps(stats.report(decoder), indent=2, sort_keys=True)
+    if report_path:
+        with open(report_path, "w") as f:
+            f.write(report + "\n")
+        print("Report written to %s" % report_path)
+    else:
+        print(report)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="ESP32-RemoteController telemetry viewer")
+    parser.add_argument("--host", default="0.0.0.0", help="监听地址")
+    parser.add_argument("--port", type=int, default=2233, help="监听端口")
+    parser.add_argument("--udp", action="store_true", help="使用 UDP 而不是 TCP")
+    parser.add_argument("--multicast", metavar="GROUP", help="UDP 模式下加入组播组以接收发现信标")
+    parser.add_argument("--command", action="append", default=[], metavar="CMD",
+                        help="连接后通过网络发送命令 (可重复), 例如 --command get_sys_info")
+    parser.add_argument("--serial", metavar="PORT", help="通过串口使用机器模式查询 (需要 pyserial)")
+    parser.add_argument("--baudrate", type=int, default=115200, help="串口波特率")
+    parser.add_argument("--count", type=int, default=50, help="机器模式下流水线发送的请求数")
+    parser.add_argument("--bench", type=float, metavar="SECONDS", help="压测模式: 统计指定秒数后输出 JSON 报告")
+    parser.add_argument("--report", metavar="FILE", help="压测报告写入文件 (默认打印到标准输出)")
+    parser.add_argument("--bench-start", metavar="ARGS",
+                        help="压测开始前通过 --serial 串口发送 'bench ARGS', 例如 \"both 500 10\"")
+    parser.add_argument("--download", metavar="FILE", help="下载设备的飞行记录到文件 (经 TCP, 给出 --serial 时经串口)")
+    parser.add_argument("--replay", metavar="FILE", help="回放飞行记录文件")
+    parser.add_argument("--hil", metavar="FILE", help="把飞行记录中的编码器/摇杆样本回放到设备的模拟输入")
+    parser.add_argument("--hil-pins", type=_int_pair, default=(33, 32), metavar="X,Y", help="摇杆 ADC 引脚")
+    parser.add_argument("--hil-center", type=_int_pair, default=(2048, 2048), metavar="X,Y",
+                        help="设备的摇杆中心值 (config get 中的 joystick.center_x/center_y)")
+    parser.add_argument("--hil-invert", default="y", metavar="AXES", help="设备上反转的轴, 例如 y, xy 或空字符串")
+    parser.add_argument("--hil-button", type=int, default=12, metavar="PIN", help="摇杆按钮引脚, -1 表示不回放按钮")
+    parser.add_argument("--hil-steps", type=int, default=4, help="编码器每刻度步数 (encoder.steps_per_notch)")
+    parser.add_argument("--hil-dump", metavar="FILE", help="不连接设备, 把 --hil 的命令写成主机测试轨迹 (test/traces)")
+    args = parser.parse_args()
+
+    try:
+        if args.replay:
+            run_replay(args.replay)
+        elif args.hil:
+            mapper = HilMapper(args.hil_pins, args.hil_center,
+                               ("x" in args.hil_invert, "y" in args.hil_invert),
+                               args.hil_button if args.hil_button >= 0 else None, args.hil_steps)
+            if args.hil_dump:
+                run_hil_dump(args.hil, mapper, args.hil_dump)
+            else:
+                run_hil(args.host, args.port, args.hil, mapper, args.serial, args.baudrate)
+        elif args.download:
+            run_download(args.host, args.port, args.download, args.serial, args.baudrate)
+        elif args.bench:
+            run_bench(args.host, args.port, args.udp, args.bench, args.report,
+                      args.serial, args.baudrate, args.bench_start, args.multicast)
+        elif args.serial:
+            run_serial(args.serial, args.baudrate, args.count)
+        elif args.udp:
+            run_udp(args.host, args.port, args.multicast, args.command)
+        else:
+            run_tcp_server(args.host, args.port, args.command)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
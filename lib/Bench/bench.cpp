@@ -0,0 +1,389 @@
+#include "bench.h"
+#include "sampler.h"
+#include "data_service.h"
+#include "wifi_task.h"
+#include "uart_parser.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "BENCH";
+
+// 压测期间需要暂停的真实采样器 (与 BENCH_STREAM_* 位一一对应)
+static const char* const real_sampler_names[] = {"encoder", "joystick"};
+#define REAL_SAMPLER_COUNT  (sizeof(real_sampler_names) / sizeof(real_sampler_names[0]))
+
+// 全局变量
+static int bench_sampler = -1;
+static volatile bool bench_running = false;
+static uint8_t bench_streams = 0;
+static uint32_t bench_rate_hz = 0;
+static uint32_t bench_limit = 0;                // 每个流的样本总数上限 (0 = 不限)
+static uint32_t bench_duration_ms = 0;
+static int64_t bench_start_us = 0;
+static int64_t bench_end_us = 0;
+static volatile uint32_t bench_generated = 0;   // 每个流已生成的样本数
+static bool real_paused[REAL_SAMPLER_COUNT];
+static uint32_t encoder_dropped_base = 0;
+static uint32_t joystick_dropped_base = 0;
+static uint32_t pool_exhausted_base = 0;
+
+static void pause_real_samplers(uint8_t streams) {
+    for (size_t i = 0; i < REAL_SAMPLER_COUNT; i++) {
+        real_paused[i] = false;
+        if (!(streams & (1 << i))) {
+            continue;
+        }
+        int id = sampler_find(real_sampler_names[i]);
+        if (id >= 0 && sampler_is_enabled(id) && sampler_set_enabled(id, false) == ESP_OK) {
+            real_paused[i] = true;
+        }
+    }
+}
+
+static void resume_real_samplers(void) {
+    for (size_t i = 0; i < REAL_SAMPLER_COUNT; i++) {
+        if (real_paused[i]) {
+            sampler_set_enabled(sampler_find(real_sampler_names[i]), true);
+            real_paused[i] = false;
+        }
+    }
+}
+
+static void emit_encoder(uint32_t n) {
+    encoder_data_t data = {
+        .position = (int32_t)(n + 1),
+        .delta = 1,
+        .button_pressed = false,
+        .timestamp = xTaskGetTickCount(),
+        .sample_us = (uint32_t)esp_timer_get_time(),
+        .publish_us = (uint32_t)esp_timer_get_time(),
+    };
+    data_service_update_encoder(&data);
+}
+
+static void emit_joystick(uint32_t n) {
+    joystick_data_t data;
+    memset(&data, 0, sizeof(data));
+    data.sample_us = (uint32_t)esp_timer_get_time();
+    data.x = (int16_t)((int32_t)(n % 1024) - 512);     // 锯齿波，上位机据此检测源头丢失
+    data.y = 0;
+    data.raw_x = (uint16_t)((data.x + 512) * 4);
+    data.raw_y = 2048;
+    data.magnitude = fminf(fabsf((float)data.x) / 512.0f, 1.0f);
+    data.angle = data.x < 0 ? 180.0f : 0.0f;
+    data.magnitude_q15 = (uint16_t)(data.magnitude * 32767.0f);
+    data.angle_cdeg = (uint16_t)(data.angle * 100.0f);
+    data.timestamp = xTaskGetTickCount();
+    data.publish_us = (uint32_t)esp_timer_get_time();
+    data_service_update_joystick(&data);
+}
+
+// 结束压测 (bench 采样任务或串口任务调用，只有一方生效)
+static bool bench_finish(void) {
+    if (!__atomic_exchange_n(&bench_running, false, __ATOMIC_SEQ_CST)) {
+        return false;
+    }
+    sampler_set_enabled(bench_sampler, false);
+    bench_end_us = esp_timer_get_time();
+    return true;
+}
+
+// bench 采样器处理函数：按实际经过的时间补齐应生成的样本，定时器抖动不会累积为速率误差
+static void bench_handler(void) {
+    if (!bench_running) {
+        return;
+    }
+
+    uint64_t elapsed_us = (uint64_t)(esp_timer_get_time() - bench_start_us);
+    uint64_t due = elapsed_us * bench_rate_hz / 1000000ULL + 1;
+    if (bench_limit != 0 && due > bench_limit) {
+        due = bench_limit;
+    }
+
+    uint32_t generated = bench_generated;
+    uint32_t burst = 0;
+    while (generated < due && burst < BENCH_MAX_BURST) {
+        if (bench_streams & BENCH_STREAM_ENCODER) {
+            emit_encoder(generated);
+        }
+        if (bench_streams & BENCH_STREAM_JOYSTICK) {
+            emit_joystick(generated);
+        }
+        generated++;
+        burst++;
+    }
+    bench_generated = generated;
+
+    if (bench_limit != 0 && generated >= bench_limit && bench_finish()) {
+        // 自身就是最后一个写入者，处理函数返回后不会再写，真实采样器可以立即恢复
+        resume_real_samplers();
+        ESP_LOGI(TAG, "Bench finished: %lu samples per stream", (unsigned long)generated);
+    }
+}
+
+esp_err_t bench_start(uint8_t streams, uint32_t rate_hz, uint32_t duration_s) {
+    if ((streams & BENCH_STREAM_BOTH) == 0 || rate_hz < BENCH_MIN_RATE_HZ || rate_hz > BENCH_MAX_RATE_HZ) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (bench_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    pause_real_samplers(streams);
+    vTaskDelay(pdMS_TO_TICKS(BENCH_SETTLE_MS));
+
+    network_tx_stats_t tx_stats;
+    network_tx_get_stats(&tx_stats);
+    pool_exhausted_base = tx_stats.pool_exhausted;
+    data_service_get_ring_stats(DATA_SERVICE_ALL_SUBSCRIBERS, BIT_EVENT_ENCODER_UPDATED, NULL, &encoder_dropped_base);
+    data_service_get_ring_stats(DATA_SERVICE_ALL_SUBSCRIBERS, BIT_EVENT_JOYSTICK_UPDATED, NULL, &joystick_dropped_base);
+
+    bench_streams = streams & BENCH_STREAM_BOTH;
+    bench_rate_hz = rate_hz;
+    bench_duration_ms = duration_s * 1000;
+    bench_limit = rate_hz * duration_s;
+    bench_generated = 0;
+    bench_start_us = esp_timer_get_time();
+    bench_end_us = 0;
+    bench_running = true;
+
+    // 定时器频率受采样器上限约束，更高的速率由处理函数在每个周期内批量生成
+    uint32_t tick_hz = rate_hz < SAMPLER_MAX_RATE_HZ ? rate_hz : SAMPLER_MAX_RATE_HZ;
+    esp_err_t ret = ESP_OK;
+    if (bench_sampler < 0) {
+        // 任务核心/优先级见任务规划表中的 "bench"
+        sampler_config_t config = {
+            .name = "bench",
+            .handler = bench_handler,
+            .rate_hz = tick_hz,
+        };
+        bench_sampler = sampler_create(&config);
+        if (bench_sampler < 0) {
+            ret = ESP_ERR_NO_MEM;
+        }
+    } else {
+        ret = sampler_set_rate(bench_sampler, tick_hz);
+        if (ret == ESP_OK) {
+            ret = sampler_set_enabled(bench_sampler, true);
+        }
+    }
+
+    if (ret != ESP_OK) {
+        bench_running = false;
+        resume_real_samplers();
+        ESP_LOGE(TAG, "Failed to start bench sampler");
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Bench started: streams 0x%02X, %lu Hz, %lu s", bench_streams,
+             (unsigned long)rate_hz, (unsigned long)duration_s);
+    return ESP_OK;
+}
+
+esp_err_t bench_stop(void) {
+    if (!bench_finish()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 等 bench 处理函数返回后再恢复真实采样器，保持单写入者
+    vTaskDelay(pdMS_TO_TICKS(BENCH_SETTLE_MS));
+    resume_real_samplers();
+    ESP_LOGI(TAG, "Bench stopped: %lu samples per stream", (unsigned long)bench_generated);
+    return ESP_OK;
+}
+
+void bench_get_status(bench_status_t* status) {
+    if (status == NULL) {
+        return;
+    }
+    memset(status, 0, sizeof(*status));
+    status->running = bench_running;
+    status->streams = bench_streams;
+    status->rate_hz = bench_rate_hz;
+    status->duration_ms = bench_duration_ms;
+    if (bench_start_us != 0) {
+        int64_t end_us = status->running || bench_end_us == 0 ? esp_timer_get_time() : bench_end_us;
+        status->elapsed_ms = (uint32_t)((end_us - bench_start_us) / 1000);
+    }
+
+    uint32_t generated = bench_generated;
+    status->encoder_samples = (bench_streams & BENCH_STREAM_ENCODER) ? generated : 0;
+    status->joystick_samples = (bench_streams & BENCH_STREAM_JOYSTICK) ? generated : 0;
+
+    uint32_t dropped = 0;
+    network_tx_stats_t tx_stats;
+    data_service_get_ring_stats(DATA_SERVICE_ALL_SUBSCRIBERS, BIT_EVENT_ENCODER_UPDATED, NULL, &dropped);
+    status->encoder_dropped = dropped - encoder_dropped_base;
+    data_service_get_ring_stats(DATA_SERVICE_ALL_SUBSCRIBERS, BIT_EVENT_JOYSTICK_UPDATED, NULL, &dropped);
+    status->joystick_dropped = dropped - joystick_dropped_base;
+    network_tx_get_stats(&tx_stats);
+    status->pool_exhausted = tx_stats.pool_exhausted - pool_exhausted_base;
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+static void print_status(void) {
+    char response[128];
+    bench_status_t status;
+    bench_get_status(&status);
+
+    if (status.rate_hz == 0) {
+        uart_parser_put_string("Bench idle.\r\n");
+        return;
+    }
+    char duration[16];
+    if (status.duration_ms) {
+        snprintf(duration, sizeof(duration), "%lu", (unsigned long)status.duration_ms);
+    } else {
+        strcpy(duration, "inf");
+    }
+    snprintf(response, sizeof(response), "Bench %s: %s%s%s %lu Hz, %lu/%s ms\r\n",
+             status.running ? "running" : "finished",
+             (status.streams & BENCH_STREAM_ENCODER) ? "encoder" : "",
+             (status.streams == BENCH_STREAM_BOTH) ? "+" : "",
+             (status.streams & BENCH_STREAM_JOYSTICK) ? "joystick" : "",
+             (unsigned long)status.rate_hz, (unsigned long)status.elapsed_ms, duration);
+    uart_parser_put_string(response);
+
+    snprintf(response, sizeof(response), "  generated: encoder %lu  joystick %lu\r\n",
+             (unsigned long)status.encoder_samples, (unsigned long)status.joystick_samples);
+    uart_parser_put_string(response);
+    snprintf(response, sizeof(response), "  dropped:   encoder ring %lu  joystick ring %lu  frame pool %lu\r\n",
+             (unsigned long)status.encoder_dropped, (unsigned long)status.joystick_dropped,
+             (unsigned long)status.pool_exhausted);
+    uart_parser_put_string(response);
+}
+
+static void handle_micro(int argc, char *argv[]) {
+    static const char* const test_names[BENCH_MICRO_COUNT] = {"parser", "data", "encode", "joystick"};
+    int first = 0;
+    int last = BENCH_MICRO_COUNT - 1;
+    if (argc >= 3 && strcmp(argv[2], "all") != 0) {
+        first = -1;
+        for (int i = 0; i < BENCH_MICRO_COUNT; i++) {
+            if (strcmp(argv[2], test_names[i]) == 0) {
+                first = last = i;
+            }
+        }
+    }
+    char *end = NULL;
+    long iterations = BENCH_MICRO_DEFAULT_ITERATIONS;
+    bool iterations_ok = true;
+    if (argc >= 4) {
+        iterations = strtol(argv[3], &end, 10);
+        iterations_ok = end != argv[3] && *end == '\0' && iterations >= 1 && iterations <= BENCH_MICRO_MAX_ITERATIONS;
+    }
+    if (first < 0 || !iterations_ok) {
+        char response[112];
+        snprintf(response, sizeof(response),
+                 "Usage: bench micro [parser|data|encode|joystick|all] [iterations] (1-%d)\r\n",
+                 BENCH_MICRO_MAX_ITERATIONS);
+        uart_parser_put_string(response);
+        return;
+    }
+
+    if (bench_running) {
+        uart_parser_put_string("Error: Bench running. Use 'bench stop' first.\r\n");
+        return;
+    }
+
+    char response[96];
+    snprintf(response, sizeof(response), "%-30s %8s %10s %8s %8s\r\n", "test", "iter", "total_us", "ns/op", "cyc/op");
+    uart_parser_put_string(response);
+    for (int i = first; i <= last; i++) {
+        bench_micro_result_t results[BENCH_MICRO_MAX_RESULTS];
+        size_t count = 0;
+        esp_err_t ret = bench_micro_run((bench_micro_t)i, (uint32_t)iterations, results, &count);
+        for (size_t n = 0; n < count; n++) {
+            snprintf(response, sizeof(response), "%-30s %8lu %10lu %8lu %8lu\r\n", results[n].name,
+                     (unsigned long)results[n].iterations, (unsigned long)results[n].elapsed_us,
+                     (unsigned long)results[n].ns_per_op, (unsigned long)results[n].cycles_per_op);
+            uart_parser_put_string(response);
+        }
+        if (ret != ESP_OK) {
+            snprintf(response, sizeof(response), "%-30s skipped (%s)\r\n", test_names[i], esp_err_to_name(ret));
+            uart_parser_put_string(response);
+        }
+    }
+}
+
+static void handle_bench(int argc, char *argv[]) {
+    if (argc < 2) {
+        print_status();
+        return;
+    }
+
+    if (strcmp(argv[1], "micro") == 0) {
+        handle_micro(argc, argv);
+        return;
+    }
+
+    if (strcmp(argv[1], "stop") == 0) {
+        if (bench_stop() != ESP_OK) {
+            uart_parser_put_string("Bench not running.\r\n");
+            return;
+        }
+        print_status();
+        return;
+    }
+
+    uint8_t streams = 0;
+    if (strcmp(argv[1], "encoder") == 0) {
+        streams = BENCH_STREAM_ENCODER;
+    } else if (strcmp(argv[1], "joystick") == 0) {
+        streams = BENCH_STREAM_JOYSTICK;
+    } else if (strcmp(argv[1], "both") == 0) {
+        streams = BENCH_STREAM_BOTH;
+    }
+
+    char *end = NULL;
+    long rate_hz = argc >= 3 ? strtol(argv[2], &end, 10) : 0;
+    bool rate_ok = argc >= 3 && end != argv[2] && *end == '\0';
+    long duration_s = 0;
+    bool duration_ok = true;
+    if (argc >= 4) {
+        duration_s = strtol(argv[3], &end, 10);
+        duration_ok = end != argv[3] && *end == '\0' && duration_s >= 0 && duration_s <= 3600;
+    }
+
+    if (streams == 0 || !rate_ok || !duration_ok) {
+        char response[112];
+        snprintf(response, sizeof(response),
+                 "Usage: bench <encoder|joystick|both> <rate_hz> (%d-%d) [seconds] | bench stop\r\n",
+                 BENCH_MIN_RATE_HZ, BENCH_MAX_RATE_HZ);
+        uart_parser_put_string(response);
+        return;
+    }
+
+    esp_err_t ret = bench_start(streams, (uint32_t)rate_hz, (uint32_t)duration_s);
+    if (ret == ESP_ERR_INVALID_STATE) {
+        uart_parser_put_string("Error: Bench already running. Use 'bench stop' first.\r\n");
+        return;
+    }
+    if (ret != ESP_OK) {
+        char response[80];
+        snprintf(response, sizeof(response), "Error: rate must be %d-%d Hz.\r\n",
+                 BENCH_MIN_RATE_HZ, BENCH_MAX_RATE_HZ);
+        uart_parser_put_string(ret == ESP_ERR_INVALID_ARG ? response : "Error: Failed to start bench.\r\n");
+        return;
+    }
+    uart_parser_put_string("Bench started.\r\n");
+}
+
+// 空命令：bench micro parser 测量分词 + 查找 + 分派的开销
+static void handle_nop(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+}
+
+static const command_t bench_commands[] = {
+    {"bench", handle_bench, "bench [<encoder|joystick|both> <rate_hz> [seconds] | stop | micro [test] [iterations]]: 生成合成样本压测网络链路，或运行微基准测试。"},
+    {"nop", handle_nop, "nop [args...]: 不执行任何操作 (命令分派基准测试用)。"},
+};
+
+void bench_register_commands(void) {
+    uart_parser_register_commands(bench_commands, sizeof(bench_commands) / sizeof(bench_commands[0]));
+}
@@ -0,0 +1,125 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 合成流选择位
+ */
+#define BENCH_STREAM_ENCODER    (1 << 0)
+#define BENCH_STREAM_JOYSTICK   (1 << 1)
+#define BENCH_STREAM_BOTH       (BENCH_STREAM_ENCODER | BENCH_STREAM_JOYSTICK)
+
+/**
+ * @brief 每个流的生成速率范围 (样本/秒)
+ * @details 超过 SAMPLER_MAX_RATE_HZ 时每个定时器周期生成多个样本
+ */
+#define BENCH_MIN_RATE_HZ       1
+#define BENCH_MAX_RATE_HZ       5000
+
+/**
+ * @brief 单个周期内每个流最多补发的样本数 (被抢占后追赶时避免一次性塞满环形缓冲区)
+ */
+#ifndef BENCH_MAX_BURST
+#define BENCH_MAX_BURST         16
+#endif
+
+/**
+ * @brief 暂停真实采样器后的等待时间 (毫秒)，确保正在执行的处理函数已经返回
+ */
+#define BENCH_SETTLE_MS         20
+
+// 压测状态
+typedef struct {
+    bool     running;           // 是否正在生成
+    uint8_t  streams;           // BENCH_STREAM_*
+    uint32_t rate_hz;           // 每个流的生成速率
+    uint32_t duration_ms;       // 设定时长 (0 = 一直运行到 bench stop)
+    uint32_t elapsed_ms;        // 已运行时间
+    uint32_t encoder_samples;   // 已生成的编码器样本数
+    uint32_t joystick_samples;  // 已生成的摇杆样本数
+    uint32_t encoder_dropped;   // 本次压测期间编码器环形缓冲区丢弃数
+    uint32_t joystick_dropped;  // 本次压测期间摇杆环形缓冲区丢弃数
+    uint32_t pool_exhausted;    // 本次压测期间帧池耗尽次数 (网络已连接或正在重连时)
+} bench_status_t;
+
+/**
+ * @brief 开始生成合成的编码器/摇杆样本
+ * @details 样本直接写入 DataPlatform，经过数据发布任务、帧池和网络发送任务，与真实样本
+ *          走同一条路径。期间暂停对应的真实采样器 ("encoder" / "joystick")，保持 DataPlatform
+ *          单写入者，结束后恢复。
+ *          编码器样本 position 每次加 1，摇杆样本 x 按 -512..511 锯齿递增，
+ *          上位机可由此区分源头丢失 (环形缓冲区/帧池) 与网络丢失 (帧序号)。
+ * @param streams     BENCH_STREAM_*
+ * @param rate_hz     每个流的生成速率 (BENCH_MIN_RATE_HZ 到 BENCH_MAX_RATE_HZ)
+ * @param duration_s  运行时长 (秒)，0 表示一直运行
+ * @return ESP_OK 成功；ESP_ERR_INVALID_ARG 参数错误；ESP_ERR_INVALID_STATE 已在运行
+ */
+esp_err_t bench_start(uint8_t streams, uint32_t rate_hz, uint32_t duration_s);
+
+/**
+ * @brief 停止生成并恢复真实采样器
+ * @return ESP_OK 成功；ESP_ERR_INVALID_STATE 未在运行
+ */
+esp_err_t bench_stop(void);
+
+/**
+ * @brief 获取压测状态 (运行结束后保留最后一次的计数)
+ */
+void bench_get_status(bench_status_t* status);
+
+/* -------------------- 微基准测试 (bench_micro.cpp) -------------------- */
+
+// 微基准测试项
+typedef enum {
+    BENCH_MICRO_PARSER = 0,     // 命令行分词 + 哈希查找 + 分派
+    BENCH_MICRO_DATA,           // DataPlatform 分段写入/读取，有无另一核心上的并发读者
+    BENCH_MICRO_ENCODE,         // 遥测编码 (二进制帧 / JSON)
+    BENCH_MICRO_JOYSTICK,       // 摇杆换算 (轴映射、死区、幅度、角度)
+    BENCH_MICRO_COUNT
+} bench_micro_t;
+
+#define BENCH_MICRO_DEFAULT_ITERATIONS  10000
+#define BENCH_MICRO_MAX_ITERATIONS      200000  // 并发读者在核心0忙等，限制时长避免空闲任务看门狗
+#define BENCH_MICRO_MAX_RESULTS         4       // 每个测试项最多输出的结果行数
+
+// 一行测试结果
+typedef struct {
+    const char* name;
+    uint32_t iterations;
+    uint32_t elapsed_us;
+    uint32_t ns_per_op;
+    uint32_t cycles_per_op;     // 按当前 CPU 频率换算
+} bench_micro_result_t;
+
+/**
+ * @brief 运行一项微基准测试并等待完成
+ * @details 测试在核心1上的临时任务中执行 (与采样任务同一核心，不受 WiFi 协议栈干扰)，调用方阻塞等待。
+ *          DataPlatform 测试使用没有写入者和订阅者的 IMU 分段，不影响实际数据；并发读者是核心0上的临时任务。
+ *          编码测试使用独立的帧序号，不影响实时遥测。
+ * @param test       测试项
+ * @param iterations 每行的迭代次数 (1 到 BENCH_MICRO_MAX_ITERATIONS)
+ * @param results    输出，至少 BENCH_MICRO_MAX_RESULTS 项
+ * @param count      输出的结果行数
+ * @return ESP_OK 成功；ESP_ERR_INVALID_ARG 参数错误；ESP_ERR_INVALID_STATE 摇杆未初始化 (joystick) 或上一次测试未结束；
+ *         ESP_ERR_NO_MEM 创建任务失败；ESP_ERR_TIMEOUT 测试超时 (测试任务结束前再次调用返回 ESP_ERR_INVALID_STATE，
+ *         结束后自动恢复)
+ */
+esp_err_t bench_micro_run(bench_micro_t test, uint32_t iterations, bench_micro_result_t* results, size_t* count);
+
+/**
+ * @brief 注册 'bench' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void bench_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BENCH_H
@@ -0,0 +1,302 @@
+#include "bench.h"
+#include "data_service.h"
+#include "telemetry_frame.h"
+#include "joystick_driver.h"
+#include "task_plan.h"
+#include "uart_parser.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+static const char* TAG = "BENCH_MICRO";
+
+#define MICRO_TASK_NAME         "bench_micro"
+#define MICRO_READER_TASK_NAME  "bench_reader"
+#define MICRO_TIMEOUT_MS        10000
+
+// 一次测试的参数与结果 (测试任务写入，调用方在信号量之后复制出去)
+// 结果放在静态的任务参数中而不是调用方的缓冲区：调用方超时返回后测试任务仍可能在写入
+typedef struct {
+    bench_micro_t test;
+    uint32_t iterations;
+    bench_micro_result_t results[BENCH_MICRO_MAX_RESULTS];
+    size_t count;
+    esp_err_t ret;
+} micro_job_t;
+
+static micro_job_t s_job;
+static SemaphoreHandle_t s_done = NULL;
+static SemaphoreHandle_t s_reader_done = NULL;
+
+// 测试任务与调用方的交接状态 (s_lock 保护)：调用方超时后置 abandoned，测试任务结束时自行清除 busy
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_busy = false;
+static bool s_finished = false;
+static bool s_abandoned = false;
+
+// 并发读者
+static volatile bool s_reader_run = false;
+static volatile uint32_t s_reader_reads = 0;
+static volatile uint32_t s_reader_elapsed_us = 0;
+
+// 防止编译器把测试主体当作无用代码删除
+static volatile uint32_t s_sink = 0;
+
+static void add_result(micro_job_t* job, const char* name, uint32_t iterations, int64_t elapsed_us) {
+    if (job->count >= BENCH_MICRO_MAX_RESULTS) {
+        return;
+    }
+    bench_micro_result_t* result = &job->results[job->count++];
+    result->name = name;
+    result->iterations = iterations;
+    result->elapsed_us = (uint32_t)elapsed_us;
+    result->ns_per_op = iterations > 0 ? (uint32_t)((uint64_t)elapsed_us * 1000 / iterations) : 0;
+    result->cycles_per_op = (uint32_t)((uint64_t)result->ns_per_op * getCpuFrequencyMhz() / 1000);
+}
+
+/* -------------------- 命令分派 -------------------- */
+
+static void run_parser(micro_job_t* job) {
+    static const char* const lines[] = {"nop", "nop 1 2 \"a b\""};
+    static const char* const names[] = {"dispatch 'nop'", "dispatch 'nop 1 2 \"a b\"'"};
+    char line[UART_PARSER_LINE_SIZE];
+
+    for (size_t n = 0; n < sizeof(lines) / sizeof(lines[0]); n++) {
+        size_t len = strlen(lines[n]) + 1;
+        int64_t start_us = esp_timer_get_time();
+        for (uint32_t i = 0; i < job->iterations; i++) {
+            memcpy(line, lines[n], len);   // 分词会原地修改命令行
+            uart_parser_dispatch(line);
+        }
+        add_result(job, names[n], job->iterations, esp_timer_get_time() - start_us);
+    }
+}
+
+/* -------------------- DataPlatform -------------------- */
+
+static void reader_task(void* parameter) {
+    imu_data_t imu;
+    uint32_t reads = 0;
+    int64_t start_us = esp_timer_get_time();
+    while (s_reader_run) {
+        s_sink += data_service_get_imu(&imu);
+        reads++;
+    }
+    s_reader_elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    s_reader_reads = reads;
+    xSemaphoreGive(s_reader_done);
+    task_plan_delete(NULL);
+}
+
+static void run_data(micro_job_t* job) {
+    imu_data_t imu;
+    memset(&imu, 0, sizeof(imu));
+
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < job->iterations; i++) {
+        imu.accel_x = (float)i;
+        data_service_update_imu(&imu);
+    }
+    add_result(job, "imu write", job->iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < job->iterations; i++) {
+        s_sink += data_service_get_imu(&imu);
+    }
+    add_result(job, "imu read", job->iterations, esp_timer_get_time() - start_us);
+
+    // 核心0上的读者持续读取同一分段，写入方与读者的缓存行争用和读者重试都计入结果
+    s_reader_run = true;
+    if (task_plan_create(reader_task, MICRO_READER_TASK_NAME, 2048, NULL, tskIDLE_PRIORITY + 1, NULL,
+                         TASK_PLAN_CORE_NETWORK) != pdPASS) {
+        s_reader_run = false;
+        ESP_LOGW(TAG, "Failed to start reader task, contention test skipped");
+        return;
+    }
+    vTaskDelay(pdMS_TO_TICKS(2));
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < job->iterations; i++) {
+        imu.accel_x = (float)i;
+        data_service_update_imu(&imu);
+    }
+    add_result(job, "imu write + reader", job->iterations, esp_timer_get_time() - start_us);
+    s_reader_run = false;
+    if (xSemaphoreTake(s_reader_done, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        add_result(job, "imu read (core0, concurrent)", s_reader_reads, s_reader_elapsed_us);
+    }
+}
+
+/* -------------------- 遥测编码 -------------------- */
+
+static void run_encode(micro_job_t* job) {
+    uint8_t buf[TELEMETRY_FRAME_OVERHEAD + TELEMETRY_FRAME_MAX_PAYLOAD];
+    encoder_data_t encoder = {
+        .position = -123456,
+        .delta = 3,
+        .button_pressed = true,
+        .timestamp = 987654,
+        .sample_us = 0,
+        .publish_us = 0,
+    };
+    joystick_data_t joystick;
+    memset(&joystick, 0, sizeof(joystick));
+    joystick.x = -317;
+    joystick.y = 402;
+    joystick.magnitude_q15 = 32767;
+    joystick.magnitude = 1.0f;
+    joystick.angle_cdeg = 12821;
+    joystick.angle = 128.21f;
+    joystick.timestamp = 987654;
+
+    // 二进制路径与 telemetry_encode_* 相同 (打包 + 加帧头和 CRC)，使用独立的帧序号
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < job->iterations; i++) {
+        telemetry_encoder_payload_t payload;
+        encoder.position = (int32_t)i;
+        telemetry_pack_encoder(&encoder, &payload);
+        s_sink += telemetry_frame_build_seq(TELEMETRY_FRAME_ENCODER, (uint16_t)i, &payload, sizeof(payload),
+                                            buf, sizeof(buf));
+    }
+    add_result(job, "encoder binary", job->iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < job->iterations; i++) {
+        encoder.position = (int32_t)i;
+        s_sink += telemetry_json_encoder(&encoder, buf, sizeof(buf));
+    }
+    add_result(job, "encoder json", job->iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < job->iterations; i++) {
+        telemetry_joystick_payload_t payload;
+        joystick.x = (int16_t)(i & 511);
+        telemetry_pack_joystick(&joystick, &payload);
+        s_sink += telemetry_frame_build_seq(TELEMETRY_FRAME_JOYSTICK, (uint16_t)i, &payload, sizeof(payload),
+                                            buf, sizeof(buf));
+    }
+    add_result(job, "joystick binary", job->iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < job->iterations; i++) {
+        joystick.x = (int16_t)(i & 511);
+        s_sink += telemetry_json_joystick(&joystick, buf, sizeof(buf));
+    }
+    add_result(job, "joystick json", job->iterations, esp_timer_get_time() - start_us);
+}
+
+/* -------------------- 摇杆换算 -------------------- */
+
+static void run_joystick(micro_job_t* job) {
+    uint16_t center_x, center_y;
+    joystick_get_center(&center_x, &center_y);
+    if (center_x == 0 || center_y == 0) {
+        job->ret = ESP_ERR_INVALID_STATE;   // 驱动未初始化，映射系数无效
+        return;
+    }
+
+    joystick_data_t data;
+    // 原始值在 12 位范围内按质数步长扫过，覆盖死区内外和全部象限
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < job->iterations; i++) {
+        joystick_process_raw((uint16_t)((i * 37) & 4095), (uint16_t)((i * 101 + 1024) & 4095), &data);
+        s_sink += data.angle_cdeg;
+    }
+    add_result(job, "joystick_process_raw (sweep)", job->iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < job->iterations; i++) {
+        joystick_process_raw(center_x, center_y, &data);
+        s_sink += data.angle_cdeg;
+    }
+    add_result(job, "joystick_process_raw (center)", job->iterations, esp_timer_get_time() - start_us);
+}
+
+/* -------------------- 测试任务 -------------------- */
+
+static void micro_task(void* parameter) {
+    micro_job_t* job = (micro_job_t*)parameter;
+    switch (job->test) {
+        case BENCH_MICRO_PARSER:   run_parser(job);   break;
+        case BENCH_MICRO_DATA:     run_data(job);     break;
+        case BENCH_MICRO_ENCODE:   run_encode(job);   break;
+        case BENCH_MICRO_JOYSTICK: run_joystick(job); break;
+        default:                   job->ret = ESP_ERR_INVALID_ARG; break;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    bool abandoned = s_abandoned;
+    s_finished = true;
+    if (abandoned) {
+        s_busy = false;     // 调用方已超时返回，没有人等待信号量
+    }
+    portEXIT_CRITICAL(&s_lock);
+    if (abandoned) {
+        ESP_LOGW(TAG, "Micro benchmark finished after timeout, results discarded");
+    } else {
+        xSemaphoreGive(s_done);
+    }
+    task_plan_delete(NULL);
+}
+
+esp_err_t bench_micro_run(bench_micro_t test, uint32_t iterations, bench_micro_result_t* results, size_t* count) {
+    if ((int)test < 0 || test >= BENCH_MICRO_COUNT || iterations == 0 || iterations > BENCH_MICRO_MAX_ITERATIONS ||
+        results == NULL || count == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *count = 0;
+    if (s_done == NULL) {
+        s_done = xSemaphoreCreateBinary();
+        s_reader_done = xSemaphoreCreateBinary();
+        if (s_done == NULL || s_reader_done == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    bool busy = s_busy;
+    if (!busy) {
+        s_busy = true;
+        s_finished = false;
+        s_abandoned = false;
+    }
+    portEXIT_CRITICAL(&s_lock);
+    if (busy) {
+        return ESP_ERR_INVALID_STATE;   // 上一次超时的测试仍在运行
+    }
+    xSemaphoreTake(s_done, 0);
+
+    s_job.test = test;
+    s_job.iterations = iterations;
+    s_job.count = 0;
+    s_job.ret = ESP_OK;
+
+    if (task_plan_create(micro_task, MICRO_TASK_NAME, 4096, &s_job, tskIDLE_PRIORITY + 2, NULL,
+                         TASK_PLAN_CORE_REALTIME) != pdPASS) {
+        portENTER_CRITICAL(&s_lock);
+        s_busy = false;
+        portEXIT_CRITICAL(&s_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    if (xSemaphoreTake(s_done, pdMS_TO_TICKS(MICRO_TIMEOUT_MS)) != pdTRUE) {
+        portENTER_CRITICAL(&s_lock);
+        bool finished = s_finished;
+        s_abandoned = !finished;
+        portEXIT_CRITICAL(&s_lock);
+        if (!finished) {
+            // 测试任务仍在运行：结果留在 s_job 中，它结束时清除 busy
+            ESP_LOGW(TAG, "Micro benchmark timed out");
+            return ESP_ERR_TIMEOUT;
+        }
+        // 超时与完成同时发生：测试任务已经决定发出信号量
+        xSemaphoreTake(s_done, portMAX_DELAY);
+    }
+
+    memcpy(results, s_job.results, s_job.count * sizeof(results[0]));
+    *count = s_job.count;
+    esp_err_t ret = s_job.ret;
+    portENTER_CRITICAL(&s_lock);
+    s_busy = false;
+    portEXIT_CRITICAL(&s_lock);
+    return ret;
+}
@@ -0,0 +1,269 @@
+#include "boot_sequencer.h"
+#include "task_plan.h"
+#include "uart_parser.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* TAG = "BOOT";
+
+static const char* const milestone_names[BOOT_MILESTONE_COUNT] = {
+    "setup_done",
+    "first_sample",
+    "wifi_connected",
+    "network_online",
+    "first_frame",
+};
+
+// 并行步骤的工作任务参数 (与阶段记录一一对应，工作任务在超时后仍可安全访问)
+typedef struct {
+    boot_step_fn_t fn;
+    int stage;
+    SemaphoreHandle_t done;
+} boot_job_t;
+
+// 全局变量
+static boot_stage_t stages[BOOT_MAX_STAGES];
+static size_t stage_count = 0;
+static boot_job_t jobs[BOOT_MAX_STAGES];
+static volatile uint32_t milestones_us[BOOT_MILESTONE_COUNT];
+static portMUX_TYPE boot_mux = portMUX_INITIALIZER_UNLOCKED;
+
+// esp_timer 启动以来的微秒数，0 保留为 "未记录"
+static uint32_t boot_now_us(void) {
+    uint32_t now_us = (uint32_t)esp_timer_get_time();
+    return now_us != 0 ? now_us : 1;
+}
+
+static int stage_alloc(const char* name, bool parallel) {
+    int stage = -1;
+    portENTER_CRITICAL(&boot_mux);
+    if (stage_count < BOOT_MAX_STAGES) {
+        stage = (int)stage_count++;
+        stages[stage].name = name;
+        stages[stage].start_us = boot_now_us();
+        stages[stage].end_us = 0;
+        stages[stage].result = ESP_OK;
+        stages[stage].core = (int8_t)xPortGetCoreID();
+        stages[stage].parallel = parallel;
+    }
+    portEXIT_CRITICAL(&boot_mux);
+    if (stage < 0) {
+        ESP_LOGW(TAG, "Stage table full, '%s' not recorded", name ? name : "?");
+    }
+    return stage;
+}
+
+int boot_stage_begin(const char* name) {
+    return stage_alloc(name, false);
+}
+
+void boot_stage_end(int stage, esp_err_t result) {
+    if (stage < 0 || stage >= BOOT_MAX_STAGES) {
+        return;
+    }
+    uint32_t end_us = boot_now_us();
+    portENTER_CRITICAL(&boot_mux);
+    stages[stage].result = result;
+    stages[stage].end_us = end_us;
+    portEXIT_CRITICAL(&boot_mux);
+    ESP_LOGI(TAG, "%s: %lu us%s", stages[stage].name, (unsigned long)(end_us - stages[stage].start_us),
+             result == ESP_OK ? "" : " (failed)");
+}
+
+static void run_job(boot_job_t* job) {
+    portENTER_CRITICAL(&boot_mux);
+    stages[job->stage].start_us = boot_now_us();
+    stages[job->stage].core = (int8_t)xPortGetCoreID();
+    portEXIT_CRITICAL(&boot_mux);
+    boot_stage_end(job->stage, job->fn());
+}
+
+static void boot_worker_task(void* parameter) {
+    boot_job_t* job = (boot_job_t*)parameter;
+    run_job(job);
+    xSemaphoreGive(job->done);
+    task_plan_delete(NULL);
+}
+
+esp_err_t boot_run_parallel(const boot_step_t* steps, size_t count, uint32_t timeout_ms) {
+    if (steps == NULL || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(count, 0);
+    if (done == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    int first_stage = -1;
+    int last_stage = -1;
+    size_t started = 0;
+    esp_err_t untracked_ret = ESP_OK;
+    for (size_t i = 0; i < count; i++) {
+        int stage = stage_alloc(steps[i].name, true);
+        if (stage < 0) {
+            // 记录已满：不计时，直接在当前任务中执行
+            esp_err_t ret = steps[i].fn();
+            if (untracked_ret == ESP_OK) untracked_ret = ret;
+            continue;
+        }
+        if (first_stage < 0) first_stage = stage;
+        last_stage = stage;
+
+        boot_job_t* job = &jobs[stage];
+        job->fn = steps[i].fn;
+        job->stage = stage;
+        job->done = done;
+        if (task_plan_create(boot_worker_task, BOOT_WORKER_TASK_NAME, 4096, job, tskIDLE_PRIORITY + 3, NULL,
+                             tskNO_AFFINITY) == pdPASS) {
+            started++;
+        } else {
+            // 内存不足时退回顺序执行
+            ESP_LOGW(TAG, "Failed to start worker for '%s', running inline", steps[i].name);
+            stages[stage].parallel = false;
+            run_job(job);
+        }
+    }
+
+    // 等待全部工作任务完成 (总等待时间不超过 timeout_ms)
+    TickType_t start_tick = xTaskGetTickCount();
+    TickType_t timeout_ticks = pdMS_TO_TICKS(timeout_ms);
+    bool timed_out = false;
+    for (size_t i = 0; i < started; i++) {
+        TickType_t elapsed = xTaskGetTickCount() - start_tick;
+        TickType_t remaining = elapsed < timeout_ticks ? timeout_ticks - elapsed : 0;
+        if (xSemaphoreTake(done, remaining) != pdTRUE) {
+            timed_out = true;
+            break;
+        }
+    }
+    if (timed_out) {
+        // 仍在运行的工作任务完成后还会释放信号量，这里不能删除
+        ESP_LOGW(TAG, "Boot steps still running after %lu ms, continuing", (unsigned long)timeout_ms);
+        return ESP_ERR_TIMEOUT;
+    }
+    vSemaphoreDelete(done);
+
+    for (int stage = first_stage; stage >= 0 && stage <= last_stage; stage++) {
+        if (stages[stage].result != ESP_OK) {
+            return stages[stage].result;
+        }
+    }
+    return untracked_ret;
+}
+
+void boot_mark(boot_milestone_t milestone) {
+    if (milestone >= BOOT_MILESTONE_COUNT || milestones_us[milestone] != 0) {
+        return;
+    }
+    uint32_t now_us = boot_now_us();
+    bool first = false;
+    portENTER_CRITICAL(&boot_mux);
+    if (milestones_us[milestone] == 0) {
+        milestones_us[milestone] = now_us;
+        first = true;
+    }
+    portEXIT_CRITICAL(&boot_mux);
+    if (first) {
+        ESP_LOGI(TAG, "Milestone %s at %lu ms", milestone_names[milestone], (unsigned long)(now_us / 1000));
+    }
+}
+
+uint32_t boot_milestone_us(boot_milestone_t milestone) {
+    return milestone < BOOT_MILESTONE_COUNT ? milestones_us[milestone] : 0;
+}
+
+const char* boot_milestone_name(boot_milestone_t milestone) {
+    return milestone < BOOT_MILESTONE_COUNT ? milestone_names[milestone] : "?";
+}
+
+size_t boot_get_stages(boot_stage_t* out, size_t max_count) {
+    if (out == NULL) {
+        return 0;
+    }
+    portENTER_CRITICAL(&boot_mux);
+    size_t count = stage_count < max_count ? stage_count : max_count;
+    memcpy(out, stages, count * sizeof(boot_stage_t));
+    portEXIT_CRITICAL(&boot_mux);
+    return count;
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+static const char* reset_reason_name(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON:   return "power-on";
+        case ESP_RST_EXT:       return "external";
+        case ESP_RST_SW:        return "software";
+        case ESP_RST_PANIC:     return "panic";
+        case ESP_RST_INT_WDT:   return "int watchdog";
+        case ESP_RST_TASK_WDT:  return "task watchdog";
+        case ESP_RST_WDT:       return "watchdog";
+        case ESP_RST_DEEPSLEEP: return "deep sleep";
+        case ESP_RST_BROWNOUT:  return "brownout";
+        case ESP_RST_SDIO:      return "sdio";
+        default:                return "unknown";
+    }
+}
+
+// 微秒格式化为 "12.3" 毫秒
+static void format_ms(char* buf, size_t size, uint32_t us) {
+    snprintf(buf, size, "%lu.%lu", (unsigned long)(us / 1000), (unsigned long)((us % 1000) / 100));
+}
+
+static void print_timing(void) {
+    static boot_stage_t snapshot[BOOT_MAX_STAGES];
+    char response[128];
+    char start[16], duration[16];
+
+    snprintf(response, sizeof(response), "Reset reason: %s (times in ms since esp_timer start)\r\n",
+             reset_reason_name(esp_reset_reason()));
+    uart_parser_put_string(response);
+
+    size_t count = boot_get_stages(snapshot, BOOT_MAX_STAGES);
+    uart_parser_put_string("Stage                start  duration  core  mode      result\r\n");
+    for (size_t i = 0; i < count; i++) {
+        format_ms(start, sizeof(start), snapshot[i].start_us);
+        if (snapshot[i].end_us != 0) {
+            format_ms(duration, sizeof(duration), snapshot[i].end_us - snapshot[i].start_us);
+        } else {
+            snprintf(duration, sizeof(duration), "-");
+        }
+        snprintf(response, sizeof(response), "  %-18s %7s %9s  %4d  %-8s  %s\r\n",
+                 snapshot[i].name ? snapshot[i].name : "?", start, duration, (int)snapshot[i].core,
+                 snapshot[i].parallel ? "parallel" : "serial",
+                 snapshot[i].end_us == 0 ? "running" : esp_err_to_name(snapshot[i].result));
+        uart_parser_put_string(response);
+    }
+
+    uart_parser_put_string("Milestones:\r\n");
+    for (int i = 0; i < BOOT_MILESTONE_COUNT; i++) {
+        uint32_t us = milestones_us[i];
+        if (us != 0) {
+            format_ms(start, sizeof(start), us);
+        } else {
+            snprintf(start, sizeof(start), "-");
+        }
+        snprintf(response, sizeof(response), "  %-18s %7s\r\n", milestone_names[i], start);
+        uart_parser_put_string(response);
+    }
+}
+
+static void handle_boot(int argc, char *argv[]) {
+    if (argc >= 2) {
+        uart_parser_put_string("Usage: boot\r\n");
+        return;
+    }
+    print_timing();
+}
+
+static const command_t boot_commands[] = {
+    {"boot", handle_boot, "boot: 查看启动各阶段耗时与里程碑。"},
+};
+
+void boot_register_commands(void) {
+    uart_parser_register_commands(boot_commands, sizeof(boot_commands) / sizeof(boot_commands[0]));
+}
@@ -0,0 +1,110 @@
+#ifndef BOOT_SEQUENCER_H
+#define BOOT_SEQUENCER_H
+
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 最多记录的启动阶段数 (顺序阶段 + 并行步骤)
+ */
+#ifndef BOOT_MAX_STAGES
+#define BOOT_MAX_STAGES           16
+#endif
+
+/**
+ * @brief 并行步骤的默认等待时间 (毫秒)，超时的步骤继续在后台运行
+ */
+#define BOOT_STEP_TIMEOUT_MS      3000
+
+/**
+ * @brief 并行步骤的工作任务名 (核心/优先级/栈大小见 src/main.cpp 中的任务规划表)
+ */
+#define BOOT_WORKER_TASK_NAME     "Boot_Worker"
+
+// 启动里程碑 (每个只记录第一次)
+typedef enum {
+    BOOT_MILESTONE_SETUP_DONE = 0,    // setup() 返回
+    BOOT_MILESTONE_FIRST_SAMPLE,      // 数据发布任务取到第一个传感器样本
+    BOOT_MILESTONE_WIFI_CONNECTED,    // 第一次获得 IP
+    BOOT_MILESTONE_NETWORK_ONLINE,    // 第一次建立网络连接
+    BOOT_MILESTONE_FIRST_FRAME,       // 网络在线后第一个遥测帧提交给网络发送任务
+    BOOT_MILESTONE_COUNT
+} boot_milestone_t;
+
+// 启动阶段记录 (时间为 esp_timer 启动以来的微秒数，约等于上电后的时间)
+typedef struct {
+    const char* name;
+    uint32_t start_us;
+    uint32_t end_us;          // 0 = 尚未完成
+    esp_err_t result;
+    int8_t core;              // 执行阶段的核心
+    bool parallel;            // 由 boot_run_parallel() 在工作任务中执行
+} boot_stage_t;
+
+// 并行启动步骤
+typedef esp_err_t (*boot_step_fn_t)(void);
+
+typedef struct {
+    const char* name;         // 阶段名 (必须在程序运行期间一直有效)
+    boot_step_fn_t fn;
+} boot_step_t;
+
+/**
+ * @brief 开始记录一个在当前任务中顺序执行的阶段
+ * @return 阶段编号，传给 boot_stage_end()；记录已满返回 -1 (boot_stage_end() 忽略)
+ */
+int boot_stage_begin(const char* name);
+
+/**
+ * @brief 结束一个顺序阶段
+ */
+void boot_stage_end(int stage, esp_err_t result);
+
+/**
+ * @brief 并行执行一组启动步骤，等待全部完成
+ * @details 每个步骤在一个独立的工作任务中执行 (不绑定核心，两个核心同时初始化)，完成后工作任务自行删除。
+ *          步骤之间不能有依赖关系，共享的资源 (DataPlatform、任务规划表等) 必须在调用前初始化。
+ *          超时后立即返回，未完成的步骤继续在后台运行，完成时间照常记录。
+ * @param steps      步骤表
+ * @param count      步骤数量
+ * @param timeout_ms 最长等待时间
+ * @return ESP_OK 全部成功；ESP_ERR_TIMEOUT 有步骤未在时间内完成；其他为第一个失败步骤的返回值
+ */
+esp_err_t boot_run_parallel(const boot_step_t* steps, size_t count, uint32_t timeout_ms);
+
+/**
+ * @brief 记录启动里程碑 (只记录第一次，之后的调用只有一次比较，可以放在热路径上)
+ */
+void boot_mark(boot_milestone_t milestone);
+
+/**
+ * @brief 获取里程碑时刻 (esp_timer 启动以来的微秒数，0 = 尚未到达)
+ */
+uint32_t boot_milestone_us(boot_milestone_t milestone);
+
+/**
+ * @brief 获取里程碑名称
+ */
+const char* boot_milestone_name(boot_milestone_t milestone);
+
+/**
+ * @brief 复制已记录的启动阶段
+ * @return 复制的阶段数
+ */
+size_t boot_get_stages(boot_stage_t* stages, size_t max_count);
+
+/**
+ * @brief 注册 'boot' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void boot_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_SEQUENCER_H
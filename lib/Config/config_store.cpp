@@ -0,0 +1,764 @@
+#include "config_store.h"
+#include "telemetry_frame.h"
+#include "uart_parser.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "freertos/semphr.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "CONFIG";
+
+// 默认 WiFi 配置 (可在 build_flags 中覆盖)
+#ifndef CONFIG_DEFAULT_WIFI_SSID
+#define CONFIG_DEFAULT_WIFI_SSID      "opti_track_xiaomi"
+#endif
+#ifndef CONFIG_DEFAULT_WIFI_PASS
+#define CONFIG_DEFAULT_WIFI_PASS      "sysu_opti_track"
+#endif
+#ifndef CONFIG_DEFAULT_REMOTE_HOST
+#define CONFIG_DEFAULT_REMOTE_HOST    "192.168.31.136"   // 通常手机热点的网关IP
+#endif
+#ifndef CONFIG_DEFAULT_REMOTE_PORT
+#define CONFIG_DEFAULT_REMOTE_PORT    2233               // 手机端TCP服务器端口
+#endif
+
+// 默认配置：与原来 setup() 中的字面量相同，默认启用 WiFi 和编码器
+static const app_config_t config_defaults = {
+    .enable = {
+        .wifi = true,
+        .encoder = true,
+        .joystick = false,
+        .keypad = false,
+        .servo = false,             // D16/D17 与按键引脚冲突，按需启用
+        .recorder = true,
+    },
+    .encoder = {
+        .pin_a = 19,                // 编码器A相引脚
+        .pin_b = 18,                // 编码器B相引脚
+        .pin_button = 21,           // 编码器按钮引脚
+        .use_pullup = true,         // 使用内部上拉电阻
+        .steps_per_notch = 4,       // 每个刻度4个步数（根据编码器型号调整）
+    },
+    .joystick = {
+        .pin_x = 33,                // X轴ADC引脚 (A0)
+        .pin_y = 32,                // Y轴ADC引脚 (A3)
+        .pin_button = 12,           // 摇杆按钮引脚
+        .use_pullup = true,         // 按钮使用内部上拉
+        .deadzone = 50,             // 死区大小
+        .invert_x = false,          // X轴不反转
+        .invert_y = true,           // Y轴反转（根据摇杆安装方向调整）
+        .center_x = 0,              // 0 = 启动时校准一次并保存
+        .center_y = 0,
+        .backend = JOYSTICK_BACKEND_ADC_DMA,  // 连续 ADC + DMA 后台采样
+        .filter = JOYSTICK_FILTER_IIR,        // 一阶 IIR 滤波
+        .filter_param = 2,                    // alpha = 1/4
+    },
+    .keypad = {
+        .row_pins = {13, 23, 22},   // 行引脚: R1=D13, R2=D23, R3=D22
+        .col_pins = {25, 26, 27},   // 列引脚: C1=D25, C2=D26, C3=D27
+        .use_pullup = true,         // 使用内部上拉电阻
+        .debounce_time_ms = 20,     // 去抖时间20ms
+        .idle_wake = true,          // 空闲时由列中断唤醒，无按键时不扫描
+    },
+    .servo = {
+        .rx_pin = 16,               // 舵机串口RX引脚
+        .tx_pin = 17,               // 舵机串口TX引脚
+        .baud_rate = 115200,        // 舵机串口波特率
+        .servo_id = 1,              // 默认舵机ID
+    },
+    .recorder = {
+        .encoder_hz = 10,           // 约 400 字节/秒，spiffs 分区可保存约半小时
+        .joystick_hz = 10,
+        .servo_hz = 2,
+        .latency_s = 10,
+    },
+    .wifi = {
+        .wifi_mode = WIFI_STA,
+        .ssid = CONFIG_DEFAULT_WIFI_SSID,
+        .password = CONFIG_DEFAULT_WIFI_PASS,
+        .ap_ssid = "",
+        .ap_password = "",
+        .power_save = false,                // Disable power saving for best performance
+        .tx_power = WIFI_POWER_19_5dBm,     // Set max power
+        .sta_connect_timeout_ms = 15000,    // 15 seconds timeout
+        .network_config = {
+            .protocol = NETWORK_PROTOCOL_TCP_CLIENT,
+            .remote_host = CONFIG_DEFAULT_REMOTE_HOST,
+            .remote_port = CONFIG_DEFAULT_REMOTE_PORT,
+            .local_port = 0,
+            .auto_connect = true,           // WiFi连接成功后自动开始TCP连接
+            .connect_timeout_ms = 10000,    // 10 seconds timeout for TCP connection
+        },
+    },
+    .ap_bssid = {0},
+    .ap_channel = 0,
+};
+
+/* -------------------- 字段表 -------------------- */
+
+// 字段类型
+typedef enum {
+    FIELD_BOOL = 0,
+    FIELD_UINT,         // 1/2/4 字节无符号整数
+    FIELD_INT,          // 1/2/4 字节有符号整数 (含枚举)
+    FIELD_ENUM,         // 按名称读写的枚举 (存储为整数)
+    FIELD_STR,          // 以 '\0' 结尾的字符数组
+    FIELD_HEX,          // 定长字节数组 (例如 BSSID)
+} field_type_t;
+
+#define FIELD_FLAG_SECRET   (1 << 0)    // 不回显 (密码)
+
+typedef struct {
+    uint8_t id;                 // 持久化 ID：一经发布不能改变含义，删除的字段 ID 不再复用
+    const char* name;
+    uint8_t type;               // field_type_t
+    uint8_t flags;              // FIELD_FLAG_*
+    uint16_t offset;
+    uint16_t size;
+    int32_t min;
+    int32_t max;
+    const char* const* names;   // FIELD_ENUM 的取值名称 (下标即数值)
+    uint8_t name_count;
+} config_field_t;
+
+static const char* const wifi_mode_names[] = {"off", "sta", "ap", "ap_sta"};
+static const char* const protocol_names[] = {"none", "tcp_client", "tcp_server", "udp"};
+static const char* const backend_names[] = {"analog_read", "adc_dma"};
+static const char* const filter_names[] = {"none", "moving_average", "iir"};
+
+#define FIELD_SIZE(member)  sizeof(((app_config_t*)0)->member)
+#define FIELD(id, name, type, member, min, max) \
+    {id, name, type, 0, offsetof(app_config_t, member), FIELD_SIZE(member), min, max, NULL, 0}
+#define SECRET(id, name, member) \
+    {id, name, FIELD_STR, FIELD_FLAG_SECRET, offsetof(app_config_t, member), FIELD_SIZE(member), 0, 0, NULL, 0}
+#define ENUM(id, name, member, names) \
+    {id, name, FIELD_ENUM, 0, offsetof(app_config_t, member), FIELD_SIZE(member), 0, \
+     (int32_t)(sizeof(names) / sizeof(names[0])) - 1, names, (uint8_t)(sizeof(names) / sizeof(names[0]))}
+
+static const config_field_t config_fields[] = {
+    FIELD( 1, "enable.wifi",              FIELD_BOOL, enable.wifi,                0, 1),
+    FIELD( 2, "enable.encoder",           FIELD_BOOL, enable.encoder,             0, 1),
+    FIELD( 3, "enable.joystick",          FIELD_BOOL, enable.joystick,            0, 1),
+    FIELD( 4, "enable.keypad",            FIELD_BOOL, enable.keypad,              0, 1),
+    FIELD( 5, "enable.servo",             FIELD_BOOL, enable.servo,               0, 1),
+    FIELD( 6, "enable.recorder",          FIELD_BOOL, enable.recorder,            0, 1),
+
+    FIELD(10, "encoder.pin_a",            FIELD_UINT, encoder.pin_a,              0, 39),
+    FIELD(11, "encoder.pin_b",            FIELD_UINT, encoder.pin_b,              0, 39),
+    FIELD(12, "encoder.pin_button",       FIELD_UINT, encoder.pin_button,         0, 255),   // 255 = 无按钮
+    FIELD(13, "encoder.pullup",           FIELD_BOOL, encoder.use_pullup,         0, 1),
+    FIELD(14, "encoder.steps_per_notch",  FIELD_INT,  encoder.steps_per_notch,    1, 64),
+
+    FIELD(20, "joystick.pin_x",           FIELD_UINT, joystick.pin_x,             0, 39),
+    FIELD(21, "joystick.pin_y",           FIELD_UINT, joystick.pin_y,             0, 39),
+    FIELD(22, "joystick.pin_button",      FIELD_UINT, joystick.pin_button,        0, 255),
+    FIELD(23, "joystick.pullup",          FIELD_BOOL, joystick.use_pullup,        0, 1),
+    FIELD(24, "joystick.deadzone",        FIELD_UINT, joystick.deadzone,          0, 512),
+    FIELD(25, "joystick.invert_x",        FIELD_BOOL, joystick.invert_x,          0, 1),
+    FIELD(26, "joystick.invert_y",        FIELD_BOOL, joystick.invert_y,          0, 1),
+    FIELD(27, "joystick.center_x",        FIELD_UINT, joystick.center_x,          0, 4095),  // 0 = 启动时校准
+    FIELD(28, "joystick.center_y",        FIELD_UINT, joystick.center_y,          0, 4095),
+    ENUM (29, "joystick.backend",         joystick.backend,                       backend_names),
+    ENUM (30, "joystick.filter",          joystick.filter,                        filter_names),
+    FIELD(31, "joystick.filter_param",    FIELD_UINT, joystick.filter_param,      0, 16),
+
+    FIELD(40, "keypad.row0",              FIELD_UINT, keypad.row_pins[0],         0, 39),
+    FIELD(41, "keypad.row1",              FIELD_UINT, keypad.row_pins[1],         0, 39),
+    FIELD(42, "keypad.row2",              FIELD_UINT, keypad.row_pins[2],         0, 39),
+    FIELD(43, "keypad.col0",              FIELD_UINT, keypad.col_pins[0],         0, 39),
+    FIELD(44, "keypad.col1",              FIELD_UINT, keypad.col_pins[1],         0, 39),
+    FIELD(45, "keypad.col2",              FIELD_UINT, keypad.col_pins[2],         0, 39),
+    FIELD(46, "keypad.pullup",            FIELD_BOOL, keypad.use_pullup,          0, 1),
+    FIELD(47, "keypad.debounce_ms",       FIELD_UINT, keypad.debounce_time_ms,    0, 255),
+    FIELD(48, "keypad.idle_wake",         FIELD_BOOL, keypad.idle_wake,           0, 1),
+
+    FIELD(50, "servo.rx_pin",             FIELD_INT,  servo.rx_pin,               -1, 39),
+    FIELD(51, "servo.tx_pin",             FIELD_INT,  servo.tx_pin,               -1, 39),
+    FIELD(52, "servo.baud",               FIELD_UINT, servo.baud_rate,            1200, 1000000),
+    FIELD(53, "servo.id",                 FIELD_UINT, servo.servo_id,             0, 253),
+
+    FIELD(55, "recorder.encoder_hz",      FIELD_UINT, recorder.encoder_hz,        0, 1000),
+    FIELD(56, "recorder.joystick_hz",     FIELD_UINT, recorder.joystick_hz,       0, 1000),
+    FIELD(57, "recorder.servo_hz",        FIELD_UINT, recorder.servo_hz,          0, 1000),
+    FIELD(58, "recorder.latency_s",       FIELD_UINT, recorder.latency_s,         0, 3600),
+
+    ENUM (60, "wifi.mode",                wifi.wifi_mode,                         wifi_mode_names),
+    FIELD(61, "wifi.ssid",                FIELD_STR,  wifi.ssid,                  0, 0),
+    SECRET(62, "wifi.password",           wifi.password),
+    FIELD(63, "wifi.ap_ssid",             FIELD_STR,  wifi.ap_ssid,               0, 0),
+    SECRET(64, "wifi.ap_password",        wifi.ap_password),
+    FIELD(65, "wifi.power_save",          FIELD_BOOL, wifi.power_save,            0, 1),
+    FIELD(66, "wifi.tx_power",            FIELD_INT,  wifi.tx_power,              -4, 84),   // 0.25 dBm 单位
+    FIELD(67, "wifi.timeout_ms",          FIELD_UINT, wifi.sta_connect_timeout_ms, 1000, 120000),
+    FIELD(68, "wifi.ap_bssid",            FIELD_HEX,  ap_bssid,                   0, 0),
+    FIELD(69, "wifi.ap_channel",          FIELD_INT,  ap_channel,                 0, 14),    // 0 = 未缓存
+
+    ENUM (70, "network.protocol",         wifi.network_config.protocol,           protocol_names),
+    FIELD(71, "network.host",             FIELD_STR,  wifi.network_config.remote_host, 0, 0),
+    FIELD(72, "network.remote_port",      FIELD_UINT, wifi.network_config.remote_port, 0, 65535),
+    FIELD(73, "network.local_port",       FIELD_UINT, wifi.network_config.local_port, 0, 65535),
+    FIELD(74, "network.auto_connect",     FIELD_BOOL, wifi.network_config.auto_connect, 0, 1),
+    FIELD(75, "network.timeout_ms",       FIELD_UINT, wifi.network_config.connect_timeout_ms, 100, 120000),
+};
+
+#define CONFIG_FIELD_COUNT  (sizeof(config_fields) / sizeof(config_fields[0]))
+
+/* -------------------- 存储格式 --------------------
+ * | magic 'C' 'F' | version u8 | reserved u8 | payload_len u16 | crc16 u16 | payload |
+ * payload 为记录序列：[id u8][len u8][value]，只包含与默认值不同的字段，
+ * 整数按小端存放，字符串不含结尾的 '\0'。
+ */
+#define BLOB_MAGIC_0        'C'
+#define BLOB_MAGIC_1        'F'
+#define BLOB_HEADER_SIZE    8
+
+// 全局变量
+static app_config_t s_config;
+static volatile bool s_loaded = false;
+static volatile bool s_dirty = false;
+static uint32_t s_changed_ms = 0;              // 最后一次修改的时刻 (写入合并)
+static uint16_t s_saved_len = 0;               // flash 中配置的长度/CRC，内容相同时跳过写入
+static uint16_t s_saved_crc = 0;
+static uint32_t s_commits = 0;
+static uint8_t s_blob[CONFIG_BLOB_MAX_SIZE];   // 序列化缓冲区 (只在持有锁时使用)
+
+static StaticSemaphore_t s_mutex_buffer;
+static SemaphoreHandle_t s_mutex = NULL;
+static portMUX_TYPE s_mutex_init_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void config_lock(void) {
+    portENTER_CRITICAL(&s_mutex_init_mux);
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutexStatic(&s_mutex_buffer);
+    }
+    portEXIT_CRITICAL(&s_mutex_init_mux);
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+}
+
+static void config_unlock(void) {
+    xSemaphoreGive(s_mutex);
+}
+
+static const config_field_t* find_field(const char* name) {
+    for (size_t i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        if (strcmp(config_fields[i].name, name) == 0) {
+            return &config_fields[i];
+        }
+    }
+    return NULL;
+}
+
+static const config_field_t* find_field_by_id(uint8_t id) {
+    for (size_t i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        if (config_fields[i].id == id) {
+            return &config_fields[i];
+        }
+    }
+    return NULL;
+}
+
+static bool field_is_signed(const config_field_t* field) {
+    return field->type == FIELD_INT || field->type == FIELD_ENUM;
+}
+
+// 按字节数读取小端整数
+static int64_t read_int(const uint8_t* p, size_t size, bool is_signed) {
+    switch (size) {
+        case 1: { uint8_t v; memcpy(&v, p, 1); return is_signed ? (int64_t)(int8_t)v : (int64_t)v; }
+        case 2: { uint16_t v; memcpy(&v, p, 2); return is_signed ? (int64_t)(int16_t)v : (int64_t)v; }
+        case 4: { uint32_t v; memcpy(&v, p, 4); return is_signed ? (int64_t)(int32_t)v : (int64_t)v; }
+        default: return 0;
+    }
+}
+
+static void write_int(uint8_t* p, size_t size, int64_t value) {
+    switch (size) {
+        case 1: { uint8_t v = (uint8_t)value; memcpy(p, &v, 1); break; }
+        case 2: { uint16_t v = (uint16_t)value; memcpy(p, &v, 2); break; }
+        case 4: { uint32_t v = (uint32_t)value; memcpy(p, &v, 4); break; }
+        default: break;
+    }
+}
+
+static bool field_in_range(const config_field_t* field, int64_t value) {
+    if (field->type == FIELD_BOOL) {
+        return value == 0 || value == 1;
+    }
+    return value >= field->min && value <= field->max;
+}
+
+// 字段与默认值是否相同 (字符串只比较到 '\0')
+static bool field_is_default(const config_field_t* field, const app_config_t* config) {
+    const uint8_t* value = (const uint8_t*)config + field->offset;
+    const uint8_t* def = (const uint8_t*)&config_defaults + field->offset;
+    if (field->type == FIELD_STR) {
+        return strncmp((const char*)value, (const char*)def, field->size) == 0;
+    }
+    return memcmp(value, def, field->size) == 0;
+}
+
+// 序列化与默认值不同的字段，返回总长度
+static size_t serialize(const app_config_t* config, uint8_t* blob, size_t max_size) {
+    size_t len = BLOB_HEADER_SIZE;
+    for (size_t i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        const config_field_t* field = &config_fields[i];
+        if (field_is_default(field, config)) {
+            continue;
+        }
+        const uint8_t* value = (const uint8_t*)config + field->offset;
+        size_t value_len = field->type == FIELD_STR ? strnlen((const char*)value, field->size - 1) : field->size;
+        if (len + 2 + value_len > max_size) {
+            ESP_LOGE(TAG, "Config blob full, '%s' not saved", field->name);
+            continue;
+        }
+        blob[len++] = field->id;
+        blob[len++] = (uint8_t)value_len;
+        memcpy(&blob[len], value, value_len);
+        len += value_len;
+    }
+    uint16_t payload_len = (uint16_t)(len - BLOB_HEADER_SIZE);
+    uint16_t crc = telemetry_crc16(&blob[BLOB_HEADER_SIZE], payload_len);
+    blob[0] = BLOB_MAGIC_0;
+    blob[1] = BLOB_MAGIC_1;
+    blob[2] = CONFIG_SCHEMA_VERSION;
+    blob[3] = 0;
+    memcpy(&blob[4], &payload_len, sizeof(payload_len));
+    memcpy(&blob[6], &crc, sizeof(crc));
+    return len;
+}
+
+// 应用一条记录：长度与当前字段不同时按类型转换 (整数宽度变化、字符串缓冲区变化)
+static void apply_record(app_config_t* config, const config_field_t* field, const uint8_t* value, size_t len) {
+    uint8_t* dst = (uint8_t*)config + field->offset;
+    switch (field->type) {
+        case FIELD_STR:
+            if (len >= field->size) {
+                ESP_LOGW(TAG, "'%s' truncated", field->name);
+                len = field->size - 1;
+            }
+            memcpy(dst, value, len);
+            dst[len] = '\0';
+            break;
+
+        case FIELD_HEX:
+            if (len == field->size) {
+                memcpy(dst, value, len);
+            }
+            break;
+
+        default: {
+            if (len != 1 && len != 2 && len != 4) {
+                return;
+            }
+            int64_t v = read_int(value, len, field_is_signed(field));
+            if (!field_in_range(field, v)) {
+                ESP_LOGW(TAG, "'%s' out of range in stored config, using default", field->name);
+                return;
+            }
+            write_int(dst, field->size, v);
+            break;
+        }
+    }
+}
+
+// 解析 flash 中的配置，返回 false 表示格式无效 (整体使用默认值)
+static bool deserialize(app_config_t* config, const uint8_t* blob, size_t len) {
+    uint16_t payload_len, crc;
+    if (len < BLOB_HEADER_SIZE || blob[0] != BLOB_MAGIC_0 || blob[1] != BLOB_MAGIC_1) {
+        return false;
+    }
+    if (blob[2] != CONFIG_SCHEMA_VERSION) {
+        ESP_LOGW(TAG, "Config schema v%u != v%u, using defaults", blob[2], CONFIG_SCHEMA_VERSION);
+        return false;
+    }
+    memcpy(&payload_len, &blob[4], sizeof(payload_len));
+    memcpy(&crc, &blob[6], sizeof(crc));
+    if ((size_t)BLOB_HEADER_SIZE + payload_len != len ||
+        telemetry_crc16(&blob[BLOB_HEADER_SIZE], payload_len) != crc) {
+        ESP_LOGW(TAG, "Config CRC mismatch, using defaults");
+        return false;
+    }
+
+    size_t pos = BLOB_HEADER_SIZE;
+    while (pos + 2 <= len) {
+        uint8_t id = blob[pos];
+        uint8_t value_len = blob[pos + 1];
+        pos += 2;
+        if (pos + value_len > len) {
+            break;
+        }
+        const config_field_t* field = find_field_by_id(id);
+        if (field != NULL) {
+            apply_record(config, field, &blob[pos], value_len);
+        }
+        pos += value_len;
+    }
+    return true;
+}
+
+static void load_locked(void) {
+    s_config = config_defaults;
+
+    nvs_handle_t handle;
+    if (nvs_open(CONFIG_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK) {
+        ESP_LOGI(TAG, "No stored config, using defaults");
+        return;   // 命名空间不存在 (从未保存过)
+    }
+    size_t len = sizeof(s_blob);
+    esp_err_t ret = nvs_get_blob(handle, CONFIG_NVS_KEY, s_blob, &len);
+    nvs_close(handle);
+    if (ret != ESP_OK) {
+        ESP_LOGI(TAG, "No stored config, using defaults");
+        return;
+    }
+
+    if (!deserialize(&s_config, s_blob, len)) {
+        s_config = config_defaults;
+        return;
+    }
+    s_saved_len = (uint16_t)len;
+    memcpy(&s_saved_crc, &s_blob[6], sizeof(s_saved_crc));
+    ESP_LOGI(TAG, "Config loaded (%u bytes)", (unsigned)len);
+}
+
+esp_err_t config_load(void) {
+    if (s_loaded) {
+        return ESP_OK;
+    }
+    config_lock();
+    if (!s_loaded) {
+        load_locked();
+        s_loaded = true;
+    }
+    config_unlock();
+    return ESP_OK;
+}
+
+const app_config_t* config_get(void) {
+    config_load();
+    return &s_config;
+}
+
+app_config_t* config_begin_update(void) {
+    config_load();
+    config_lock();
+    return &s_config;
+}
+
+void config_end_update(bool changed) {
+    if (changed) {
+        s_dirty = true;
+        s_changed_ms = millis();
+    }
+    config_unlock();
+}
+
+bool config_is_dirty(void) {
+    return s_dirty;
+}
+
+void config_reset(void) {
+    app_config_t* config = config_begin_update();
+    *config = config_defaults;
+    config_end_update(true);
+}
+
+esp_err_t config_save(void) {
+    if (!s_dirty) {
+        return ESP_OK;
+    }
+
+    config_lock();
+    size_t len = serialize(&s_config, s_blob, sizeof(s_blob));
+    uint16_t crc;
+    memcpy(&crc, &s_blob[6], sizeof(crc));
+    s_dirty = false;
+    if (len == s_saved_len && crc == s_saved_crc) {
+        // 改回了 flash 中已有的内容
+        config_unlock();
+        return ESP_OK;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t ret = nvs_open(CONFIG_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(handle, CONFIG_NVS_KEY, s_blob, len);
+        if (ret == ESP_OK) {
+            ret = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    if (ret == ESP_OK) {
+        s_saved_len = (uint16_t)len;
+        s_saved_crc = crc;
+        s_commits++;
+        ESP_LOGI(TAG, "Config saved (%u bytes)", (unsigned)len);
+    } else {
+        s_dirty = true;   // 下一次 config_service() 重试
+        s_changed_ms = millis();
+        ESP_LOGE(TAG, "Failed to save config: %s", esp_err_to_name(ret));
+    }
+    config_unlock();
+    return ret;
+}
+
+void config_service(void) {
+    if (s_dirty && millis() - s_changed_ms >= CONFIG_COMMIT_DELAY_MS) {
+        config_save();
+    }
+}
+
+/* -------------------- 按名称读写 -------------------- */
+
+static bool parse_bool(const char* value, int64_t* out) {
+    if (strcmp(value, "1") == 0 || strcmp(value, "on") == 0 || strcmp(value, "true") == 0) {
+        *out = 1;
+        return true;
+    }
+    if (strcmp(value, "0") == 0 || strcmp(value, "off") == 0 || strcmp(value, "false") == 0) {
+        *out = 0;
+        return true;
+    }
+    return false;
+}
+
+static bool parse_hex(const char* value, uint8_t* out, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        while (*value == ':' || *value == '-') value++;
+        char digits[3] = {value[0], value[0] != '\0' ? value[1] : '\0', '\0'};
+        char* end;
+        unsigned long byte = strtoul(digits, &end, 16);
+        if (digits[0] == '\0' || *end != '\0') {
+            return false;
+        }
+        out[i] = (uint8_t)byte;
+        value += 2;
+    }
+    return *value == '\0';
+}
+
+static esp_err_t set_field_locked(app_config_t* config, const config_field_t* field, const char* value) {
+    uint8_t* dst = (uint8_t*)config + field->offset;
+    int64_t v = 0;
+    char* end;
+
+    switch (field->type) {
+        case FIELD_STR:
+            if (strlen(value) >= field->size) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            memset(dst, 0, field->size);
+            memcpy(dst, value, strlen(value));
+            return ESP_OK;
+
+        case FIELD_HEX:
+            return parse_hex(value, dst, field->size) ? ESP_OK : ESP_ERR_INVALID_ARG;
+
+        case FIELD_BOOL:
+            if (!parse_bool(value, &v)) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            break;
+
+        case FIELD_ENUM:
+            v = -1;
+            for (uint8_t i = 0; i < field->name_count; i++) {
+                if (strcmp(value, field->names[i]) == 0) {
+                    v = i;
+                }
+            }
+            if (v < 0) {
+                v = strtol(value, &end, 0);
+                if (*value == '\0' || *end != '\0') {
+                    return ESP_ERR_INVALID_ARG;
+                }
+            }
+            break;
+
+        default:
+            v = strtoll(value, &end, 0);
+            if (*value == '\0' || *end != '\0') {
+                return ESP_ERR_INVALID_ARG;
+            }
+            break;
+    }
+    if (!field_in_range(field, v)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    write_int(dst, field->size, v);
+    return ESP_OK;
+}
+
+esp_err_t config_set(const char* name, const char* value) {
+    if (name == NULL || value == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const config_field_t* field = find_field(name);
+    if (field == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    app_config_t* config = config_begin_update();
+    esp_err_t ret = set_field_locked(config, field, value);
+    config_end_update(ret == ESP_OK);
+    return ret;
+}
+
+static void format_field(const config_field_t* field, const app_config_t* config, char* buf, size_t size) {
+    const uint8_t* value = (const uint8_t*)config + field->offset;
+    switch (field->type) {
+        case FIELD_STR:
+            if (field->flags & FIELD_FLAG_SECRET) {
+                snprintf(buf, size, "%s", value[0] != '\0' ? "***" : "");
+            } else {
+                snprintf(buf, size, "%.*s", (int)field->size, (const char*)value);
+            }
+            break;
+
+        case FIELD_HEX: {
+            size_t pos = 0;
+            buf[0] = '\0';
+            for (size_t i = 0; i < field->size && pos + 3 < size; i++) {
+                pos += snprintf(&buf[pos], size - pos, i == 0 ? "%02X" : ":%02X", value[i]);
+            }
+            break;
+        }
+
+        case FIELD_BOOL:
+            snprintf(buf, size, "%s", value[0] ? "on" : "off");
+            break;
+
+        case FIELD_ENUM: {
+            int64_t v = read_int(value, field->size, true);
+            if (v >= 0 && v < field->name_count) {
+                snprintf(buf, size, "%s", field->names[v]);
+            } else {
+                snprintf(buf, size, "%ld", (long)v);
+            }
+            break;
+        }
+
+        default:
+            snprintf(buf, size, "%ld", (long)read_int(value, field->size, field_is_signed(field)));
+            break;
+    }
+}
+
+esp_err_t config_get_field(const char* name, char* buf, size_t size) {
+    if (name == NULL || buf == NULL || size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const config_field_t* field = find_field(name);
+    if (field == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    const app_config_t* config = config_begin_update();
+    format_field(field, config, buf, size);
+    config_end_update(false);
+    return ESP_OK;
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+// 列出名称以 prefix 开头的字段，与默认值不同的字段标记 '*'
+// 输出可能阻塞在串口上：只在复制快照时持有锁，不拖住其他任务的配置写回
+static void print_fields(const char* prefix) {
+    static app_config_t snapshot;   // 只由命令处理函数 (uart_parser_task) 使用，不占任务栈
+    char value[80];
+    char response[128];
+    size_t prefix_len = prefix != NULL ? strlen(prefix) : 0;
+    int printed = 0;
+
+    snapshot = *config_begin_update();
+    config_end_update(false);
+
+    const app_config_t* config = &snapshot;
+    for (size_t i = 0; i < CONFIG_FIELD_COUNT; i++) {
+        const config_field_t* field = &config_fields[i];
+        if (prefix_len > 0 && strncmp(field->name, prefix, prefix_len) != 0) {
+            continue;
+        }
+        format_field(field, config, value, sizeof(value));
+        snprintf(response, sizeof(response), "%c %-24s %s\r\n", field_is_default(field, config) ? ' ' : '*',
+                 field->name, value);
+        uart_parser_put_string(response);
+        printed++;
+    }
+
+    if (printed == 0) {
+        uart_parser_put_string("No such config field.\r\n");
+    }
+}
+
+static void print_status(void) {
+    char response[128];
+    snprintf(response, sizeof(response), "Config: schema v%d, %u/%d bytes in NVS, %lu commits%s\r\n",
+             CONFIG_SCHEMA_VERSION, (unsigned)s_saved_len, CONFIG_BLOB_MAX_SIZE, (unsigned long)s_commits,
+             s_dirty ? ", unsaved changes" : "");
+    uart_parser_put_string(response);
+}
+
+static void handle_config(int argc, char *argv[]) {
+    char response[128];
+    config_load();
+
+    if (argc < 2) {
+        print_status();
+        print_fields(NULL);
+        return;
+    }
+
+    if (strcmp(argv[1], "get") == 0) {
+        print_fields(argc >= 3 ? argv[2] : NULL);
+        return;
+    }
+
+    if (strcmp(argv[1], "set") == 0) {
+        if (argc < 4) {
+            uart_parser_put_string("Usage: config set <name> <value>\r\n");
+            return;
+        }
+        esp_err_t ret = config_set(argv[2], argv[3]);
+        if (ret == ESP_ERR_NOT_FOUND) {
+            snprintf(response, sizeof(response), "Error: unknown field '%s'.\r\n", argv[2]);
+        } else if (ret != ESP_OK) {
+            snprintf(response, sizeof(response), "Error: invalid value for '%s'.\r\n", argv[2]);
+        } else {
+            char value[80];
+            config_get_field(argv[2], value, sizeof(value));
+            snprintf(response, sizeof(response), "%s = %s (saved in %d ms, applied after reboot)\r\n",
+                     argv[2], value, CONFIG_COMMIT_DELAY_MS);
+        }
+        uart_parser_put_string(response);
+        return;
+    }
+
+    if (strcmp(argv[1], "save") == 0) {
+        esp_err_t ret = config_save();
+        if (ret == ESP_OK) {
+            uart_parser_put_string("Config saved.\r\n");
+        } else {
+            snprintf(response, sizeof(response), "Error: %s\r\n", esp_err_to_name(ret));
+            uart_parser_put_string(response);
+        }
+        return;
+    }
+
+    if (strcmp(argv[1], "reset") == 0) {
+        config_reset();
+        uart_parser_put_string("Config reset to defaults (saved shortly, applied after reboot).\r\n");
+        return;
+    }
+
+    uart_parser_put_string("Usage: config [get [prefix] | set <name> <value> | save | reset]\r\n");
+}
+
+static const command_t config_commands[] = {
+    {"config", handle_config, "config [get [prefix] | set <name> <value> | save | reset]: 查看/修改保存在 NVS 中的配置。"},
+};
+
+void config_register_commands(void) {
+    uart_parser_register_commands(config_commands, sizeof(config_commands) / sizeof(config_commands[0]));
+}
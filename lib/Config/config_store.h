@@ -0,0 +1,150 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "wifi_task.h"
+#include "encoder_driver.h"
+#include "joystick_driver.h"
+#include "matrix_keypad.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 配置在 NVS 中的命名空间与键
+ */
+#define CONFIG_NVS_NAMESPACE      "config"
+#define CONFIG_NVS_KEY            "app"
+
+/**
+ * @brief 存储格式版本
+ * @details 记录按字段 ID 存放，增加字段不需要改版本 (旧配置中没有的字段使用默认值，未知 ID 被跳过)；
+ *          只有字段 ID 的含义改变时才递增，旧版本的配置整体丢弃。
+ */
+#define CONFIG_SCHEMA_VERSION     1
+
+/**
+ * @brief 修改配置后延迟写入 flash 的时间 (毫秒)
+ * @details 期间的多次修改合并为一次 NVS 写入和提交
+ */
+#ifndef CONFIG_COMMIT_DELAY_MS
+#define CONFIG_COMMIT_DELAY_MS    2000
+#endif
+
+/**
+ * @brief 序列化后的最大长度 (字节，只保存与默认值不同的字段)
+ */
+#define CONFIG_BLOB_MAX_SIZE      768
+
+// 启动时初始化的外设
+typedef struct {
+    bool wifi;
+    bool encoder;
+    bool joystick;
+    bool keypad;
+    bool servo;
+    bool recorder;
+} config_enable_t;
+
+// 串口舵机总线
+typedef struct {
+    int8_t rx_pin;
+    int8_t tx_pin;
+    uint32_t baud_rate;
+    uint8_t servo_id;
+} config_servo_t;
+
+// 飞行记录仪 (lib/Recorder)
+typedef struct {
+    uint16_t encoder_hz;            // 各数据源的最高记录频率 (0 = 不记录)
+    uint16_t joystick_hz;
+    uint16_t servo_hz;
+    uint16_t latency_s;             // 延迟直方图的记录周期 (秒，0 = 不记录)
+} config_recorder_t;
+
+// 应用配置 (驱动配置结构体直接嵌入，启动时原样传给各驱动)
+typedef struct {
+    config_enable_t enable;
+    encoder_config_t encoder;
+    joystick_config_t joystick;     // center_x/center_y 为 0 时启动时校准一次并写回
+    keypad_config_t keypad;
+    config_servo_t servo;
+    config_recorder_t recorder;
+    wifi_task_config_t wifi;        // 含 network_config；连接成功后写回当前配置
+    uint8_t ap_bssid[6];            // 上次连接的 AP，启动后第一次连接直接关联
+    int32_t ap_channel;             // 0 = 未缓存
+} app_config_t;
+
+/**
+ * @brief 从 NVS 加载配置 (只在第一次调用时读取 flash)
+ * @details config_get() 会自动调用，一般不需要显式调用。没有保存过或格式版本不匹配时使用默认值。
+ * @return ESP_OK 已加载 (包括使用默认值)
+ */
+esp_err_t config_load(void);
+
+/**
+ * @brief 获取当前配置 (第一次调用时从 NVS 加载)
+ * @details 返回的指针一直有效；内容只在 config_begin_update() / config_set() 时变化，
+ *          启动时读取即可 (大部分字段重启后生效)。
+ */
+const app_config_t* config_get(void);
+
+/**
+ * @brief 开始修改配置 (加锁，返回可写的配置)
+ * @details 必须与 config_end_update() 成对调用，期间不要阻塞；多个字段一起修改只产生一次 flash 写入。
+ */
+app_config_t* config_begin_update(void);
+
+/**
+ * @brief 结束修改配置 (解锁)
+ * @param changed true 时标记为待写入，CONFIG_COMMIT_DELAY_MS 之后由 config_service() 写入 flash
+ */
+void config_end_update(bool changed);
+
+/**
+ * @brief 按名称设置字段 (例如 "encoder.pin_a" "19")，值按字段类型解析并检查范围
+ * @return ESP_OK 成功；ESP_ERR_NOT_FOUND 没有该字段；ESP_ERR_INVALID_ARG 值无效或超出范围
+ */
+esp_err_t config_set(const char* name, const char* value);
+
+/**
+ * @brief 按名称读取字段并格式化为字符串
+ * @return ESP_OK 成功；ESP_ERR_NOT_FOUND 没有该字段
+ */
+esp_err_t config_get_field(const char* name, char* buf, size_t size);
+
+/**
+ * @brief 恢复默认配置 (标记为待写入)
+ */
+void config_reset(void);
+
+/**
+ * @brief 立即写入待保存的修改
+ * @return ESP_OK 成功或没有待写入的修改
+ */
+esp_err_t config_save(void);
+
+/**
+ * @brief 周期调用 (例如 loop())：最后一次修改 CONFIG_COMMIT_DELAY_MS 之后写入 flash
+ * @details flash 写入期间两个核心的 cache 都会暂停，调用方应是低优先级任务
+ */
+void config_service(void);
+
+/**
+ * @brief 是否有尚未写入 flash 的修改
+ */
+bool config_is_dirty(void);
+
+/**
+ * @brief 注册 'config' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void config_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONFIG_STORE_H
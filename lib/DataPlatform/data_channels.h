@@ -0,0 +1,38 @@
+/**
+ * @file data_channels.h
+ * @brief 數據通道表 (編譯期)
+ *
+ * @details
+ * 每一行是一個傳感器通道：數據服務層據此生成通道ID (DATA_CHANNEL_<名稱>)、
+ * 每個通道的雙緩衝分段和樣本環形緩衝區，數據發布任務按表逐個通道發送遙測。
+ * 增加一個傳感器實例 (例如第二個編碼器) 只需要在表中增加一行，
+ * 再用驅動的 *_set_channel() 把驅動綁定到新通道，例如雙編碼器的控制器追加：
+ *
+ *     X(ENCODER_1,    ENCODER,    encoder_data_t,     1,      DATA_SERVICE_ENCODER_RING_SIZE)
+ *
+ * 欄位：
+ *  - 名稱     通道ID 為 DATA_CHANNEL_<名稱>
+ *  - 類別     data_kind_t 去掉 DATA_KIND_ 前綴，決定樣本類型的含義和事件位 (BIT_EVENT_<類別>_UPDATED)
+ *  - 樣本類型 每個樣本的結構體
+ *  - 實例號   同一類別內的編號 (0 ~ 15)，實例 0 的遙測幀與舊格式完全相同
+ *  - 環形容量 樣本環形緩衝區容量 (2的冪)，0 表示只保存最新值、不能 drain
+ *
+ * @note
+ * TEMP_HUMID / IMU / GPS / ENCODER_0 / JOYSTICK_0 / KEYPAD_0 由 data_service_update_*()
+ * 等兼容接口使用，不能刪除。板級配置可以用 -DDATA_SERVICE_CHANNEL_TABLE='"board_channels.h"'
+ * 提供自己的通道表 (格式相同)。
+ */
+
+#ifndef DATA_CHANNELS_H
+#define DATA_CHANNELS_H
+
+#define DATA_SERVICE_CHANNELS(X)                                                                 \
+    /* 名稱         類別        樣本類型            實例號  環形容量 */                          \
+    X(TEMP_HUMID,   TEMP_HUMID, temp_humid_data_t,  0,      0)                                   \
+    X(IMU,          IMU,        imu_data_t,         0,      0)                                   \
+    X(GPS,          GPS,        gps_data_t,         0,      0)                                   \
+    X(ENCODER_0,    ENCODER,    encoder_data_t,     0,      DATA_SERVICE_ENCODER_RING_SIZE)      \
+    X(JOYSTICK_0,   JOYSTICK,   joystick_data_t,    0,      DATA_SERVICE_JOYSTICK_RING_SIZE)     \
+    X(KEYPAD_0,     KEYPAD,     keypad_data_t,      0,      DATA_SERVICE_KEYPAD_RING_SIZE)
+
+#endif // DATA_CHANNELS_H
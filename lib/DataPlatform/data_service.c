@@ -4,32 +4,157 @@
  *
  * @details
  * 此文件實現了 data_service.h 中聲明的所有功能。
- * 它管理一個靜態的全局系統狀態實例，並使用FreeRTOS的互斥鎖(Mutex)和
- * 事件標誌組(Event Group)來確保線程安全和高效的任務間通信。
+ * 它按通道表 (data_channels.h) 為每個傳感器通道生成一個靜態分段和樣本環形緩衝區，
+ * 每個分段使用雙緩衝 + 版本號 (seqlock) 保證讀寫一致，並使用FreeRTOS的事件標誌組
+ * (Event Group) 向其他任務發送實時通知。
+ *
+ * 需要樣本流的任務通過 data_service_subscribe() 訂閱：更新時直接向訂閱任務
+ * 發送任務通知 (eSetBits)，每個訂閱者在樣本環形緩衝區中有自己的讀游標，
+ * 訂閱者之間互不影響。
+ *
+ * 分段的讀寫規則：
+ *  - 寫入方總是寫入「非活動」緩衝區，寫完後再切換活動索引，因此寫入方
+ *    永不阻塞，也不會因為被搶佔而讓讀取方自旋等待；
+ *  - 讀取方讀取活動緩衝區，並用該緩衝區的序號檢查讀取期間是否被改寫，
+ *    若被改寫則重新讀取活動索引後重試。
  *
  * @note
  * 這個模塊是系統的核心，但它不包含任何與具體硬件平台相關的代碼，
- * 因此具有良好的可移植性。
+ * 因此具有良好的可移植性 (僅依賴 GCC 的 __atomic 內建函數)。
  */
 
 #include "data_service.h"
+#include "freertos/task.h"
+#include <stdint.h>
 #include <string.h> // 用於 memcpy
 
 /*============================================================================*/
-/* 靜態全局變量 (Static Globals)                         */
+/* 分段存儲 (Sections)                                   */
 /*============================================================================*/
 
 /**
- * @brief 全局系統狀態的唯一實例
+ * @brief 單個數據分段的控制塊
+ * @details
+ * seq[i] 為偶數表示緩衝區 i 穩定，為奇數表示正在寫入。
+ * active 指向最近一次寫完的緩衝區，version 為累計更新次數。
+ */
+typedef struct {
+    volatile uint32_t seq[2];
+    volatile uint32_t active;
+    volatile uint32_t version;
+    uint8_t          *storage;  // 指向 2 * size 字節的雙緩衝存儲
+    size_t            size;     // 單個緩衝區大小
+} data_section_t;
+
+/**
+ * @brief 單生產者/多消費者環形緩衝區的控制塊
  * @details
- * 'static' 關鍵字確保此變量僅在該文件內可見，外部模塊必須通過API訪問。
+ * head 只由生產者修改並單調遞增，取模 capacity (2的冪) 得到存儲下標。
+ * 讀游標保存在各訂閱者中，生產者不檢查讀游標，永不阻塞也不被慢速訂閱者拖住；
+ * 落後超過 capacity 的訂閱者丟失最舊的樣本並計入自己的 dropped。
  */
-static system_state_t g_system_state;
+typedef struct {
+    volatile uint32_t head;      // 下一個寫入位置
+    uint8_t          *storage;   // capacity * elem_size 字節
+    size_t            elem_size;
+    uint32_t          capacity;
+    EventBits_t       topic;     // 對應的事件位
+} data_ring_t;
 
 /**
- * @brief 用於保護 g_system_state 的互斥鎖
+ * @brief 單個通道的控制塊 (分段 + 環形緩衝區)
+ * @details
+ * 按 cache 行對齊並填充，寫入方更新的序號/版本號/head 不與其他通道共用 cache 行。
  */
-static SemaphoreHandle_t g_state_mutex = NULL;
+typedef struct {
+    data_section_t section;
+    data_ring_t    ring;        // capacity 為 0 表示該通道沒有環形緩衝區
+} __attribute__((aligned(DATA_SERVICE_CACHE_LINE))) data_channel_block_t;
+
+/**
+ * @brief 訂閱者控制塊
+ * @details
+ * task 非 NULL 表示該槽位已經登記完成；tail/dropped 按通道ID索引，只由訂閱任務自己修改。
+ * ring_topics 為擁有讀游標的事件位：只需要最新值的訂閱者為 0，不讀取也不計入環形緩衝區統計。
+ */
+typedef struct {
+    TaskHandle_t volatile task;
+    EventBits_t           topics;
+    EventBits_t           ring_topics;
+    uint32_t              tail[DATA_CHANNEL_COUNT];
+    volatile uint32_t     dropped[DATA_CHANNEL_COUNT];
+} data_subscriber_t;
+
+#define DATA_SECTION_DEFINE(name, type)                                   \
+    static type g_##name##_storage[2];                                   \
+    static data_section_t g_##name##_section = {                         \
+        .storage = (uint8_t *)g_##name##_storage, .size = sizeof(type)   \
+    }
+
+/*
+ * 由通道表生成各通道的存儲：雙緩衝和環形緩衝區 (容量為 0 時保留一個樣本的空間，不使用)
+ */
+#define DATA_CHANNEL_STORAGE_(id, kind_id, type, inst, cap)                             \
+    _Static_assert(((cap) & ((cap) - 1)) == 0,                                         \
+                   #id " ring capacity must be a power of two");                        \
+    _Static_assert((inst) < 16, #id " instance must be 0-15");                         \
+    static type g_##id##_channel_storage[2]                                            \
+        __attribute__((aligned(DATA_SERVICE_CACHE_LINE)));                             \
+    static type g_##id##_channel_ring[(cap) > 0 ? (cap) : 1]                           \
+        __attribute__((aligned(DATA_SERVICE_CACHE_LINE)));
+
+#define DATA_CHANNEL_BLOCK_(id, kind_id, type, inst, cap)                               \
+    [DATA_CHANNEL_##id] = {                                                             \
+        .section = { .storage = (uint8_t *)g_##id##_channel_storage,                   \
+                     .size = sizeof(type) },                                            \
+        .ring = { .storage = (uint8_t *)g_##id##_channel_ring,                         \
+                  .elem_size = sizeof(type), .capacity = (cap),                         \
+                  .topic = BIT_EVENT_##kind_id##_UPDATED },                             \
+    },
+
+#define DATA_CHANNEL_INFO_(id, kind_id, type, inst, cap)                                \
+    [DATA_CHANNEL_##id] = {                                                             \
+        .name = #id, .kind = DATA_KIND_##kind_id, .instance = (inst),                   \
+        .sensor_id = DATA_SENSOR_ID(DATA_KIND_##kind_id, inst),                         \
+        .sample_size = sizeof(type), .ring_capacity = (cap),                            \
+        .topic = BIT_EVENT_##kind_id##_UPDATED,                                         \
+    },
+
+/*============================================================================*/
+/* 靜態全局變量 (Static Globals)                         */
+/*============================================================================*/
+
+/*
+ * 各傳感器通道的存儲、控制塊和描述 (按通道ID索引)
+ * 'static' 關鍵字確保這些變量僅在該文件內可見，外部模塊必須通過API訪問。
+ */
+DATA_SERVICE_CHANNELS(DATA_CHANNEL_STORAGE_)
+
+static data_channel_block_t g_channels[DATA_CHANNEL_COUNT] = {
+    DATA_SERVICE_CHANNELS(DATA_CHANNEL_BLOCK_)
+};
+
+static const data_channel_info_t g_channel_info[DATA_CHANNEL_COUNT] = {
+    DATA_SERVICE_CHANNELS(DATA_CHANNEL_INFO_)
+};
+
+/*
+ * 不屬於傳感器通道的分段
+ */
+DATA_SECTION_DEFINE(profile,    system_profile_t);
+
+/*
+ * 舵機分段按下標組成數組，存儲在 data_service_init() 中綁定
+ */
+static servo_data_t g_servo_storage[DATA_SERVICE_MAX_SERVOS][2];
+static data_section_t g_servo_sections[DATA_SERVICE_MAX_SERVOS];
+
+/*
+ * 訂閱者表：g_subscriber_reserved 為已分配的槽位數 (只增不減)，
+ * 槽位的 task 寫入後才對通知和讀取可見。
+ */
+static data_subscriber_t g_subscribers[DATA_SERVICE_MAX_SUBSCRIBERS];
+static volatile uint32_t g_subscriber_reserved = 0;
 
 /**
  * @brief 用於向其他任務發送實時通知的事件標誌組
@@ -37,6 +162,186 @@ static SemaphoreHandle_t g_state_mutex = NULL;
 static EventGroupHandle_t g_system_events = NULL;
 
 
+/*============================================================================*/
+/* 內部函數 (Private Functions)                          */
+/*============================================================================*/
+
+/**
+ * @brief 清空分段
+ */
+static void section_reset(data_section_t *p_section) {
+    memset(p_section->storage, 0, 2 * p_section->size);
+    p_section->seq[0] = 0;
+    p_section->seq[1] = 0;
+    p_section->active = 0;
+    p_section->version = 0;
+}
+
+/**
+ * @brief 寫入分段 (單寫入者，永不阻塞)
+ */
+static void section_write(data_section_t *p_section, const void *p_src) {
+    uint32_t idx = p_section->active ^ 1;
+    uint8_t *p_dst = p_section->storage + idx * p_section->size;
+
+    // 標記緩衝區正在寫入 (序號變為奇數)
+    p_section->seq[idx]++;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    memcpy(p_dst, p_src, p_section->size);
+
+    // 標記寫入完成 (序號恢復偶數)，再發布為活動緩衝區
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    p_section->seq[idx]++;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    p_section->active = idx;
+    p_section->version++;
+}
+
+/**
+ * @brief 讀取分段 (衝突時重試)
+ * @return 讀取到的數據對應的版本號
+ */
+static uint32_t section_read(const data_section_t *p_section, void *p_dst) {
+    for (;;) {
+        uint32_t version = p_section->version;
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        uint32_t idx = p_section->active;
+        uint32_t seq_begin = p_section->seq[idx];
+        if (seq_begin & 1) {
+            // 寫入方已連續寫入兩次並正在改寫此緩衝區，活動索引已經切換
+            continue;
+        }
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        memcpy(p_dst, p_section->storage + idx * p_section->size, p_section->size);
+
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (p_section->seq[idx] == seq_begin) {
+            return version;
+        }
+    }
+}
+
+/**
+ * @brief 清空環形緩衝區
+ */
+static void ring_reset(data_ring_t *p_ring) {
+    p_ring->head = 0;
+}
+
+/**
+ * @brief 寫入一個樣本 (僅生產者調用，永不失敗)
+ */
+static void ring_push(data_ring_t *p_ring, const void *p_elem) {
+    uint32_t head = p_ring->head;
+
+    memcpy(p_ring->storage + (head & (p_ring->capacity - 1)) * p_ring->elem_size,
+           p_elem, p_ring->elem_size);
+
+    // 數據寫入完成後再發布新的 head
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    p_ring->head = head + 1;
+}
+
+/**
+ * @brief 按訂閱者的讀游標取出最多 max_count 個樣本 (僅該訂閱任務調用)
+ * @details
+ * 生產者不等待讀取方，因此複製完成後要重新檢查 head：生產者正在寫入
+ * 下標 head 時會覆蓋下標 head - capacity 的槽位，複製期間被覆蓋
+ * (或可能正在被覆蓋) 的樣本從結果中去掉並計入 dropped。
+ * @return 實際取出的樣本數
+ */
+static size_t ring_read(const data_ring_t *p_ring, uint32_t *p_tail, volatile uint32_t *p_dropped,
+                        void *p_out, size_t max_count) {
+    uint32_t tail = *p_tail;
+    uint32_t head = p_ring->head;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    // 落後超過一整圈：跳到仍然有效的最舊樣本
+    if (head - tail > p_ring->capacity) {
+        *p_dropped += head - tail - p_ring->capacity;
+        tail = head - p_ring->capacity;
+    }
+
+    uint32_t count = head - tail;
+    if (count > max_count) {
+        count = (uint32_t)max_count;
+    }
+
+    uint8_t *p_dst = (uint8_t *)p_out;
+    for (uint32_t i = 0; i < count; i++) {
+        memcpy(p_dst + i * p_ring->elem_size,
+               p_ring->storage + ((tail + i) & (p_ring->capacity - 1)) * p_ring->elem_size,
+               p_ring->elem_size);
+    }
+
+    // 下標不大於 head_after - capacity 的槽位在複製期間可能已被改寫
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    uint32_t head_after = p_ring->head;
+    uint32_t valid_from = head_after - p_ring->capacity + 1;
+    uint32_t overwritten = 0;
+    if ((int32_t)(valid_from - tail) > 0) {
+        overwritten = valid_from - tail;
+        if (overwritten > count) {
+            overwritten = count;
+        }
+    }
+    if (overwritten > 0) {
+        memmove(p_dst, p_dst + overwritten * p_ring->elem_size, (count - overwritten) * p_ring->elem_size);
+        *p_dropped += overwritten;
+    }
+
+    *p_tail = tail + count;
+    return count - overwritten;
+}
+
+/**
+ * @brief 根據訂閱ID取得已登記的訂閱者
+ */
+static data_subscriber_t *subscriber_get(int subscriber) {
+    if (subscriber < 0 || subscriber >= DATA_SERVICE_MAX_SUBSCRIBERS ||
+        (uint32_t)subscriber >= g_subscriber_reserved) {
+        return NULL;
+    }
+    data_subscriber_t *p_sub = &g_subscribers[subscriber];
+    return (p_sub->task != NULL) ? p_sub : NULL;
+}
+
+/**
+ * @brief 根據通道ID取得控制塊
+ */
+static data_channel_block_t *channel_get(data_channel_t channel) {
+    if ((int)channel < 0 || channel >= DATA_CHANNEL_COUNT) {
+        return NULL;
+    }
+    return &g_channels[channel];
+}
+
+/**
+ * @brief 設置事件位通知其他任務
+ */
+static void notify(EventBits_t bits) {
+    // 訂閱者：直接向任務發送通知，每個訂閱者各自累積事件位，互不搶佔
+    uint32_t reserved = g_subscriber_reserved;
+    if (reserved > DATA_SERVICE_MAX_SUBSCRIBERS) {
+        reserved = DATA_SERVICE_MAX_SUBSCRIBERS;
+    }
+    for (uint32_t i = 0; i < reserved; i++) {
+        TaskHandle_t task = g_subscribers[i].task;
+        EventBits_t topics = bits & g_subscribers[i].topics;
+        if (task != NULL && topics != 0) {
+            xTaskNotify(task, (uint32_t)topics, eSetBits);
+        }
+    }
+
+    // 兼容直接等待事件標誌組的任務
+    if (g_system_events != NULL) {
+        xEventGroupSetBits(g_system_events, bits);
+    }
+}
+
+
 /*============================================================================*/
 /* 公共API函數實現 (Public APIs)                         */
 /*============================================================================*/
@@ -45,99 +350,218 @@ static EventGroupHandle_t g_system_events = NULL;
  * @brief 初始化數據服務層
  */
 BaseType_t data_service_init(void) {
-    // 創建互斥鎖
-    g_state_mutex = xSemaphoreCreateMutex();
-    if (g_state_mutex == NULL) {
-        // 錯誤處理：互斥鎖創建失敗
-        return pdFAIL;
-    }
-
     // 創建事件標誌組
     g_system_events = xEventGroupCreate();
     if (g_system_events == NULL) {
         // 錯誤處理：事件組創建失敗
-        vSemaphoreDelete(g_state_mutex);
         return pdFAIL;
     }
 
-    // 初始化系統狀態結構體為0或默認值
-    memset(&g_system_state, 0, sizeof(system_state_t));
+    // 初始化所有分段為0
+    for (int i = 0; i < DATA_CHANNEL_COUNT; i++) {
+        section_reset(&g_channels[i].section);
+        ring_reset(&g_channels[i].ring);
+    }
+    section_reset(&g_profile_section);
+    for (int i = 0; i < DATA_SERVICE_MAX_SERVOS; i++) {
+        g_servo_sections[i].storage = (uint8_t *)g_servo_storage[i];
+        g_servo_sections[i].size = sizeof(servo_data_t);
+        section_reset(&g_servo_sections[i]);
+    }
 
     return pdPASS;
 }
 
 /**
- * @brief 獲取整個系統狀態的線程安全副本（快照）
+ * @brief 獲取整個系統狀態的副本（快照）
  */
 void data_service_get_system_state(system_state_t *p_state_copy) {
-    // 檢查輸入指針和互斥鎖是否有效
-    if (p_state_copy == NULL || g_state_mutex == NULL) {
+    if (p_state_copy == NULL) {
         return;
     }
 
-    // 獲取互斥鎖，設置一個合理的等待超時
-    if (xSemaphoreTake(g_state_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        // 成功獲取鎖，複製數據
-        memcpy(p_state_copy, &g_system_state, sizeof(system_state_t));
-        
-        // 釋放互斥鎖
-        xSemaphoreGive(g_state_mutex);
-    } else {
-        // 錯誤處理：獲取鎖超時。
-        memset(p_state_copy, 0, sizeof(system_state_t));
+    data_service_get_temp_humid(&p_state_copy->temperature, &p_state_copy->humidity);
+    section_read(&g_channels[DATA_CHANNEL_IMU].section, &p_state_copy->imu_data);
+    section_read(&g_channels[DATA_CHANNEL_GPS].section, &p_state_copy->gps_data);
+    section_read(&g_channels[DATA_CHANNEL_ENCODER_0].section, &p_state_copy->encoder_data);
+    section_read(&g_channels[DATA_CHANNEL_JOYSTICK_0].section, &p_state_copy->joystick_data);
+    for (int i = 0; i < DATA_SERVICE_MAX_SERVOS; i++) {
+        section_read(&g_servo_sections[i], &p_state_copy->servo_data[i]);
     }
 }
 
 /**
- * @brief 更新溫濕度數據
+ * @brief 取得通道描述
  */
-void data_service_update_temp_humid(float temp, float humid) {
-    if (g_state_mutex == NULL) return;
-
-    if (xSemaphoreTake(g_state_mutex, portMAX_DELAY) == pdTRUE) {
-        g_system_state.temperature = temp;
-        g_system_state.humidity = humid;
-        xSemaphoreGive(g_state_mutex);
+const data_channel_info_t *data_channel_get_info(data_channel_t channel) {
+    if ((int)channel < 0 || channel >= DATA_CHANNEL_COUNT) return NULL;
+    return &g_channel_info[channel];
+}
 
-        // 數據更新完成後，設置事件位通知其他任務
-        if (g_system_events != NULL) {
-            xEventGroupSetBits(g_system_events, BIT_EVENT_TEMP_HUMID_UPDATED);
+/**
+ * @brief 按類別和實例號查找通道
+ */
+data_channel_t data_channel_find(data_kind_t kind, uint8_t instance) {
+    for (int i = 0; i < DATA_CHANNEL_COUNT; i++) {
+        if (g_channel_info[i].kind == kind && g_channel_info[i].instance == instance) {
+            return (data_channel_t)i;
         }
     }
+    return DATA_CHANNEL_NONE;
 }
 
 /**
- * @brief 更新IMU數據
+ * @brief 寫入通道
  */
-void data_service_update_imu(const imu_data_t *p_imu_data) {
-    if (p_imu_data == NULL || g_state_mutex == NULL) return;
+BaseType_t data_channel_write(data_channel_t channel, const void *p_sample, size_t size) {
+    data_channel_block_t *p_block = channel_get(channel);
+    if (p_block == NULL || p_sample == NULL || size != p_block->section.size) return pdFAIL;
 
-    if (xSemaphoreTake(g_state_mutex, portMAX_DELAY) == pdTRUE) {
-        memcpy(&g_system_state.imu_data, p_imu_data, sizeof(imu_data_t));
-        xSemaphoreGive(g_state_mutex);
-
-        if (g_system_events != NULL) {
-            xEventGroupSetBits(g_system_events, BIT_EVENT_IMU_UPDATED);
-        }
+    section_write(&p_block->section, p_sample);
+    if (p_block->ring.capacity > 0) {
+        ring_push(&p_block->ring, p_sample);
     }
+
+    // 數據更新完成後，設置事件位通知其他任務
+    notify(p_block->ring.topic);
+    return pdPASS;
 }
 
 /**
- * @brief 更新GPS數據
+ * @brief 讀取通道的最新值
  */
-void data_service_update_gps(const gps_data_t *p_gps_data) {
-    if (p_gps_data == NULL || g_state_mutex == NULL) return;
+uint32_t data_channel_read(data_channel_t channel, void *p_sample, size_t size) {
+    const data_channel_block_t *p_block = channel_get(channel);
+    if (p_block == NULL || p_sample == NULL || size != p_block->section.size) return 0;
+    return section_read(&p_block->section, p_sample);
+}
 
-    if (xSemaphoreTake(g_state_mutex, portMAX_DELAY) == pdTRUE) {
-        memcpy(&g_system_state.gps_data, p_gps_data, sizeof(gps_data_t));
-        xSemaphoreGive(g_state_mutex);
+/**
+ * @brief 從通道的環形緩衝區取出樣本
+ */
+size_t data_channel_drain(int subscriber, data_channel_t channel, void *p_out, size_t sample_size,
+                          size_t max_count) {
+    data_channel_block_t *p_block = channel_get(channel);
+    data_subscriber_t *p_sub = subscriber_get(subscriber);
+    if (p_block == NULL || p_sub == NULL || p_out == NULL || max_count == 0 ||
+        p_block->ring.capacity == 0 || sample_size != p_block->ring.elem_size ||
+        !(p_sub->ring_topics & p_block->ring.topic)) {
+        return 0;
+    }
+    return ring_read(&p_block->ring, &p_sub->tail[channel], &p_sub->dropped[channel], p_out, max_count);
+}
 
-        if (g_system_events != NULL) {
-            xEventGroupSetBits(g_system_events, BIT_EVENT_GPS_UPDATED);
-        }
+/**
+ * @brief 累計一個通道的環形緩衝區狀態 (pending 取最大值，dropped 取總和)
+ */
+static void channel_ring_stats(int subscriber, int channel, uint32_t *p_pending, uint32_t *p_dropped) {
+    const data_ring_t *p_ring = &g_channels[channel].ring;
+    uint32_t head = p_ring->head;
+    for (int i = 0; i < DATA_SERVICE_MAX_SUBSCRIBERS; i++) {
+        if (subscriber != DATA_SERVICE_ALL_SUBSCRIBERS && subscriber != i) continue;
+        const data_subscriber_t *p_sub = subscriber_get(i);
+        if (p_sub == NULL || !(p_sub->ring_topics & p_ring->topic)) continue;
+
+        uint32_t behind = head - p_sub->tail[channel];
+        if (behind > p_ring->capacity) behind = p_ring->capacity;
+        if (behind > *p_pending) *p_pending = behind;
+        *p_dropped += p_sub->dropped[channel];
     }
 }
 
+/**
+ * @brief 查詢通道環形緩衝區的狀態
+ */
+BaseType_t data_channel_get_ring_stats(int subscriber, data_channel_t channel,
+                                       uint32_t *p_pending, uint32_t *p_dropped) {
+    const data_channel_block_t *p_block = channel_get(channel);
+    if (p_block == NULL || p_block->ring.capacity == 0) return pdFAIL;
+
+    uint32_t pending = 0;
+    uint32_t dropped = 0;
+    channel_ring_stats(subscriber, (int)channel, &pending, &dropped);
+    if (p_pending) *p_pending = pending;
+    if (p_dropped) *p_dropped = dropped;
+    return pdPASS;
+}
+
+/**
+ * @brief 讀取溫濕度數據
+ */
+uint32_t data_service_get_temp_humid(float *p_temp, float *p_humid) {
+    temp_humid_data_t data;
+    uint32_t version = data_channel_read(DATA_CHANNEL_TEMP_HUMID, &data, sizeof(data));
+    if (p_temp)  *p_temp = data.temperature;
+    if (p_humid) *p_humid = data.humidity;
+    return version;
+}
+
+/**
+ * @brief 讀取IMU數據
+ */
+uint32_t data_service_get_imu(imu_data_t *p_imu_data) {
+    return data_channel_read(DATA_CHANNEL_IMU, p_imu_data, sizeof(*p_imu_data));
+}
+
+/**
+ * @brief 讀取GPS數據
+ */
+uint32_t data_service_get_gps(gps_data_t *p_gps_data) {
+    return data_channel_read(DATA_CHANNEL_GPS, p_gps_data, sizeof(*p_gps_data));
+}
+
+/**
+ * @brief 讀取旋轉編碼器數據
+ */
+uint32_t data_service_get_encoder(encoder_data_t *p_encoder_data) {
+    return data_channel_read(DATA_CHANNEL_ENCODER_0, p_encoder_data, sizeof(*p_encoder_data));
+}
+
+/**
+ * @brief 讀取搖杆數據
+ */
+uint32_t data_service_get_joystick(joystick_data_t *p_joystick_data) {
+    return data_channel_read(DATA_CHANNEL_JOYSTICK_0, p_joystick_data, sizeof(*p_joystick_data));
+}
+
+/**
+ * @brief 讀取總線舵機狀態
+ */
+uint32_t data_service_get_servo(uint8_t slot, servo_data_t *p_servo_data) {
+    if (p_servo_data == NULL || slot >= DATA_SERVICE_MAX_SERVOS) return 0;
+    return section_read(&g_servo_sections[slot], p_servo_data);
+}
+
+/**
+ * @brief 讀取系統負載快照
+ */
+uint32_t data_service_get_profile(system_profile_t *p_profile) {
+    if (p_profile == NULL) return 0;
+    return section_read(&g_profile_section, p_profile);
+}
+
+/**
+ * @brief 更新溫濕度數據
+ */
+void data_service_update_temp_humid(float temp, float humid) {
+    temp_humid_data_t data = { .temperature = temp, .humidity = humid };
+    data_channel_write(DATA_CHANNEL_TEMP_HUMID, &data, sizeof(data));
+}
+
+/**
+ * @brief 更新IMU數據
+ */
+void data_service_update_imu(const imu_data_t *p_imu_data) {
+    data_channel_write(DATA_CHANNEL_IMU, p_imu_data, sizeof(*p_imu_data));
+}
+
+/**
+ * @brief 更新GPS數據
+ */
+void data_service_update_gps(const gps_data_t *p_gps_data) {
+    data_channel_write(DATA_CHANNEL_GPS, p_gps_data, sizeof(*p_gps_data));
+}
+
 /**
  * @brief 獲取系統事件標誌組的句柄
  */
@@ -149,30 +573,119 @@ EventGroupHandle_t data_service_get_event_group_handle(void) {
  * @brief 更新旋轉編碼器數據
  */
 void data_service_update_encoder(const encoder_data_t *p_encoder_data) {
-    if (p_encoder_data == NULL || g_state_mutex == NULL) return;
+    data_channel_write(DATA_CHANNEL_ENCODER_0, p_encoder_data, sizeof(*p_encoder_data));
+}
 
-    if (xSemaphoreTake(g_state_mutex, portMAX_DELAY) == pdTRUE) {
-        memcpy(&g_system_state.encoder_data, p_encoder_data, sizeof(encoder_data_t));
-        xSemaphoreGive(g_state_mutex);
+/**
+ * @brief 更新搖杆數據
+ */
+void data_service_update_joystick(const joystick_data_t *p_joystick_data) {
+    data_channel_write(DATA_CHANNEL_JOYSTICK_0, p_joystick_data, sizeof(*p_joystick_data));
+}
 
-        if (g_system_events != NULL) {
-            xEventGroupSetBits(g_system_events, BIT_EVENT_ENCODER_UPDATED);
-        }
+/**
+ * @brief 更新總線舵機狀態
+ */
+void data_service_update_servo(uint8_t slot, const servo_data_t *p_servo_data) {
+    if (p_servo_data == NULL || slot >= DATA_SERVICE_MAX_SERVOS) return;
+
+    section_write(&g_servo_sections[slot], p_servo_data);
+    notify(BIT_EVENT_SERVO_UPDATED);
+}
+
+/**
+ * @brief 更新系統負載快照
+ */
+void data_service_update_profile(const system_profile_t *p_profile) {
+    if (p_profile == NULL) return;
+
+    section_write(&g_profile_section, p_profile);
+    notify(BIT_EVENT_PROFILE_UPDATED);
+}
+
+/**
+ * @brief 為當前任務登記一個訂閱者槽位
+ */
+static int subscriber_register(EventBits_t topics, EventBits_t ring_topics) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    if (topics == 0 || task == NULL) return -1;
+
+    uint32_t slot = __atomic_fetch_add(&g_subscriber_reserved, 1, __ATOMIC_SEQ_CST);
+    if (slot >= DATA_SERVICE_MAX_SUBSCRIBERS) {
+        return -1;
+    }
+
+    data_subscriber_t *p_sub = &g_subscribers[slot];
+    p_sub->topics = topics;
+    p_sub->ring_topics = ring_topics;
+    for (int i = 0; i < DATA_CHANNEL_COUNT; i++) {
+        // 只接收訂閱之後的新樣本
+        p_sub->tail[i] = g_channels[i].ring.head;
+        p_sub->dropped[i] = 0;
     }
+
+    // 控制塊寫完後再登記任務句柄，此後才會收到通知
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    p_sub->task = task;
+    return (int)slot;
 }
 
 /**
- * @brief 更新搖杆數據
+ * @brief 訂閱事件 (帶環形緩衝區讀游標)
  */
-void data_service_update_joystick(const joystick_data_t *p_joystick_data) {
-    if (p_joystick_data == NULL || g_state_mutex == NULL) return;
+int data_service_subscribe(EventBits_t topics) {
+    return subscriber_register(topics, topics);
+}
 
-    if (xSemaphoreTake(g_state_mutex, portMAX_DELAY) == pdTRUE) {
-        memcpy(&g_system_state.joystick_data, p_joystick_data, sizeof(joystick_data_t));
-        xSemaphoreGive(g_state_mutex);
+/**
+ * @brief 訂閱事件 (只接收通知)
+ */
+int data_service_subscribe_latest(EventBits_t topics) {
+    return subscriber_register(topics, 0);
+}
 
-        if (g_system_events != NULL) {
-            xEventGroupSetBits(g_system_events, BIT_EVENT_JOYSTICK_UPDATED);
-        }
+/**
+ * @brief 等待訂閱的事件
+ */
+EventBits_t data_service_wait(int subscriber, TickType_t ticks_to_wait) {
+    data_subscriber_t *p_sub = subscriber_get(subscriber);
+    if (p_sub == NULL) return 0;
+
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &bits, ticks_to_wait);
+    return (EventBits_t)bits & p_sub->topics;
+}
+
+/**
+ * @brief 從編碼器環形緩衝區取出樣本
+ */
+size_t data_service_drain_encoder(int subscriber, encoder_data_t *p_out, size_t max_count) {
+    return data_channel_drain(subscriber, DATA_CHANNEL_ENCODER_0, p_out, sizeof(*p_out), max_count);
+}
+
+/**
+ * @brief 從搖杆環形緩衝區取出樣本
+ */
+size_t data_service_drain_joystick(int subscriber, joystick_data_t *p_out, size_t max_count) {
+    return data_channel_drain(subscriber, DATA_CHANNEL_JOYSTICK_0, p_out, sizeof(*p_out), max_count);
+}
+
+/**
+ * @brief 查詢某一類別所有通道的環形緩衝區狀態
+ */
+BaseType_t data_service_get_ring_stats(int subscriber, EventBits_t event_bit,
+                                       uint32_t *p_pending, uint32_t *p_dropped) {
+    uint32_t pending = 0;
+    uint32_t dropped = 0;
+    bool found = false;
+    for (int i = 0; i < DATA_CHANNEL_COUNT; i++) {
+        if (g_channels[i].ring.capacity == 0 || g_channels[i].ring.topic != event_bit) continue;
+        channel_ring_stats(subscriber, i, &pending, &dropped);
+        found = true;
     }
+    if (!found) return pdFAIL;
+
+    if (p_pending) *p_pending = pending;
+    if (p_dropped) *p_dropped = dropped;
+    return pdPASS;
 }
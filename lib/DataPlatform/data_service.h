@@ -36,14 +36,81 @@ extern "C" {
 #define BIT_EVENT_GPS_UPDATED          (1 << 2) // GPS數據已更新
 #define BIT_EVENT_ENCODER_UPDATED      (1 << 3) // 旋转编码器数据已更新
 #define BIT_EVENT_JOYSTICK_UPDATED     (1 << 4) // 摇杆数据已更新
-// 在此處為新的傳感器或事件添加更多的事件位...
-// #define BIT_EVENT_NEW_SENSOR_UPDATED (1 << 5)
+#define BIT_EVENT_SERVO_UPDATED        (1 << 5) // 舵機狀態已更新
+#define BIT_EVENT_PROFILE_UPDATED      (1 << 6) // 任務性能剖析窗口已更新
+#define BIT_EVENT_KEYPAD_UPDATED       (1 << 7) // 矩陣鍵盤按鍵事件
+// 事件位按傳感器類別分配 (同一類別的所有通道共用)，新的類別在此處添加...
+// #define BIT_EVENT_NEW_SENSOR_UPDATED (1 << 8)
+
+/*============================================================================*/
+/* 樣本環形緩衝區容量 (Sample Rings)                   */
+/*============================================================================*/
+/**
+ * @brief 各事件類別的樣本環形緩衝區容量 (必須為2的冪)
+ * @details
+ * 除了最新值快照外，編碼器和摇杆的每一次更新都會按順序寫入一個
+ * 單生產者/多消費者環形緩衝區，每個訂閱者有自己的讀游標，可一次取出多個樣本。
+ * 容量即訂閱者最多可以落後的樣本數。
+ */
+#ifndef DATA_SERVICE_ENCODER_RING_SIZE
+#define DATA_SERVICE_ENCODER_RING_SIZE   32
+#endif
+#ifndef DATA_SERVICE_JOYSTICK_RING_SIZE
+#define DATA_SERVICE_JOYSTICK_RING_SIZE  16
+#endif
+#ifndef DATA_SERVICE_KEYPAD_RING_SIZE
+#define DATA_SERVICE_KEYPAD_RING_SIZE    16
+#endif
+
+/**
+ * @brief 通道控制塊和存儲的對齊 (ESP32 cache 行為 32 字節)
+ * @details
+ * 每個通道的控制塊、雙緩衝和環形緩衝區各自按此對齊，不同通道 (通常由不同核心上的
+ * 任務寫入) 不共用 cache 行；樣本按字對齊，分段複製不需要逐字節處理。
+ */
+#ifndef DATA_SERVICE_CACHE_LINE
+#define DATA_SERVICE_CACHE_LINE  32
+#endif
+
+/**
+ * @brief 最多可登記的訂閱者數量 (見 data_service_subscribe())
+ */
+#ifndef DATA_SERVICE_MAX_SUBSCRIBERS
+#define DATA_SERVICE_MAX_SUBSCRIBERS  6
+#endif
+
+/**
+ * @brief data_service_get_ring_stats() 中表示匯總所有訂閱者
+ */
+#define DATA_SERVICE_ALL_SUBSCRIBERS  (-1)
+
+/**
+ * @brief 舵機狀態分段的數量 (總線上最多可管理的舵機數)
+ */
+#ifndef DATA_SERVICE_MAX_SERVOS
+#define DATA_SERVICE_MAX_SERVOS  4
+#endif
+
+/**
+ * @brief 性能剖析結果中最多記錄的任務數 (按CPU佔用從高到低保留)
+ */
+#ifndef DATA_SERVICE_PROFILE_MAX_TASKS
+#define DATA_SERVICE_PROFILE_MAX_TASKS  24
+#endif
 
 /*============================================================================*/
 /* 系統狀態數據結構 (System State)                     */
 /*============================================================================*/
 
 // 下面是一些例子
+/**
+ * @brief 溫濕度數據結構
+ */
+typedef struct {
+    float temperature; // 溫度 (°C)
+    float humidity;    // 濕度 (%)
+} temp_humid_data_t;
+
 /**
  * @brief IMU（慣性測量單元）數據結構
  */
@@ -74,6 +141,8 @@ typedef struct {
     int32_t delta;           // 位置变化量
     bool    button_pressed;  // 按钮状态
     uint32_t timestamp;      // 时间戳
+    uint32_t sample_us;      // 采样时刻 (esp_timer 微秒低32位，用于延迟统计)
+    uint32_t publish_us;     // 写入 DataPlatform 的时刻 (同上)
 } encoder_data_t;
 
 /**
@@ -88,14 +157,137 @@ typedef struct {
     bool in_deadzone;        // 是否在死区内
     float magnitude;         // 摇杆偏移量 (0.0-1.0)
     float angle;             // 摇杆角度 (0-360度)
+    uint16_t magnitude_q15;  // 摇杆偏移量, Q15 定点 (0-32767 对应 0.0-1.0)
+    uint16_t angle_cdeg;     // 摇杆角度, 单位 0.01 度 (0-35999)
     uint32_t timestamp;      // 时间戳
+    uint32_t sample_us;      // 采样时刻 (esp_timer 微秒低32位，用于延迟统计)
+    uint32_t publish_us;     // 写入 DataPlatform 的时刻 (同上)
 } joystick_data_t;
 
+/**
+ * @brief 矩陣鍵盤按鍵事件
+ */
+typedef struct {
+    uint8_t  key_code;       // 按鍵代碼 (從 1 開始)
+    bool     pressed;        // true = 按下, false = 釋放
+    uint32_t timestamp;      // 時間戳 (FreeRTOS tick)
+    uint32_t sample_us;      // 掃描到狀態變化的時刻 (esp_timer 微秒低32位，用於延遲統計)
+    uint32_t publish_us;     // 寫入 DataPlatform 的時刻 (同上)
+} keypad_data_t;
+
+/**
+ * @brief 舵機狀態標誌位
+ */
+#define SERVO_STATE_FLAG_POSITION_VALID  (1 << 0) // position 來自舵機回讀
+#define SERVO_STATE_FLAG_TEMP_VALID      (1 << 1) // temperature 來自舵機回讀
+#define SERVO_STATE_FLAG_VOLTAGE_VALID   (1 << 2) // voltage 來自舵機回讀
+#define SERVO_STATE_FLAG_TIMEOUT         (1 << 3) // 最近一次讀取超時或失敗
+
+/**
+ * @brief 總線舵機狀態數據結構
+ */
+typedef struct {
+    uint8_t  id;            // 舵機ID
+    uint8_t  flags;         // SERVO_STATE_FLAG_*
+    int16_t  temperature;   // 溫度 (°C)
+    float    position;      // 當前角度 (度)
+    float    target;        // 最近一次下發的目標角度 (度)
+    float    voltage;       // 電壓 (V)
+    uint32_t timeouts;      // 累計讀取失敗次數
+    uint32_t timestamp;     // 最近一次更新的時間戳 (FreeRTOS tick)
+} servo_data_t;
+
+/**
+ * @brief 性能剖析標誌位
+ */
+#define PROFILE_FLAG_CPU_VALID   (1 << 0) // 已啟用 FreeRTOS 運行時間統計，CPU佔用有效
+#define PROFILE_FLAG_TRUNCATED   (1 << 1) // 系統任務數超過 DATA_SERVICE_PROFILE_MAX_TASKS
+
+/**
+ * @brief 單個任務在一個剖析窗口內的統計
+ */
+typedef struct {
+    char     name[16];      // 任務名
+    uint8_t  core;          // 綁定的核心 (0/1，0xFF = 不綁定)
+    uint8_t  priority;      // 當前優先級
+    uint16_t cpu_permille;  // 窗口內佔用單個核心的比例 (千分比)
+    uint32_t stack_free;    // 棧高水位：運行以來剩餘棧的最小值 (字節)
+} task_profile_t;
+
+/**
+ * @brief 一個剖析窗口的系統負載快照
+ */
+typedef struct {
+    uint32_t window_ms;                  // 實際窗口長度
+    uint16_t core_load_permille[2];      // 各核心負載 (千分比，1000 減去空閒任務佔用)
+    uint32_t heap_free;                  // 當前空閒堆
+    uint32_t heap_min_free;              // 啟動以來的最小空閒堆
+    uint8_t  flags;                      // PROFILE_FLAG_*
+    uint8_t  task_count;                 // tasks[] 中的有效項數 (按CPU佔用降序)
+    uint8_t  total_tasks;                // 系統中的任務總數
+    task_profile_t tasks[DATA_SERVICE_PROFILE_MAX_TASKS];
+    uint32_t timestamp;                  // 窗口結束時間 (FreeRTOS tick)
+} system_profile_t;
+
+/*============================================================================*/
+/* 傳感器通道 (Channels)                               */
+/*============================================================================*/
+
+/**
+ * @brief 傳感器類別
+ * @details 決定通道的樣本類型和事件位；同一類別可以有多個通道 (實例)。
+ */
+typedef enum {
+    DATA_KIND_TEMP_HUMID = 0,   // temp_humid_data_t
+    DATA_KIND_IMU,              // imu_data_t
+    DATA_KIND_GPS,              // gps_data_t
+    DATA_KIND_ENCODER,          // encoder_data_t
+    DATA_KIND_JOYSTICK,         // joystick_data_t
+    DATA_KIND_KEYPAD,           // keypad_data_t
+    DATA_KIND_COUNT
+} data_kind_t;
+
+/**
+ * @brief 傳感器ID：高 4 位為類別，低 4 位為實例號，與通道表的順序無關
+ */
+#define DATA_SENSOR_ID(kind, instance)  ((uint8_t)(((kind) << 4) | ((instance) & 0x0F)))
+
+#ifdef DATA_SERVICE_CHANNEL_TABLE
+#include DATA_SERVICE_CHANNEL_TABLE
+#else
+#include "data_channels.h"
+#endif
+
+#define DATA_CHANNEL_ENUM_(id, kind_id, type, inst, cap)  DATA_CHANNEL_##id,
+
+/**
+ * @brief 通道ID (由通道表生成，按表中順序編號)
+ */
+typedef enum {
+    DATA_SERVICE_CHANNELS(DATA_CHANNEL_ENUM_)
+    DATA_CHANNEL_COUNT,
+    DATA_CHANNEL_NONE = -1      // data_channel_find() 未找到
+} data_channel_t;
+
+/**
+ * @brief 通道描述 (常量，由通道表生成)
+ */
+typedef struct {
+    const char *name;           // 通道名 (通道表中的名稱)
+    uint8_t     kind;           // data_kind_t
+    uint8_t     instance;       // 同一類別內的實例號
+    uint8_t     sensor_id;      // DATA_SENSOR_ID(kind, instance)
+    uint16_t    sample_size;    // 樣本大小 (字節)
+    uint16_t    ring_capacity;  // 環形緩衝區容量，0 表示沒有環形緩衝區
+    EventBits_t topic;          // 事件位 (BIT_EVENT_*_UPDATED)
+} data_channel_info_t;
+
 /**
  * @brief 系統狀態緩存的完整數據結構
  * @details
- * 這是系統中所有共享數據的集合。數據服務層的核心職責就是維護該結構的
- * 一個全局實例，並保證對其訪問的線程安全。
+ * 這是系統中所有共享數據的集合。數據服務層內部按傳感器分段存儲，
+ * 每個分段各自保證讀寫一致；此結構僅作為 data_service_get_system_state()
+ * 的聚合輸出格式，只包含各類別的實例 0 (其他實例用 data_channel_read() 讀取)。
  */
 typedef struct {
     float      temperature; // 溫度 (°C)
@@ -104,8 +296,8 @@ typedef struct {
     gps_data_t gps_data;    // GPS數據
     encoder_data_t encoder_data;  // 旋转编码器数据
     joystick_data_t joystick_data; // 摇杆数据
-    // 在此處為新的傳感器添加數據字段...
-    // uint32_t new_sensor_value;
+    servo_data_t servo_data[DATA_SERVICE_MAX_SERVOS]; // 總線舵機狀態 (按分段下標)
+    // 新的傳感器請在通道表 (data_channels.h) 中添加，不需要新的字段
 } system_state_t;
 
 
@@ -117,20 +309,143 @@ typedef struct {
  * @brief 初始化數據服務層
  * @details
  * 必須在任何其他API被調用之前，在系統啟動時調用一次。
- * 此函數會創建所需的Mutex和Event Group。
+ * 此函數會創建所需的Event Group並清空所有數據分段。
  * @return pdPASS 初始化成功, pdFAIL 初始化失敗.
  */
 BaseType_t data_service_init(void);
 
 /**
- * @brief 獲取整個系統狀態的線程安全副本（快照）
+ * @brief 獲取整個系統狀態的副本（快照）
  * @details
- * 此函數會鎖定互斥鎖，將當前的全局系統狀態複製到用戶提供的指針中，然後解鎖。
- * 這是應用層任務獲取數據的主要方式。
+ * 逐個分段讀取並聚合到用戶提供的結構體中。每個分段內部保證一致，
+ * 但不同分段之間不保證來自同一時刻。只需要某一個傳感器數據時，
+ * 請使用下面的 data_service_get_*() 以避免複製整個狀態。
  * @param[out] p_state_copy 指向用戶提供的 system_state_t 結構體，用於存儲狀態副本。
  */
 void data_service_get_system_state(system_state_t *p_state_copy);
 
+/*
+ * 通道接口
+ *
+ * 所有傳感器數據按通道存儲，data_service_get_*() / data_service_update_*() 等
+ * 按類別命名的接口是實例 0 通道的簡寫。樣本大小必須與通道表中的樣本類型一致。
+ */
+
+/**
+ * @brief 取得通道描述
+ * @return 通道描述，通道ID無效時返回 NULL
+ */
+const data_channel_info_t *data_channel_get_info(data_channel_t channel);
+
+/**
+ * @brief 按類別和實例號查找通道
+ * @return 通道ID，未找到返回 DATA_CHANNEL_NONE
+ */
+data_channel_t data_channel_find(data_kind_t kind, uint8_t instance);
+
+/**
+ * @brief 寫入通道 (更新最新值、寫入環形緩衝區並通知訂閱者)
+ * @details 每個通道只允許一個寫入任務；寫入方永不阻塞。
+ * @param[in] channel  通道ID
+ * @param[in] p_sample 樣本
+ * @param[in] size     樣本大小 (sizeof(樣本類型))
+ * @return pdPASS 成功, pdFAIL 通道無效或樣本大小不符
+ */
+BaseType_t data_channel_write(data_channel_t channel, const void *p_sample, size_t size);
+
+/**
+ * @brief 讀取通道的最新值
+ * @param[in]  channel  通道ID
+ * @param[out] p_sample 輸出緩衝區
+ * @param[in]  size     樣本大小 (sizeof(樣本類型))
+ * @return 通道版本號 (累計更新次數)，0 表示從未更新或參數無效
+ */
+uint32_t data_channel_read(data_channel_t channel, void *p_sample, size_t size);
+
+/**
+ * @brief 從通道的環形緩衝區取出最多 max_count 個樣本 (按時間順序，只能由訂閱任務調用)
+ * @param[in]  subscriber  訂閱ID (需訂閱該通道的事件位)
+ * @param[in]  channel     通道ID
+ * @param[out] p_out       輸出數組
+ * @param[in]  sample_size 樣本大小 (sizeof(樣本類型))
+ * @param[in]  max_count   輸出數組容量 (樣本數)
+ * @return 實際取出的樣本數
+ */
+size_t data_channel_drain(int subscriber, data_channel_t channel, void *p_out, size_t sample_size,
+                          size_t max_count);
+
+/**
+ * @brief 查詢通道環形緩衝區的狀態
+ * @param[in]  subscriber 訂閱ID，DATA_SERVICE_ALL_SUBSCRIBERS 表示匯總所有訂閱了該事件的訂閱者
+ * @param[in]  channel    通道ID
+ * @param[out] p_pending  尚未取出的樣本數，匯總時取最大值 (可為 NULL)
+ * @param[out] p_dropped  因落後超過容量而丟失的樣本總數，匯總時取總和 (可為 NULL)
+ * @return pdPASS 查詢成功, pdFAIL 通道無效或沒有環形緩衝區
+ */
+BaseType_t data_channel_get_ring_stats(int subscriber, data_channel_t channel,
+                                       uint32_t *p_pending, uint32_t *p_dropped);
+
+/*
+ * 按分段讀取接口
+ *
+ * 各分段採用雙緩衝 + 版本號 (seqlock) 存儲：寫入方永不阻塞，
+ * 讀取方在與寫入衝突時重試而不是等待鎖。返回值為該分段的版本號
+ * (累計更新次數)，0 表示從未更新，可用於判斷數據是否有新值。
+ *
+ * @note 每個分段只允許一個寫入任務 (例如編碼器分段只由編碼器任務更新)。
+ */
+
+/**
+ * @brief 讀取溫濕度數據
+ * @param[out] p_temp  溫度 (可為 NULL)
+ * @param[out] p_humid 濕度 (可為 NULL)
+ * @return 分段版本號
+ */
+uint32_t data_service_get_temp_humid(float *p_temp, float *p_humid);
+
+/**
+ * @brief 讀取IMU數據
+ * @param[out] p_imu_data 輸出緩衝區
+ * @return 分段版本號
+ */
+uint32_t data_service_get_imu(imu_data_t *p_imu_data);
+
+/**
+ * @brief 讀取GPS數據
+ * @param[out] p_gps_data 輸出緩衝區
+ * @return 分段版本號
+ */
+uint32_t data_service_get_gps(gps_data_t *p_gps_data);
+
+/**
+ * @brief 讀取旋转编码器数据
+ * @param[out] p_encoder_data 輸出緩衝區
+ * @return 分段版本號
+ */
+uint32_t data_service_get_encoder(encoder_data_t *p_encoder_data);
+
+/**
+ * @brief 讀取摇杆数据
+ * @param[out] p_joystick_data 輸出緩衝區
+ * @return 分段版本號
+ */
+uint32_t data_service_get_joystick(joystick_data_t *p_joystick_data);
+
+/**
+ * @brief 讀取總線舵機狀態
+ * @param[in]  slot         舵機分段下標 (0 到 DATA_SERVICE_MAX_SERVOS-1，由舵機總線管理器分配)
+ * @param[out] p_servo_data 輸出緩衝區
+ * @return 分段版本號，下標無效時返回 0
+ */
+uint32_t data_service_get_servo(uint8_t slot, servo_data_t *p_servo_data);
+
+/**
+ * @brief 讀取最近一個剖析窗口的系統負載快照
+ * @param[out] p_profile 輸出緩衝區
+ * @return 分段版本號 (已完成的窗口數)
+ */
+uint32_t data_service_get_profile(system_profile_t *p_profile);
+
 /**
  * @brief 更新溫濕度數據
  * @details
@@ -172,8 +487,99 @@ void data_service_update_encoder(const encoder_data_t *p_encoder_data);
  */
 void data_service_update_joystick(const joystick_data_t *p_joystick_data);
 
-// 在此處為新的傳感器添加更新函數的聲明...
-// void data_service_update_new_sensor(uint32_t value);
+/**
+ * @brief 更新總線舵機狀態
+ * @details
+ * 由舵機總線管理任務調用 (所有舵機分段的唯一寫入者)，並設置 BIT_EVENT_SERVO_UPDATED。
+ * @param[in] slot         舵機分段下標
+ * @param[in] p_servo_data 指向包含最新舵機狀態的結構體。
+ */
+void data_service_update_servo(uint8_t slot, const servo_data_t *p_servo_data);
+
+/**
+ * @brief 更新系統負載快照
+ * @details
+ * 由性能剖析任務在每個窗口結束時調用，並設置 BIT_EVENT_PROFILE_UPDATED。
+ * @param[in] p_profile 指向最新剖析結果的結構體。
+ */
+void data_service_update_profile(const system_profile_t *p_profile);
+
+/*
+ * 訂閱接口
+ *
+ * 每個需要事件通知或樣本流的任務各自訂閱一次：數據更新時直接向訂閱任務發送
+ * 任務通知 (xTaskNotify(..., eSetBits))，通知值中累積的是事件位，多個訂閱者
+ * 之間不會互相清除事件。訂閱任務的任務通知由數據服務層獨佔，不能再用於其他用途
+ * (例如 ulTaskNotifyTake())。
+ */
+
+/**
+ * @brief 為當前任務訂閱事件
+ * @details
+ * 必須在訂閱任務自身中調用 (登記的是 xTaskGetCurrentTaskHandle())，
+ * 訂閱不可取消，適用於常駐任務。訂閱者對事件位所屬類別的每個帶環形緩衝區的通道
+ * 各有一個讀游標，從訂閱時刻之後的樣本開始讀取。
+ * @param[in] topics 關心的事件位 (BIT_EVENT_* 的組合)
+ * @return 訂閱ID (>= 0)，topics 為 0 或訂閱者已滿 (DATA_SERVICE_MAX_SUBSCRIBERS) 時返回 -1
+ */
+int data_service_subscribe(EventBits_t topics);
+
+/**
+ * @brief 為當前任務訂閱事件，只接收通知，不建立環形緩衝區讀游標
+ * @details
+ * 適用於只讀取最新值 (data_service_get_*() 及分段版本號) 的任務：不調用 data_service_drain_*()，
+ * 也不計入 data_service_get_ring_stats() 的 pending/dropped，不會掩蓋其他訂閱者的積壓。
+ * 其餘規則與 data_service_subscribe() 相同，同樣佔用一個訂閱者槽位。
+ * @param[in] topics 關心的事件位 (BIT_EVENT_* 的組合)
+ * @return 訂閱ID (>= 0)，topics 為 0 或訂閱者已滿時返回 -1
+ */
+int data_service_subscribe_latest(EventBits_t topics);
+
+/**
+ * @brief 等待訂閱的事件 (只能由訂閱任務調用)
+ * @param[in] subscriber    訂閱ID
+ * @param[in] ticks_to_wait 最長等待時間
+ * @return 上次等待以來發生的事件位 (已與訂閱的 topics 相與)，超時返回 0
+ */
+EventBits_t data_service_wait(int subscriber, TickType_t ticks_to_wait);
+
+/*
+ * 樣本環形緩衝區接口
+ *
+ * 每個環形緩衝區只有一個生產者 (該通道的寫入任務)，可以有多個
+ * 訂閱者各自按讀游標讀取，讀取不需要複製到中間緩衝區，也不互相等待。
+ * 生產者從不等待讀取方：落後超過容量的訂閱者丟失最舊的樣本，計入該訂閱者
+ * 自己的 dropped，不影響其他訂閱者。
+ */
+
+/**
+ * @brief 從編碼器實例 0 的環形緩衝區取出最多 max_count 個樣本 (按時間順序，只能由訂閱任務調用)
+ * @param[in]  subscriber 訂閱ID (需訂閱 BIT_EVENT_ENCODER_UPDATED)
+ * @param[out] p_out      輸出數組
+ * @param[in]  max_count  輸出數組容量
+ * @return 實際取出的樣本數
+ */
+size_t data_service_drain_encoder(int subscriber, encoder_data_t *p_out, size_t max_count);
+
+/**
+ * @brief 從摇杆實例 0 的環形緩衝區取出最多 max_count 個樣本 (按時間順序，只能由訂閱任務調用)
+ * @param[in]  subscriber 訂閱ID (需訂閱 BIT_EVENT_JOYSTICK_UPDATED)
+ * @param[out] p_out      輸出數組
+ * @param[in]  max_count  輸出數組容量
+ * @return 實際取出的樣本數
+ */
+size_t data_service_drain_joystick(int subscriber, joystick_data_t *p_out, size_t max_count);
+
+/**
+ * @brief 查詢某一類別所有通道的環形緩衝區狀態
+ * @param[in]  subscriber 訂閱ID，DATA_SERVICE_ALL_SUBSCRIBERS 表示匯總所有訂閱了該事件的訂閱者
+ * @param[in]  event_bit  事件類別 (例如 BIT_EVENT_ENCODER_UPDATED)，匯總該類別的所有通道
+ * @param[out] p_pending  尚未取出的樣本數，匯總時取最大值 (可為 NULL)
+ * @param[out] p_dropped  因落後超過容量而丟失的樣本總數，匯總時取總和 (可為 NULL)
+ * @return pdPASS 查詢成功, pdFAIL 該事件類別沒有帶環形緩衝區的通道
+ */
+BaseType_t data_service_get_ring_stats(int subscriber, EventBits_t event_bit,
+                                       uint32_t *p_pending, uint32_t *p_dropped);
 
 
 /**
@@ -181,6 +587,8 @@ void data_service_update_joystick(const joystick_data_t *p_joystick_data);
  * @details
  * 允許需要等待特定事件的任務（如報警任務）獲取Event Group句柄，
  * 以便使用 xEventGroupWaitBits() 函數。
+ * @note 事件標誌組由所有等待者共享，用 pdTRUE 清除事件位會搶走其他等待者的通知；
+ *       新代碼請使用 data_service_subscribe() / data_service_wait()。
  * @return EventGroupHandle_t 事件標誌組的句柄，如果未初始化則返回NULL。
  */
 EventGroupHandle_t data_service_get_event_group_handle(void);
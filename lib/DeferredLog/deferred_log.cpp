@@ -0,0 +1,329 @@
+#include "deferred_log.h"
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "task_plan.h"
+#include "uart_parser.h"
+#include <string.h>
+#include <stdio.h>
+
+static const char* TAG = "DLOG";
+
+#if (DLOG_RING_SIZE & (DLOG_RING_SIZE - 1)) != 0
+#error "DLOG_RING_SIZE must be a power of two"
+#endif
+
+// 环形缓冲区条目 (32 字节)
+// seq 表示条目状态 (有界 MPMC 队列的序号法)：
+//   seq == pos      空闲，可由写入位置为 pos 的生产者占用
+//   seq == pos + 1  已写入，等待消费者读取
+// 消费者读取后置为 pos + DLOG_RING_SIZE，供下一圈的生产者使用
+typedef struct {
+    volatile uint32_t seq;
+    const dlog_format_t* format;
+    uint32_t timestamp_us;
+    uint32_t args[DLOG_MAX_ARGS];
+} dlog_entry_t;
+
+static dlog_entry_t s_ring[DLOG_RING_SIZE];
+static uint32_t s_head = 0;             // 下一个写入位置 (生产者原子递增)
+static uint32_t s_tail = 0;             // 下一个读取位置 (只有格式化任务访问)
+static volatile bool s_ready = false;
+static TaskHandle_t s_task = NULL;
+
+static uint32_t s_written = 0;
+static uint32_t s_dropped = 0;
+static uint32_t s_printed = 0;
+static uint32_t s_max_pending = 0;
+
+volatile uint8_t dlog_levels[DLOG_MODULE_COUNT] = {
+    DLOG_DEFAULT_LEVEL, DLOG_DEFAULT_LEVEL, DLOG_DEFAULT_LEVEL,
+    DLOG_DEFAULT_LEVEL, DLOG_DEFAULT_LEVEL, DLOG_DEFAULT_LEVEL,
+};
+
+static const char* const module_names[DLOG_MODULE_COUNT] = {
+    "main", "encoder", "joystick", "keypad", "publisher", "network",
+};
+
+// 输出时使用的日志标签 (与原来 ESP_LOGx 的 TAG 一致)
+static const char* const module_tags[DLOG_MODULE_COUNT] = {
+    "MAIN", "ENCODER", "JOYSTICK", "KEYPAD", "PUBLISHER", "NETWORK_TASK",
+};
+
+static const char* const level_names[] = {"none", "error", "warn", "info", "debug", "verbose"};
+static const char level_letters[] = {'N', 'E', 'W', 'I', 'D', 'V'};
+#define LEVEL_COUNT ((int)(sizeof(level_names) / sizeof(level_names[0])))
+
+/* -------------------- 写入 (任意任务) -------------------- */
+
+void dlog_write(const dlog_format_t* format, const uint32_t* args, size_t arg_count) {
+    if (!s_ready) {
+        return;
+    }
+    if (arg_count > DLOG_MAX_ARGS) {
+        arg_count = DLOG_MAX_ARGS;
+    }
+
+    // 占用一个空闲条目：只有 CAS 推进 s_head 成功的生产者写入该条目
+    uint32_t pos = __atomic_load_n(&s_head, __ATOMIC_RELAXED);
+    dlog_entry_t* entry;
+    while (true) {
+        entry = &s_ring[pos & (DLOG_RING_SIZE - 1)];
+        int32_t diff = (int32_t)(__atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&s_head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // 缓冲区满 (格式化任务落后一整圈)
+            __atomic_fetch_add(&s_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        } else {
+            pos = __atomic_load_n(&s_head, __ATOMIC_RELAXED);
+        }
+    }
+
+    entry->format = format;
+    entry->timestamp_us = (uint32_t)esp_timer_get_time();
+    for (size_t i = 0; i < arg_count; i++) {
+        entry->args[i] = args[i];
+    }
+    __atomic_store_n(&entry->seq, pos + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&s_written, 1, __ATOMIC_RELAXED);
+}
+
+/* -------------------- 格式化 (DLog 任务) -------------------- */
+
+static float bits_to_float(uint32_t bits) {
+    union { uint32_t u; float f; } value;
+    value.u = bits;
+    return value.f;
+}
+
+// 按格式串逐个转换说明格式化，每个参数按其转换字符解释 32 位原始值
+// 长度修饰 (h/l/z...) 在 32 位目标上不改变参数宽度，去掉后按转换字符重新加上
+static void format_entry(const dlog_entry_t* entry, char* out, size_t size) {
+    const char* p = entry->format->format;
+    size_t len = 0;
+    size_t arg = 0;
+
+    while (*p != '\0' && len + 1 < size) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // 转换说明：'%' + 标志/宽度/精度 + 长度修饰 (丢弃) + 转换字符
+        char spec[16];
+        size_t spec_len = 0;
+        spec[spec_len++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.hlzjtL", *p) != NULL) {
+            if (strchr("hlzjtL", *p) == NULL && spec_len < sizeof(spec) - 3) {
+                spec[spec_len++] = *p;
+            }
+            p++;
+        }
+        char conversion = *p;
+        if (conversion == '\0') {
+            break;
+        }
+        p++;
+
+        uint32_t value = arg < DLOG_MAX_ARGS ? entry->args[arg] : 0;
+        arg++;
+
+        int written;
+        switch (conversion) {
+            case 'd': case 'i':
+                spec[spec_len++] = 'l';
+                spec[spec_len++] = 'd';
+                spec[spec_len] = '\0';
+                written = snprintf(out + len, size - len, spec, (long)(int32_t)value);
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                spec[spec_len++] = 'l';
+                spec[spec_len++] = conversion;
+                spec[spec_len] = '\0';
+                written = snprintf(out + len, size - len, spec, (unsigned long)value);
+                break;
+            case 'c':
+                spec[spec_len++] = 'c';
+                spec[spec_len] = '\0';
+                written = snprintf(out + len, size - len, spec, (int)value);
+                break;
+            case 's':
+                spec[spec_len++] = 's';
+                spec[spec_len] = '\0';
+                written = snprintf(out + len, size - len, spec, value != 0 ? (const char*)(uintptr_t)value : "(null)");
+                break;
+            case 'p':
+                written = snprintf(out + len, size - len, "%p", (void*)(uintptr_t)value);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+                spec[spec_len++] = conversion;
+                spec[spec_len] = '\0';
+                written = snprintf(out + len, size - len, spec, (double)bits_to_float(value));
+                break;
+            default:
+                // 不支持的转换 (例如 64 位整数) 原样输出
+                written = snprintf(out + len, size - len, "%%%c", conversion);
+                break;
+        }
+        if (written < 0) {
+            break;
+        }
+        len += (size_t)written;
+        if (len >= size) {
+            len = size - 1;
+        }
+    }
+    out[len] = '\0';
+}
+
+// 取出并输出一个条目，没有已写入的条目时返回 false
+static bool print_next(void) {
+    dlog_entry_t* entry = &s_ring[s_tail & (DLOG_RING_SIZE - 1)];
+    if (__atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE) != s_tail + 1) {
+        return false;
+    }
+
+    char line[DLOG_LINE_MAX];
+    format_entry(entry, line, sizeof(line));
+    const dlog_format_t* format = entry->format;
+    uint32_t timestamp_ms = entry->timestamp_us / 1000;
+    // 参数已复制到 line 中，立即释放条目
+    __atomic_store_n(&entry->seq, s_tail + DLOG_RING_SIZE, __ATOMIC_RELEASE);
+    s_tail++;
+
+    uint8_t level = format->level < LEVEL_COUNT ? format->level : ESP_LOG_INFO;
+    const char* tag = format->module < DLOG_MODULE_COUNT ? module_tags[format->module] : TAG;
+    esp_log_write((esp_log_level_t)level, tag, "%c (%lu) %s: %s\n", level_letters[level],
+                  (unsigned long)timestamp_ms, tag, line);
+    s_printed++;
+    return true;
+}
+
+static void dlog_task(void* parameter) {
+    uint32_t reported_dropped = 0;
+
+    while (1) {
+        uint32_t pending = __atomic_load_n(&s_head, __ATOMIC_RELAXED) - s_tail;
+        if (pending > s_max_pending) {
+            s_max_pending = pending;
+        }
+        while (print_next()) {
+        }
+
+        uint32_t dropped = __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+        if (dropped != reported_dropped) {
+            ESP_LOGW(TAG, "%lu log messages dropped (ring full)", (unsigned long)(dropped - reported_dropped));
+            reported_dropped = dropped;
+        }
+        vTaskDelay(pdMS_TO_TICKS(DLOG_POLL_MS));
+    }
+}
+
+esp_err_t dlog_init(void) {
+    if (s_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (uint32_t i = 0; i < DLOG_RING_SIZE; i++) {
+        s_ring[i].seq = i;
+    }
+    s_head = 0;
+    s_tail = 0;
+
+    if (task_plan_create(dlog_task, DLOG_TASK_NAME, 3072, NULL, tskIDLE_PRIORITY + 1,
+                         &s_task, TASK_PLAN_CORE_NETWORK) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create log task");
+        return ESP_ERR_NO_MEM;
+    }
+    s_ready = true;
+    return ESP_OK;
+}
+
+esp_err_t dlog_set_level(dlog_module_t module, esp_log_level_t level) {
+    if ((int)module < 0 || module >= DLOG_MODULE_COUNT || (int)level < 0 || (int)level >= LEVEL_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    dlog_levels[module] = (uint8_t)level;
+    return ESP_OK;
+}
+
+void dlog_get_stats(dlog_stats_t* stats) {
+    stats->written = __atomic_load_n(&s_written, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&s_dropped, __ATOMIC_RELAXED);
+    stats->printed = s_printed;
+    stats->max_pending = s_max_pending;
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+static int find_level(const char* name) {
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        if (strcmp(name, level_names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void print_status(void) {
+    char response[128];
+    dlog_stats_t stats;
+    dlog_get_stats(&stats);
+
+    snprintf(response, sizeof(response), "Deferred log: %lu written, %lu dropped, %lu printed, max %lu/%d pending\r\n",
+             (unsigned long)stats.written, (unsigned long)stats.dropped, (unsigned long)stats.printed,
+             (unsigned long)stats.max_pending, DLOG_RING_SIZE);
+    uart_parser_put_string(response);
+    for (int i = 0; i < DLOG_MODULE_COUNT; i++) {
+        uint8_t level = dlog_levels[i];
+        snprintf(response, sizeof(response), "  %-10s %s%s\r\n", module_names[i], level_names[level],
+                 level > DLOG_MAX_LEVEL ? " (compiled out)" : "");
+        uart_parser_put_string(response);
+    }
+}
+
+static void handle_log(int argc, char *argv[]) {
+    if (argc < 2) {
+        print_status();
+        return;
+    }
+    if (argc == 3) {
+        int level = find_level(argv[2]);
+        if (level < 0) {
+            uart_parser_put_string("Levels: none error warn info debug verbose\r\n");
+            return;
+        }
+        bool found = false;
+        for (int i = 0; i < DLOG_MODULE_COUNT; i++) {
+            if (strcmp(argv[1], "all") == 0 || strcmp(argv[1], module_names[i]) == 0) {
+                dlog_set_level((dlog_module_t)i, (esp_log_level_t)level);
+                found = true;
+            }
+        }
+        if (found) {
+            char response[64];
+            snprintf(response, sizeof(response), "Log level %s = %s\r\n", argv[1], level_names[level]);
+            uart_parser_put_string(response);
+            return;
+        }
+    }
+    uart_parser_put_string("Usage: log [<module>|all <none|error|warn|info|debug|verbose>]\r\n"
+                           "Modules: main encoder joystick keypad publisher network\r\n");
+}
+
+static const command_t dlog_commands[] = {
+    {"log", handle_log, "log [<module>|all <level>]: 查看延迟日志统计，设置各模块的运行时日志级别。"},
+};
+
+void dlog_register_commands(void) {
+    uart_parser_register_commands(dlog_commands, sizeof(dlog_commands) / sizeof(dlog_commands[0]));
+}
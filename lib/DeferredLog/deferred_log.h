@@ -0,0 +1,179 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 环形缓冲区条目数 (2 的幂，每条 32 字节)
+ * @details 缓冲区满时新的日志被丢弃并计数，不阻塞调用方
+ */
+#ifndef DLOG_RING_SIZE
+#define DLOG_RING_SIZE          64
+#endif
+
+/**
+ * @brief 每条日志最多携带的参数个数 (每个参数 32 位)
+ */
+#define DLOG_MAX_ARGS           5
+
+/**
+ * @brief 编译期保留的最高级别 (数值同 esp_log_level_t，0 = 全部去掉)，高于此级别的 DLOG() 不产生任何代码
+ */
+#ifndef DLOG_MAX_LEVEL
+#define DLOG_MAX_LEVEL          5
+#endif
+
+/**
+ * @brief 上电时各模块的运行时级别 (数值同 esp_log_level_t)，可用 'log' 命令修改
+ */
+#ifndef DLOG_DEFAULT_LEVEL
+#define DLOG_DEFAULT_LEVEL      3
+#endif
+
+/**
+ * @brief 格式化任务的轮询周期 (毫秒)
+ */
+#ifndef DLOG_POLL_MS
+#define DLOG_POLL_MS            20
+#endif
+
+/**
+ * @brief 格式化后单行的最大长度 (超出部分截断)
+ */
+#define DLOG_LINE_MAX           160
+
+/**
+ * @brief 格式化任务名 (核心/优先级/栈大小见 src/main.cpp 中的任务规划表)
+ */
+#define DLOG_TASK_NAME          "DLog"
+
+// 日志模块 (各自独立的运行时级别)
+typedef enum {
+    DLOG_MODULE_MAIN = 0,
+    DLOG_MODULE_ENCODER,
+    DLOG_MODULE_JOYSTICK,
+    DLOG_MODULE_KEYPAD,
+    DLOG_MODULE_PUBLISHER,
+    DLOG_MODULE_NETWORK,
+    DLOG_MODULE_COUNT
+} dlog_module_t;
+
+// 格式描述 (每个调用点一个，放在 flash 中；指针即格式 ID)
+typedef struct {
+    const char* format;     // printf 格式，参数均为 32 位：%d %u %x %c %p %f，%s 只能是字符串常量
+    uint8_t module;         // dlog_module_t
+    uint8_t level;          // esp_log_level_t
+} dlog_format_t;
+
+// 日志统计
+typedef struct {
+    uint32_t written;       // 写入环形缓冲区的条数
+    uint32_t dropped;       // 缓冲区满而丢弃的条数
+    uint32_t printed;       // 已格式化输出的条数
+    uint32_t max_pending;   // 缓冲区中同时等待格式化的最大条数
+} dlog_stats_t;
+
+/**
+ * @brief 各模块当前的运行时级别 (DLOG() 内联检查，不要直接修改，用 dlog_set_level())
+ */
+extern volatile uint8_t dlog_levels[DLOG_MODULE_COUNT];
+
+/**
+ * @brief 初始化环形缓冲区并创建格式化任务
+ * @details 调用前的 DLOG() 被丢弃。格式化任务每 DLOG_POLL_MS 取出全部条目，
+ *          按格式描述和原始参数格式化后经 esp_log_write() 输出。
+ * @return ESP_OK 成功；ESP_ERR_INVALID_STATE 已初始化；ESP_ERR_NO_MEM 创建任务失败
+ */
+esp_err_t dlog_init(void);
+
+/**
+ * @brief 写入一条日志 (一般通过 DLOG() 调用)
+ * @details 无锁多生产者环形缓冲区：任意任务都可以调用，不格式化、不阻塞、不分配内存。
+ *          缓冲区满时丢弃并计数。
+ */
+void dlog_write(const dlog_format_t* format, const uint32_t* args, size_t arg_count);
+
+/**
+ * @brief 设置模块的运行时级别
+ * @return ESP_OK 成功；ESP_ERR_INVALID_ARG 模块或级别无效
+ */
+esp_err_t dlog_set_level(dlog_module_t module, esp_log_level_t level);
+
+/**
+ * @brief 获取日志统计
+ */
+void dlog_get_stats(dlog_stats_t* stats);
+
+/**
+ * @brief 注册 'log' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void dlog_register_commands(void);
+
+static inline uint32_t dlog_float_bits(float value) {
+    union { float f; uint32_t u; } bits;
+    bits.f = value;
+    return bits.u;
+}
+
+#ifdef __cplusplus
+}
+
+// 参数转换为 32 位原始值：整数/枚举/指针按位保留，浮点数以 float 位模式保存 (格式化时按 %f 还原)
+// (src/main.cpp 在 extern "C" 块中包含本头文件，重载和模板需要显式 C++ 链接)
+extern "C++" {
+template <typename T>
+static inline uint32_t dlog_arg(T value) { return (uint32_t)(uintptr_t)value; }
+static inline uint32_t dlog_arg(float value) { return dlog_float_bits(value); }
+static inline uint32_t dlog_arg(double value) { return dlog_float_bits((float)value); }
+}
+#else
+static inline uint32_t dlog_arg_pointer(const void* value) { return (uint32_t)(uintptr_t)value; }
+static inline uint32_t dlog_arg_integer(uint32_t value) { return value; }
+#define dlog_arg(value) _Generic((value), \
+    float: dlog_float_bits, double: dlog_float_bits, \
+    char*: dlog_arg_pointer, const char*: dlog_arg_pointer, void*: dlog_arg_pointer, const void*: dlog_arg_pointer, \
+    default: dlog_arg_integer)(value)
+#endif
+
+// 参数个数 (0 ~ DLOG_MAX_ARGS) 与逐个转换
+#define DLOG_NARG_(...)     DLOG_NARG_N_(0, ##__VA_ARGS__, 5, 4, 3, 2, 1, 0)
+#define DLOG_NARG_N_(_0, _1, _2, _3, _4, _5, N, ...) N
+#define DLOG_CAT_(a, b)     DLOG_CAT2_(a, b)
+#define DLOG_CAT2_(a, b)    a##b
+#define DLOG_MAP_0()
+#define DLOG_MAP_1(a)                   dlog_arg(a)
+#define DLOG_MAP_2(a, b)                dlog_arg(a), dlog_arg(b)
+#define DLOG_MAP_3(a, b, c)             dlog_arg(a), dlog_arg(b), dlog_arg(c)
+#define DLOG_MAP_4(a, b, c, d)          dlog_arg(a), dlog_arg(b), dlog_arg(c), dlog_arg(d)
+#define DLOG_MAP_5(a, b, c, d, e)       dlog_arg(a), dlog_arg(b), dlog_arg(c), dlog_arg(d), dlog_arg(e)
+
+/**
+ * @brief 延迟格式化的日志
+ * @details 调用方只检查级别并把格式描述指针和原始参数写入环形缓冲区，格式化在低优先级的 DLog 任务中进行。
+ *          用法与 ESP_LOGx 相同，最多 DLOG_MAX_ARGS 个参数，不支持 64 位参数；
+ *          %s 参数保存的是指针，只能传字符串常量 (格式化时可能已经离开调用方的作用域)。
+ *          例：DLOG(DLOG_MODULE_ENCODER, ESP_LOG_DEBUG, "Position: %ld, Delta: %ld", position, delta);
+ */
+#define DLOG(module, level, format, ...) do { \
+    if ((level) <= DLOG_MAX_LEVEL && (level) <= dlog_levels[module]) { \
+        static const dlog_format_t dlog_format_ = {format, (uint8_t)(module), (uint8_t)(level)}; \
+        const uint32_t dlog_args_[] = {0, DLOG_CAT_(DLOG_MAP_, DLOG_NARG_(__VA_ARGS__))(__VA_ARGS__)}; \
+        dlog_write(&dlog_format_, dlog_args_ + 1, DLOG_NARG_(__VA_ARGS__)); \
+    } \
+} while (0)
+
+#define DLOGE(module, format, ...)  DLOG(module, ESP_LOG_ERROR, format, ##__VA_ARGS__)
+#define DLOGW(module, format, ...)  DLOG(module, ESP_LOG_WARN, format, ##__VA_ARGS__)
+#define DLOGI(module, format, ...)  DLOG(module, ESP_LOG_INFO, format, ##__VA_ARGS__)
+#define DLOGD(module, format, ...)  DLOG(module, ESP_LOG_DEBUG, format, ##__VA_ARGS__)
+#define DLOGV(module, format, ...)  DLOG(module, ESP_LOG_VERBOSE, format, ##__VA_ARGS__)
+
+#endif // DEFERRED_LOG_H
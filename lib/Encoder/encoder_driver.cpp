@@ -1,5 +1,10 @@
 #include "encoder_driver.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "freertos/queue.h"
+#include "deferred_log.h"
+#include "hal_io.h"
 
 static const char* TAG = "ENCODER";
 
@@ -8,12 +13,30 @@ static ESP32Encoder esp32_encoder;
 static encoder_config_t encoder_config;
 static encoder_callback_t position_callback = nullptr;
 static encoder_button_callback_t button_callback = nullptr;
+static data_channel_t data_channel = DATA_CHANNEL_ENCODER_0;
 
 static int32_t last_position = 0;
-static bool last_button_state = false;
-static unsigned long last_button_time = 0;
-static const unsigned long DEBOUNCE_DELAY = 80; // 增加防抖延时至80ms
-static bool button_initialized = false;  // 添加初始化标志
+
+// 按钮边沿事件 (由GPIO中断产生)
+typedef struct {
+    uint8_t level;           // 边沿之后的引脚电平
+    int64_t time_us;         // esp_timer 时间戳，用于去抖
+    TickType_t tick;         // FreeRTOS tick，用于上报 DataPlatform
+} button_edge_t;
+
+// 按钮去抖状态机：边沿事件只记录原始电平，电平稳定 ENCODER_BUTTON_STABLE_US 后才确认
+static QueueHandle_t button_edge_queue = NULL;
+static bool button_stable_state = false;     // 已确认的按钮状态 (true = 按下)
+static bool button_raw_state = false;        // 最近一次边沿后的原始状态
+static bool button_settling = false;         // 是否处于等待电平稳定阶段
+static int64_t button_settle_start_us = 0;   // 最近一次边沿的时间
+static TickType_t button_edge_tick = 0;      // 本次动作第一个边沿的 tick
+static int64_t button_edge_us = 0;           // 本次动作第一个边沿的时间 (延迟统计的采样时刻)
+
+// 内部函数声明
+static bool read_button_level(void);
+static void button_edge_isr(void* arg);
+static bool button_debounce_update(void);
 
 // 编码器初始化
 esp_err_t encoder_init(const encoder_config_t* config) {
@@ -34,9 +57,19 @@ esp_err_t encoder_init(const encoder_config_t* config) {
     if (config->pin_button != 255) {
         pinMode(config->pin_button, config->use_pullup ? INPUT_PULLUP : INPUT);
         
-        // 初始化按钮状态 - 额外添加初始化步骤
-        button_initialized = false;
-        vTaskDelay(pdMS_TO_TICKS(10)); // 给引脚状态稳定一些时间
+        if (button_edge_queue == NULL) {
+            button_edge_queue = xQueueCreate(ENCODER_BUTTON_EVENT_QUEUE_LEN, sizeof(button_edge_t));
+            if (button_edge_queue == NULL) {
+                ESP_LOGE(TAG, "Failed to create button event queue");
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        
+        // 以当前电平作为初始状态，之后的变化全部由中断捕获
+        button_stable_state = read_button_level();
+        button_raw_state = button_stable_state;
+        button_settling = false;
+        attachInterruptArg(config->pin_button, button_edge_isr, NULL, CHANGE);
     }
 
     ESP_LOGI(TAG, "Encoder initialized: PIN_A=%d, PIN_B=%d, BUTTON=%d", 
@@ -47,8 +80,11 @@ esp_err_t encoder_init(const encoder_config_t* config) {
 
 // 获取编码器位置
 int32_t encoder_get_position(void) {
-    // ESP32Encoder 计数需要根据 steps_per_notch 进行调整
-    int32_t raw_count = esp32_encoder.getCount();
+    // ESP32Encoder 计数需要根据 steps_per_notch 进行调整 (硬件在环测试时计数来自模拟值)
+    int32_t raw_count;
+    if (!hal_encoder_sim_read(&raw_count)) {
+        raw_count = (int32_t)esp32_encoder.getCount();
+    }
     return raw_count / encoder_config.steps_per_notch;
 }
 
@@ -58,6 +94,52 @@ void encoder_reset_position(void) {
     last_position = 0;
 }
 
+// 读取按钮当前电平 (true = 按下)
+static bool IRAM_ATTR read_button_level(void) {
+    bool level = gpio_get_level((gpio_num_t)encoder_config.pin_button);
+    return encoder_config.use_pullup ? !level : level; // 上拉时逻辑反转
+}
+
+// 按钮GPIO中断：只记录电平和时间戳，去抖在任务上下文中完成
+static void IRAM_ATTR button_edge_isr(void* arg) {
+    button_edge_t edge = {
+        .level = read_button_level(),
+        .time_us = esp_timer_get_time(),
+        .tick = xTaskGetTickCountFromISR(),
+    };
+    BaseType_t higher_priority_woken = pdFALSE;
+    xQueueSendFromISR(button_edge_queue, &edge, &higher_priority_woken);
+    if (higher_priority_woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// 处理按钮边沿事件，返回 true 表示确认了一次状态变化
+static bool button_debounce_update(void) {
+    button_edge_t edge;
+    while (xQueueReceive(button_edge_queue, &edge, 0) == pdTRUE) {
+        if (!button_settling) {
+            button_edge_tick = edge.tick;  // 抖动期间的后续边沿不改变动作时刻
+            button_edge_us = edge.time_us;
+        }
+        button_raw_state = edge.level;
+        button_settle_start_us = edge.time_us;
+        button_settling = true;
+    }
+    
+    // 队列溢出时边沿可能丢失，稳定后以实际电平为准
+    if (button_settling &&
+        esp_timer_get_time() - button_settle_start_us >= ENCODER_BUTTON_STABLE_US) {
+        button_settling = false;
+        button_raw_state = read_button_level();
+        if (button_raw_state != button_stable_state) {
+            button_stable_state = button_raw_state;
+            return true;
+        }
+    }
+    return false;
+}
+
 // 设置编码器回调函数
 void encoder_set_callback(encoder_callback_t callback) {
     position_callback = callback;
@@ -67,27 +149,40 @@ void encoder_set_button_callback(encoder_button_callback_t callback) {
     button_callback = callback;
 }
 
+// 设置写入的 DataPlatform 通道
+esp_err_t encoder_set_channel(data_channel_t channel) {
+    const data_channel_info_t* info = data_channel_get_info(channel);
+    if (info == NULL || info->kind != DATA_KIND_ENCODER) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    data_channel = channel;
+    return ESP_OK;
+}
+
 // 编码器处理函数
 void encoder_handler(void) {
     // ESP32Encoder 不需要像 RotaryEncoder 那样调用 tick()
     // 它使用中断自动处理编码器信号
     
     // 检查位置变化
+    uint32_t sample_us = (uint32_t)esp_timer_get_time();
     int32_t current_position = encoder_get_position();
     if (current_position != last_position) {
         int32_t delta = current_position - last_position;
         last_position = current_position;
         
-        ESP_LOGD(TAG, "Position: %ld, Delta: %ld", current_position, delta);
+        DLOGD(DLOG_MODULE_ENCODER, "Position: %ld, Delta: %ld", current_position, delta);
         
         // 更新到DataPlatform
         encoder_data_t encoder_data = {
             .position = current_position,
             .delta = delta,
             .button_pressed = encoder_get_button_state(),
-            .timestamp = xTaskGetTickCount()
+            .timestamp = xTaskGetTickCount(),
+            .sample_us = sample_us,
+            .publish_us = (uint32_t)esp_timer_get_time(),
         };
-        data_service_update_encoder(&encoder_data);
+        data_channel_write(data_channel, &encoder_data, sizeof(encoder_data));
         
         // 调用回调函数（保持兼容性）
         if (position_callback) {
@@ -95,81 +190,32 @@ void encoder_handler(void) {
         }
     }
 
-    // 检查按钮状态（如果配置了按钮）
-    if (encoder_config.pin_button != 255) {
-        bool current_button_state = digitalRead(encoder_config.pin_button);
-        if (encoder_config.use_pullup) {
-            current_button_state = !current_button_state; // 上拉时逻辑反转
-        }
-        
-        unsigned long current_time = millis();
+    // 检查按钮状态（如果配置了按钮），不阻塞
+    if (encoder_config.pin_button != 255 && button_debounce_update()) {
+        DLOGD(DLOG_MODULE_ENCODER, "Button state: %s", button_stable_state ? "PRESSED" : "RELEASED");
         
-        // 首次初始化按钮状态
-        if (!button_initialized) {
-            if (current_time > 1000) {  // 系统启动1秒后再初始化按钮
-                last_button_state = current_button_state; // 不触发回调，只记录初始状态
-                last_button_time = current_time;
-                button_initialized = true;
-                ESP_LOGI(TAG, "Button initialized, initial state: %s", 
-                         current_button_state ? "PRESSED" : "RELEASED");
-            }
-            return;  // 初始化阶段不处理按钮事件
+        // 调用按钮回调函数
+        if (button_callback) {
+            button_callback(button_stable_state);
         }
         
-        // 状态变化检测和防抖处理
-        if (current_button_state != last_button_state && 
-            (current_time - last_button_time) > DEBOUNCE_DELAY) {
-            
-            // 再次检查状态，确保不是瞬态干扰
-            vTaskDelay(pdMS_TO_TICKS(5));  // 短暂延时
-            bool verify_state = digitalRead(encoder_config.pin_button);
-            if (encoder_config.use_pullup) {
-                verify_state = !verify_state;
-            }
-            
-            // 如果状态一致，才认为是真实的按钮事件
-            if (verify_state == current_button_state) {
-                last_button_state = current_button_state;
-                last_button_time = current_time;
-                
-                ESP_LOGD(TAG, "Button state: %s", current_button_state ? "PRESSED" : "RELEASED");
-                
-                // 调用按钮回调函数
-                if (button_callback) {
-                    button_callback(current_button_state);
-                }
-                
-                // 更新到DataPlatform
-                encoder_data_t encoder_data = {
-                    .position = encoder_get_position(),
-                    .delta = 0,  // 按钮事件不涉及位置变化
-                    .button_pressed = current_button_state,
-                    .timestamp = xTaskGetTickCount()
-                };
-                data_service_update_encoder(&encoder_data);
-            }
-        }
+        // 更新到DataPlatform，时间戳取按钮实际动作的边沿时刻
+        encoder_data_t encoder_data = {
+            .position = current_position,
+            .delta = 0,  // 按钮事件不涉及位置变化
+            .button_pressed = button_stable_state,
+            .timestamp = button_edge_tick,
+            .sample_us = (uint32_t)button_edge_us,   // 包含去抖等待时间
+            .publish_us = (uint32_t)esp_timer_get_time(),
+        };
+        data_channel_write(data_channel, &encoder_data, sizeof(encoder_data));
     }
 }
 
-// 获取编码器按钮状态
+// 获取编码器按钮状态 (已去抖的状态，不阻塞)
 bool encoder_get_button_state(void) {
-    if (encoder_config.pin_button == 255 || !button_initialized) {
-        return false;  // 如果按钮未配置或未初始化，返回false
+    if (encoder_config.pin_button == 255) {
+        return false;  // 如果按钮未配置，返回false
     }
-    
-    // 读取按钮状态 - 使用多次采样提高可靠性
-    int samples = 0;
-    for (int i = 0; i < 3; i++) {
-        bool state = digitalRead(encoder_config.pin_button);
-        if (encoder_config.use_pullup) {
-            state = !state; // 上拉时逻辑反转
-        }
-        
-        if (state) samples++;
-        if (i < 2) vTaskDelay(pdMS_TO_TICKS(1));  // 每次采样间隔1ms
-    }
-    
-    // 多数投票法确定最终状态
-    return (samples >= 2);  // 至少2个样本为高电平，认为按钮被按下
+    return button_stable_state;
 }
@@ -9,6 +9,14 @@
 extern "C" {
 #endif
 
+// 按钮电平需保持稳定的时间，超过后才确认按下/释放 (微秒)
+#ifndef ENCODER_BUTTON_STABLE_US
+#define ENCODER_BUTTON_STABLE_US        20000
+#endif
+
+// 按钮边沿事件队列深度
+#define ENCODER_BUTTON_EVENT_QUEUE_LEN  16
+
 // 编码器配置结构体
 typedef struct {
     uint8_t pin_a;           // 编码器A相引脚
@@ -35,10 +43,13 @@ void encoder_reset_position(void);
 void encoder_set_callback(encoder_callback_t callback);
 void encoder_set_button_callback(encoder_button_callback_t callback);
 
+// 设置写入的 DataPlatform 通道 (默认 DATA_CHANNEL_ENCODER_0)，通道类别必须是 DATA_KIND_ENCODER
+esp_err_t encoder_set_channel(data_channel_t channel);
+
 // 编码器处理函数（需要在任务中调用）
 void encoder_handler(void);
 
-// 获取编码器按钮状态
+// 获取编码器按钮状态 (已去抖，不阻塞)
 bool encoder_get_button_state(void);
 
 #ifdef __cplusplus
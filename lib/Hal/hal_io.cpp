@@ -0,0 +1,295 @@
+#include "hal_io.h"
+#include "uart_parser.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "HAL";
+
+#define HAL_ADC_MAX     4095
+
+volatile uint64_t hal_sim_gpio_mask = 0;
+volatile uint64_t hal_sim_adc_mask = 0;
+volatile uint64_t hal_output_levels = 0;
+volatile bool hal_sim_encoder_enabled = false;
+
+// 模拟值 (只在对应的模拟位为 1 时有效)
+static uint64_t s_forced_gpio_mask = 0;         // hal_sim_set_gpio() 设置的引脚
+static uint64_t s_gpio_levels = 0;
+static uint16_t s_adc_values[HAL_GPIO_COUNT];
+static volatile int32_t s_encoder_count = 0;
+
+// 模拟按键：行引脚与列引脚接通
+typedef struct {
+    uint8_t row_pin;
+    uint8_t col_pin;
+} hal_sim_key_t;
+
+static hal_sim_key_t s_keys[HAL_SIM_MAX_KEYS];
+static volatile uint8_t s_key_count = 0;
+
+static portMUX_TYPE s_sim_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* -------------------- 驱动侧读取 -------------------- */
+
+int hal_sim_gpio_level(uint8_t pin) {
+    // 按键按下时列引脚跟随行引脚：扫描拉低该行时读到低电平
+    uint8_t key_count = s_key_count;
+    for (uint8_t i = 0; i < key_count; i++) {
+        if (s_keys[i].col_pin == pin && !((hal_output_levels >> s_keys[i].row_pin) & 1)) {
+            return LOW;
+        }
+    }
+    if ((s_forced_gpio_mask >> pin) & 1) {
+        return (int)((s_gpio_levels >> pin) & 1);
+    }
+    return HIGH;    // 只有模拟按键的列引脚：松开时为上拉电平
+}
+
+uint16_t hal_sim_adc_value(uint8_t pin) {
+    return s_adc_values[pin];
+}
+
+int32_t hal_sim_encoder_value(void) {
+    return s_encoder_count;
+}
+
+/* -------------------- 模拟控制 -------------------- */
+
+// 在锁内重新计算数字输入模拟位
+static void update_gpio_mask(void) {
+    uint64_t mask = s_forced_gpio_mask;
+    for (uint8_t i = 0; i < s_key_count; i++) {
+        mask |= 1ULL << s_keys[i].col_pin;
+    }
+    hal_sim_gpio_mask = mask;
+}
+
+esp_err_t hal_sim_set_gpio(uint8_t pin, int level) {
+    if (pin >= HAL_GPIO_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint64_t bit = 1ULL << pin;
+    taskENTER_CRITICAL(&s_sim_mux);
+    if (level < 0) {
+        s_forced_gpio_mask &= ~bit;
+    } else {
+        s_gpio_levels = level ? (s_gpio_levels | bit) : (s_gpio_levels & ~bit);
+        s_forced_gpio_mask |= bit;
+    }
+    update_gpio_mask();
+    taskEXIT_CRITICAL(&s_sim_mux);
+    return ESP_OK;
+}
+
+esp_err_t hal_sim_set_adc(uint8_t pin, int32_t value) {
+    if (pin >= HAL_GPIO_COUNT || value > HAL_ADC_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    uint64_t bit = 1ULL << pin;
+    taskENTER_CRITICAL(&s_sim_mux);
+    if (value < 0) {
+        hal_sim_adc_mask &= ~bit;
+    } else {
+        s_adc_values[pin] = (uint16_t)value;
+        hal_sim_adc_mask |= bit;
+    }
+    taskEXIT_CRITICAL(&s_sim_mux);
+    return ESP_OK;
+}
+
+void hal_sim_set_encoder(int32_t count) {
+    s_encoder_count = count;
+    hal_sim_encoder_enabled = true;
+}
+
+void hal_sim_clear_encoder(void) {
+    hal_sim_encoder_enabled = false;
+}
+
+esp_err_t hal_sim_set_key(uint8_t row_pin, uint8_t col_pin, bool pressed) {
+    if (row_pin >= HAL_GPIO_COUNT || col_pin >= HAL_GPIO_COUNT || row_pin == col_pin) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ESP_OK;
+    taskENTER_CRITICAL(&s_sim_mux);
+    int found = -1;
+    for (uint8_t i = 0; i < s_key_count; i++) {
+        if (s_keys[i].row_pin == row_pin && s_keys[i].col_pin == col_pin) {
+            found = i;
+            break;
+        }
+    }
+    if (pressed && found < 0) {
+        if (s_key_count < HAL_SIM_MAX_KEYS) {
+            s_keys[s_key_count].row_pin = row_pin;
+            s_keys[s_key_count].col_pin = col_pin;
+            s_key_count++;
+        } else {
+            ret = ESP_ERR_NO_MEM;
+        }
+    } else if (!pressed && found >= 0) {
+        s_keys[found] = s_keys[s_key_count - 1];
+        s_key_count--;
+    }
+    update_gpio_mask();
+    taskEXIT_CRITICAL(&s_sim_mux);
+    return ret;
+}
+
+void hal_sim_clear(void) {
+    taskENTER_CRITICAL(&s_sim_mux);
+    s_forced_gpio_mask = 0;
+    s_key_count = 0;
+    hal_sim_gpio_mask = 0;
+    hal_sim_adc_mask = 0;
+    hal_sim_encoder_enabled = false;
+    taskEXIT_CRITICAL(&s_sim_mux);
+}
+
+bool hal_sim_active(void) {
+    return hal_sim_gpio_mask != 0 || hal_sim_adc_mask != 0 || hal_sim_encoder_enabled;
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+static bool parse_int(const char* text, long min, long max, long* value) {
+    char* end;
+    long v = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || v < min || v > max) {
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+static void print_status(void) {
+    char response[96];
+
+    if (!hal_sim_active()) {
+        uart_parser_put_string("HAL: all inputs from hardware\r\n");
+        return;
+    }
+    uart_parser_put_string("HAL simulated inputs:\r\n");
+    for (uint8_t pin = 0; pin < HAL_GPIO_COUNT; pin++) {
+        if ((s_forced_gpio_mask >> pin) & 1) {
+            snprintf(response, sizeof(response), "  gpio %2u = %d\r\n", pin, (int)((s_gpio_levels >> pin) & 1));
+            uart_parser_put_string(response);
+        }
+        if ((hal_sim_adc_mask >> pin) & 1) {
+            snprintf(response, sizeof(response), "  adc  %2u = %u\r\n", pin, s_adc_values[pin]);
+            uart_parser_put_string(response);
+        }
+    }
+    for (uint8_t i = 0; i < s_key_count; i++) {
+        snprintf(response, sizeof(response), "  key  row %u - col %u pressed\r\n", s_keys[i].row_pin, s_keys[i].col_pin);
+        uart_parser_put_string(response);
+    }
+    if (hal_sim_encoder_enabled) {
+        snprintf(response, sizeof(response), "  encoder count = %ld\r\n", (long)s_encoder_count);
+        uart_parser_put_string(response);
+    }
+}
+
+static void print_usage(void) {
+    uart_parser_put_string("Usage: hal [off | sim gpio <pin> <0|1|off> | sim adc <pin> <value|off> [<pin> <value|off>]... |\r\n"
+                           "           sim encoder <count|off> | sim key <row_pin> <col_pin> <on|off>]\r\n");
+}
+
+static void handle_sim(int argc, char *argv[]) {
+    char response[64];
+    long pin, value;
+
+    if (argc == 5 && strcmp(argv[2], "gpio") == 0) {
+        if (!parse_int(argv[3], 0, HAL_GPIO_COUNT - 1, &pin) ||
+            (strcmp(argv[4], "off") != 0 && !parse_int(argv[4], 0, 1, &value))) {
+            print_usage();
+            return;
+        }
+        hal_sim_set_gpio((uint8_t)pin, strcmp(argv[4], "off") == 0 ? -1 : (int)value);
+        snprintf(response, sizeof(response), "gpio %ld = %s\r\n", pin, argv[4]);
+        uart_parser_put_string(response);
+        return;
+    }
+
+    // 一行可以设置多个 ADC 引脚 (摇杆两轴同时更新，回放时不会出现只更新了一轴的样本)
+    if (argc >= 5 && (argc - 3) % 2 == 0 && strcmp(argv[2], "adc") == 0) {
+        for (int i = 3; i < argc; i += 2) {
+            if (!parse_int(argv[i], 0, HAL_GPIO_COUNT - 1, &pin) ||
+                (strcmp(argv[i + 1], "off") != 0 && !parse_int(argv[i + 1], 0, HAL_ADC_MAX, &value))) {
+                print_usage();
+                return;
+            }
+        }
+        for (int i = 3; i < argc; i += 2) {
+            parse_int(argv[i], 0, HAL_GPIO_COUNT - 1, &pin);
+            value = -1;
+            if (strcmp(argv[i + 1], "off") != 0) {
+                parse_int(argv[i + 1], 0, HAL_ADC_MAX, &value);
+            }
+            hal_sim_set_adc((uint8_t)pin, (int32_t)value);
+        }
+        uart_parser_put_string("ok\r\n");
+        return;
+    }
+
+    if (argc == 4 && strcmp(argv[2], "encoder") == 0) {
+        if (strcmp(argv[3], "off") == 0) {
+            hal_sim_clear_encoder();
+        } else if (parse_int(argv[3], -2147483647L, 2147483647L, &value)) {
+            hal_sim_set_encoder((int32_t)value);
+        } else {
+            print_usage();
+            return;
+        }
+        uart_parser_put_string("ok\r\n");
+        return;
+    }
+
+    if (argc == 6 && strcmp(argv[2], "key") == 0) {
+        long row, col;
+        bool on = strcmp(argv[5], "on") == 0;
+        if (!parse_int(argv[3], 0, HAL_GPIO_COUNT - 1, &row) || !parse_int(argv[4], 0, HAL_GPIO_COUNT - 1, &col) ||
+            (!on && strcmp(argv[5], "off") != 0)) {
+            print_usage();
+            return;
+        }
+        esp_err_t ret = hal_sim_set_key((uint8_t)row, (uint8_t)col, on);
+        if (ret == ESP_OK) {
+            snprintf(response, sizeof(response), "key %ld-%ld %s\r\n", row, col, on ? "pressed" : "released");
+        } else {
+            snprintf(response, sizeof(response), "key %ld-%ld: at most %d keys\r\n", row, col, HAL_SIM_MAX_KEYS);
+        }
+        uart_parser_put_string(response);
+        return;
+    }
+
+    print_usage();
+}
+
+static void handle_hal(int argc, char *argv[]) {
+    if (argc < 2) {
+        print_status();
+        return;
+    }
+    if (strcmp(argv[1], "off") == 0) {
+        hal_sim_clear();
+        ESP_LOGI(TAG, "Simulation cleared, inputs from hardware");
+        uart_parser_put_string("All inputs from hardware.\r\n");
+        return;
+    }
+    if (strcmp(argv[1], "sim") == 0) {
+        handle_sim(argc, argv);
+        return;
+    }
+    print_usage();
+}
+
+static const command_t hal_commands[] = {
+    {"hal", handle_hal, "hal [off | sim gpio|adc|encoder|key ...]: 用模拟值代替 GPIO/ADC/编码器输入 (硬件在环测试)。"},
+};
+
+void hal_register_commands(void) {
+    uart_parser_register_commands(hal_commands, sizeof(hal_commands) / sizeof(hal_commands[0]));
+}
@@ -0,0 +1,138 @@
+#ifndef HAL_IO_H
+#define HAL_IO_H
+
+#include "Arduino.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 可模拟的 GPIO 数量 (ESP32 GPIO0 ~ GPIO39)
+ */
+#define HAL_GPIO_COUNT          40
+
+/**
+ * @brief 同时模拟的按键 (行引脚与列引脚接通) 数量上限
+ */
+#define HAL_SIM_MAX_KEYS        4
+
+/**
+ * @brief 模拟状态 (由 hal_sim_* 修改，驱动经下面的内联函数检查，不要直接写)
+ * @details 对应位为 0 的引脚直接访问硬件，驱动的正常路径只多一次位测试。
+ */
+extern volatile uint64_t hal_sim_gpio_mask;     // 输入电平被模拟的引脚 (含模拟按键的列引脚)
+extern volatile uint64_t hal_sim_adc_mask;      // ADC 读数被模拟的引脚
+extern volatile uint64_t hal_output_levels;     // 经 hal_gpio_write() 输出的电平 (模拟按键用)
+extern volatile bool hal_sim_encoder_enabled;   // 编码器计数被模拟
+
+int hal_sim_gpio_level(uint8_t pin);
+uint16_t hal_sim_adc_value(uint8_t pin);
+int32_t hal_sim_encoder_value(void);
+
+/**
+ * @brief 读取数字输入 (代替 digitalRead)
+ */
+static inline int hal_gpio_read(uint8_t pin) {
+    if (pin < HAL_GPIO_COUNT && ((hal_sim_gpio_mask >> pin) & 1)) {
+        return hal_sim_gpio_level(pin);
+    }
+    return digitalRead(pin);
+}
+
+/**
+ * @brief 输出数字电平 (代替 digitalWrite)，同时记录电平供模拟按键使用
+ */
+static inline void hal_gpio_write(uint8_t pin, uint8_t level) {
+    digitalWrite(pin, level);
+    if (pin < HAL_GPIO_COUNT) {
+        uint64_t bit = 1ULL << pin;
+        hal_output_levels = level ? (hal_output_levels | bit) : (hal_output_levels & ~bit);
+    }
+}
+
+/**
+ * @brief 读取 ADC 原始值 (代替 analogRead)
+ */
+static inline uint16_t hal_adc_read(uint8_t pin) {
+    if (pin < HAL_GPIO_COUNT && ((hal_sim_adc_mask >> pin) & 1)) {
+        return hal_sim_adc_value(pin);
+    }
+    return (uint16_t)analogRead(pin);
+}
+
+/**
+ * @brief ADC 引脚是否被模拟 (DMA 等不经过 hal_adc_read() 的后端据此切换到模拟值)
+ */
+static inline bool hal_adc_is_simulated(uint8_t pin) {
+    return pin < HAL_GPIO_COUNT && ((hal_sim_adc_mask >> pin) & 1);
+}
+
+/**
+ * @brief 是否有数字输入被模拟 (依赖边沿中断唤醒的驱动据此改为轮询，模拟输入不产生中断)
+ */
+static inline bool hal_sim_gpio_any(void) {
+    return hal_sim_gpio_mask != 0;
+}
+
+/**
+ * @brief 编码器计数被模拟时取出模拟计数 (原始计数，未除以每刻度步数)
+ * @return true 已写入 count；false 使用硬件计数器
+ */
+static inline bool hal_encoder_sim_read(int32_t* count) {
+    if (!hal_sim_encoder_enabled) {
+        return false;
+    }
+    *count = hal_sim_encoder_value();
+    return true;
+}
+
+/**
+ * @brief 模拟数字输入电平
+ * @param level 0/1，负数表示取消模拟 (恢复读取硬件)
+ */
+esp_err_t hal_sim_set_gpio(uint8_t pin, int level);
+
+/**
+ * @brief 模拟 ADC 读数 (0 ~ 4095)
+ * @param value 负数表示取消模拟
+ */
+esp_err_t hal_sim_set_adc(uint8_t pin, int32_t value);
+
+/**
+ * @brief 模拟编码器原始计数
+ */
+void hal_sim_set_encoder(int32_t count);
+
+/**
+ * @brief 取消编码器计数模拟
+ */
+void hal_sim_clear_encoder(void);
+
+/**
+ * @brief 模拟矩阵键盘的一个按键：按下时列引脚读到行引脚的输出电平 (行扫描逐行拉低)
+ * @return ESP_OK 成功；ESP_ERR_NO_MEM 已有 HAL_SIM_MAX_KEYS 个按键按下；ESP_ERR_INVALID_ARG 引脚无效
+ */
+esp_err_t hal_sim_set_key(uint8_t row_pin, uint8_t col_pin, bool pressed);
+
+/**
+ * @brief 取消全部模拟，驱动恢复读取硬件
+ */
+void hal_sim_clear(void);
+
+/**
+ * @brief 是否有任何输入被模拟
+ */
+bool hal_sim_active(void);
+
+/**
+ * @brief 注册 'hal' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void hal_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HAL_IO_H
@@ -0,0 +1,247 @@
+#include "joystick_adc_dma.h"
+#include "driver/adc.h"
+#include "esp_log.h"
+#include "task_plan.h"
+#include <string.h>
+
+static const char* TAG = "JOYSTICK_ADC";
+
+#define ADC_RESULT_BYTES     sizeof(adc_digi_output_data_t)
+#define FILTER_MAX_WINDOW    16
+#define IIR_FRACTION_BITS    4    // IIR 状态保留4位小数，避免小步长时截断误差
+#define CALIBRATION_TIMEOUT_MS 200
+
+// 单轴滤波器状态
+typedef struct {
+    uint16_t window[FILTER_MAX_WINDOW];
+    uint8_t index;
+    uint8_t count;
+    uint32_t sum;
+    int32_t iir_state;
+    bool iir_primed;
+} axis_filter_t;
+
+// 全局变量
+static int8_t adc_channel[2] = {-1, -1};   // [0] = X, [1] = Y
+static joystick_filter_t filter_type = JOYSTICK_FILTER_NONE;
+static uint8_t filter_param = 0;
+static axis_filter_t axis_filter[2];
+
+static TaskHandle_t reader_task = NULL;
+static volatile uint32_t filtered_xy = 0;    // 低16位 X，高16位 Y，单次32位读写保证两轴一致
+static volatile bool data_ready = false;
+
+static TaskHandle_t calibration_waiter = NULL;
+static volatile uint32_t calibration_remaining = 0;
+static uint32_t calibration_sum[2] = {0, 0};
+
+static joystick_adc_stats_t adc_stats;
+
+// ESP32 ADC1 通道与 GPIO 的对应关系 (连续模式只支持 ADC1)
+static int8_t gpio_to_adc1_channel(uint8_t pin) {
+    switch (pin) {
+        case 36: return 0;
+        case 37: return 1;
+        case 38: return 2;
+        case 39: return 3;
+        case 32: return 4;
+        case 33: return 5;
+        case 34: return 6;
+        case 35: return 7;
+        default: return -1;
+    }
+}
+
+static uint16_t filter_apply(axis_filter_t* filter, uint16_t input) {
+    switch (filter_type) {
+        case JOYSTICK_FILTER_MOVING_AVERAGE:
+            filter->sum -= filter->window[filter->index];
+            filter->window[filter->index] = input;
+            filter->sum += input;
+            filter->index = (filter->index + 1) % filter_param;
+            if (filter->count < filter_param) {
+                filter->count++;
+            }
+            return filter->sum / filter->count;
+
+        case JOYSTICK_FILTER_IIR:
+            if (!filter->iir_primed) {
+                filter->iir_state = (int32_t)input << IIR_FRACTION_BITS;
+                filter->iir_primed = true;
+            } else {
+                filter->iir_state += (((int32_t)input << IIR_FRACTION_BITS) - filter->iir_state) >> filter_param;
+            }
+            return (uint16_t)((filter->iir_state + (1 << (IIR_FRACTION_BITS - 1))) >> IIR_FRACTION_BITS);
+
+        default:
+            return input;
+    }
+}
+
+// 后台读取任务：每个 DMA 块内对两轴分别求平均 (过采样/抽取)，再送入滤波器
+static void adc_dma_reader_task(void* parameter) {
+    static uint8_t frame[JOYSTICK_ADC_DMA_FRAME_BYTES];
+
+    while (1) {
+        uint32_t length = 0;
+        esp_err_t ret = adc_digi_read_bytes(frame, sizeof(frame), &length, UINT32_MAX);
+        if (ret == ESP_ERR_INVALID_STATE) {
+            // 驱动内部缓冲区溢出，本次数据仍然有效
+            adc_stats.overruns++;
+        } else if (ret != ESP_OK) {
+            continue;
+        }
+
+        uint32_t sum[2] = {0, 0};
+        uint32_t count[2] = {0, 0};
+        for (uint32_t i = 0; i + ADC_RESULT_BYTES <= length; i += ADC_RESULT_BYTES) {
+            const adc_digi_output_data_t* result = (const adc_digi_output_data_t*)&frame[i];
+            uint8_t channel = result->type1.channel;
+            if (channel == adc_channel[0]) {
+                sum[0] += result->type1.data;
+                count[0]++;
+            } else if (channel == adc_channel[1]) {
+                sum[1] += result->type1.data;
+                count[1]++;
+            }
+        }
+        if (count[0] == 0 || count[1] == 0) {
+            continue;
+        }
+
+        uint16_t raw_x = sum[0] / count[0];
+        uint16_t raw_y = sum[1] / count[1];
+
+        // 校准使用未经滤波的块平均值，避免滤波器的建立时间影响中心值
+        if (calibration_remaining > 0) {
+            calibration_sum[0] += raw_x;
+            calibration_sum[1] += raw_y;
+            if (--calibration_remaining == 0 && calibration_waiter != NULL) {
+                xTaskNotifyGive(calibration_waiter);
+            }
+        }
+
+        uint16_t x = filter_apply(&axis_filter[0], raw_x);
+        uint16_t y = filter_apply(&axis_filter[1], raw_y);
+        filtered_xy = (uint32_t)x | ((uint32_t)y << 16);
+        data_ready = true;
+        adc_stats.blocks++;
+    }
+}
+
+esp_err_t joystick_adc_dma_start(const joystick_config_t* config) {
+    if (reader_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    adc_channel[0] = gpio_to_adc1_channel(config->pin_x);
+    adc_channel[1] = gpio_to_adc1_channel(config->pin_y);
+    if (adc_channel[0] < 0 || adc_channel[1] < 0) {
+        ESP_LOGE(TAG, "ADC DMA requires ADC1 pins (GPIO32-39), got X=%d Y=%d",
+                 config->pin_x, config->pin_y);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    // 校验滤波器参数，0 表示使用默认值
+    filter_type = config->filter;
+    filter_param = config->filter_param;
+    if (filter_type == JOYSTICK_FILTER_MOVING_AVERAGE) {
+        if (filter_param == 0) filter_param = JOYSTICK_ADC_DMA_DEFAULT_MA_WINDOW;
+        filter_param = constrain(filter_param, 1, FILTER_MAX_WINDOW);
+    } else if (filter_type == JOYSTICK_FILTER_IIR) {
+        if (filter_param == 0) filter_param = JOYSTICK_ADC_DMA_DEFAULT_IIR_SHIFT;
+        filter_param = constrain(filter_param, 1, 6);
+    }
+    memset(axis_filter, 0, sizeof(axis_filter));
+
+    adc_digi_init_config_t init_config = {
+        .max_store_buf_size = JOYSTICK_ADC_DMA_FRAME_BYTES * 4,
+        .conv_num_each_intr = JOYSTICK_ADC_DMA_FRAME_BYTES,
+        .adc1_chan_mask = (uint32_t)(BIT(adc_channel[0]) | BIT(adc_channel[1])),
+        .adc2_chan_mask = 0,
+    };
+    esp_err_t ret = adc_digi_initialize(&init_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "adc_digi_initialize failed: %d", ret);
+        return ret;
+    }
+
+    adc_digi_pattern_config_t pattern[2];
+    for (int i = 0; i < 2; i++) {
+        pattern[i].atten = ADC_ATTEN_DB_11;        // 支持 3.3V 输入
+        pattern[i].channel = adc_channel[i];
+        pattern[i].unit = 0;                       // ADC1
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    adc_digi_configuration_t digi_config = {
+        .conv_limit_en = true,                     // ESP32 的 I2S-ADC 模式必须启用
+        .conv_limit_num = 250,
+        .pattern_num = 2,
+        .adc_pattern = pattern,
+        .sample_freq_hz = JOYSTICK_ADC_DMA_SAMPLE_FREQ_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    };
+    ret = adc_digi_controller_configure(&digi_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "adc_digi_controller_configure failed: %d", ret);
+        adc_digi_deinitialize();
+        return ret;
+    }
+
+    memset(&adc_stats, 0, sizeof(adc_stats));
+    adc_stats.sample_rate_hz = JOYSTICK_ADC_DMA_SAMPLE_FREQ_HZ / 2;
+    adc_stats.output_rate_hz = adc_stats.sample_rate_hz / (JOYSTICK_ADC_DMA_FRAME_BYTES / ADC_RESULT_BYTES / 2);
+
+    if (task_plan_create(adc_dma_reader_task, "Joystick_ADC", 2048, NULL,
+                         tskIDLE_PRIORITY + 4, &reader_task, TASK_PLAN_CORE_REALTIME) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create ADC reader task");
+        adc_digi_deinitialize();
+        return ESP_ERR_NO_MEM;
+    }
+    adc_digi_start();
+
+    ESP_LOGI(TAG, "ADC DMA started: %lu Hz per axis, %lu Hz output, filter=%d param=%d",
+             (unsigned long)adc_stats.sample_rate_hz, (unsigned long)adc_stats.output_rate_hz,
+             filter_type, filter_param);
+    return ESP_OK;
+}
+
+bool joystick_adc_dma_get(uint16_t* raw_x, uint16_t* raw_y) {
+    if (!data_ready) {
+        return false;
+    }
+    uint32_t xy = filtered_xy;
+    if (raw_x) *raw_x = (uint16_t)(xy & 0xFFFF);
+    if (raw_y) *raw_y = (uint16_t)(xy >> 16);
+    return true;
+}
+
+esp_err_t joystick_adc_dma_calibrate(uint16_t* center_x, uint16_t* center_y) {
+    if (reader_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    calibration_sum[0] = 0;
+    calibration_sum[1] = 0;
+    calibration_waiter = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);  // 清除残留通知
+    calibration_remaining = JOYSTICK_ADC_DMA_CALIBRATION_BLOCKS;
+
+    if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CALIBRATION_TIMEOUT_MS)) == 0) {
+        calibration_remaining = 0;
+        calibration_waiter = NULL;
+        ESP_LOGE(TAG, "Calibration timed out, no ADC data");
+        return ESP_ERR_TIMEOUT;
+    }
+    calibration_waiter = NULL;
+
+    *center_x = calibration_sum[0] / JOYSTICK_ADC_DMA_CALIBRATION_BLOCKS;
+    *center_y = calibration_sum[1] / JOYSTICK_ADC_DMA_CALIBRATION_BLOCKS;
+    return ESP_OK;
+}
+
+void joystick_adc_dma_get_stats(joystick_adc_stats_t* stats) {
+    *stats = adc_stats;
+}
@@ -0,0 +1,39 @@
+#ifndef JOYSTICK_ADC_DMA_H
+#define JOYSTICK_ADC_DMA_H
+
+#include "joystick_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 连续 ADC 总采样率 (两轴合计)，ESP32 I2S-ADC 模式最低为 20kHz
+#define JOYSTICK_ADC_DMA_SAMPLE_FREQ_HZ     20000
+
+// 每次从 DMA 读取的字节数，每个转换结果 2 字节 (每轴 64 个样本，约 6.4ms)
+#define JOYSTICK_ADC_DMA_FRAME_BYTES        256
+
+// 校准时累加的 DMA 块数 (约 32ms)
+#define JOYSTICK_ADC_DMA_CALIBRATION_BLOCKS 5
+
+// 滤波器默认参数
+#define JOYSTICK_ADC_DMA_DEFAULT_MA_WINDOW  8
+#define JOYSTICK_ADC_DMA_DEFAULT_IIR_SHIFT  2
+
+// 启动连续 ADC 采样和后台读取任务 (内部接口，由 joystick_init 调用)
+esp_err_t joystick_adc_dma_start(const joystick_config_t* config);
+
+// 获取最新的滤波后原始值，尚未采到第一块数据时返回 false
+bool joystick_adc_dma_get(uint16_t* raw_x, uint16_t* raw_y);
+
+// 用后台缓冲的样本求中心值，阻塞约 JOYSTICK_ADC_DMA_CALIBRATION_BLOCKS 个块
+esp_err_t joystick_adc_dma_calibrate(uint16_t* center_x, uint16_t* center_y);
+
+// 获取后台采样统计
+void joystick_adc_dma_get_stats(joystick_adc_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JOYSTICK_ADC_DMA_H
@@ -1,5 +1,8 @@
 #include "joystick_driver.h"
+#include "joystick_adc_dma.h"
+#include "hal_io.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <math.h>
 
 static const char* TAG = "JOYSTICK";
@@ -8,6 +11,7 @@ static const char* TAG = "JOYSTICK";
 static joystick_config_t joystick_config;
 static joystick_callback_t data_callback = nullptr;
 static joystick_button_callback_t button_callback = nullptr;
+static data_channel_t data_channel = DATA_CHANNEL_JOYSTICK_0;
 
 static bool last_button_state = false;
 static unsigned long last_button_time = 0;
@@ -15,9 +19,8 @@ static const unsigned long DEBOUNCE_DELAY = 50; // 防抖延时 50ms
 static const uint16_t ADC_MAX = 4095; // ESP32 ADC最大值
 
 // 内部函数声明
-static int16_t map_axis_value(uint16_t raw_value, uint16_t center, bool invert);
-static float calculate_magnitude(int16_t x, int16_t y);
-static float calculate_angle(int16_t x, int16_t y);
+static void read_raw_axes(uint16_t* x, uint16_t* y);
+static void update_math_config(void);
 
 // 摇杆初始化
 esp_err_t joystick_init(const joystick_config_t* config) {
@@ -36,10 +39,20 @@ esp_err_t joystick_init(const joystick_config_t* config) {
     if (joystick_config.center_y == 0) {
         joystick_config.center_y = ADC_MAX / 2;
     }
+    update_math_config();
+
+    // 启动连续 ADC 采样，失败时回退到 analogRead
+    if (joystick_config.backend == JOYSTICK_BACKEND_ADC_DMA &&
+        joystick_adc_dma_start(&joystick_config) != ESP_OK) {
+        ESP_LOGW(TAG, "ADC DMA backend unavailable, falling back to analogRead");
+        joystick_config.backend = JOYSTICK_BACKEND_ANALOG_READ;
+    }
 
     // 初始化模拟输入引脚
-    analogReadResolution(12); // 设置ADC分辨率为12位
-    analogSetAttenuation(ADC_11db); // 设置衰减以支持3.3V输入
+    if (joystick_config.backend == JOYSTICK_BACKEND_ANALOG_READ) {
+        analogReadResolution(12); // 设置ADC分辨率为12位
+        analogSetAttenuation(ADC_11db); // 设置衰减以支持3.3V输入
+    }
 
     // 初始化按钮引脚（如果配置了）
     if (config->pin_button != 255) {
@@ -55,27 +68,13 @@ esp_err_t joystick_init(const joystick_config_t* config) {
 // 读取摇杆数据
 joystick_data_t joystick_read(void) {
     joystick_data_t data;
+    data.sample_us = (uint32_t)esp_timer_get_time();
+    data.publish_us = 0;
     
-    // 读取原始ADC值
-    data.raw_x = analogRead(joystick_config.pin_x);
-    data.raw_y = analogRead(joystick_config.pin_y);
-    
-    // 映射到 -512 到 +512 范围
-    data.x = map_axis_value(data.raw_x, joystick_config.center_x, joystick_config.invert_x);
-    data.y = map_axis_value(data.raw_y, joystick_config.center_y, joystick_config.invert_y);
-    
-    // 应用死区
-    if (abs(data.x) < joystick_config.deadzone && abs(data.y) < joystick_config.deadzone) {
-        data.x = 0;
-        data.y = 0;
-        data.in_deadzone = true;
-    } else {
-        data.in_deadzone = false;
-    }
-    
-    // 计算幅度和角度
-    data.magnitude = calculate_magnitude(data.x, data.y);
-    data.angle = calculate_angle(data.x, data.y);
+    // 读取原始ADC值并换算
+    uint16_t raw_x, raw_y;
+    read_raw_axes(&raw_x, &raw_y);
+    joystick_process_raw(raw_x, raw_y, &data);
     
     // 读取按钮状态
     data.button_pressed = joystick_get_button_state();
@@ -88,26 +87,44 @@ joystick_data_t joystick_read(void) {
 
 // 获取摇杆原始ADC值
 void joystick_get_raw_values(uint16_t* x, uint16_t* y) {
-    if (x) *x = analogRead(joystick_config.pin_x);
-    if (y) *y = analogRead(joystick_config.pin_y);
+    uint16_t raw_x, raw_y;
+    read_raw_axes(&raw_x, &raw_y);
+    if (x) *x = raw_x;
+    if (y) *y = raw_y;
 }
 
 // 校准摇杆中心位置
 esp_err_t joystick_calibrate_center(void) {
     ESP_LOGI(TAG, "Starting joystick calibration...");
     
+    // DMA 后端直接使用后台缓冲的样本，约 30ms 完成
+    if (joystick_config.backend == JOYSTICK_BACKEND_ADC_DMA) {
+        uint16_t center_x, center_y;
+        esp_err_t ret = joystick_adc_dma_calibrate(&center_x, &center_y);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        joystick_config.center_x = center_x;
+        joystick_config.center_y = center_y;
+        update_math_config();
+        ESP_LOGI(TAG, "Calibration complete: center_x=%d, center_y=%d", 
+                 joystick_config.center_x, joystick_config.center_y);
+        return ESP_OK;
+    }
+    
     // 采样多次以获得更准确的中心值
     const int samples = 100;
     uint32_t sum_x = 0, sum_y = 0;
     
     for (int i = 0; i < samples; i++) {
-        sum_x += analogRead(joystick_config.pin_x);
-        sum_y += analogRead(joystick_config.pin_y);
+        sum_x += hal_adc_read(joystick_config.pin_x);
+        sum_y += hal_adc_read(joystick_config.pin_y);
         vTaskDelay(pdMS_TO_TICKS(10));
     }
     
     joystick_config.center_x = sum_x / samples;
     joystick_config.center_y = sum_y / samples;
+    update_math_config();
     
     ESP_LOGI(TAG, "Calibration complete: center_x=%d, center_y=%d", 
              joystick_config.center_x, joystick_config.center_y);
@@ -115,6 +132,12 @@ esp_err_t joystick_calibrate_center(void) {
     return ESP_OK;
 }
 
+// 获取当前使用的中心值
+void joystick_get_center(uint16_t* x, uint16_t* y) {
+    if (x) *x = joystick_config.center_x;
+    if (y) *y = joystick_config.center_y;
+}
+
 // 设置回调函数
 void joystick_set_callback(joystick_callback_t callback) {
     data_callback = callback;
@@ -124,6 +147,16 @@ void joystick_set_button_callback(joystick_button_callback_t callback) {
     button_callback = callback;
 }
 
+// 设置写入的 DataPlatform 通道
+esp_err_t joystick_set_channel(data_channel_t channel) {
+    const data_channel_info_t* info = data_channel_get_info(channel);
+    if (info == NULL || info->kind != DATA_KIND_JOYSTICK) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    data_channel = channel;
+    return ESP_OK;
+}
+
 // 摇杆处理函数
 void joystick_handler(void) {
     static joystick_data_t last_data = {0};
@@ -139,7 +172,8 @@ void joystick_handler(void) {
     
     if (data_changed) {
         // 更新到DataPlatform
-        data_service_update_joystick(&current_data);
+        current_data.publish_us = (uint32_t)esp_timer_get_time();
+        data_channel_write(data_channel, &current_data, sizeof(current_data));
         
         // 调用回调函数（保持兼容性）
         if (data_callback) {
@@ -173,7 +207,7 @@ bool joystick_get_button_state(void) {
         return false;
     }
     
-    bool state = digitalRead(joystick_config.pin_button);
+    bool state = hal_gpio_read(joystick_config.pin_button);
     if (joystick_config.use_pullup) {
         state = !state; // 上拉时逻辑反转
     }
@@ -183,9 +217,22 @@ bool joystick_get_button_state(void) {
 // 设置死区大小
 void joystick_set_deadzone(uint16_t deadzone) {
     joystick_config.deadzone = deadzone;
+    update_math_config();
     ESP_LOGI(TAG, "Deadzone set to: %d", deadzone);
 }
 
+// 获取 ADC DMA 后端统计
+esp_err_t joystick_get_adc_stats(joystick_adc_stats_t* stats) {
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (joystick_config.backend != JOYSTICK_BACKEND_ADC_DMA) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    joystick_adc_dma_get_stats(stats);
+    return ESP_OK;
+}
+
 // 打印摇杆状态
 void joystick_print_status(void) {
     joystick_data_t data = joystick_read();
@@ -193,52 +240,38 @@ void joystick_print_status(void) {
     ESP_LOGI(TAG, "Joystick Status:");
     ESP_LOGI(TAG, "  Raw: X=%d, Y=%d", data.raw_x, data.raw_y);
     ESP_LOGI(TAG, "  Mapped: X=%d, Y=%d", data.x, data.y);
-    ESP_LOGI(TAG, "  Magnitude: %.2f, Angle: %.1f°", data.magnitude, data.angle);
+    ESP_LOGI(TAG, "  Magnitude: %.2f (Q15 %u), Angle: %.1f° (%u cdeg)",
+             data.magnitude, data.magnitude_q15, data.angle, data.angle_cdeg);
     ESP_LOGI(TAG, "  In deadzone: %s", data.in_deadzone ? "YES" : "NO");
     ESP_LOGI(TAG, "  Button: %s", data.button_pressed ? "PRESSED" : "RELEASED");
+    
+    joystick_adc_stats_t adc_stats;
+    if (joystick_get_adc_stats(&adc_stats) == ESP_OK) {
+        ESP_LOGI(TAG, "  ADC DMA: %lu Hz/axis, %lu Hz output, blocks=%lu, overruns=%lu",
+                 (unsigned long)adc_stats.sample_rate_hz, (unsigned long)adc_stats.output_rate_hz,
+                 (unsigned long)adc_stats.blocks, (unsigned long)adc_stats.overruns);
+    }
 }
 
 // 内部函数实现
 
-// 映射轴值到 -512 到 +512 范围
-static int16_t map_axis_value(uint16_t raw_value, uint16_t center, bool invert) {
-    int16_t mapped;
-    
-    if (raw_value >= center) {
-        // 正方向 (center 到 ADC_MAX)
-        mapped = map(raw_value, center, ADC_MAX, 0, 512);
-    } else {
-        // 负方向 (0 到 center)
-        mapped = map(raw_value, 0, center, -512, 0);
-    }
-    
-    // 限制在范围内
-    mapped = constrain(mapped, -512, 512);
-    
-    // 应用反转
-    if (invert) {
-        mapped = -mapped;
+// 读取两轴原始值：DMA 后端取后台滤波结果，否则直接 analogRead；模拟输入时两种后端都取模拟值
+static void read_raw_axes(uint16_t* x, uint16_t* y) {
+    if (joystick_config.backend == JOYSTICK_BACKEND_ADC_DMA &&
+        !hal_adc_is_simulated(joystick_config.pin_x) && !hal_adc_is_simulated(joystick_config.pin_y)) {
+        if (!joystick_adc_dma_get(x, y)) {
+            // 尚未采到第一块数据，按中心位置处理
+            *x = joystick_config.center_x;
+            *y = joystick_config.center_y;
+        }
+        return;
     }
-    
-    return mapped;
-}
-
-// 计算摇杆偏移量（0.0 到 1.0）
-static float calculate_magnitude(int16_t x, int16_t y) {
-    float magnitude = sqrt(x * x + y * y) / 512.0f;
-    return constrain(magnitude, 0.0f, 1.0f);
+    *x = hal_adc_read(joystick_config.pin_x);
+    *y = hal_adc_read(joystick_config.pin_y);
 }
 
-// 计算摇杆角度（0 到 360 度）
-static float calculate_angle(int16_t x, int16_t y) {
-    if (x == 0 && y == 0) {
-        return 0.0f;
-    }
-    
-    float angle = atan2(y, x) * 180.0f / PI;
-    if (angle < 0) {
-        angle += 360.0f;
-    }
-    
-    return angle;
+// 中心值/死区变化后 (初始化 / 校准 / 设置死区) 更新换算参数
+static void update_math_config(void) {
+    joystick_math_configure(joystick_config.center_x, joystick_config.center_y, joystick_config.deadzone,
+                            joystick_config.invert_x, joystick_config.invert_y);
 }
@@ -3,11 +3,25 @@
 
 #include "Arduino.h"
 #include "data_service.h"
+#include "joystick_math.h"   // joystick_process_raw()
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// ADC 采样后端
+typedef enum {
+    JOYSTICK_BACKEND_ANALOG_READ = 0,  // 每次读取调用两次 analogRead() (默认)
+    JOYSTICK_BACKEND_ADC_DMA,          // 连续 ADC + DMA 后台采样，读取时只取滤波结果
+} joystick_backend_t;
+
+// 滤波器类型 (仅 ADC_DMA 后端有效)
+typedef enum {
+    JOYSTICK_FILTER_NONE = 0,          // 只做过采样平均
+    JOYSTICK_FILTER_MOVING_AVERAGE,    // 滑动平均，filter_param 为窗口长度 (1-16)
+    JOYSTICK_FILTER_IIR,               // 一阶 IIR，filter_param 为移位系数 k，alpha = 1/2^k (1-6)
+} joystick_filter_t;
+
 // 摇杆配置结构体
 typedef struct {
     uint8_t pin_x;           // X轴模拟输入引脚
@@ -19,8 +33,19 @@ typedef struct {
     bool invert_y;           // 是否反转Y轴
     uint16_t center_x;       // X轴中心值校准
     uint16_t center_y;       // Y轴中心值校准
+    joystick_backend_t backend;  // ADC 采样后端 (默认 analogRead)
+    joystick_filter_t filter;    // 滤波器类型 (仅 ADC_DMA 后端)
+    uint8_t filter_param;        // 滤波器参数，含义见 joystick_filter_t
 } joystick_config_t;
 
+// ADC DMA 后端统计
+typedef struct {
+    uint32_t sample_rate_hz;     // 每轴的 ADC 采样率
+    uint32_t output_rate_hz;     // 过采样/抽取后的输出速率
+    uint32_t blocks;             // 已处理的 DMA 块数
+    uint32_t overruns;           // DMA 缓冲区溢出次数 (处理跟不上采样)
+} joystick_adc_stats_t;
+
 // 使用DataPlatform中定义的joystick_data_t结构体
 // 摇杆回调函数类型
 typedef void (*joystick_callback_t)(const joystick_data_t* data);
@@ -38,10 +63,16 @@ void joystick_get_raw_values(uint16_t* x, uint16_t* y);
 // 校准摇杆中心位置
 esp_err_t joystick_calibrate_center(void);
 
+// 获取当前使用的中心值 (校准结果，可保存后在下次启动时通过 center_x/center_y 传入)
+void joystick_get_center(uint16_t* x, uint16_t* y);
+
 // 设置回调函数
 void joystick_set_callback(joystick_callback_t callback);
 void joystick_set_button_callback(joystick_button_callback_t callback);
 
+// 设置写入的 DataPlatform 通道 (默认 DATA_CHANNEL_JOYSTICK_0)，通道类别必须是 DATA_KIND_JOYSTICK
+esp_err_t joystick_set_channel(data_channel_t channel);
+
 // 摇杆处理函数（需要在任务中调用）
 void joystick_handler(void);
 
@@ -51,6 +82,9 @@ bool joystick_get_button_state(void);
 // 设置死区大小
 void joystick_set_deadzone(uint16_t deadzone);
 
+// 获取 ADC DMA 后端统计，未使用 DMA 后端时返回 ESP_ERR_INVALID_STATE
+esp_err_t joystick_get_adc_stats(joystick_adc_stats_t* stats);
+
 // 打印摇杆状态（调试用）
 void joystick_print_status(void);
 
@@ -0,0 +1,205 @@
+#include "joystick_math.h"
+#include <stdlib.h>
+
+static const uint16_t ADC_MAX = 4095; // ESP32 ADC最大值
+static const int16_t AXIS_RANGE = 512;  // 映射后的轴值范围 (-512 到 +512)
+
+// 每轴映射系数 (Q16)，在初始化和校准时根据中心值预先计算
+// mapped = ((raw - center) * scale) >> 16，正负半轴各用一个系数
+typedef struct {
+    int32_t scale_pos;
+    int32_t scale_neg;
+} axis_scale_t;
+
+// 换算参数 (由驱动在初始化、校准和修改死区时设置)
+typedef struct {
+    uint16_t center_x;
+    uint16_t center_y;
+    uint16_t deadzone;
+    bool invert_x;
+    bool invert_y;
+    axis_scale_t scale_x;
+    axis_scale_t scale_y;
+} joystick_math_config_t;
+
+static joystick_math_config_t math_config;
+
+// 内部函数声明
+static void compute_axis_scale(uint16_t center, axis_scale_t* scale);
+static int16_t map_axis_value(uint16_t raw_value, uint16_t center, const axis_scale_t* scale, bool invert);
+static uint16_t calculate_magnitude_q15(int16_t x, int16_t y);
+static uint16_t calculate_angle_cdeg(int16_t x, int16_t y);
+
+// 设置换算参数并重新计算映射系数
+void joystick_math_configure(uint16_t center_x, uint16_t center_y, uint16_t deadzone, bool invert_x, bool invert_y) {
+    math_config.center_x = center_x;
+    math_config.center_y = center_y;
+    math_config.deadzone = deadzone;
+    math_config.invert_x = invert_x;
+    math_config.invert_y = invert_y;
+    compute_axis_scale(center_x, &math_config.scale_x);
+    compute_axis_scale(center_y, &math_config.scale_y);
+}
+
+// 由原始ADC值计算轴值、死区、幅度和角度
+void joystick_process_raw(uint16_t raw_x, uint16_t raw_y, joystick_data_t* data) {
+    data->raw_x = raw_x;
+    data->raw_y = raw_y;
+    
+    // 映射到 -512 到 +512 范围
+    data->x = map_axis_value(raw_x, math_config.center_x, &math_config.scale_x, math_config.invert_x);
+    data->y = map_axis_value(raw_y, math_config.center_y, &math_config.scale_y, math_config.invert_y);
+    
+    // 应用死区：死区内直接返回零值，跳过幅度和角度计算
+    if (abs(data->x) < math_config.deadzone && abs(data->y) < math_config.deadzone) {
+        data->x = 0;
+        data->y = 0;
+        data->in_deadzone = true;
+        data->magnitude_q15 = 0;
+        data->angle_cdeg = 0;
+        data->magnitude = 0.0f;
+        data->angle = 0.0f;
+    } else {
+        data->in_deadzone = false;
+        // 定点计算幅度和角度，浮点字段仅由定点值换算得到
+        data->magnitude_q15 = calculate_magnitude_q15(data->x, data->y);
+        data->angle_cdeg = calculate_angle_cdeg(data->x, data->y);
+        data->magnitude = data->magnitude_q15 * (1.0f / 32767.0f);
+        data->angle = data->angle_cdeg * 0.01f;
+    }
+}
+
+// 内部函数实现
+
+// atan 查找表：ATAN_LUT.v[i] = atan(i / ATAN_LUT_SIZE)，单位 0.01 度
+// 表在编译期由 constexpr 函数生成，运行时只做查表和线性插值
+#define ATAN_LUT_BITS 6
+#define ATAN_LUT_SIZE (1 << ATAN_LUT_BITS)
+
+static constexpr double lut_sqrt_iter(double v, double guess, int n) {
+    return n == 0 ? guess : lut_sqrt_iter(v, 0.5 * (guess + v / guess), n - 1);
+}
+
+static constexpr double lut_sqrt(double v) {
+    return lut_sqrt_iter(v, v > 1.0 ? v : 1.0, 24);
+}
+
+// 级数 atan(t) = t - t^3/3 + t^5/5 - ...，t <= 0.42 时取 10 项误差远小于 0.01 度
+static constexpr double lut_atan_series(double t, double t2, double term, int k) {
+    return k == 10 ? 0.0 : term / (2 * k + 1) - lut_atan_series(t, t2, term * t2, k + 1);
+}
+
+static constexpr double lut_atan_reduced(double u) {
+    return 2.0 * lut_atan_series(u, u * u, u, 0);
+}
+
+// 半角公式 atan(t) = 2 * atan(t / (1 + sqrt(1 + t^2)))，把 t 压缩到 [0, 0.42]
+static constexpr double lut_atan(double t) {
+    return lut_atan_reduced(t / (1.0 + lut_sqrt(1.0 + t * t)));
+}
+
+static constexpr uint16_t lut_atan_cdeg(int i) {
+    return (uint16_t)(lut_atan((double)i / ATAN_LUT_SIZE) * 18000.0 / 3.14159265358979323846 + 0.5);
+}
+
+typedef struct {
+    uint16_t v[ATAN_LUT_SIZE + 1];
+} atan_lut_t;
+
+template <int... I> struct lut_indices {};
+template <int N, int... I> struct make_lut_indices : make_lut_indices<N - 1, N - 1, I...> {};
+template <int... I> struct make_lut_indices<0, I...> { typedef lut_indices<I...> type; };
+
+template <int... I>
+static constexpr atan_lut_t make_atan_lut(lut_indices<I...>) {
+    return atan_lut_t{{lut_atan_cdeg(I)...}};
+}
+
+static constexpr atan_lut_t ATAN_LUT = make_atan_lut(make_lut_indices<ATAN_LUT_SIZE + 1>::type());
+
+static_assert(ATAN_LUT.v[0] == 0, "atan LUT must start at 0");
+static_assert(ATAN_LUT.v[ATAN_LUT_SIZE] == 4500, "atan(1) must be 45.00 degrees");
+static_assert(ATAN_LUT.v[ATAN_LUT_SIZE / 2] == 2657, "atan(0.5) must be 26.57 degrees");
+
+// 根据中心值计算单轴映射系数
+static void compute_axis_scale(uint16_t center, axis_scale_t* scale) {
+    center = center < 1 ? 1 : (center > ADC_MAX - 1 ? ADC_MAX - 1 : center);
+    scale->scale_pos = ((int32_t)AXIS_RANGE << 16) / (ADC_MAX - center);
+    scale->scale_neg = ((int32_t)AXIS_RANGE << 16) / center;
+}
+
+// 映射轴值到 -512 到 +512 范围
+static int16_t map_axis_value(uint16_t raw_value, uint16_t center, const axis_scale_t* scale, bool invert) {
+    int32_t offset = (int32_t)raw_value - center;
+    int32_t mapped = (offset * (offset >= 0 ? scale->scale_pos : scale->scale_neg)) / 65536;
+    
+    // 限制在范围内
+    mapped = mapped < -AXIS_RANGE ? -AXIS_RANGE : (mapped > AXIS_RANGE ? AXIS_RANGE : mapped);
+    
+    // 应用反转
+    if (invert) {
+        mapped = -mapped;
+    }
+    
+    return (int16_t)mapped;
+}
+
+// 整数平方根 (逐位法，无除法)
+static uint32_t isqrt32(uint32_t value) {
+    uint32_t result = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+// 计算摇杆偏移量，Q15 定点 (0 到 32767)
+static uint16_t calculate_magnitude_q15(int16_t x, int16_t y) {
+    // |x|,|y| <= 512，x^2+y^2 <= 2^19；左移12位后开方即得 sqrt(x^2+y^2) * 64，
+    // 而 512 * 64 = 32768，正好是 Q15 的比例
+    uint32_t r2 = (uint32_t)((int32_t)x * x + (int32_t)y * y);
+    uint32_t magnitude = isqrt32(r2 << 12);
+    return magnitude > 32767 ? 32767 : (uint16_t)magnitude;
+}
+
+// 计算摇杆角度，单位 0.01 度 (0 到 35999)
+static uint16_t calculate_angle_cdeg(int16_t x, int16_t y) {
+    if (x == 0 && y == 0) {
+        return 0;
+    }
+    
+    uint32_t ax = abs(x);
+    uint32_t ay = abs(y);
+    
+    // 折叠到第一八分区 (0-45度)，t = min/max 为 Q16 定点
+    bool swapped = ay > ax;
+    uint32_t t = swapped ? (ax << 16) / ay : (ay << 16) / ax;
+    uint32_t index = t >> (16 - ATAN_LUT_BITS);
+    uint32_t frac = t & ((1UL << (16 - ATAN_LUT_BITS)) - 1);
+    int32_t angle = ATAN_LUT.v[index];
+    if (index < ATAN_LUT_SIZE) {
+        angle += (int32_t)(((ATAN_LUT.v[index + 1] - ATAN_LUT.v[index]) * frac) >> (16 - ATAN_LUT_BITS));
+    }
+    if (swapped) {
+        angle = 9000 - angle;
+    }
+    
+    // 根据象限展开到 0-360 度
+    if (x < 0) {
+        angle = 18000 - angle;
+    }
+    if (y < 0) {
+        angle = 36000 - angle;
+    }
+    return (uint16_t)(angle % 36000);
+}
@@ -0,0 +1,25 @@
+#ifndef JOYSTICK_MATH_H
+#define JOYSTICK_MATH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "data_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 摇杆换算 (轴值映射、死区、定点幅度和角度)，不访问硬件，可在 native 环境单独编译 (test/test_joystick)
+
+// 设置换算参数：中心值、死区和反转 (驱动在初始化、校准和修改死区时调用)
+void joystick_math_configure(uint16_t center_x, uint16_t center_y, uint16_t deadzone, bool invert_x, bool invert_y);
+
+// 由原始ADC值计算轴值、死区、幅度和角度 (joystick_read() 的换算部分，使用当前中心值/死区/反转配置)
+// 只填写 raw_x/raw_y/x/y/in_deadzone/magnitude*/angle*，时间戳和按钮由调用方填写
+void joystick_process_raw(uint16_t raw_x, uint16_t raw_y, joystick_data_t* data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JOYSTICK_MATH_H
@@ -0,0 +1,185 @@
+#include "latency_stats.h"
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "uart_parser.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* TAG = "LATENCY";
+
+const uint32_t latency_bucket_bounds_us[LATENCY_BUCKET_COUNT - 1] = {
+    50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000,
+};
+
+static const char* const stage_names[LATENCY_STAGE_COUNT] = {
+    "sample->publish",
+    "publish->wake",
+    "wake->wire",
+    "sample->wire",
+};
+
+// 全局变量
+static latency_histogram_t histograms[LATENCY_STAGE_COUNT];
+static portMUX_TYPE histograms_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool latency_export = false;
+
+uint32_t latency_now_us(void) {
+    return (uint32_t)esp_timer_get_time();
+}
+
+void latency_record(latency_stage_t stage, uint32_t from_us, uint32_t to_us) {
+    if (from_us == 0 || stage >= LATENCY_STAGE_COUNT) {
+        return;
+    }
+    uint32_t delta_us = to_us - from_us;
+    if ((int32_t)delta_us < 0) {
+        // 终点在起点之前 (例如样本在发布任务取时间戳之后才写入)，按 0 计
+        delta_us = 0;
+    }
+
+    // 桶查找在临界区外完成，临界区内只有几次加法
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKET_COUNT - 1 && delta_us >= latency_bucket_bounds_us[bucket]) {
+        bucket++;
+    }
+
+    latency_histogram_t* histogram = &histograms[stage];
+    portENTER_CRITICAL(&histograms_mux);
+    if (histogram->count == 0 || delta_us < histogram->min_us) histogram->min_us = delta_us;
+    histogram->count++;
+    histogram->sum_us += delta_us;
+    histogram->buckets[bucket]++;
+    if (delta_us > histogram->max_us) histogram->max_us = delta_us;
+    portEXIT_CRITICAL(&histograms_mux);
+}
+
+void latency_get_histogram(latency_stage_t stage, latency_histogram_t* histogram) {
+    if (histogram == NULL) {
+        return;
+    }
+    if (stage >= LATENCY_STAGE_COUNT) {
+        memset(histogram, 0, sizeof(*histogram));
+        return;
+    }
+    portENTER_CRITICAL(&histograms_mux);
+    *histogram = histograms[stage];
+    portEXIT_CRITICAL(&histograms_mux);
+}
+
+uint32_t latency_percentile_us(const latency_histogram_t* histogram, uint8_t percent) {
+    if (histogram == NULL || histogram->count == 0) {
+        return 0;
+    }
+    uint64_t target = ((uint64_t)histogram->count * percent + 99) / 100;
+    uint64_t cumulative = 0;
+    for (int i = 0; i < LATENCY_BUCKET_COUNT - 1; i++) {
+        cumulative += histogram->buckets[i];
+        if (cumulative >= target) {
+            uint32_t bound = latency_bucket_bounds_us[i];
+            return bound < histogram->max_us ? bound : histogram->max_us;
+        }
+    }
+    return histogram->max_us;
+}
+
+void latency_reset(void) {
+    portENTER_CRITICAL(&histograms_mux);
+    memset(histograms, 0, sizeof(histograms));
+    portEXIT_CRITICAL(&histograms_mux);
+}
+
+const char* latency_stage_name(latency_stage_t stage) {
+    return stage < LATENCY_STAGE_COUNT ? stage_names[stage] : "?";
+}
+
+void latency_set_export(bool enabled) {
+    latency_export = enabled;
+    ESP_LOGI(TAG, "Latency telemetry export %s", enabled ? "enabled" : "disabled");
+}
+
+bool latency_get_export(void) {
+    return latency_export;
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+static void print_histograms(void) {
+    char response[160];
+
+    uart_parser_put_string("Stage              count    min    p50    p99    max   mean (us)\r\n");
+    for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        latency_histogram_t histogram;
+        latency_get_histogram((latency_stage_t)stage, &histogram);
+        uint32_t mean_us = histogram.count > 0 ? (uint32_t)(histogram.sum_us / histogram.count) : 0;
+        snprintf(response, sizeof(response), "  %-16s %6lu %6lu %6lu %6lu %6lu %6lu\r\n",
+                 stage_names[stage], (unsigned long)histogram.count, (unsigned long)histogram.min_us,
+                 (unsigned long)latency_percentile_us(&histogram, 50),
+                 (unsigned long)latency_percentile_us(&histogram, 99),
+                 (unsigned long)histogram.max_us, (unsigned long)mean_us);
+        uart_parser_put_string(response);
+    }
+}
+
+// 打印单个阶段的桶分布
+static void print_buckets(latency_stage_t stage) {
+    char response[96];
+    latency_histogram_t histogram;
+    latency_get_histogram(stage, &histogram);
+
+    snprintf(response, sizeof(response), "%s (n=%lu):\r\n", stage_names[stage], (unsigned long)histogram.count);
+    uart_parser_put_string(response);
+    uint32_t lower = 0;
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        if (i < LATENCY_BUCKET_COUNT - 1) {
+            snprintf(response, sizeof(response), "  %6lu - %6lu us  %lu\r\n", (unsigned long)lower,
+                     (unsigned long)latency_bucket_bounds_us[i], (unsigned long)histogram.buckets[i]);
+            lower = latency_bucket_bounds_us[i];
+        } else {
+            snprintf(response, sizeof(response), "  %6lu +         %lu\r\n", (unsigned long)lower,
+                     (unsigned long)histogram.buckets[i]);
+        }
+        uart_parser_put_string(response);
+    }
+}
+
+static void handle_latency(int argc, char *argv[]) {
+    if (argc >= 2) {
+        if (strcmp(argv[1], "reset") == 0) {
+            latency_reset();
+            uart_parser_put_string("Latency histograms reset.\r\n");
+            return;
+        }
+        if (strcmp(argv[1], "export") == 0) {
+            if (argc >= 3 && strcmp(argv[2], "on") == 0) {
+                latency_set_export(true);
+            } else if (argc >= 3 && strcmp(argv[2], "off") == 0) {
+                latency_set_export(false);
+            } else if (argc >= 3) {
+                uart_parser_put_string("Usage: latency export [on|off]\r\n");
+                return;
+            }
+            uart_parser_put_string(latency_get_export() ? "Latency export: on\r\n" : "Latency export: off\r\n");
+            return;
+        }
+        for (int stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+            if (strcmp(argv[1], stage_names[stage]) == 0) {
+                print_buckets((latency_stage_t)stage);
+                return;
+            }
+        }
+        uart_parser_put_string("Usage: latency [reset | export on|off | <stage>]\r\n");
+        return;
+    }
+
+    print_histograms();
+}
+
+static const command_t latency_commands[] = {
+    {"latency", handle_latency, "latency [reset | export on|off | <stage>]: 查看采样到网络发送各阶段的延迟直方图。"},
+};
+
+void latency_register_commands(void) {
+    uart_parser_register_commands(latency_commands, sizeof(latency_commands) / sizeof(latency_commands[0]));
+}
@@ -0,0 +1,105 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 热路径上的阶段
+ * @details 时间戳均取自 esp_timer_get_time() 的低 32 位 (微秒，约 71 分钟回绕，差值不受影响)：
+ *          sample_us (驱动读取硬件) -> publish_us (写入 DataPlatform) ->
+ *          wake_us (数据发布任务被唤醒) -> 网络发送完成。
+ */
+typedef enum {
+    LATENCY_STAGE_SAMPLE_TO_PUBLISH = 0,  // 采样读取 -> 写入 DataPlatform
+    LATENCY_STAGE_PUBLISH_TO_WAKE,        // 写入 DataPlatform -> 数据发布任务唤醒 (含环形缓冲区排队)
+    LATENCY_STAGE_WAKE_TO_WIRE,           // 数据发布任务唤醒 -> 网络写入完成 (含编码、发送队列与聚合等待)
+    LATENCY_STAGE_SAMPLE_TO_WIRE,         // 端到端：采样读取 -> 网络写入完成
+    LATENCY_STAGE_COUNT
+} latency_stage_t;
+
+/**
+ * @brief 固定桶数量：前 LATENCY_BUCKET_COUNT - 1 个桶的上界见 latency_bucket_bounds_us，最后一个桶不设上界
+ */
+#define LATENCY_BUCKET_COUNT    12
+
+/**
+ * @brief 桶上界 (微秒，不含)：50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000
+ */
+extern const uint32_t latency_bucket_bounds_us[LATENCY_BUCKET_COUNT - 1];
+
+/**
+ * @brief 遥测导出周期 (毫秒)
+ */
+#ifndef LATENCY_EXPORT_INTERVAL_MS
+#define LATENCY_EXPORT_INTERVAL_MS  1000
+#endif
+
+// 单个阶段的直方图
+typedef struct {
+    uint32_t count;                           // 样本数
+    uint32_t min_us;                          // 最小值
+    uint32_t max_us;                          // 最大值
+    uint64_t sum_us;                          // 总和 (用于计算均值)
+    uint32_t buckets[LATENCY_BUCKET_COUNT];   // 各桶计数
+} latency_histogram_t;
+
+/**
+ * @brief 当前时间戳 (esp_timer 微秒的低 32 位)
+ */
+uint32_t latency_now_us(void);
+
+/**
+ * @brief 记录一个延迟样本 (任务上下文，多个任务可同时调用)
+ * @param stage   阶段
+ * @param from_us 起点时间戳 (latency_now_us())，0 表示没有时间戳、不记录
+ * @param to_us   终点时间戳
+ */
+void latency_record(latency_stage_t stage, uint32_t from_us, uint32_t to_us);
+
+/**
+ * @brief 获取阶段直方图的副本
+ */
+void latency_get_histogram(latency_stage_t stage, latency_histogram_t* histogram);
+
+/**
+ * @brief 由直方图估算百分位 (返回所在桶的上界，最后一个桶返回 max_us)
+ * @param percent 百分位 (1-100)
+ */
+uint32_t latency_percentile_us(const latency_histogram_t* histogram, uint8_t percent);
+
+/**
+ * @brief 清零所有直方图
+ */
+void latency_reset(void);
+
+/**
+ * @brief 阶段名称 (用于串口输出)
+ */
+const char* latency_stage_name(latency_stage_t stage);
+
+/**
+ * @brief 启用/停用直方图的遥测导出 (由数据发布任务每 LATENCY_EXPORT_INTERVAL_MS 发送一次)
+ */
+void latency_set_export(bool enabled);
+
+/**
+ * @brief 直方图是否导出到遥测
+ */
+bool latency_get_export(void);
+
+/**
+ * @brief 注册 'latency' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void latency_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LATENCY_STATS_H
@@ -1,5 +1,7 @@
 #include "matrix_keypad.h"
-#include "uart_parser.h" // 用于串口输出
+#include "deferred_log.h" // 按键日志延迟格式化
+#include "hal_io.h"       // GPIO 访问 (可被硬件在环模拟代替)
+#include "esp_timer.h"
 // 调试标签
 static const char* TAG = "KEYPAD";
 
@@ -9,6 +11,12 @@ static keypad_callback_t key_callback = NULL;
 static bool key_states[9] = {false}; // 按键状态数组 (1-9)
 static uint32_t key_last_change[9] = {0}; // 按键最后一次变化时间
 static uint8_t last_key_pressed = 0; // 最后一次按下的按键
+static data_channel_t data_channel = DATA_CHANNEL_KEYPAD_0; // 按键事件写入的通道
+
+// 空闲唤醒模式状态
+static bool idle_wake_enabled = false;          // 是否启用空闲唤醒模式
+static volatile bool wake_pending = false;      // 列边沿中断置位，扫描后清零
+static uint8_t keys_down = 0;                   // 当前处于按下状态的按键数
 
 // 按键映射表 - 将行列坐标映射到按键码
 // 按键布局:
@@ -21,6 +29,28 @@ static const uint8_t KEY_MAP[3][3] = {
     {7, 8, 9}
 };
 
+// 列引脚下降沿中断：有按键被按下 (空闲时所有行为低电平)
+static void IRAM_ATTR keypad_column_isr(void* arg) {
+    wake_pending = true;
+}
+
+// 进入空闲状态：所有行拉低，任一按键按下都会把对应列拉低
+static void keypad_enter_idle(void) {
+    for (int i = 0; i < 3; i++) {
+        hal_gpio_write(keypad_config.row_pins[i], LOW);
+    }
+}
+
+// 空闲状态下检查是否有列处于低电平 (用于补偿扫描期间被清除的唤醒标志)
+static bool keypad_any_column_active(void) {
+    for (int col = 0; col < 3; col++) {
+        if (hal_gpio_read(keypad_config.col_pins[col]) == LOW) {
+            return true;
+        }
+    }
+    return false;
+}
+
 // 初始化矩阵键盘
 esp_err_t keypad_init(const keypad_config_t* config) {
     if (!config) {
@@ -34,7 +64,7 @@ esp_err_t keypad_init(const keypad_config_t* config) {
     // 初始化行引脚为输出
     for (int i = 0; i < 3; i++) {
         pinMode(config->row_pins[i], OUTPUT);
-        digitalWrite(config->row_pins[i], HIGH); // 初始状态为高电平
+        hal_gpio_write(config->row_pins[i], HIGH); // 初始状态为高电平
     }
 
     // 初始化列引脚为输入
@@ -45,10 +75,24 @@ esp_err_t keypad_init(const keypad_config_t* config) {
     // 重置按键状态
     keypad_reset();
 
+    // 空闲唤醒模式：依赖上拉电阻，列在无按键时保持高电平
+    idle_wake_enabled = config->idle_wake && config->use_pullup;
+    if (config->idle_wake && !config->use_pullup) {
+        ESP_LOGW(TAG, "Idle wake requires pull-up columns, falling back to polling scan");
+    }
+    if (idle_wake_enabled) {
+        keypad_enter_idle();
+        for (int i = 0; i < 3; i++) {
+            attachInterruptArg(config->col_pins[i], keypad_column_isr, NULL, FALLING);
+        }
+        wake_pending = keypad_any_column_active();
+    }
+
     ESP_LOGI(TAG, "Matrix keypad initialized: Rows[%d,%d,%d], Cols[%d,%d,%d], Pullup:%s", 
             config->row_pins[0], config->row_pins[1], config->row_pins[2],
             config->col_pins[0], config->col_pins[1], config->col_pins[2],
             config->use_pullup ? "Enabled" : "Disabled");
+    ESP_LOGI(TAG, "Scan mode: %s", idle_wake_enabled ? "idle wake (interrupt)" : "polling");
     
     return ESP_OK;
 }
@@ -73,6 +117,7 @@ void keypad_reset(void) {
         key_last_change[i] = 0;
     }
     last_key_pressed = 0;
+    keys_down = 0;
 }
 
 // 获取最后一次按下的按键
@@ -80,14 +125,37 @@ uint8_t keypad_get_last_key(void) {
     return last_key_pressed;
 }
 
+// 设置按键事件写入的 DataPlatform 通道
+esp_err_t keypad_set_channel(data_channel_t channel) {
+    const data_channel_info_t* info = data_channel_get_info(channel);
+    if (info == NULL || info->kind != DATA_KIND_KEYPAD) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    data_channel = channel;
+    return ESP_OK;
+}
+
 // 键盘扫描与处理
 void keypad_handler(void) {
+    // 空闲唤醒模式：没有被唤醒且没有按键按下时不扫描 (模拟输入不产生列中断，模拟期间每次都扫描)
+    if (idle_wake_enabled && !wake_pending && keys_down == 0 && !hal_sim_gpio_any()) {
+        return;
+    }
+    
     uint32_t current_time = millis();
+    uint32_t sample_us = (uint32_t)esp_timer_get_time();
+    
+    // 空闲唤醒模式下先把所有行恢复为高电平，再逐行扫描
+    if (idle_wake_enabled) {
+        for (int i = 0; i < 3; i++) {
+            hal_gpio_write(keypad_config.row_pins[i], HIGH);
+        }
+    }
     
     // 扫描键盘矩阵
     for (int row = 0; row < 3; row++) {
         // 激活当前行（设置为低电平）
-        digitalWrite(keypad_config.row_pins[row], LOW);
+        hal_gpio_write(keypad_config.row_pins[row], LOW);
         
         // 短暂延时，确保电平稳定
         delayMicroseconds(10);
@@ -98,7 +166,7 @@ void keypad_handler(void) {
             bool key_pressed;
             
             // 读取列引脚状态
-            int pin_state = digitalRead(keypad_config.col_pins[col]);
+            int pin_state = hal_gpio_read(keypad_config.col_pins[col]);
             
             // 根据上拉/下拉配置确定按键状态
             if (keypad_config.use_pullup) {
@@ -119,29 +187,43 @@ void keypad_handler(void) {
                     // 更新最后按下的按键
                     if (key_pressed) {
                         last_key_pressed = key;
+                        keys_down++;
+                    } else if (keys_down > 0) {
+                        keys_down--;
                     }
                     
-                    // 打印按键信息
-                    ESP_LOGI(TAG, "Key %d %s", key, key_pressed ? "PRESSED" : "RELEASED");
-                    
-                    // 发送到串口
-                    char buffer[50];
-                    snprintf(buffer, sizeof(buffer), "矩阵键盘: 按键 %d %s\r\n", 
-                             key, key_pressed ? "按下" : "释放");
-                    uart_parser_put_string(buffer);
+                    // 按键日志只写入延迟日志缓冲区，格式化和串口输出在 DLog 任务中进行
+                    DLOGI(DLOG_MODULE_KEYPAD, "Key %d %s", key, key_pressed ? "PRESSED" : "RELEASED");
                     
                     // 调用回调函数
                     if (key_callback) {
                         key_callback(key, key_pressed);
                     }
                     
-                    // 更新到DataPlatform (如果需要)
-                    // 此处可以根据需要添加数据服务更新代码
+                    // 更新到DataPlatform
+                    keypad_data_t keypad_data = {
+                        .key_code = key,
+                        .pressed = key_pressed,
+                        .timestamp = xTaskGetTickCount(),
+                        .sample_us = sample_us,
+                        .publish_us = (uint32_t)esp_timer_get_time(),
+                    };
+                    data_channel_write(data_channel, &keypad_data, sizeof(keypad_data));
                 }
             }
         }
         
         // 恢复当前行（设置为高电平）
-        digitalWrite(keypad_config.row_pins[row], HIGH);
+        hal_gpio_write(keypad_config.row_pins[row], HIGH);
+    }
+    
+    if (idle_wake_enabled) {
+        // 扫描时行电平切换也会触发列中断，回到空闲状态后清除标志，
+        // 再直接读一次列电平，避免丢失恰好在此期间按下的按键
+        keypad_enter_idle();
+        wake_pending = false;
+        if (keypad_any_column_active()) {
+            wake_pending = true;
+        }
     }
 }
@@ -17,14 +17,10 @@ typedef struct {
     uint8_t col_pins[3];      // 列引脚数组
     bool use_pullup;          // 是否使用内部上拉电阻
     uint8_t debounce_time_ms; // 按键去抖时间(毫秒)
+    bool idle_wake;           // 空闲时所有行拉低，由列边沿中断唤醒后才扫描 (需要 use_pullup)
 } keypad_config_t;
 
-// 键盘按键数据结构
-typedef struct {
-    uint8_t key_code;         // 按键代码 (1-9)
-    bool pressed;             // 是否按下
-    uint32_t timestamp;       // 时间戳
-} keypad_data_t;
+// 键盘按键数据结构 keypad_data_t 定义在 data_service.h 中 (DataPlatform 的 KEYPAD 通道样本)
 
 // 按键事件回调函数类型
 typedef void (*keypad_callback_t)(uint8_t key, bool pressed);
@@ -38,7 +34,11 @@ bool keypad_is_key_pressed(uint8_t key);
 // 设置按键回调函数
 void keypad_set_callback(keypad_callback_t callback);
 
+// 设置按键事件写入的 DataPlatform 通道 (默认 DATA_CHANNEL_KEYPAD_0)，通道类别必须是 DATA_KIND_KEYPAD
+esp_err_t keypad_set_channel(data_channel_t channel);
+
 // 键盘处理函数（需要在任务中调用）
+// idle_wake 模式下无按键时立即返回，只有列边沿唤醒或仍有按键按下时才扫描
 void keypad_handler(void);
 
 // 获取最后一次按下的按键
@@ -0,0 +1,53 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+/*
+ * native 环境的 Arduino 最小替身 (lib/NativeHost)
+ * 只有 hal_io.h 的硬件路径和时间函数；引脚"硬件"见 native_arduino.cpp：
+ * 数字输入未被模拟时读到上拉电平 (输出引脚读回输出电平)，ADC 读到 NATIVE_ADC_IDLE_VALUE。
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HIGH                0x1
+#define LOW                 0x0
+
+#define INPUT               0x01
+#define OUTPUT              0x03
+#define INPUT_PULLUP        0x05
+
+/**
+ * @brief 未被模拟的 ADC 引脚的读数 (12 位中点，相当于摇杆停在中心)
+ */
+#ifndef NATIVE_ADC_IDLE_VALUE
+#define NATIVE_ADC_IDLE_VALUE   2048
+#endif
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+uint16_t analogRead(uint8_t pin);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_ARDUINO_H
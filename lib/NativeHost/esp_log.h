@@ -0,0 +1,31 @@
+#ifndef NATIVE_ESP_LOG_H
+#define NATIVE_ESP_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 输出到 stderr 的日志级别 (与 CORE_DEBUG_LEVEL 相同：1=错误 ... 5=详细)
+ * @details 默认只输出警告和错误，避免测试中大量的信息日志淹没基准测试结果。
+ */
+#ifndef NATIVE_LOG_LEVEL
+#define NATIVE_LOG_LEVEL    2
+#endif
+
+void native_log_write(char level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+#define NATIVE_LOG(level, letter, tag, format, ...) \
+    do { if (NATIVE_LOG_LEVEL >= (level)) native_log_write(letter, tag, format, ##__VA_ARGS__); } while (0)
+
+#define ESP_LOGE(tag, format, ...)  NATIVE_LOG(1, 'E', tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)  NATIVE_LOG(2, 'W', tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)  NATIVE_LOG(3, 'I', tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)  NATIVE_LOG(4, 'D', tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...)  NATIVE_LOG(5, 'V', tag, format, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_ESP_LOG_H
@@ -0,0 +1,60 @@
+#ifndef NATIVE_FREERTOS_H
+#define NATIVE_FREERTOS_H
+
+/*
+ * native 环境的 FreeRTOS 最小替身 (lib/NativeHost)
+ * 只提供 DataPlatform、Telemetry、Latency、Hal 和主机测试用到的接口，
+ * 任务为 pthread 线程，tick 为 1 毫秒，临界区为自旋锁 (不屏蔽中断，主机上没有中断)。
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define errQUEUE_FULL           0
+
+#define configTICK_RATE_HZ      1000
+#define configMAX_PRIORITIES    25
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define portNUM_PROCESSORS      2
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+/* 临界区：ESP32 上为跨核自旋锁 + 关中断，这里只保留自旋锁 */
+typedef struct {
+    volatile int owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    {0}
+
+void native_port_enter_critical(portMUX_TYPE *mux);
+void native_port_exit_critical(portMUX_TYPE *mux);
+
+#define portENTER_CRITICAL(mux)         native_port_enter_critical(mux)
+#define portEXIT_CRITICAL(mux)          native_port_exit_critical(mux)
+#define portENTER_CRITICAL_ISR(mux)     native_port_enter_critical(mux)
+#define portEXIT_CRITICAL_ISR(mux)      native_port_exit_critical(mux)
+#define taskENTER_CRITICAL(mux)         native_port_enter_critical(mux)
+#define taskEXIT_CRITICAL(mux)          native_port_exit_critical(mux)
+#define portYIELD_FROM_ISR(...)         ((void)0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_FREERTOS_H
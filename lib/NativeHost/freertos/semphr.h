@@ -0,0 +1,26 @@
+#ifndef NATIVE_FREERTOS_SEMPHR_H
+#define NATIVE_FREERTOS_SEMPHR_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"     // 与 ESP-IDF 相同，事件组/信号量头文件带入任务接口
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 二值/计数信号量和互斥量共用一个计数实现 (互斥量没有优先级继承) */
+typedef struct native_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#define xSemaphoreCreateBinary()    xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreCreateMutex()     xSemaphoreCreateCounting(1, 1)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_FREERTOS_SEMPHR_H
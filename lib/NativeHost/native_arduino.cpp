@@ -0,0 +1,53 @@
+#include "Arduino.h"
+#include <time.h>
+
+// 主机上没有引脚：记录模式和输出电平，输入读数固定 (模拟值由 lib/Hal 的 hal_sim_* 提供)
+#define NATIVE_PIN_COUNT    64
+
+static uint8_t s_pin_modes[NATIVE_PIN_COUNT];
+static volatile uint64_t s_output_levels = 0;
+
+unsigned long millis(void) {
+    return (unsigned long)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros(void) {
+    return (unsigned long)esp_timer_get_time();
+}
+
+void delay(uint32_t ms) {
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+    struct timespec ts = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+    nanosleep(&ts, NULL);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < NATIVE_PIN_COUNT) {
+        s_pin_modes[pin] = mode;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin >= NATIVE_PIN_COUNT) {
+        return LOW;
+    }
+    if (s_pin_modes[pin] == OUTPUT) {
+        return (int)((s_output_levels >> pin) & 1);
+    }
+    return HIGH;    // 输入引脚按上拉处理：按钮松开、键盘列空闲
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin < NATIVE_PIN_COUNT) {
+        uint64_t bit = 1ULL << pin;
+        s_output_levels = level ? (s_output_levels | bit) : (s_output_levels & ~bit);
+    }
+}
+
+uint16_t analogRead(uint8_t pin) {
+    (void)pin;
+    return NATIVE_ADC_IDLE_VALUE;
+}
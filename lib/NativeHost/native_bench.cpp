@@ -0,0 +1,15 @@
+#include "native_host.h"
+#include <stdio.h>
+
+// 结果直接写 stdout ('pio test -e native -v' 或直接运行测试程序时可见)
+
+void native_bench_header(void) {
+    printf("%-30s %8s %10s %8s\n", "test", "iter", "total_us", "ns/op");
+}
+
+void native_bench_report(const char* name, uint32_t iterations, int64_t elapsed_us) {
+    uint32_t ns_per_op = iterations > 0 ? (uint32_t)((uint64_t)elapsed_us * 1000 / iterations) : 0;
+    printf("%-30s %8lu %10lld %8lu\n", name, (unsigned long)iterations, (long long)elapsed_us,
+           (unsigned long)ns_per_op);
+    fflush(stdout);
+}
@@ -0,0 +1,60 @@
+#include "native_host.h"
+#include "uart_parser.h"
+#include "uart_command_index.h"
+#include "freertos/FreeRTOS.h"
+#include <stdio.h>
+#include <string.h>
+
+// uart_parser.cpp 中与队列、串口和网络来源无关的部分：命令在调用方线程中直接执行，输出写入捕获缓冲区
+
+static char s_capture[NATIVE_CONSOLE_CAPTURE_SIZE];
+static size_t s_capture_len = 0;
+static bool s_echo = false;
+static portMUX_TYPE s_capture_mux = portMUX_INITIALIZER_UNLOCKED;
+
+const char* native_console_output(void) {
+    return s_capture;
+}
+
+void native_console_clear(void) {
+    taskENTER_CRITICAL(&s_capture_mux);
+    s_capture_len = 0;
+    s_capture[0] = '\0';
+    taskEXIT_CRITICAL(&s_capture_mux);
+}
+
+void native_console_set_echo(bool echo) {
+    s_echo = echo;
+}
+
+void uart_parser_put_bytes(const uint8_t* data, size_t len) {
+    taskENTER_CRITICAL(&s_capture_mux);
+    size_t room = sizeof(s_capture) - 1 - s_capture_len;
+    size_t n = len < room ? len : room;
+    memcpy(&s_capture[s_capture_len], data, n);
+    s_capture_len += n;
+    s_capture[s_capture_len] = '\0';
+    taskEXIT_CRITICAL(&s_capture_mux);
+    if (s_echo) {
+        fwrite(data, 1, len, stdout);
+    }
+}
+
+void uart_parser_put_string(const char* str) {
+    uart_parser_put_bytes((const uint8_t*)str, strlen(str));
+}
+
+int uart_parser_register_commands(const command_t* table, size_t count) {
+    if (table == NULL || count == 0) {
+        return pdFAIL;
+    }
+    return uart_command_index_insert(table, count) == count ? pdPASS : pdFAIL;
+}
+
+void uart_parser_dispatch(char* line) {
+    uart_command_execute(line);
+}
+
+int uart_parser_command_is_remote(void) {
+    return 0;
+}
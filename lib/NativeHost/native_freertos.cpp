@@ -0,0 +1,389 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char* TAG = "NATIVE_RTOS";
+
+#define NATIVE_TASK_NAME_SIZE   16
+
+// 任务控制块：线程 + 通知值 (句柄在进程结束前一直有效，删除后的通知被忽略)
+struct native_task {
+    pthread_t thread;
+    TaskFunction_t code;
+    void* parameter;
+    char name[NATIVE_TASK_NAME_SIZE];
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify_value;
+    bool notify_pending;
+    volatile bool deleted;
+};
+
+struct native_event_group {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    EventBits_t bits;
+};
+
+struct native_semaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max_count;
+};
+
+static __thread struct native_task* s_current = NULL;
+
+/* -------------------- 时间 -------------------- */
+
+static int64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t s_start_us = monotonic_us();
+
+int64_t esp_timer_get_time(void) {
+    return monotonic_us() - s_start_us;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / (1000 * portTICK_PERIOD_MS));
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        sched_yield();
+        return;
+    }
+    uint64_t ns = (uint64_t)ticks * portTICK_PERIOD_MS * 1000000ULL;
+    struct timespec ts = {(time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL)};
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+void taskYIELD(void) {
+    sched_yield();
+}
+
+// 计算阻塞等待的绝对截止时间 (pthread_cond_timedwait 使用 CLOCK_REALTIME)
+static struct timespec deadline_after(TickType_t ticks) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t ns = (uint64_t)ts.tv_nsec + (uint64_t)ticks * portTICK_PERIOD_MS * 1000000ULL;
+    ts.tv_sec += (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    return ts;
+}
+
+// 在 lock 已持有时等待 cond，直到 ready() 为真或超时；返回 ready() 的最终结果
+template <typename Ready>
+static bool wait_until(pthread_cond_t* cond, pthread_mutex_t* lock, TickType_t ticks, Ready ready) {
+    if (ready() || ticks == 0) {
+        return ready();
+    }
+    if (ticks == portMAX_DELAY) {
+        while (!ready()) {
+            pthread_cond_wait(cond, lock);
+        }
+        return true;
+    }
+    struct timespec deadline = deadline_after(ticks);
+    while (!ready()) {
+        if (pthread_cond_timedwait(cond, lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    return ready();
+}
+
+/* -------------------- 临界区 -------------------- */
+
+void native_port_enter_critical(portMUX_TYPE* mux) {
+    while (__atomic_exchange_n(&mux->owner, 1, __ATOMIC_ACQUIRE) != 0) {
+        while (__atomic_load_n(&mux->owner, __ATOMIC_RELAXED) != 0) {
+            sched_yield();
+        }
+    }
+}
+
+void native_port_exit_critical(portMUX_TYPE* mux) {
+    __atomic_store_n(&mux->owner, 0, __ATOMIC_RELEASE);
+}
+
+/* -------------------- 任务 -------------------- */
+
+static struct native_task* task_alloc(const char* name) {
+    struct native_task* task = (struct native_task*)calloc(1, sizeof(struct native_task));
+    if (task == NULL) {
+        return NULL;
+    }
+    strncpy(task->name, name != NULL ? name : "", sizeof(task->name) - 1);
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    return task;
+}
+
+static void* task_entry(void* arg) {
+    struct native_task* task = (struct native_task*)arg;
+    s_current = task;
+    task->code(task->parameter);
+    // FreeRTOS 任务函数不允许返回；这里按自行删除处理
+    task->deleted = true;
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char* name, uint32_t stack_depth, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* created_task, BaseType_t core_id) {
+    (void)stack_depth;
+    (void)priority;
+    (void)core_id;
+    struct native_task* task = task_alloc(name);
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->code = code;
+    task->parameter = parameter;
+    if (created_task != NULL) {
+        *created_task = task;   // 先写句柄，任务函数中可以立刻使用
+    }
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        ESP_LOGE(TAG, "Failed to create task %s", task->name);
+        if (created_task != NULL) {
+            *created_task = NULL;
+        }
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint32_t stack_depth, void* parameter,
+                       UBaseType_t priority, TaskHandle_t* created_task) {
+    return xTaskCreatePinnedToCore(code, name, stack_depth, parameter, priority, created_task, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    struct native_task* self = xTaskGetCurrentTaskHandle();
+    if (task != NULL && task != self) {
+        ESP_LOGE(TAG, "vTaskDelete(%s): only self-delete is supported", task->name);
+        return;
+    }
+    self->deleted = true;
+    if (self->code != NULL) {
+        pthread_exit(NULL);
+    }
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    if (s_current == NULL) {
+        // 不是由 xTaskCreate 创建的线程 (例如测试的 main)，首次调用时补建控制块
+        s_current = task_alloc("main");
+    }
+    return s_current;
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+    if (task == NULL) {
+        task = xTaskGetCurrentTaskHandle();
+    }
+    return task->name;
+}
+
+/* -------------------- 任务通知 -------------------- */
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    if (task == NULL || task->deleted) {
+        return pdFAIL;
+    }
+    BaseType_t ret = pdPASS;
+    pthread_mutex_lock(&task->lock);
+    switch (action) {
+        case eSetBits:                  task->notify_value |= value; break;
+        case eIncrement:                task->notify_value++; break;
+        case eSetValueWithOverwrite:    task->notify_value = value; break;
+        case eSetValueWithoutOverwrite:
+            if (task->notify_pending) {
+                ret = pdFAIL;
+            } else {
+                task->notify_value = value;
+            }
+            break;
+        case eNoAction:
+        default:
+            break;
+    }
+    task->notify_pending = true;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return ret;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* value, TickType_t ticks) {
+    struct native_task* self = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&self->lock);
+    if (!self->notify_pending) {
+        self->notify_value &= ~clear_on_entry;
+    }
+    bool notified = wait_until(&self->cond, &self->lock, ticks, [self] { return self->notify_pending; });
+    if (value != NULL) {
+        *value = self->notify_value;
+    }
+    if (notified) {
+        self->notify_value &= ~clear_on_exit;
+        self->notify_pending = false;
+    }
+    pthread_mutex_unlock(&self->lock);
+    return notified ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    struct native_task* self = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&self->lock);
+    wait_until(&self->cond, &self->lock, ticks, [self] { return self->notify_value != 0; });
+    uint32_t value = self->notify_value;
+    if (value != 0) {
+        self->notify_value = clear_on_exit ? 0 : value - 1;
+    }
+    self->notify_pending = false;
+    pthread_mutex_unlock(&self->lock);
+    return value;
+}
+
+/* -------------------- 事件组 -------------------- */
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    struct native_event_group* group = (struct native_event_group*)calloc(1, sizeof(struct native_event_group));
+    if (group != NULL) {
+        pthread_mutex_init(&group->lock, NULL);
+        pthread_cond_init(&group->cond, NULL);
+    }
+    return group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    EventBits_t result = group->bits;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->lock);
+    EventBits_t previous = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    pthread_mutex_lock(&group->lock);
+    EventBits_t bits = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks) {
+    pthread_mutex_lock(&group->lock);
+    bool satisfied = wait_until(&group->cond, &group->lock, ticks, [group, bits, wait_for_all] {
+        return wait_for_all ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+    });
+    EventBits_t result = group->bits;
+    if (satisfied && clear_on_exit) {
+        group->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
+
+/* -------------------- 信号量 -------------------- */
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    struct native_semaphore* semaphore = (struct native_semaphore*)calloc(1, sizeof(struct native_semaphore));
+    if (semaphore != NULL) {
+        pthread_mutex_init(&semaphore->lock, NULL);
+        pthread_cond_init(&semaphore->cond, NULL);
+        semaphore->count = initial_count;
+        semaphore->max_count = max_count;
+    }
+    return semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    pthread_mutex_lock(&semaphore->lock);
+    bool taken = wait_until(&semaphore->cond, &semaphore->lock, ticks, [semaphore] { return semaphore->count > 0; });
+    if (taken) {
+        semaphore->count--;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    BaseType_t ret = pdFALSE;
+    pthread_mutex_lock(&semaphore->lock);
+    if (semaphore->count < semaphore->max_count) {
+        semaphore->count++;
+        pthread_cond_broadcast(&semaphore->cond);
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return ret;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    if (semaphore != NULL) {
+        pthread_cond_destroy(&semaphore->cond);
+        pthread_mutex_destroy(&semaphore->lock);
+        free(semaphore);
+    }
+}
+
+/* -------------------- ESP-IDF 杂项 -------------------- */
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:                    return "ESP_OK";
+        case ESP_FAIL:                  return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:            return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:       return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:     return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:      return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:         return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:     return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:           return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE:  return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_INVALID_CRC:       return "ESP_ERR_INVALID_CRC";
+        default:                        return "UNKNOWN ERROR";
+    }
+}
+
+void native_log_write(char level, const char* tag, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%c (%lu) %s: ", level, (unsigned long)(esp_timer_get_time() / 1000), tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
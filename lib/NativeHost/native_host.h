@@ -0,0 +1,121 @@
+#ifndef NATIVE_HOST_H
+#define NATIVE_HOST_H
+
+/**
+ * @file native_host.h
+ * @brief native 环境 (PlatformIO platform = native) 的主机侧替身
+ *
+ * @details
+ * - 串口命令：uart_parser_put_string() 等输出写入捕获缓冲区，命令注册和分派直接使用
+ *   lib/UARTParser 的 uart_command_index.cpp (与固件相同的哈希索引和分词器)
+ * - 网络：实现 network_frame.h 的帧池和提交接口，提交的帧在调用方线程中交给
+ *   native_network_set_sink() 设置的回调 (代替网络发送任务)
+ * - 轨迹回放：逐行执行 "<t_ms> <命令>" 文本轨迹中的命令 (通常是 'hal sim ...')，
+ *   lib/Hal 的模拟状态由真实代码修改，驱动经 hal_io.h 读到的就是轨迹中的输入
+ * - 基准测试输出：与设备上 'bench micro' 相同的列格式
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "network_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -------------------- 串口命令输出 -------------------- */
+
+/**
+ * @brief 命令输出捕获缓冲区大小 (写满后丢弃后续输出)
+ */
+#define NATIVE_CONSOLE_CAPTURE_SIZE     4096
+
+/**
+ * @brief 自上次 native_console_clear() 以来的命令输出 (以 '\0' 结尾)
+ */
+const char *native_console_output(void);
+
+/**
+ * @brief 清空命令输出捕获缓冲区
+ */
+void native_console_clear(void);
+
+/**
+ * @brief 命令输出是否同时打印到 stdout (默认关闭)
+ */
+void native_console_set_echo(bool echo);
+
+/* -------------------- 网络 -------------------- */
+
+/**
+ * @brief 提交帧的接收回调 (在 network_frame_submit() 的调用方线程中执行，返回后帧被归还)
+ */
+typedef void (*native_network_sink_t)(const network_frame_t *frame, void *arg);
+
+/**
+ * @brief 网络替身统计
+ */
+typedef struct {
+    uint32_t frames;            // 提交成功的帧数
+    uint32_t bytes;             // 提交成功的字节数
+    uint32_t rejected;          // 网络未连接时被拒绝的帧数
+    uint32_t pool_exhausted;    // 帧池耗尽导致 network_frame_alloc() 失败的次数
+} native_network_stats_t;
+
+/**
+ * @brief 设置网络是否连接 (默认已连接；未连接时 network_frame_submit() 返回 -1)
+ */
+void native_network_set_connected(bool connected);
+
+/**
+ * @brief 设置提交帧的接收回调，NULL 表示只计数
+ */
+void native_network_set_sink(native_network_sink_t sink, void *arg);
+
+void native_network_get_stats(native_network_stats_t *stats);
+void native_network_reset_stats(void);
+
+/* -------------------- 轨迹回放 -------------------- */
+
+/**
+ * @brief 每执行完一行轨迹命令后的回调
+ * @param t_ms 该行的时间戳 (毫秒，相对轨迹开始)
+ */
+typedef void (*native_trace_step_t)(uint32_t t_ms, void *arg);
+
+/**
+ * @brief 回放一个文本轨迹文件
+ * @details 每行格式为 "<t_ms> <命令>"，空行和以 '#' 开头的行被忽略；命令经 uart_command_execute()
+ *          执行 (需要先注册对应的命令表，例如 hal_register_commands())。回放不按时间戳等待。
+ *          轨迹文件可以用 example/upper_usage.py --hil-dump 从飞行记录生成。
+ * @param path    文件路径
+ * @param on_step 每行执行后的回调 (可为 NULL)
+ * @return 执行的命令行数，文件无法打开或有格式错误的行时返回 -1
+ */
+int native_trace_replay(const char *path, native_trace_step_t on_step, void *arg);
+
+/* -------------------- 基准测试输出 -------------------- */
+
+/**
+ * @brief 基准测试每项的默认循环次数 (可通过 build_flags 覆盖)
+ */
+#ifndef NATIVE_BENCH_ITERATIONS
+#define NATIVE_BENCH_ITERATIONS     100000
+#endif
+
+/**
+ * @brief 打印结果表头 (列与 'bench micro' 相同，没有周期数列)
+ */
+void native_bench_header(void);
+
+/**
+ * @brief 打印一行结果：名称、次数、总耗时和每次操作的纳秒数
+ */
+void native_bench_report(const char *name, uint32_t iterations, int64_t elapsed_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_HOST_H
@@ -0,0 +1,112 @@
+#include "native_host.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+
+// network_frame.h 的主机实现：与 wifi_task.cpp 相同的静态帧池，提交的帧同步交给接收回调后归还
+
+static network_frame_t s_frame_pool[NETWORK_FRAME_POOL_SIZE];
+static network_frame_t* s_free_frames[NETWORK_FRAME_POOL_SIZE];
+static size_t s_free_count = 0;
+static bool s_pool_ready = false;
+static portMUX_TYPE s_pool_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static volatile bool s_connected = true;
+static native_network_sink_t s_sink = NULL;
+static void* s_sink_arg = NULL;
+static native_network_stats_t s_stats;
+
+// 在锁内调用
+static void pool_init_locked(void) {
+    if (!s_pool_ready) {
+        for (size_t i = 0; i < NETWORK_FRAME_POOL_SIZE; i++) {
+            s_free_frames[i] = &s_frame_pool[i];
+        }
+        s_free_count = NETWORK_FRAME_POOL_SIZE;
+        s_pool_ready = true;
+    }
+}
+
+network_frame_t* network_frame_alloc(void) {
+    network_frame_t* frame = NULL;
+    taskENTER_CRITICAL(&s_pool_mux);
+    pool_init_locked();
+    if (s_free_count > 0) {
+        frame = s_free_frames[--s_free_count];
+    } else {
+        s_stats.pool_exhausted++;
+    }
+    taskEXIT_CRITICAL(&s_pool_mux);
+    if (frame != NULL) {
+        frame->len = 0;
+        frame->flags = 0;
+        frame->sample_us = 0;
+        frame->wake_us = 0;
+        frame->client = -1;
+        frame->client_generation = 0;
+    }
+    return frame;
+}
+
+void network_frame_free(network_frame_t* frame) {
+    if (frame == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_pool_mux);
+    if (s_free_count < NETWORK_FRAME_POOL_SIZE) {
+        s_free_frames[s_free_count++] = frame;
+    }
+    taskEXIT_CRITICAL(&s_pool_mux);
+}
+
+int network_frame_submit(network_frame_t* frame) {
+    if (frame == NULL) {
+        return -1;
+    }
+    if (!s_connected || frame->len > NETWORK_FRAME_DATA_SIZE) {
+        taskENTER_CRITICAL(&s_pool_mux);
+        s_stats.rejected++;
+        taskEXIT_CRITICAL(&s_pool_mux);
+        network_frame_free(frame);
+        return -1;
+    }
+    int len = frame->len;
+    native_network_sink_t sink = s_sink;
+    if (sink != NULL) {
+        sink(frame, s_sink_arg);
+    }
+    network_frame_free(frame);
+    taskENTER_CRITICAL(&s_pool_mux);
+    s_stats.frames++;
+    s_stats.bytes += (uint32_t)len;
+    taskEXIT_CRITICAL(&s_pool_mux);
+    return len;
+}
+
+bool network_tx_accepting(void) {
+    return s_connected;
+}
+
+bool is_network_connected(void) {
+    return s_connected;
+}
+
+void native_network_set_connected(bool connected) {
+    s_connected = connected;
+}
+
+void native_network_set_sink(native_network_sink_t sink, void* arg) {
+    s_sink_arg = arg;
+    s_sink = sink;
+}
+
+void native_network_get_stats(native_network_stats_t* stats) {
+    taskENTER_CRITICAL(&s_pool_mux);
+    *stats = s_stats;
+    taskEXIT_CRITICAL(&s_pool_mux);
+}
+
+void native_network_reset_stats(void) {
+    taskENTER_CRITICAL(&s_pool_mux);
+    memset(&s_stats, 0, sizeof(s_stats));
+    taskEXIT_CRITICAL(&s_pool_mux);
+}
@@ -0,0 +1,46 @@
+#include "native_host.h"
+#include "uart_command_index.h"
+#include "uart_parser.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "NATIVE_TRACE";
+
+int native_trace_replay(const char* path, native_trace_step_t on_step, void* arg) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        ESP_LOGE(TAG, "Cannot open trace %s", path);
+        return -1;
+    }
+
+    // 一行 = 时间戳 + 空格 + 命令，命令长度与串口命令行相同
+    char line[UART_PARSER_LINE_SIZE + 16];
+    int executed = 0;
+    unsigned line_no = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_no++;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '#' || *p == '\r' || *p == '\n' || *p == '\0') {
+            continue;
+        }
+        char* end;
+        unsigned long t_ms = strtoul(p, &end, 10);
+        if (end == p || (*end != ' ' && *end != '\t')) {
+            ESP_LOGE(TAG, "%s:%u: expected '<t_ms> <command>'", path, line_no);
+            executed = -1;
+            break;
+        }
+        uart_command_execute(end);
+        executed++;
+        if (on_step != NULL) {
+            on_step((uint32_t)t_ms, arg);
+        }
+    }
+    fclose(file);
+    return executed;
+}
@@ -0,0 +1,709 @@
+#include "flight_recorder.h"
+#include "data_service.h"
+#include "telemetry_frame.h"
+#include "latency_stats.h"
+#include "task_plan.h"
+#include "uart_parser.h"
+#include "wifi_task.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "RECORDER";
+
+// 记录任务的轮询周期：没有传感器事件时也要按时写入 flash 和推进下载
+#define RECORDER_POLL_MS            20
+// 每次从环形缓冲区取出的样本数
+#define RECORDER_BATCH_SIZE         8
+// 每个轮询周期发送的下载分块数 (串口 115200 波特率约 11KB/s，一块约 250 字节)
+#define RECORDER_DUMP_CHUNKS_UART   1
+#define RECORDER_DUMP_CHUNKS_NET    2
+
+#define RECORDER_SECTOR_MAGIC       0x43455246  // "FREC"
+#define RECORDER_MAX_FRAME          (TELEMETRY_FRAME_OVERHEAD + TELEMETRY_FRAME_MAX_PAYLOAD)
+
+// 扇区头 (16 字节)：每个扇区写入的第一批数据的开头
+typedef struct __attribute__((packed)) {
+    uint32_t magic;          // RECORDER_SECTOR_MAGIC，清除记录时改写为 0
+    uint32_t seq;            // 扇区序号 (单调递增，决定读取顺序)
+    uint32_t session;        // 写入该扇区的启动序号
+    uint8_t  version;        // RECORDER_FORMAT_VERSION
+    uint8_t  reserved[3];
+} recorder_sector_header_t;
+
+// 全局变量
+static const esp_partition_t* s_partition = NULL;
+static uint32_t s_sector_count = 0;
+static TaskHandle_t s_task = NULL;
+
+static volatile bool s_enabled = false;
+static volatile uint16_t s_rate_hz[RECORDER_SOURCE_COUNT];
+static volatile uint16_t s_latency_interval_s = 0;
+
+// 发给记录任务的请求
+static volatile bool s_flush_request = false;
+static volatile bool s_erase_request = false;
+static volatile bool s_dump_start_request = false;
+static volatile bool s_dump_stop_request = false;
+static volatile recorder_sink_t s_dump_request_sink = RECORDER_SINK_UART;
+
+// 写入位置 (只由记录任务访问)
+static bool s_started = false;              // 本次启动是否已开始写入 (第一次写入时切换到新扇区)
+static bool s_session_written = false;
+static uint32_t s_sector = 0;               // 当前扇区下标
+static uint32_t s_write_pos = 0;            // 当前扇区中下一次 flash 写入的偏移 (页对齐)
+static uint8_t s_buffer[RECORDER_WRITE_SIZE + RECORDER_MAX_FRAME + sizeof(recorder_sector_header_t)];
+static size_t s_buffer_len = 0;
+static uint16_t s_record_seq = 0;           // 记录帧的序号 (所有类型共用，回放时可发现缺口)
+
+// 下载位置 (只由记录任务访问)
+static uint32_t s_dump_sector = 0;
+static uint32_t s_dump_pos = 0;             // 扇区内的读取偏移，0 = 尚未读取扇区头
+static uint32_t s_dump_offset = 0;          // 下载流中的偏移
+static uint16_t s_dump_seq = 0;             // 下载分块的帧序号
+
+static recorder_stats_t s_stats;
+static portMUX_TYPE s_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t sector_address(uint32_t sector) {
+    return sector * RECORDER_SECTOR_SIZE;
+}
+
+static bool read_header(uint32_t sector, recorder_sector_header_t* header) {
+    if (esp_partition_read(s_partition, sector_address(sector), header, sizeof(*header)) != ESP_OK) {
+        return false;
+    }
+    return header->magic == RECORDER_SECTOR_MAGIC && header->version == RECORDER_FORMAT_VERSION;
+}
+
+// flash 读写失败：停止记录，避免每个周期重复失败
+static void set_failed(const char* what, esp_err_t ret) {
+    ESP_LOGE(TAG, "Flash %s failed: %s, recording stopped", what, esp_err_to_name(ret));
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.errors++;
+    s_stats.failed = true;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+static void set_dump_active(bool active) {
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.dump_active = active;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+/* -------------------- 写入 -------------------- */
+
+// 把缓冲区写入 flash：pad 为 false 时只写整页 (不足一页的尾部留在内存中)，为 true 时全部写入并跳到下一页
+static void write_buffer(bool pad) {
+    size_t len = pad ? s_buffer_len : (s_buffer_len & ~(size_t)(RECORDER_PAGE_SIZE - 1));
+    if (len == 0 || s_stats.failed) {
+        return;
+    }
+    esp_err_t ret = esp_partition_write(s_partition, sector_address(s_sector) + s_write_pos, s_buffer, len);
+    if (ret != ESP_OK) {
+        set_failed("write", ret);
+        s_buffer_len = 0;
+        return;
+    }
+    // 下一次写入从页边界开始，跳过的字节保持擦除状态 (0xFF)
+    s_write_pos += (len + RECORDER_PAGE_SIZE - 1) & ~(uint32_t)(RECORDER_PAGE_SIZE - 1);
+    s_buffer_len -= len;
+    if (s_buffer_len > 0) {
+        memmove(s_buffer, &s_buffer[len], s_buffer_len);
+    }
+
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.bytes_written += len;
+    s_stats.writes++;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+// 切换到下一个扇区：擦除后在缓冲区开头放入扇区头
+static void next_sector(void) {
+    if (s_started) {
+        write_buffer(true);
+    }
+    s_sector = (s_sector + 1) % s_sector_count;
+    s_started = true;
+
+    // 下载还没读到的最早扇区即将被覆盖：跳到下一个扇区 (跳过的字节计入偏移，上位机据此发现缺口)
+    if (s_stats.dump_active && s_dump_sector == s_sector) {
+        uint32_t skipped = RECORDER_SECTOR_SIZE - (s_dump_pos > 0 ? s_dump_pos : sizeof(recorder_sector_header_t));
+        s_dump_offset += skipped;
+        s_dump_sector = (s_dump_sector + 1) % s_sector_count;
+        s_dump_pos = 0;
+        portENTER_CRITICAL(&s_stats_mux);
+        s_stats.dump_skipped += skipped;
+        portEXIT_CRITICAL(&s_stats_mux);
+    }
+
+    esp_err_t ret = esp_partition_erase_range(s_partition, sector_address(s_sector), RECORDER_SECTOR_SIZE);
+    if (ret != ESP_OK) {
+        set_failed("erase", ret);
+        return;
+    }
+
+    recorder_sector_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = RECORDER_SECTOR_MAGIC;
+    header.seq = s_stats.sector_seq + 1;
+    header.session = s_stats.session;
+    header.version = RECORDER_FORMAT_VERSION;
+    memcpy(s_buffer, &header, sizeof(header));
+    s_buffer_len = sizeof(header);
+    s_write_pos = 0;
+
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.sector = s_sector;
+    s_stats.sector_seq = header.seq;
+    s_stats.erases++;
+    if (s_stats.valid_sectors < s_sector_count) {
+        s_stats.valid_sectors++;
+    }
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+static void append_frame(const uint8_t* frame, size_t len) {
+    if (!s_started || s_write_pos + s_buffer_len + len > RECORDER_SECTOR_SIZE) {
+        // 帧不跨扇区：每个扇区可以单独解析
+        next_sector();
+    }
+    if (s_stats.failed) {
+        return;
+    }
+    memcpy(&s_buffer[s_buffer_len], frame, len);
+    s_buffer_len += len;
+    if (s_buffer_len >= RECORDER_WRITE_SIZE) {
+        write_buffer(false);
+    }
+}
+
+static void record(uint8_t type, const void* payload, size_t payload_len) {
+    uint8_t frame[RECORDER_MAX_FRAME];
+    if (!s_session_written) {
+        // 每次启动的第一帧：回放时据此区分不同的启动
+        telemetry_session_payload_t session = {
+            .session = s_stats.session,
+            .timestamp = xTaskGetTickCount(),
+            .reset_reason = (uint8_t)esp_reset_reason(),
+            .version = RECORDER_FORMAT_VERSION,
+        };
+        s_session_written = true;
+        record(TELEMETRY_FRAME_SESSION, &session, sizeof(session));
+    }
+    size_t len = telemetry_frame_build_seq(type, s_record_seq++, payload, payload_len, frame, sizeof(frame));
+    if (len > 0) {
+        append_frame(frame, len);
+    }
+}
+
+// 按最高记录频率抽取样本 (允许 1/4 周期的采样抖动)
+static bool rate_due(uint16_t rate_hz, uint32_t* last_us, uint32_t now_us) {
+    if (rate_hz == 0) {
+        return false;
+    }
+    uint32_t interval_us = 1000000UL / rate_hz;
+    if (*last_us != 0 && now_us - *last_us < interval_us - interval_us / 4) {
+        return false;
+    }
+    *last_us = now_us;
+    return true;
+}
+
+static void count_frame(int index) {
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.frames[index]++;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+// 作废全部扇区头 (只把 magic 写为 0，不需要擦除)，之后从下一个扇区重新开始
+static void erase_all(void) {
+    static const uint32_t zero = 0;
+    recorder_sector_header_t header;
+    for (uint32_t i = 0; i < s_sector_count; i++) {
+        if (read_header(i, &header)) {
+            esp_partition_write(s_partition, sector_address(i), &zero, sizeof(zero));
+        }
+    }
+    s_buffer_len = 0;
+    s_started = false;
+    s_session_written = false;
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.dump_active = false;
+    s_stats.valid_sectors = 0;
+    portEXIT_CRITICAL(&s_stats_mux);
+    ESP_LOGI(TAG, "Recording erased");
+}
+
+/* -------------------- 下载 -------------------- */
+
+static bool send_chunk(recorder_sink_t sink, const uint8_t* data, size_t len) {
+    uint8_t payload[sizeof(telemetry_record_header_t) + TELEMETRY_RECORD_CHUNK_SIZE];
+    telemetry_record_header_t header = {.offset = s_dump_offset};
+    memcpy(payload, &header, sizeof(header));
+    if (len > 0) {
+        memcpy(&payload[sizeof(header)], data, len);
+    }
+
+    if (sink == RECORDER_SINK_UART) {
+        uint8_t frame[RECORDER_MAX_FRAME];
+        size_t frame_len = telemetry_frame_build_seq(TELEMETRY_FRAME_RECORD, s_dump_seq, payload,
+                                                     sizeof(header) + len, frame, sizeof(frame));
+        uart_parser_port_put_bytes(frame, frame_len);
+    } else {
+        // 只在连接正常时发送：重连期间进入断线缓冲区的帧可能被丢弃
+        if (!is_network_connected()) {
+            return false;
+        }
+        network_frame_t* frame = network_frame_alloc();
+        if (frame == NULL) {
+            return false;   // 帧池被实时遥测占满，下个周期再发
+        }
+        frame->len = telemetry_frame_build_seq(TELEMETRY_FRAME_RECORD, s_dump_seq, payload,
+                                               sizeof(header) + len, frame->data, sizeof(frame->data));
+        if (network_frame_submit(frame) < 0) {
+            return false;
+        }
+    }
+    s_dump_seq++;
+    return true;
+}
+
+static void dump_finish(recorder_sink_t sink) {
+    if (!send_chunk(sink, NULL, 0)) {
+        return;   // 结束分块下个周期重试
+    }
+    set_dump_active(false);
+    ESP_LOGI(TAG, "Dump finished, %lu bytes", (unsigned long)s_dump_offset);
+}
+
+static void dump_step(void) {
+    if (!s_stats.dump_active) {
+        return;
+    }
+    recorder_sink_t sink = s_stats.dump_sink;
+    int budget = sink == RECORDER_SINK_UART ? RECORDER_DUMP_CHUNKS_UART : RECORDER_DUMP_CHUNKS_NET;
+    uint8_t chunk[TELEMETRY_RECORD_CHUNK_SIZE];
+
+    while (budget > 0) {
+        bool current = s_started && s_dump_sector == s_sector;
+        if (s_dump_pos == 0) {
+            recorder_sector_header_t header;
+            if (!read_header(s_dump_sector, &header)) {
+                // 未写入或已清除的扇区 (当前扇区总是有效的，除非本次启动还没有写入)
+                if (current || (!s_started && s_dump_sector == s_sector)) {
+                    dump_finish(sink);
+                    return;
+                }
+                s_dump_sector = (s_dump_sector + 1) % s_sector_count;
+                continue;
+            }
+            s_dump_pos = sizeof(recorder_sector_header_t);
+        }
+
+        // 当前扇区只读到已写入 flash 的位置
+        uint32_t limit = current ? s_write_pos : RECORDER_SECTOR_SIZE;
+        if (s_dump_pos >= limit) {
+            if (current || (!s_started && s_dump_sector == s_sector)) {
+                dump_finish(sink);
+                return;
+            }
+            s_dump_sector = (s_dump_sector + 1) % s_sector_count;
+            s_dump_pos = 0;
+            continue;
+        }
+
+        size_t len = limit - s_dump_pos;
+        if (len > sizeof(chunk)) {
+            len = sizeof(chunk);
+        }
+        esp_err_t ret = esp_partition_read(s_partition, sector_address(s_dump_sector) + s_dump_pos, chunk, len);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Flash read failed: %s, dump stopped", esp_err_to_name(ret));
+            set_dump_active(false);
+            return;
+        }
+        if (!send_chunk(sink, chunk, len)) {
+            return;
+        }
+        s_dump_pos += len;
+        s_dump_offset += len;
+        portENTER_CRITICAL(&s_stats_mux);
+        s_stats.dump_bytes += len;
+        portEXIT_CRITICAL(&s_stats_mux);
+        budget--;
+    }
+}
+
+static void dump_begin(recorder_sink_t sink) {
+    // 先写入内存中的数据，下载包含请求之前的全部记录
+    if (s_started) {
+        write_buffer(true);
+    }
+    // 从当前扇区的下一个 (最早的) 扇区开始，绕一圈读到当前扇区
+    s_dump_sector = (s_sector + 1) % s_sector_count;
+    s_dump_pos = 0;
+    s_dump_offset = 0;
+    s_dump_seq = 0;
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.dump_active = true;
+    s_stats.dump_sink = sink;
+    s_stats.dump_bytes = 0;
+    s_stats.dump_skipped = 0;
+    portEXIT_CRITICAL(&s_stats_mux);
+    ESP_LOGI(TAG, "Dump started (%s)", sink == RECORDER_SINK_UART ? "uart" : "network");
+}
+
+/* -------------------- 记录任务 -------------------- */
+
+static void recorder_task(void* parameter) {
+    (void)parameter;
+    const int subscriber = data_service_subscribe(BIT_EVENT_ENCODER_UPDATED | BIT_EVENT_JOYSTICK_UPDATED |
+                                                  BIT_EVENT_SERVO_UPDATED);
+    if (subscriber < 0) {
+        ESP_LOGE(TAG, "Failed to subscribe to DataPlatform");
+        s_task = NULL;
+        task_plan_delete(NULL);
+        return;
+    }
+
+    static encoder_data_t encoder_batch[RECORDER_BATCH_SIZE];
+    static joystick_data_t joystick_batch[RECORDER_BATCH_SIZE];
+    uint32_t last_encoder_us = 0;
+    uint32_t last_joystick_us = 0;
+    uint32_t last_servo_us[DATA_SERVICE_MAX_SERVOS] = {0};
+    uint32_t servo_versions[DATA_SERVICE_MAX_SERVOS] = {0};
+    TickType_t last_flush = xTaskGetTickCount();
+    TickType_t last_latency = xTaskGetTickCount();
+
+    while (1) {
+        EventBits_t bits = data_service_wait(subscriber, pdMS_TO_TICKS(RECORDER_POLL_MS));
+        bool recording = s_enabled && !s_stats.failed;
+
+        // 不记录时同样取出样本，保持读游标最新
+        size_t count;
+        do {
+            count = data_service_drain_encoder(subscriber, encoder_batch, RECORDER_BATCH_SIZE);
+            for (size_t i = 0; i < count && recording; i++) {
+                if (rate_due(s_rate_hz[RECORDER_SOURCE_ENCODER], &last_encoder_us, encoder_batch[i].sample_us)) {
+                    telemetry_encoder_payload_t payload;
+                    telemetry_pack_encoder(&encoder_batch[i], &payload);
+                    record(TELEMETRY_FRAME_ENCODER, &payload, sizeof(payload));
+                    count_frame(RECORDER_SOURCE_ENCODER);
+                }
+            }
+        } while (count == RECORDER_BATCH_SIZE);
+
+        do {
+            count = data_service_drain_joystick(subscriber, joystick_batch, RECORDER_BATCH_SIZE);
+            for (size_t i = 0; i < count && recording; i++) {
+                if (rate_due(s_rate_hz[RECORDER_SOURCE_JOYSTICK], &last_joystick_us, joystick_batch[i].sample_us)) {
+                    telemetry_joystick_payload_t payload;
+                    telemetry_pack_joystick(&joystick_batch[i], &payload);
+                    record(TELEMETRY_FRAME_JOYSTICK, &payload, sizeof(payload));
+                    count_frame(RECORDER_SOURCE_JOYSTICK);
+                }
+            }
+        } while (count == RECORDER_BATCH_SIZE);
+
+        // 舵机状态只有最新值，用分段版本号判断是否有新数据
+        if ((bits & BIT_EVENT_SERVO_UPDATED) && recording) {
+            uint32_t now_us = latency_now_us();
+            for (uint8_t slot = 0; slot < DATA_SERVICE_MAX_SERVOS; slot++) {
+                servo_data_t servo;
+                uint32_t version = data_service_get_servo(slot, &servo);
+                if (version == 0 || version == servo_versions[slot]) {
+                    continue;
+                }
+                servo_versions[slot] = version;
+                if (rate_due(s_rate_hz[RECORDER_SOURCE_SERVO], &last_servo_us[slot], now_us)) {
+                    telemetry_servo_payload_t payload;
+                    telemetry_pack_servo(&servo, &payload);
+                    record(TELEMETRY_FRAME_SERVO, &payload, sizeof(payload));
+                    count_frame(RECORDER_SOURCE_SERVO);
+                }
+            }
+        }
+
+        TickType_t now = xTaskGetTickCount();
+        uint16_t latency_interval_s = s_latency_interval_s;
+        if (recording && latency_interval_s > 0 &&
+            now - last_latency >= pdMS_TO_TICKS(latency_interval_s * 1000UL)) {
+            last_latency = now;
+            telemetry_latency_payload_t payload;
+            telemetry_pack_latency(&payload);
+            record(TELEMETRY_FRAME_LATENCY, &payload, sizeof(payload));
+            count_frame(RECORDER_SOURCE_COUNT);
+        }
+
+        // 请求
+        if (s_erase_request) {
+            s_erase_request = false;
+            erase_all();
+        }
+        if (s_dump_stop_request) {
+            s_dump_stop_request = false;
+            set_dump_active(false);
+        }
+        if (s_dump_start_request) {
+            s_dump_start_request = false;
+            dump_begin(s_dump_request_sink);
+        }
+        if (s_started && s_buffer_len > 0 &&
+            (s_flush_request || !s_enabled || now - last_flush >= pdMS_TO_TICKS(RECORDER_FLUSH_INTERVAL_MS))) {
+            write_buffer(true);
+        }
+        if (s_flush_request || s_buffer_len == 0) {
+            s_flush_request = false;
+            last_flush = now;
+        }
+
+        dump_step();
+    }
+}
+
+/* -------------------- 公共接口 -------------------- */
+
+esp_err_t recorder_init(const recorder_config_t* config) {
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                           RECORDER_PARTITION_LABEL);
+    if (s_partition == NULL || s_partition->size < 2 * RECORDER_SECTOR_SIZE) {
+        ESP_LOGE(TAG, "No '%s' partition for recording", RECORDER_PARTITION_LABEL);
+        s_partition = NULL;
+        return ESP_ERR_NOT_FOUND;
+    }
+    s_sector_count = s_partition->size / RECORDER_SECTOR_SIZE;
+
+    // 找到序号最大的扇区，本次启动从它的下一个扇区开始写入
+    uint32_t newest_seq = 0;
+    uint32_t newest_session = 0;
+    uint32_t newest = s_sector_count - 1;
+    uint32_t valid = 0;
+    recorder_sector_header_t header;
+    for (uint32_t i = 0; i < s_sector_count; i++) {
+        if (!read_header(i, &header)) {
+            continue;
+        }
+        valid++;
+        if (header.seq > newest_seq) {
+            newest_seq = header.seq;
+            newest_session = header.session;
+            newest = i;
+        }
+    }
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.partition_size = s_partition->size;
+    s_stats.sector_count = s_sector_count;
+    s_stats.session = newest_session + 1;
+    s_stats.sector = newest;
+    s_stats.sector_seq = newest_seq;
+    s_stats.valid_sectors = valid;
+    s_sector = newest;
+
+    for (int i = 0; i < RECORDER_SOURCE_COUNT; i++) {
+        s_rate_hz[i] = config->rate_hz[i];
+    }
+    s_latency_interval_s = config->latency_interval_s;
+    s_enabled = config->enabled;
+    s_stats.enabled = config->enabled;
+
+    if (task_plan_create(recorder_task, RECORDER_TASK_NAME, 4096, NULL, tskIDLE_PRIORITY + 1,
+                         &s_task, TASK_PLAN_CORE_NETWORK) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create recorder task");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Recorder ready: %lu sectors (%lu valid), session %lu", (unsigned long)s_sector_count,
+             (unsigned long)valid, (unsigned long)s_stats.session);
+    return ESP_OK;
+}
+
+void recorder_set_enabled(bool enabled) {
+    s_enabled = enabled;
+    portENTER_CRITICAL(&s_stats_mux);
+    s_stats.enabled = enabled;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+esp_err_t recorder_set_rate(recorder_source_t source, uint16_t rate_hz) {
+    if ((int)source < 0 || (int)source >= RECORDER_SOURCE_COUNT || rate_hz > 1000) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_rate_hz[source] = rate_hz;
+    return ESP_OK;
+}
+
+void recorder_set_latency_interval(uint16_t interval_s) {
+    s_latency_interval_s = interval_s;
+}
+
+void recorder_flush(void) {
+    s_flush_request = true;
+}
+
+void recorder_erase(void) {
+    s_erase_request = true;
+}
+
+esp_err_t recorder_dump_start(recorder_sink_t sink) {
+    if (s_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_dump_request_sink = sink;
+    s_dump_start_request = true;
+    return ESP_OK;
+}
+
+void recorder_dump_stop(void) {
+    s_dump_stop_request = true;
+}
+
+void recorder_get_stats(recorder_stats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_stats_mux);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_mux);
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+static const char* const source_names[RECORDER_SOURCE_COUNT] = {"encoder", "joystick", "servo"};
+
+static void print_status(void) {
+    recorder_stats_t stats;
+    char response[160];
+    recorder_get_stats(&stats);
+
+    snprintf(response, sizeof(response), "Recorder: %s%s, session %lu, partition '%s' %lu KB (%lu/%lu sectors used)\r\n",
+             stats.enabled ? "on" : "off", stats.failed ? " (flash error)" : "", (unsigned long)stats.session,
+             RECORDER_PARTITION_LABEL, (unsigned long)(stats.partition_size / 1024),
+             (unsigned long)stats.valid_sectors, (unsigned long)stats.sector_count);
+    uart_parser_put_string(response);
+    snprintf(response, sizeof(response), "  rates: encoder %u Hz, joystick %u Hz, servo %u Hz, latency every %u s\r\n",
+             s_rate_hz[RECORDER_SOURCE_ENCODER], s_rate_hz[RECORDER_SOURCE_JOYSTICK],
+             s_rate_hz[RECORDER_SOURCE_SERVO], s_latency_interval_s);
+    uart_parser_put_string(response);
+    snprintf(response, sizeof(response), "  frames: encoder %lu, joystick %lu, servo %lu, latency %lu\r\n",
+             (unsigned long)stats.frames[RECORDER_SOURCE_ENCODER], (unsigned long)stats.frames[RECORDER_SOURCE_JOYSTICK],
+             (unsigned long)stats.frames[RECORDER_SOURCE_SERVO], (unsigned long)stats.frames[RECORDER_SOURCE_COUNT]);
+    uart_parser_put_string(response);
+    snprintf(response, sizeof(response), "  flash: sector %lu (seq %lu), %lu bytes in %lu writes, %lu erases, %lu errors\r\n",
+             (unsigned long)stats.sector, (unsigned long)stats.sector_seq, (unsigned long)stats.bytes_written,
+             (unsigned long)stats.writes, (unsigned long)stats.erases, (unsigned long)stats.errors);
+    uart_parser_put_string(response);
+    if (stats.dump_active) {
+        snprintf(response, sizeof(response), "  dump: %s, %lu bytes sent, %lu bytes skipped (overwritten)\r\n",
+                 stats.dump_sink == RECORDER_SINK_UART ? "uart" : "network", (unsigned long)stats.dump_bytes,
+                 (unsigned long)stats.dump_skipped);
+        uart_parser_put_string(response);
+    }
+}
+
+static void handle_recorder(int argc, char *argv[]) {
+    char response[96];
+
+    if (s_partition == NULL) {
+        uart_parser_put_string("Recorder not initialized (enable.recorder off or no partition).\r\n");
+        return;
+    }
+    if (argc < 2) {
+        print_status();
+        return;
+    }
+
+    if (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0) {
+        recorder_set_enabled(strcmp(argv[1], "on") == 0);
+        snprintf(response, sizeof(response), "Recording %s.\r\n", s_enabled ? "started" : "stopped");
+        uart_parser_put_string(response);
+        return;
+    }
+
+    if (strcmp(argv[1], "rate") == 0) {
+        int source = -1;
+        for (int i = 0; argc >= 3 && i < RECORDER_SOURCE_COUNT; i++) {
+            if (strcmp(argv[2], source_names[i]) == 0) {
+                source = i;
+            }
+        }
+        if (argc < 4 || source < 0 ||
+            recorder_set_rate((recorder_source_t)source, (uint16_t)atoi(argv[3])) != ESP_OK) {
+            uart_parser_put_string("Usage: recorder rate <encoder|joystick|servo> <0-1000 Hz>\r\n");
+            return;
+        }
+        snprintf(response, sizeof(response), "Recording %s at up to %u Hz.\r\n", source_names[source],
+                 s_rate_hz[source]);
+        uart_parser_put_string(response);
+        return;
+    }
+
+    if (strcmp(argv[1], "latency") == 0) {
+        if (argc < 3) {
+            uart_parser_put_string("Usage: recorder latency <seconds, 0 = off>\r\n");
+            return;
+        }
+        recorder_set_latency_interval((uint16_t)atoi(argv[2]));
+        snprintf(response, sizeof(response), "Latency histograms recorded every %u s.\r\n", s_latency_interval_s);
+        uart_parser_put_string(response);
+        return;
+    }
+
+    if (strcmp(argv[1], "flush") == 0) {
+        recorder_flush();
+        uart_parser_put_string("Flush requested.\r\n");
+        return;
+    }
+
+    if (strcmp(argv[1], "erase") == 0) {
+        recorder_erase();
+        uart_parser_put_string("Erase requested.\r\n");
+        return;
+    }
+
+    if (strcmp(argv[1], "dump") == 0) {
+        if (argc >= 3 && strcmp(argv[2], "stop") == 0) {
+            recorder_dump_stop();
+            uart_parser_put_string("Dump stopped.\r\n");
+            return;
+        }
+        // 默认发回命令来源：网络命令走网络连接，串口命令走串口
+        recorder_sink_t sink = uart_parser_command_is_remote() ? RECORDER_SINK_NETWORK : RECORDER_SINK_UART;
+        if (argc >= 3) {
+            if (strcmp(argv[2], "uart") == 0) {
+                sink = RECORDER_SINK_UART;
+            } else if (strcmp(argv[2], "net") == 0) {
+                sink = RECORDER_SINK_NETWORK;
+            } else {
+                uart_parser_put_string("Usage: recorder dump [uart|net|stop]\r\n");
+                return;
+            }
+        }
+        recorder_dump_start(sink);
+        snprintf(response, sizeof(response), "Dump started (%s).\r\n", sink == RECORDER_SINK_UART ? "uart" : "net");
+        uart_parser_put_string(response);
+        return;
+    }
+
+    uart_parser_put_string("Usage: recorder [on|off | rate <source> <hz> | latency <s> | flush | erase | dump [uart|net|stop]]\r\n");
+}
+
+static const command_t recorder_commands[] = {
+    {"recorder", handle_recorder, "recorder [on|off | rate <source> <hz> | latency <s> | flush | erase | dump [uart|net|stop]]: 飞行记录仪。"},
+};
+
+void recorder_register_commands(void) {
+    uart_parser_register_commands(recorder_commands, sizeof(recorder_commands) / sizeof(recorder_commands[0]));
+}
@@ -0,0 +1,150 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 记录使用的数据分区 (huge_app.csv 中的 spiffs 分区，按原始扇区环形写入，不能再挂载文件系统)
+ */
+#ifndef RECORDER_PARTITION_LABEL
+#define RECORDER_PARTITION_LABEL    "spiffs"
+#endif
+
+/**
+ * @brief 记录格式版本 (扇区头与启动记录帧中携带)
+ */
+#define RECORDER_FORMAT_VERSION     1
+
+#define RECORDER_SECTOR_SIZE        4096    // flash 擦除单位
+#define RECORDER_PAGE_SIZE          256     // flash 编程页，每次写入都从页边界开始
+
+/**
+ * @brief 累积多少字节后写入一次 flash (按页对齐，不足一页的尾部留在内存中)
+ */
+#ifndef RECORDER_WRITE_SIZE
+#define RECORDER_WRITE_SIZE         1024
+#endif
+
+/**
+ * @brief 内存中的数据最长保留时间 (毫秒)，到期后补齐到页边界写入；即复位时最多丢失的记录时长
+ */
+#ifndef RECORDER_FLUSH_INTERVAL_MS
+#define RECORDER_FLUSH_INTERVAL_MS  5000
+#endif
+
+/**
+ * @brief 记录任务名 (核心/优先级/栈大小见 src/main.cpp 中的任务规划表)
+ */
+#define RECORDER_TASK_NAME          "Recorder"
+
+// 记录的数据源
+typedef enum {
+    RECORDER_SOURCE_ENCODER = 0,
+    RECORDER_SOURCE_JOYSTICK,
+    RECORDER_SOURCE_SERVO,          // 每个舵机分别限速
+    RECORDER_SOURCE_COUNT
+} recorder_source_t;
+
+// 下载输出
+typedef enum {
+    RECORDER_SINK_UART = 0,         // 串口 (与日志共用，上位机按同步字节 + CRC 取帧)
+    RECORDER_SINK_NETWORK,          // 当前网络连接 (与实时遥测共用帧池)
+} recorder_sink_t;
+
+// 记录配置
+typedef struct {
+    bool enabled;                               // 启动后立即开始记录
+    uint16_t rate_hz[RECORDER_SOURCE_COUNT];    // 各数据源的最高记录频率 (0 = 不记录，高于采样频率时每个样本都记录)
+    uint16_t latency_interval_s;                // 延迟直方图的记录周期 (0 = 不记录)
+} recorder_config_t;
+
+// 记录统计
+typedef struct {
+    bool enabled;
+    bool failed;                    // flash 读写失败后停止记录
+    uint32_t partition_size;
+    uint32_t sector_count;
+    uint32_t session;               // 本次启动的序号
+    uint32_t sector;                // 正在写入的扇区
+    uint32_t sector_seq;            // 正在写入的扇区序号 (单调递增)
+    uint32_t valid_sectors;         // 启动时找到的有效扇区数 (之后每写满一个扇区加 1，不超过 sector_count)
+    uint32_t frames[RECORDER_SOURCE_COUNT + 1];  // 各数据源已记录的帧数，最后一项为延迟直方图
+    uint32_t bytes_written;         // 写入 flash 的字节数
+    uint32_t writes;                // flash 写入次数
+    uint32_t erases;                // 扇区擦除次数
+    uint32_t errors;                // flash 读写失败次数
+    bool dump_active;               // 正在下载
+    recorder_sink_t dump_sink;
+    uint32_t dump_bytes;            // 已下载的字节数
+    uint32_t dump_skipped;          // 下载过程中被覆盖写入而跳过的字节数
+} recorder_stats_t;
+
+/**
+ * @brief 初始化飞行记录仪并创建记录任务
+ * @details 查找记录分区，读取各扇区头找到上次写到的位置，从下一个扇区继续 (不擦除历史记录)。
+ *          记录任务独立订阅 DataPlatform (编码器/摇杆环形缓冲区各有自己的读游标)，
+ *          按配置的频率抽取样本编码为二进制遥测帧，累积 RECORDER_WRITE_SIZE 字节后按页对齐写入。
+ * @return ESP_OK 成功；ESP_ERR_NOT_FOUND 没有记录分区；ESP_ERR_INVALID_STATE 已初始化
+ */
+esp_err_t recorder_init(const recorder_config_t* config);
+
+/**
+ * @brief 开始/停止记录 (停止时把内存中的数据写入 flash)
+ */
+void recorder_set_enabled(bool enabled);
+
+/**
+ * @brief 设置数据源的最高记录频率 (Hz，0 = 不记录)
+ */
+esp_err_t recorder_set_rate(recorder_source_t source, uint16_t rate_hz);
+
+/**
+ * @brief 设置延迟直方图的记录周期 (秒，0 = 不记录)
+ */
+void recorder_set_latency_interval(uint16_t interval_s);
+
+/**
+ * @brief 请求把内存中的数据立即写入 flash (由记录任务执行)
+ */
+void recorder_flush(void);
+
+/**
+ * @brief 请求清除全部记录 (由记录任务执行：作废各扇区头，不整片擦除)
+ */
+void recorder_erase(void);
+
+/**
+ * @brief 开始下载：从最早的扇区开始，以 TELEMETRY_FRAME_RECORD 分块发送到 sink，直到追上当前写入位置
+ * @details 由记录任务在记录间隙中发送，记录不停止；下载较慢、最早的扇区在下载前被覆盖时跳过该扇区
+ *          (跳过的字节计入分块偏移)。结束时发送一个不带数据的分块。
+ * @return ESP_OK 已开始；ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t recorder_dump_start(recorder_sink_t sink);
+
+/**
+ * @brief 停止下载
+ */
+void recorder_dump_stop(void);
+
+/**
+ * @brief 获取记录统计
+ */
+void recorder_get_stats(recorder_stats_t* stats);
+
+/**
+ * @brief 注册 'recorder' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void recorder_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FLIGHT_RECORDER_H
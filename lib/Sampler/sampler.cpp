@@ -0,0 +1,347 @@
+#include "sampler.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "uart_parser.h"
+#include "task_plan.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "SAMPLER";
+
+// 采样器运行时状态
+typedef struct {
+    sampler_config_t config;
+    esp_timer_handle_t timer;
+    TaskHandle_t task;
+    volatile uint32_t rate_hz;
+    volatile bool enabled;          // 暂停时定时器停止，已排队的通知也不再调用处理函数
+    volatile bool reset_pending;    // 由采样任务自己清零统计，避免与统计更新竞争
+    int64_t last_start_us;
+    uint64_t period_sum_us;
+    sampler_stats_t stats;
+} sampler_slot_t;
+
+static sampler_slot_t s_samplers[SAMPLER_MAX_COUNT];
+static volatile int s_sampler_count = 0;
+
+// 启动时各外设可能在不同任务中并行创建采样器，创建过程互斥 (静态互斥锁，第一次使用时创建)
+static StaticSemaphore_t s_create_mutex_buffer;
+static SemaphoreHandle_t s_create_mutex = NULL;
+static portMUX_TYPE s_create_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline uint32_t rate_to_period_us(uint32_t rate_hz) {
+    return 1000000UL / rate_hz;
+}
+
+static void reset_slot_stats(sampler_slot_t* slot) {
+    memset(&slot->stats, 0, sizeof(slot->stats));
+    slot->stats.rate_hz = slot->rate_hz;
+    slot->stats.target_period_us = rate_to_period_us(slot->rate_hz);
+    slot->stats.min_period_us = UINT32_MAX;
+    slot->period_sum_us = 0;
+    slot->last_start_us = 0;
+}
+
+// esp_timer 回调 (在 esp_timer 任务中执行)：只负责唤醒采样任务
+static void sampler_timer_callback(void* arg) {
+    sampler_slot_t* slot = (sampler_slot_t*)arg;
+    if (slot->task != NULL) {
+        xTaskNotifyGive(slot->task);
+    }
+}
+
+// 采样任务：等待定时器通知后调用处理函数，并记录实际周期与执行时间
+static void sampler_task(void* parameter) {
+    sampler_slot_t* slot = (sampler_slot_t*)parameter;
+    ESP_LOGI(TAG, "Sampler '%s' started at %lu Hz", slot->config.name, (unsigned long)slot->rate_hz);
+
+    while (1) {
+        uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (pending == 0 || !slot->enabled) {
+            continue;
+        }
+
+        if (slot->reset_pending) {
+            reset_slot_stats(slot);
+            slot->reset_pending = false;
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        sampler_stats_t* stats = &slot->stats;
+
+        // 通知计数大于1说明上一次处理超时，期间有周期被合并
+        if (pending > 1) {
+            stats->missed += pending - 1;
+        }
+
+        if (slot->last_start_us != 0) {
+            uint32_t period_us = (uint32_t)(start_us - slot->last_start_us);
+            if (period_us < stats->min_period_us) stats->min_period_us = period_us;
+            if (period_us > stats->max_period_us) stats->max_period_us = period_us;
+            slot->period_sum_us += period_us;
+            stats->samples++;
+            stats->mean_period_us = (uint32_t)(slot->period_sum_us / stats->samples);
+        }
+        slot->last_start_us = start_us;
+
+        slot->config.handler();
+
+        uint32_t exec_us = (uint32_t)(esp_timer_get_time() - start_us);
+        if (exec_us > stats->max_exec_us) {
+            stats->max_exec_us = exec_us;
+        }
+    }
+}
+
+static bool rate_is_valid(uint32_t rate_hz) {
+    return rate_hz >= SAMPLER_MIN_RATE_HZ && rate_hz <= SAMPLER_MAX_RATE_HZ;
+}
+
+static int sampler_create_locked(const sampler_config_t* config) {
+    if (config == NULL || config->name == NULL || config->handler == NULL) {
+        ESP_LOGE(TAG, "Invalid sampler config");
+        return -1;
+    }
+    if (!rate_is_valid(config->rate_hz)) {
+        ESP_LOGE(TAG, "Invalid rate %lu Hz for '%s'", (unsigned long)config->rate_hz, config->name);
+        return -1;
+    }
+    if (s_sampler_count >= SAMPLER_MAX_COUNT) {
+        ESP_LOGE(TAG, "Sampler table full");
+        return -1;
+    }
+
+    int id = s_sampler_count;
+    sampler_slot_t* slot = &s_samplers[id];
+    memset(slot, 0, sizeof(*slot));
+    slot->config = *config;
+    slot->rate_hz = config->rate_hz;
+    slot->enabled = true;
+    reset_slot_stats(slot);
+
+    // 核心/优先级/栈大小以任务规划表为准，config 中的参数只在未列入规划表时使用
+    if (task_plan_create(sampler_task, config->name, config->stack_size, slot,
+                         config->priority, &slot->task, tskNO_AFFINITY) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create task for '%s'", config->name);
+        return -1;
+    }
+
+    esp_timer_create_args_t timer_args = {
+        .callback = sampler_timer_callback,
+        .arg = slot,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = config->name,
+        .skip_unhandled_events = true,
+    };
+    if (esp_timer_create(&timer_args, &slot->timer) != ESP_OK ||
+        esp_timer_start_periodic(slot->timer, rate_to_period_us(slot->rate_hz)) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start timer for '%s'", config->name);
+        task_plan_delete(slot->task);
+        return -1;
+    }
+
+    s_sampler_count = id + 1;
+    ESP_LOGI(TAG, "Sampler '%s' created: %lu Hz, period %lu us", config->name,
+             (unsigned long)slot->rate_hz, (unsigned long)rate_to_period_us(slot->rate_hz));
+    return id;
+}
+
+int sampler_create(const sampler_config_t* config) {
+    portENTER_CRITICAL(&s_create_mux);
+    if (s_create_mutex == NULL) {
+        s_create_mutex = xSemaphoreCreateMutexStatic(&s_create_mutex_buffer);
+    }
+    portEXIT_CRITICAL(&s_create_mux);
+
+    xSemaphoreTake(s_create_mutex, portMAX_DELAY);
+    int id = sampler_create_locked(config);
+    xSemaphoreGive(s_create_mutex);
+    return id;
+}
+
+int sampler_find(const char* name) {
+    if (name == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < s_sampler_count; i++) {
+        if (strcmp(s_samplers[i].config.name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int sampler_get_count(void) {
+    return s_sampler_count;
+}
+
+const char* sampler_get_name(int id) {
+    if (id < 0 || id >= s_sampler_count) {
+        return NULL;
+    }
+    return s_samplers[id].config.name;
+}
+
+esp_err_t sampler_set_rate(int id, uint32_t rate_hz) {
+    if (id < 0 || id >= s_sampler_count || !rate_is_valid(rate_hz)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sampler_slot_t* slot = &s_samplers[id];
+    esp_timer_stop(slot->timer);
+    slot->rate_hz = rate_hz;
+    slot->reset_pending = true;
+    if (!slot->enabled) {
+        // 暂停中只记录新频率，恢复时按新频率启动
+        ESP_LOGI(TAG, "Sampler '%s' rate set to %lu Hz (paused)", slot->config.name, (unsigned long)rate_hz);
+        return ESP_OK;
+    }
+    esp_err_t ret = esp_timer_start_periodic(slot->timer, rate_to_period_us(rate_hz));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to restart timer for '%s'", slot->config.name);
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Sampler '%s' rate set to %lu Hz", slot->config.name, (unsigned long)rate_hz);
+    return ESP_OK;
+}
+
+esp_err_t sampler_set_enabled(int id, bool enabled) {
+    if (id < 0 || id >= s_sampler_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sampler_slot_t* slot = &s_samplers[id];
+    if (slot->enabled == enabled) {
+        return ESP_OK;
+    }
+    if (!enabled) {
+        slot->enabled = false;
+        esp_timer_stop(slot->timer);
+        ESP_LOGI(TAG, "Sampler '%s' paused", slot->config.name);
+        return ESP_OK;
+    }
+
+    // 暂停期间的间隔不计入周期统计
+    slot->reset_pending = true;
+    slot->enabled = true;
+    esp_err_t ret = esp_timer_start_periodic(slot->timer, rate_to_period_us(slot->rate_hz));
+    if (ret != ESP_OK) {
+        slot->enabled = false;
+        ESP_LOGE(TAG, "Failed to resume timer for '%s'", slot->config.name);
+        return ret;
+    }
+    ESP_LOGI(TAG, "Sampler '%s' resumed", slot->config.name);
+    return ESP_OK;
+}
+
+bool sampler_is_enabled(int id) {
+    if (id < 0 || id >= s_sampler_count) {
+        return false;
+    }
+    return s_samplers[id].enabled;
+}
+
+esp_err_t sampler_get_stats(int id, sampler_stats_t* stats) {
+    if (id < 0 || id >= s_sampler_count || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sampler_slot_t* slot = &s_samplers[id];
+    *stats = slot->stats;
+    if (slot->reset_pending) {
+        // 统计尚未被采样任务清零，按清零后的状态返回
+        memset(stats, 0, sizeof(*stats));
+        stats->rate_hz = slot->rate_hz;
+        stats->target_period_us = rate_to_period_us(slot->rate_hz);
+    }
+    if (stats->samples == 0) {
+        stats->min_period_us = 0;
+    }
+    return ESP_OK;
+}
+
+void sampler_reset_stats(int id) {
+    if (id < 0 || id >= s_sampler_count) {
+        return;
+    }
+    s_samplers[id].reset_pending = true;
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+// 打印单个采样器的周期抖动统计
+static void print_sampler_stats(int id) {
+    char response[160];
+    sampler_stats_t stats;
+    
+    if (sampler_get_stats(id, &stats) != ESP_OK) {
+        return;
+    }
+    snprintf(response, sizeof(response),
+             "  %-10s %4lu Hz  target %6lu us  min %6lu  max %6lu  mean %6lu  exec %5lu  missed %lu  (n=%lu)%s\r\n",
+             sampler_get_name(id),
+             (unsigned long)stats.rate_hz,
+             (unsigned long)stats.target_period_us,
+             (unsigned long)stats.min_period_us,
+             (unsigned long)stats.max_period_us,
+             (unsigned long)stats.mean_period_us,
+             (unsigned long)stats.max_exec_us,
+             (unsigned long)stats.missed,
+             (unsigned long)stats.samples,
+             sampler_is_enabled(id) ? "" : "  [paused]");
+    uart_parser_put_string(response);
+}
+
+static void handle_sampler(int argc, char *argv[]) {
+    if (argc < 2) {
+        if (sampler_get_count() == 0) {
+            uart_parser_put_string("No samplers running.\r\n");
+            return;
+        }
+        uart_parser_put_string("Sampler period statistics (us):\r\n");
+        for (int i = 0; i < sampler_get_count(); i++) {
+            print_sampler_stats(i);
+        }
+        return;
+    }
+    
+    int id = sampler_find(argv[1]);
+    if (id < 0) {
+        uart_parser_put_string("Error: Unknown sampler. Use 'sampler' to list all samplers.\r\n");
+        return;
+    }
+    
+    if (argc >= 3) {
+        if (strcmp(argv[2], "reset") == 0) {
+            sampler_reset_stats(id);
+            uart_parser_put_string("Sampler statistics reset.\r\n");
+            return;
+        }
+        char *end = NULL;
+        long rate_hz = strtol(argv[2], &end, 10);
+        if (end == argv[2] || *end != '\0' || rate_hz < SAMPLER_MIN_RATE_HZ || rate_hz > SAMPLER_MAX_RATE_HZ) {
+            char response[80];
+            snprintf(response, sizeof(response), "Usage: sampler <name> <rate_hz> (%d-%d) | reset\r\n",
+                     SAMPLER_MIN_RATE_HZ, SAMPLER_MAX_RATE_HZ);
+            uart_parser_put_string(response);
+            return;
+        }
+        if (sampler_set_rate(id, (uint32_t)rate_hz) != ESP_OK) {
+            uart_parser_put_string("Error: Failed to change sampler rate.\r\n");
+            return;
+        }
+    }
+    
+    print_sampler_stats(id);
+}
+
+static const command_t sampler_commands[] = {
+    {"sampler", handle_sampler, "sampler [name] [rate_hz|reset]: 查看采样周期抖动统计，或修改采样频率。"},
+};
+
+void sampler_register_commands(void) {
+    uart_parser_register_commands(sampler_commands, sizeof(sampler_commands) / sizeof(sampler_commands[0]));
+}
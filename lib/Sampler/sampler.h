@@ -0,0 +1,86 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 最多可注册的采样器数量
+ */
+#ifndef SAMPLER_MAX_COUNT
+#define SAMPLER_MAX_COUNT     6
+#endif
+
+/**
+ * @brief 允许的采样频率范围 (Hz)
+ */
+#define SAMPLER_MIN_RATE_HZ   1
+#define SAMPLER_MAX_RATE_HZ   1000
+
+// 采样处理函数类型 (例如 encoder_handler / joystick_handler)
+typedef void (*sampler_handler_t)(void);
+
+// 采样器配置结构体
+typedef struct {
+    const char* name;            // 采样器名称 (用于串口命令和任务名)
+    sampler_handler_t handler;   // 每个采样周期调用一次的处理函数
+    uint32_t rate_hz;            // 采样频率
+    uint32_t stack_size;         // 采样任务栈大小 (任务规划表中没有该名称时使用，0 = 默认值)
+    UBaseType_t priority;        // 采样任务优先级 (同上)
+} sampler_config_t;
+
+// 采样周期抖动统计 (单位: 微秒)
+typedef struct {
+    uint32_t rate_hz;            // 当前采样频率
+    uint32_t target_period_us;   // 目标周期
+    uint32_t samples;            // 已统计的周期数
+    uint32_t min_period_us;      // 最小实际周期
+    uint32_t max_period_us;      // 最大实际周期
+    uint32_t mean_period_us;     // 平均实际周期
+    uint32_t max_exec_us;        // 处理函数的最长执行时间
+    uint32_t missed;             // 因处理超时而错过的周期数
+} sampler_stats_t;
+
+// 创建采样器: 由 esp_timer 周期性唤醒一个专用任务调用处理函数
+// 周期由硬件定时器产生，不受处理函数执行时间影响
+// 返回采样器ID (>= 0)，失败返回 -1；可以在多个任务中同时调用 (并行启动)
+int sampler_create(const sampler_config_t* config);
+
+// 根据名称查找采样器，未找到返回 -1
+int sampler_find(const char* name);
+
+// 获取已注册的采样器数量
+int sampler_get_count(void);
+
+// 获取采样器名称
+const char* sampler_get_name(int id);
+
+// 运行时修改采样频率 (同时重置统计)
+esp_err_t sampler_set_rate(int id, uint32_t rate_hz);
+
+// 暂停/恢复采样器: 暂停时停止定时器，处理函数不再被调用；恢复时清零统计
+// 注意: 暂停前已开始执行的那一次处理函数仍会执行完，调用者需要自行等待
+esp_err_t sampler_set_enabled(int id, bool enabled);
+
+// 采样器是否在运行 (未暂停)
+bool sampler_is_enabled(int id);
+
+// 获取采样周期抖动统计
+esp_err_t sampler_get_stats(int id, sampler_stats_t* stats);
+
+// 重置采样周期抖动统计
+void sampler_reset_stats(int id);
+
+// 向 uart_parser 注册 'sampler' 串口命令
+void sampler_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAMPLER_H
@@ -0,0 +1,510 @@
+#include "servo_bus.h"
+#include "serial_servo.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "uart_parser.h"
+#include "task_plan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "SERVO_BUS";
+
+// 运动命令 (count = 1 且 group = false 为单舵机立即运动)
+typedef struct {
+    bool     group;                           // 同步组运动
+    uint8_t  count;
+    uint16_t time_ms;
+    uint8_t  slots[SERVO_BUS_MAX_SERVOS];
+    float    angles[SERVO_BUS_MAX_SERVOS];
+    int64_t  queued_us;                       // 入队时间，用于统计等待时间
+} servo_move_cmd_t;
+
+// 读取请求
+typedef struct {
+    uint8_t slot;
+    uint8_t fields;       // SERVO_BUS_READ_*
+} servo_read_cmd_t;
+
+// 全局变量
+static servo_bus_config_t bus_config;
+static SerialServo* servo_controller = nullptr;
+static TaskHandle_t bus_task = NULL;
+static QueueHandle_t move_queue = NULL;
+static QueueHandle_t read_queue = NULL;
+
+// 各舵机的最新状态 (只由总线任务修改，修改后发布到 DataPlatform)
+static servo_data_t servo_state[SERVO_BUS_MAX_SERVOS];
+static servo_bus_stats_t bus_stats;
+
+// 轮询器状态 (只由总线任务访问，poll_period_us 除外)
+static volatile uint32_t poll_period_us = 0;    // 0 表示不轮询
+static int64_t next_poll_us = 0;
+static uint8_t poll_slot = 0;
+static uint8_t poll_field = SERVO_BUS_READ_POSITION;
+
+int servo_bus_get_slot(uint8_t id) {
+    for (int i = 0; i < bus_config.servo_count; i++) {
+        if (bus_config.servo_ids[i] == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void publish_state(uint8_t slot) {
+    servo_state[slot].timestamp = xTaskGetTickCount();
+    data_service_update_servo(slot, &servo_state[slot]);
+}
+
+static void record_transaction(int64_t start_us) {
+    uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+    if (elapsed_us > bus_stats.max_transaction_us) {
+        bus_stats.max_transaction_us = elapsed_us;
+    }
+}
+
+static void execute_move(const servo_move_cmd_t* cmd) {
+    int64_t start_us = esp_timer_get_time();
+    uint32_t wait_us = (uint32_t)(start_us - cmd->queued_us);
+    if (wait_us > bus_stats.max_move_wait_us) {
+        bus_stats.max_move_wait_us = wait_us;
+    }
+
+    if (!cmd->group) {
+        uint8_t id = bus_config.servo_ids[cmd->slots[0]];
+        if (servo_controller->move_servo_immediate(id, cmd->angles[0], cmd->time_ms) != Operation_Success) {
+            bus_stats.move_failures++;
+            ESP_LOGW(TAG, "Move command to servo %d failed", id);
+            return;
+        }
+    } else {
+        // 先逐个预装目标 (舵机收到后等待启动命令)，再广播启动，所有舵机同时开始运动
+        for (uint8_t i = 0; i < cmd->count; i++) {
+            uint8_t id = bus_config.servo_ids[cmd->slots[i]];
+            if (servo_controller->move_servo_with_time_delay(id, cmd->angles[i], cmd->time_ms) != Operation_Success) {
+                bus_stats.move_failures++;
+                ESP_LOGW(TAG, "Preload to servo %d failed, group move aborted", id);
+                return;
+            }
+        }
+        if (servo_controller->start_servo(SERVO_BUS_BROADCAST_ID) != Operation_Success) {
+            bus_stats.move_failures++;
+            ESP_LOGW(TAG, "Group move start failed");
+            return;
+        }
+        bus_stats.group_moves++;
+    }
+    record_transaction(start_us);
+    bus_stats.moves++;
+
+    for (uint8_t i = 0; i < cmd->count; i++) {
+        servo_state[cmd->slots[i]].target = cmd->angles[i];
+        publish_state(cmd->slots[i]);
+    }
+}
+
+// 发送所有排队中的运动命令 (在每次读取事务之前调用，保证运动命令优先)
+static void drain_moves(void) {
+    servo_move_cmd_t cmd;
+    while (xQueueReceive(move_queue, &cmd, 0) == pdPASS) {
+        execute_move(&cmd);
+    }
+}
+
+// 读取单个字段，返回是否成功
+static bool read_field(uint8_t slot, uint8_t field) {
+    servo_data_t* state = &servo_state[slot];
+    uint8_t id = state->id;
+    int64_t start_us = esp_timer_get_time();
+    bool ok = false;
+
+    switch (field) {
+        case SERVO_BUS_READ_POSITION: {
+            float position = 0;
+            ok = servo_controller->read_servo_position(id, position) == Operation_Success;
+            if (ok) {
+                state->position = position;
+                state->flags |= SERVO_STATE_FLAG_POSITION_VALID;
+            }
+            break;
+        }
+        case SERVO_BUS_READ_TEMP: {
+            int temperature = 0;
+            ok = servo_controller->read_servo_temp(id, temperature) == Operation_Success;
+            if (ok) {
+                state->temperature = (int16_t)temperature;
+                state->flags |= SERVO_STATE_FLAG_TEMP_VALID;
+            }
+            break;
+        }
+        case SERVO_BUS_READ_VOLTAGE: {
+            float voltage = 0;
+            ok = servo_controller->read_servo_voltage(id, voltage) == Operation_Success;
+            if (ok) {
+                state->voltage = voltage;
+                state->flags |= SERVO_STATE_FLAG_VOLTAGE_VALID;
+            }
+            break;
+        }
+        default:
+            return false;
+    }
+
+    record_transaction(start_us);
+    bus_stats.reads++;
+    if (!ok) {
+        bus_stats.timeouts++;
+        state->timeouts++;
+    }
+    return ok;
+}
+
+static void execute_read(const servo_read_cmd_t* cmd) {
+    bool all_ok = true;
+    for (uint8_t field = SERVO_BUS_READ_POSITION; field <= SERVO_BUS_READ_VOLTAGE; field <<= 1) {
+        if (!(cmd->fields & field)) {
+            continue;
+        }
+        // 两次读取事务之间插入排队中的运动命令，运动延迟最多为一次事务的时间
+        drain_moves();
+        if (!read_field(cmd->slot, field)) {
+            all_ok = false;
+        }
+    }
+
+    if (all_ok) {
+        servo_state[cmd->slot].flags &= ~SERVO_STATE_FLAG_TIMEOUT;
+    } else {
+        servo_state[cmd->slot].flags |= SERVO_STATE_FLAG_TIMEOUT;
+    }
+    publish_state(cmd->slot);
+}
+
+// 轮询器前进到下一个 "舵机 x 字段" 组合
+static void poll_advance(void) {
+    uint8_t fields = bus_config.poll_fields & SERVO_BUS_READ_ALL;
+    do {
+        poll_field <<= 1;
+        if (poll_field > SERVO_BUS_READ_VOLTAGE) {
+            poll_field = SERVO_BUS_READ_POSITION;
+            poll_slot = (poll_slot + 1) % bus_config.servo_count;
+        }
+    } while (!(fields & poll_field));
+}
+
+// 执行一次轮询读取事务
+static void poll_once(void) {
+    uint8_t slot = poll_slot;
+    servo_data_t* state = &servo_state[slot];
+
+    bus_stats.polls++;
+    if (read_field(slot, poll_field)) {
+        state->flags &= ~SERVO_STATE_FLAG_TIMEOUT;
+    } else {
+        state->flags |= SERVO_STATE_FLAG_TIMEOUT;
+    }
+    publish_state(slot);
+    poll_advance();
+}
+
+// 计算距离下一次轮询的等待时间
+static TickType_t poll_wait_ticks(void) {
+    if (poll_period_us == 0) {
+        return portMAX_DELAY;
+    }
+    int64_t remaining_us = next_poll_us - esp_timer_get_time();
+    if (remaining_us <= 0) {
+        return 0;
+    }
+    TickType_t ticks = pdMS_TO_TICKS((uint32_t)((remaining_us + 999) / 1000));
+    return ticks > 0 ? ticks : 1;
+}
+
+// 总线任务：独占串口，按 "运动命令 > 读取请求 > 轮询" 的优先级逐个执行总线事务
+static void servo_bus_task(void* parameter) {
+    ESP_LOGI(TAG, "Servo bus task started, %d servo(s)", bus_config.servo_count);
+
+    while (1) {
+        // 入队方每次入队后都会发送通知，队列清空后再等待；启用轮询时最多等到下一个轮询时刻
+        ulTaskNotifyTake(pdTRUE, poll_wait_ticks());
+
+        servo_read_cmd_t read_cmd;
+        for (;;) {
+            drain_moves();
+            if (xQueueReceive(read_queue, &read_cmd, 0) != pdPASS) {
+                break;
+            }
+            execute_read(&read_cmd);
+        }
+
+        uint32_t period_us = poll_period_us;
+        if (period_us != 0) {
+            int64_t now_us = esp_timer_get_time();
+            if (now_us >= next_poll_us) {
+                poll_once();
+                // 总线被其他事务占满时不补发落后的轮询，保持预算上限
+                next_poll_us += period_us;
+                if (next_poll_us < now_us) {
+                    next_poll_us = now_us + period_us;
+                }
+            }
+        }
+    }
+}
+
+esp_err_t servo_bus_init(const servo_bus_config_t* config) {
+    if (config == NULL || config->servo_count == 0 || config->servo_count > SERVO_BUS_MAX_SERVOS) {
+        ESP_LOGE(TAG, "Invalid servo bus config");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (bus_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    bus_config = *config;
+    memset(&bus_stats, 0, sizeof(bus_stats));
+    memset(servo_state, 0, sizeof(servo_state));
+    for (int i = 0; i < bus_config.servo_count; i++) {
+        servo_state[i].id = bus_config.servo_ids[i];
+    }
+
+    if ((bus_config.poll_fields & SERVO_BUS_READ_ALL) == 0) {
+        bus_config.poll_fields = SERVO_BUS_READ_ALL;
+    }
+    poll_slot = 0;
+    poll_field = SERVO_BUS_READ_POSITION;
+    if (!(bus_config.poll_fields & poll_field)) {
+        poll_advance();
+    }
+    if (bus_config.poll_budget_hz > SERVO_BUS_MAX_POLL_HZ) {
+        bus_config.poll_budget_hz = SERVO_BUS_MAX_POLL_HZ;
+    }
+    poll_period_us = bus_config.poll_budget_hz ? 1000000UL / bus_config.poll_budget_hz : 0;
+    next_poll_us = 0;
+
+    move_queue = xQueueCreate(SERVO_BUS_MOVE_QUEUE_LEN, sizeof(servo_move_cmd_t));
+    read_queue = xQueueCreate(SERVO_BUS_READ_QUEUE_LEN, sizeof(servo_read_cmd_t));
+    if (move_queue == NULL || read_queue == NULL) {
+        ESP_LOGE(TAG, "Failed to create command queues");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 半双工总线：应答超时由串口的读取超时决定
+    Serial2.begin(bus_config.baud_rate, SERIAL_8N1, bus_config.rx_pin, bus_config.tx_pin);
+    Serial2.setTimeout(bus_config.response_timeout_ms);
+    servo_controller = new SerialServo(Serial2);
+
+    if (task_plan_create(servo_bus_task, "Servo_Bus", bus_config.stack_size, NULL,
+                         bus_config.priority, &bus_task, TASK_PLAN_CORE_REALTIME) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create servo bus task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Servo bus initialized: %lu baud, timeout %d ms, poll budget %d Hz",
+             (unsigned long)bus_config.baud_rate, bus_config.response_timeout_ms, bus_config.poll_budget_hz);
+    return ESP_OK;
+}
+
+static esp_err_t enqueue_move(servo_move_cmd_t* cmd) {
+    cmd->queued_us = esp_timer_get_time();
+    if (xQueueSend(move_queue, cmd, 0) != pdPASS) {
+        bus_stats.move_queue_full++;
+        return ESP_ERR_NO_MEM;
+    }
+    xTaskNotifyGive(bus_task);
+    return ESP_OK;
+}
+
+esp_err_t servo_bus_move(uint8_t id, float angle, uint16_t time_ms) {
+    if (bus_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int slot = servo_bus_get_slot(id);
+    if (slot < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    servo_move_cmd_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.group = false;
+    cmd.count = 1;
+    cmd.time_ms = time_ms;
+    cmd.slots[0] = (uint8_t)slot;
+    cmd.angles[0] = angle;
+    return enqueue_move(&cmd);
+}
+
+esp_err_t servo_bus_group_move(const uint8_t* ids, const float* angles, uint8_t count, uint16_t time_ms) {
+    if (bus_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (ids == NULL || angles == NULL || count == 0 || count > SERVO_BUS_MAX_SERVOS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    servo_move_cmd_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.group = true;
+    cmd.count = count;
+    cmd.time_ms = time_ms;
+    for (uint8_t i = 0; i < count; i++) {
+        int slot = servo_bus_get_slot(ids[i]);
+        if (slot < 0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        cmd.slots[i] = (uint8_t)slot;
+        cmd.angles[i] = angles[i];
+    }
+    return enqueue_move(&cmd);
+}
+
+esp_err_t servo_bus_request_read(uint8_t id, uint8_t fields) {
+    if (bus_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int slot = servo_bus_get_slot(id);
+    if (slot < 0 || (fields & SERVO_BUS_READ_ALL) == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    servo_read_cmd_t cmd = {
+        .slot = (uint8_t)slot,
+        .fields = (uint8_t)(fields & SERVO_BUS_READ_ALL),
+    };
+    if (xQueueSend(read_queue, &cmd, 0) != pdPASS) {
+        bus_stats.read_queue_full++;
+        return ESP_ERR_NO_MEM;
+    }
+    xTaskNotifyGive(bus_task);
+    return ESP_OK;
+}
+
+esp_err_t servo_bus_set_poll_budget(uint16_t budget_hz) {
+    if (budget_hz > SERVO_BUS_MAX_POLL_HZ) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    bus_config.poll_budget_hz = budget_hz;
+    poll_period_us = budget_hz ? 1000000UL / budget_hz : 0;
+    if (bus_task != NULL) {
+        // 唤醒总线任务以按新的周期重新计算等待时间
+        xTaskNotifyGive(bus_task);
+    }
+    ESP_LOGI(TAG, "Poll budget set to %d Hz", budget_hz);
+    return ESP_OK;
+}
+
+uint16_t servo_bus_get_poll_budget(void) {
+    return bus_config.poll_budget_hz;
+}
+
+void servo_bus_get_stats(servo_bus_stats_t* stats) {
+    *stats = bus_stats;
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+static void print_servo_state(int slot) {
+    char response[128];
+    servo_data_t state;
+
+    if (data_service_get_servo(slot, &state) == 0) {
+        snprintf(response, sizeof(response), "  servo %3d  (no data)\r\n", bus_config.servo_ids[slot]);
+    } else {
+        snprintf(response, sizeof(response),
+                 "  servo %3d  pos %6.1f  target %6.1f  temp %3d C  volt %5.2f V  timeouts %lu%s\r\n",
+                 state.id, state.position, state.target, state.temperature, state.voltage,
+                 (unsigned long)state.timeouts,
+                 (state.flags & SERVO_STATE_FLAG_TIMEOUT) ? "  (offline)" : "");
+    }
+    uart_parser_put_string(response);
+}
+
+static void handle_servo(int argc, char *argv[]) {
+    if (bus_task == NULL) {
+        uart_parser_put_string("Servo bus not initialized.\r\n");
+        return;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "poll") == 0) {
+        if (argc >= 3) {
+            char *end = NULL;
+            long budget_hz = strtol(argv[2], &end, 10);
+            if (end == argv[2] || *end != '\0' || budget_hz < 0 ||
+                servo_bus_set_poll_budget((uint16_t)budget_hz) != ESP_OK) {
+                char response[64];
+                snprintf(response, sizeof(response), "Usage: servo poll [budget_hz] (0-%d)\r\n", SERVO_BUS_MAX_POLL_HZ);
+                uart_parser_put_string(response);
+                return;
+            }
+        }
+        char response[64];
+        snprintf(response, sizeof(response), "Servo poll budget: %d Hz\r\n", servo_bus_get_poll_budget());
+        uart_parser_put_string(response);
+        return;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "sync") == 0) {
+        // servo sync <time_ms> <id> <angle> [<id> <angle> ...]
+        uint8_t ids[SERVO_BUS_MAX_SERVOS];
+        float angles[SERVO_BUS_MAX_SERVOS];
+        uint8_t count = 0;
+        long time_ms = (argc >= 3) ? strtol(argv[2], NULL, 10) : -1;
+        for (int i = 3; i + 1 < argc && count < SERVO_BUS_MAX_SERVOS; i += 2) {
+            ids[count] = (uint8_t)strtol(argv[i], NULL, 10);
+            angles[count] = strtof(argv[i + 1], NULL);
+            count++;
+        }
+        if (time_ms < 0 || time_ms > 30000 || count == 0 ||
+            servo_bus_group_move(ids, angles, count, (uint16_t)time_ms) != ESP_OK) {
+            uart_parser_put_string("Usage: servo sync <time_ms> <id> <angle> [<id> <angle> ...]\r\n");
+            return;
+        }
+        uart_parser_put_string("Servo group move queued.\r\n");
+        return;
+    }
+
+    if (argc >= 3) {
+        char *end = NULL;
+        long id = strtol(argv[1], &end, 10);
+        float angle = strtof(argv[2], NULL);
+        long time_ms = (argc >= 4) ? strtol(argv[3], NULL, 10) : 1000;
+        if (end == argv[1] || *end != '\0' || servo_bus_get_slot((uint8_t)id) < 0 ||
+            time_ms < 0 || time_ms > 30000) {
+            uart_parser_put_string("Usage: servo [<id> <angle> [time_ms]] | sync ... | poll [budget_hz]\r\n");
+            return;
+        }
+        if (servo_bus_move((uint8_t)id, angle, (uint16_t)time_ms) != ESP_OK) {
+            uart_parser_put_string("Error: Servo move queue full.\r\n");
+            return;
+        }
+        servo_bus_request_read((uint8_t)id, SERVO_BUS_READ_POSITION);
+        uart_parser_put_string("Servo move queued.\r\n");
+        return;
+    }
+
+    char response[256];
+    servo_bus_stats_t stats;
+    servo_bus_get_stats(&stats);
+    snprintf(response, sizeof(response),
+             "Servo bus: moves %lu (group %lu)  reads %lu (poll %lu, budget %d Hz)  timeouts %lu  move failures %lu\r\n"
+             "  queue full: move %lu  read %lu  max move wait %lu us  max transaction %lu us\r\n",
+             (unsigned long)stats.moves, (unsigned long)stats.group_moves,
+             (unsigned long)stats.reads, (unsigned long)stats.polls, servo_bus_get_poll_budget(),
+             (unsigned long)stats.timeouts, (unsigned long)stats.move_failures,
+             (unsigned long)stats.move_queue_full, (unsigned long)stats.read_queue_full,
+             (unsigned long)stats.max_move_wait_us, (unsigned long)stats.max_transaction_us);
+    uart_parser_put_string(response);
+    for (int i = 0; i < bus_config.servo_count; i++) {
+        print_servo_state(i);
+    }
+}
+
+static const command_t servo_bus_commands[] = {
+    {"servo", handle_servo, "servo [<id> <angle> [time_ms]] | sync <time_ms> <id> <angle>... | poll [hz]: 舵机总线状态、运动、同步组运动与轮询预算。"},
+};
+
+void servo_bus_register_commands(void) {
+    uart_parser_register_commands(servo_bus_commands, sizeof(servo_bus_commands) / sizeof(servo_bus_commands[0]));
+}
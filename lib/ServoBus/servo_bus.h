@@ -0,0 +1,150 @@
+#ifndef SERVO_BUS_H
+#define SERVO_BUS_H
+
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+#include "data_service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 总线上最多可管理的舵机数 (与 DataPlatform 的舵机分段数一致)
+ */
+#define SERVO_BUS_MAX_SERVOS          DATA_SERVICE_MAX_SERVOS
+
+/**
+ * @brief 广播ID，总线上所有舵机都会执行 (舵机不应答)
+ */
+#define SERVO_BUS_BROADCAST_ID        0xFE
+
+/**
+ * @brief 轮询预算上限 (总线事务数/秒)
+ */
+#define SERVO_BUS_MAX_POLL_HZ         500
+
+/**
+ * @brief 命令队列深度
+ */
+#ifndef SERVO_BUS_MOVE_QUEUE_LEN
+#define SERVO_BUS_MOVE_QUEUE_LEN      8
+#endif
+#ifndef SERVO_BUS_READ_QUEUE_LEN
+#define SERVO_BUS_READ_QUEUE_LEN      8
+#endif
+
+/**
+ * @brief 读取请求的字段掩码
+ */
+#define SERVO_BUS_READ_POSITION       (1 << 0)
+#define SERVO_BUS_READ_TEMP           (1 << 1)
+#define SERVO_BUS_READ_VOLTAGE        (1 << 2)
+#define SERVO_BUS_READ_ALL            (SERVO_BUS_READ_POSITION | SERVO_BUS_READ_TEMP | SERVO_BUS_READ_VOLTAGE)
+
+// 舵机总线配置结构体
+typedef struct {
+    int8_t   rx_pin;                          // 串口RX引脚
+    int8_t   tx_pin;                          // 串口TX引脚
+    uint32_t baud_rate;                       // 串口波特率
+    uint8_t  servo_ids[SERVO_BUS_MAX_SERVOS]; // 总线上的舵机ID
+    uint8_t  servo_count;                     // 舵机数量
+    uint16_t response_timeout_ms;             // 单次读取的应答超时
+    uint16_t poll_budget_hz;                  // 轮询读取占用的总线事务数/秒 (所有舵机合计，0 = 不轮询)
+    uint8_t  poll_fields;                     // 轮询读取的字段 (SERVO_BUS_READ_*)
+    uint32_t stack_size;                      // 总线任务栈大小 (任务规划表中没有 "Servo_Bus" 时使用，0 = 默认值)
+    UBaseType_t priority;                     // 总线任务优先级 (同上)
+} servo_bus_config_t;
+
+// 总线统计信息
+typedef struct {
+    uint32_t moves;              // 已发送的运动命令数
+    uint32_t group_moves;        // 已触发的同步组运动数
+    uint32_t polls;              // 轮询发起的读取事务数
+    uint32_t reads;              // 已完成的读取事务数 (每个字段一次)
+    uint32_t timeouts;           // 读取超时/失败次数
+    uint32_t move_failures;      // 运动命令发送失败次数
+    uint32_t move_queue_full;    // 运动队列已满导致丢弃的命令数
+    uint32_t read_queue_full;    // 读取队列已满导致丢弃的请求数
+    uint32_t max_move_wait_us;   // 运动命令从入队到发出的最长等待时间
+    uint32_t max_transaction_us; // 单次总线事务的最长耗时
+} servo_bus_stats_t;
+
+/**
+ * @brief 初始化舵机总线并启动总线任务 (独占 Serial2)
+ * @param config 总线配置
+ * @return ESP_OK 成功
+ */
+esp_err_t servo_bus_init(const servo_bus_config_t* config);
+
+/**
+ * @brief 将运动命令加入队列 (不阻塞，任何任务都可以调用)
+ * @details 运动命令优先于读取请求执行，并在发出后更新 DataPlatform 中的目标角度。
+ * @param id       舵机ID (必须在配置的 servo_ids 中)
+ * @param angle    目标角度 (度)
+ * @param time_ms  运动时间
+ * @return ESP_OK 已入队；ESP_ERR_INVALID_ARG 未知舵机；ESP_ERR_NO_MEM 队列已满；ESP_ERR_INVALID_STATE 未初始化
+ */
+esp_err_t servo_bus_move(uint8_t id, float angle, uint16_t time_ms);
+
+/**
+ * @brief 将同步组运动加入队列 (不阻塞)
+ * @details 总线任务先用 "延迟运动" 命令把目标预装到每个舵机 (舵机收到后不动)，
+ *          再发送一条广播启动命令，所有舵机在同一时刻开始运动，
+ *          不会因逐个发送而产生与总线往返时间相当的舵机间偏差。
+ * @param ids      舵机ID数组
+ * @param angles   目标角度数组 (度)，与 ids 一一对应
+ * @param count    舵机数量 (1 到 SERVO_BUS_MAX_SERVOS)
+ * @param time_ms  运动时间 (所有舵机相同，同时到达)
+ * @return 同 servo_bus_move()
+ */
+esp_err_t servo_bus_group_move(const uint8_t* ids, const float* angles, uint8_t count, uint16_t time_ms);
+
+/**
+ * @brief 将读取请求加入队列 (不阻塞，任何任务都可以调用)
+ * @details 读取完成后结果写入 DataPlatform 并设置 BIT_EVENT_SERVO_UPDATED。
+ * @param id     舵机ID
+ * @param fields SERVO_BUS_READ_* 字段掩码
+ * @return 同 servo_bus_move()
+ */
+esp_err_t servo_bus_request_read(uint8_t id, uint8_t fields);
+
+/**
+ * @brief 获取舵机在 DataPlatform 中的分段下标
+ * @param id 舵机ID
+ * @return 分段下标，未知舵机返回 -1
+ */
+int servo_bus_get_slot(uint8_t id);
+
+/**
+ * @brief 设置轮询预算
+ * @details 轮询器按 "舵机 x 字段" 轮转，每个周期只发起一次读取事务，
+ *          因此每个舵机每个字段的刷新频率约为 budget / (舵机数 x 字段数)。
+ *          运动命令和显式读取请求总是优先于轮询。
+ * @param budget_hz 总线事务数/秒 (0 = 停止轮询，最大 SERVO_BUS_MAX_POLL_HZ)
+ * @return ESP_OK 成功；ESP_ERR_INVALID_ARG 超出范围
+ */
+esp_err_t servo_bus_set_poll_budget(uint16_t budget_hz);
+
+/**
+ * @brief 获取当前轮询预算 (总线事务数/秒)
+ */
+uint16_t servo_bus_get_poll_budget(void);
+
+/**
+ * @brief 获取总线统计信息
+ */
+void servo_bus_get_stats(servo_bus_stats_t* stats);
+
+/**
+ * @brief 注册 'servo' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void servo_bus_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERVO_BUS_H
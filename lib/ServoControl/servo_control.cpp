@@ -0,0 +1,258 @@
+#include "servo_control.h"
+#include "servo_bus.h"
+#include "data_service.h"
+#include "uart_parser.h"
+#include "task_plan.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* TAG = "SERVO_CONTROL";
+
+// 单个映射的运行时状态
+typedef struct {
+    float filtered;       // 平滑后的目标角度
+    float command;        // 经速率限制后的角度
+    float last_sent;      // 最近一次成功提交的角度
+    bool  primed;         // 已收到第一次输入
+    bool  sent;           // 已经提交过命令
+} mapping_state_t;
+
+// 全局变量
+static servo_control_config_t control_config;
+static mapping_state_t mapping_state[SERVO_CONTROL_MAX_MAPPINGS];
+static TaskHandle_t control_task = NULL;
+static volatile bool control_enabled = true;
+static servo_control_stats_t control_stats;
+static uint32_t last_input_version = 0;     // 摇杆与编码器分段版本号之和，用于判断是否有新输入
+
+static float clampf(float value, float min_value, float max_value) {
+    if (value < min_value) return min_value;
+    if (value > max_value) return max_value;
+    return value;
+}
+
+// 读取映射的输入值
+static float read_source(servo_control_source_t source, const joystick_data_t* joystick,
+                         const encoder_data_t* encoder) {
+    switch (source) {
+        case SERVO_CONTROL_SOURCE_JOYSTICK_X: return joystick->in_deadzone ? 0.0f : (float)joystick->x;
+        case SERVO_CONTROL_SOURCE_JOYSTICK_Y: return joystick->in_deadzone ? 0.0f : (float)joystick->y;
+        case SERVO_CONTROL_SOURCE_ENCODER:    return (float)encoder->position;
+        default:                              return 0.0f;
+    }
+}
+
+// 一个控制周期：输入 -> 映射 -> 平滑 -> 速率限制 -> 提交舵机总线
+// 返回 true 表示所有舵机已到达目标且命令已发出 (没有新输入时无需继续推进)
+static bool control_step(float dt_s) {
+    joystick_data_t joystick;
+    encoder_data_t encoder;
+    uint32_t version = data_service_get_joystick(&joystick) + data_service_get_encoder(&encoder);
+    if (version != last_input_version) {
+        last_input_version = version;
+        control_stats.input_events++;
+    }
+
+    uint8_t ids[SERVO_CONTROL_MAX_MAPPINGS];
+    float angles[SERVO_CONTROL_MAX_MAPPINGS];
+    uint8_t indices[SERVO_CONTROL_MAX_MAPPINGS];
+    uint8_t count = 0;
+    bool settled = true;
+
+    for (uint8_t i = 0; i < control_config.mapping_count; i++) {
+        const servo_control_mapping_t* mapping = &control_config.mappings[i];
+        mapping_state_t* state = &mapping_state[i];
+
+        float target = mapping->center_deg + read_source(mapping->source, &joystick, &encoder) * mapping->scale_deg;
+        target = clampf(target, mapping->min_deg, mapping->max_deg);
+
+        if (!state->primed) {
+            state->filtered = target;
+            state->command = target;
+            state->primed = true;
+        } else {
+            state->filtered += (target - state->filtered) * mapping->smoothing;
+            float step = state->filtered - state->command;
+            if (mapping->max_rate_deg_s > 0) {
+                float max_step = mapping->max_rate_deg_s * dt_s;
+                step = clampf(step, -max_step, max_step);
+            }
+            state->command += step;
+        }
+        if (fabsf(target - state->command) >= control_config.deadband_deg) {
+            settled = false;
+        }
+
+        if (!state->sent || fabsf(state->command - state->last_sent) >= control_config.deadband_deg) {
+            ids[count] = mapping->servo_id;
+            angles[count] = state->command;
+            indices[count] = i;
+            count++;
+        }
+    }
+
+    if (count == 0 || !control_enabled) {
+        return settled && count == 0;
+    }
+
+    // 运动时间取一个控制周期，舵机在下一次命令到达前刚好走完这一步
+    uint16_t time_ms = (uint16_t)(1000 / control_config.update_rate_hz);
+    esp_err_t ret = (count == 1) ? servo_bus_move(ids[0], angles[0], time_ms)
+                                 : servo_bus_group_move(ids, angles, count, time_ms);
+    if (ret != ESP_OK) {
+        // 总线队列已满，保留当前状态，下个周期重新比较后再发送
+        control_stats.bus_busy++;
+        return false;
+    }
+    control_stats.commands++;
+    for (uint8_t i = 0; i < count; i++) {
+        mapping_state[indices[i]].last_sent = angles[i];
+        mapping_state[indices[i]].sent = true;
+    }
+    return settled;
+}
+
+// 控制任务：被摇杆/编码器更新事件唤醒；平滑/速率限制尚未收敛时按控制周期继续推进，
+// 收敛后一直等待下一次输入，新输入到达即可立即处理
+static void servo_control_task(void* parameter) {
+    // 只需要最新值：不建立环形缓冲区读游标，否则从不取出的读游标会一直显示为积压
+    const int subscriber = data_service_subscribe_latest(BIT_EVENT_JOYSTICK_UPDATED | BIT_EVENT_ENCODER_UPDATED);
+    const TickType_t period_ticks = pdMS_TO_TICKS(1000 / control_config.update_rate_hz) > 0 ?
+                                    pdMS_TO_TICKS(1000 / control_config.update_rate_hz) : 1;
+    const int64_t min_interval_us = 1000000LL / control_config.update_rate_hz;
+    int64_t last_step_us = esp_timer_get_time();
+    bool settled = false;
+
+    if (subscriber < 0) {
+        ESP_LOGE(TAG, "Failed to subscribe to DataPlatform");
+        control_task = NULL;
+        task_plan_delete(NULL);
+        return;
+    }
+
+    ESP_LOGI(TAG, "Servo control task started on core %d, %d mapping(s) at %d Hz",
+             xPortGetCoreID(), control_config.mapping_count, control_config.update_rate_hz);
+
+    while (1) {
+        // 是否有新输入由分段版本号判断
+        data_service_wait(subscriber, settled ? portMAX_DELAY : period_ticks);
+
+        int64_t now_us = esp_timer_get_time();
+        int64_t elapsed_us = now_us - last_step_us;
+        if (elapsed_us < min_interval_us) {
+            // 传感器更新比控制周期更快：等到本周期结束再处理，保证命令速率不超过 update_rate_hz
+            vTaskDelay(pdMS_TO_TICKS((uint32_t)((min_interval_us - elapsed_us + 999) / 1000)));
+            now_us = esp_timer_get_time();
+            elapsed_us = now_us - last_step_us;
+        }
+        last_step_us = now_us;
+
+        // 长时间空闲后 dt 按一个周期计算，避免速率限制被一次放开
+        float dt_s = (float)(elapsed_us < 2 * min_interval_us ? elapsed_us : min_interval_us) / 1000000.0f;
+        settled = control_step(dt_s);
+        control_stats.ticks++;
+
+        uint32_t exec_us = (uint32_t)(esp_timer_get_time() - now_us);
+        if (exec_us > control_stats.max_exec_us) {
+            control_stats.max_exec_us = exec_us;
+        }
+    }
+}
+
+esp_err_t servo_control_init(const servo_control_config_t* config) {
+    if (config == NULL || config->mapping_count == 0 || config->mapping_count > SERVO_CONTROL_MAX_MAPPINGS ||
+        config->update_rate_hz == 0 || config->update_rate_hz > 1000) {
+        ESP_LOGE(TAG, "Invalid servo control config");
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (control_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (data_service_get_event_group_handle() == NULL) {
+        ESP_LOGE(TAG, "DataPlatform not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    control_config = *config;
+    for (uint8_t i = 0; i < control_config.mapping_count; i++) {
+        servo_control_mapping_t* mapping = &control_config.mappings[i];
+        if (servo_bus_get_slot(mapping->servo_id) < 0) {
+            ESP_LOGE(TAG, "Servo %d is not on the servo bus", mapping->servo_id);
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (mapping->smoothing <= 0.0f || mapping->smoothing > 1.0f) {
+            mapping->smoothing = 1.0f;
+        }
+        if (mapping->min_deg > mapping->max_deg) {
+            float tmp = mapping->min_deg;
+            mapping->min_deg = mapping->max_deg;
+            mapping->max_deg = tmp;
+        }
+    }
+    memset(mapping_state, 0, sizeof(mapping_state));
+    memset(&control_stats, 0, sizeof(control_stats));
+    last_input_version = 0;
+
+    if (task_plan_create(servo_control_task, "Servo_Control", control_config.stack_size, NULL,
+                         control_config.priority, &control_task, control_config.core_id) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create servo control task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void servo_control_set_enabled(bool enabled) {
+    control_enabled = enabled;
+    ESP_LOGI(TAG, "Local servo control %s", enabled ? "enabled" : "disabled");
+}
+
+bool servo_control_is_enabled(void) {
+    return control_enabled;
+}
+
+void servo_control_get_stats(servo_control_stats_t* stats) {
+    *stats = control_stats;
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+static void handle_servo_control(int argc, char *argv[]) {
+    if (control_task == NULL) {
+        uart_parser_put_string("Servo control not initialized.\r\n");
+        return;
+    }
+
+    if (argc >= 2) {
+        if (strcmp(argv[1], "on") == 0) {
+            servo_control_set_enabled(true);
+        } else if (strcmp(argv[1], "off") == 0) {
+            servo_control_set_enabled(false);
+        } else {
+            uart_parser_put_string("Usage: servo_control [on|off]\r\n");
+            return;
+        }
+    }
+
+    char response[192];
+    servo_control_stats_t stats;
+    servo_control_get_stats(&stats);
+    snprintf(response, sizeof(response),
+             "Servo control: %s  %d Hz  ticks %lu  input events %lu  commands %lu  bus busy %lu  max exec %lu us\r\n",
+             servo_control_is_enabled() ? "on" : "off", control_config.update_rate_hz,
+             (unsigned long)stats.ticks, (unsigned long)stats.input_events,
+             (unsigned long)stats.commands, (unsigned long)stats.bus_busy,
+             (unsigned long)stats.max_exec_us);
+    uart_parser_put_string(response);
+}
+
+static const command_t servo_control_commands[] = {
+    {"servo_control", handle_servo_control, "servo_control [on|off]: 查看或启停摇杆/编码器到舵机的本地控制。"},
+};
+
+void servo_control_register_commands(void) {
+    uart_parser_register_commands(servo_control_commands,
+                                  sizeof(servo_control_commands) / sizeof(servo_control_commands[0]));
+}
@@ -0,0 +1,90 @@
+#ifndef SERVO_CONTROL_H
+#define SERVO_CONTROL_H
+
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 最多可配置的 "输入 -> 舵机" 映射数
+ */
+#ifndef SERVO_CONTROL_MAX_MAPPINGS
+#define SERVO_CONTROL_MAX_MAPPINGS    4
+#endif
+
+// 映射的输入源
+typedef enum {
+    SERVO_CONTROL_SOURCE_JOYSTICK_X = 0,  // 摇杆X轴 (-512 到 +512)
+    SERVO_CONTROL_SOURCE_JOYSTICK_Y,      // 摇杆Y轴 (-512 到 +512)
+    SERVO_CONTROL_SOURCE_ENCODER,         // 编码器位置 (计数)
+} servo_control_source_t;
+
+// 单个 "输入 -> 舵机" 映射
+typedef struct {
+    uint8_t servo_id;                 // 目标舵机ID (必须已在 servo_bus 中配置)
+    servo_control_source_t source;    // 输入源
+    float center_deg;                 // 输入为 0 时的角度
+    float scale_deg;                  // 每单位输入对应的角度 (摇杆: 512 * scale 为满偏角度)
+    float min_deg;                    // 角度下限
+    float max_deg;                    // 角度上限
+    float max_rate_deg_s;             // 速率限制 (度/秒，0 = 不限制)
+    float smoothing;                  // 一阶低通系数 (0-1]，1 = 不平滑
+} servo_control_mapping_t;
+
+// 控制任务配置
+typedef struct {
+    servo_control_mapping_t mappings[SERVO_CONTROL_MAX_MAPPINGS];
+    uint8_t mapping_count;
+    uint16_t update_rate_hz;          // 控制周期频率，也是无新输入时平滑/速率限制继续推进的频率
+    float deadband_deg;               // 与上次下发的角度相差小于该值时不发送命令
+    uint32_t stack_size;              // 控制任务栈大小 (任务规划表中没有 "Servo_Control" 时使用，0 = 默认值)
+    UBaseType_t priority;             // 控制任务优先级 (同上)
+    BaseType_t core_id;               // 绑定的CPU核心 (同上，0/1，tskNO_AFFINITY = 不绑定)
+} servo_control_config_t;
+
+// 控制统计信息
+typedef struct {
+    uint32_t ticks;                   // 控制周期数
+    uint32_t input_events;            // 检测到新输入 (摇杆/编码器数据版本变化) 的周期数
+    uint32_t commands;                // 已提交到舵机总线的命令数
+    uint32_t bus_busy;                // 舵机总线队列已满而推迟的次数
+    uint32_t max_exec_us;             // 单个控制周期的最长执行时间
+} servo_control_stats_t;
+
+/**
+ * @brief 初始化并启动控制任务 (依赖 DataPlatform 与 servo_bus 已初始化)
+ * @param config 控制配置
+ * @return ESP_OK 成功
+ */
+esp_err_t servo_control_init(const servo_control_config_t* config);
+
+/**
+ * @brief 启用/停用本地控制 (停用后不再向舵机发送命令，默认启用)
+ */
+void servo_control_set_enabled(bool enabled);
+
+/**
+ * @brief 本地控制是否启用
+ */
+bool servo_control_is_enabled(void);
+
+/**
+ * @brief 获取控制统计信息
+ */
+void servo_control_get_stats(servo_control_stats_t* stats);
+
+/**
+ * @brief 注册 'servo_control' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void servo_control_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERVO_CONTROL_H
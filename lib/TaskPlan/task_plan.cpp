@@ -0,0 +1,225 @@
+#include "task_plan.h"
+#include "uart_parser.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "TASK_PLAN";
+
+// 已创建任务的记录
+typedef struct {
+    bool in_use;
+    const char* name;
+    uint32_t stack_size;
+    UBaseType_t priority;
+    BaseType_t core_id;
+    bool planned;             // 参数来自规划表
+    TaskHandle_t handle;
+} task_record_t;
+
+// 全局变量
+static const task_plan_entry_t* plan_table = NULL;
+static size_t plan_count = 0;
+static task_record_t task_records[TASK_PLAN_MAX_TASKS];
+static portMUX_TYPE task_records_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void task_plan_init(const task_plan_entry_t* table, size_t count) {
+    plan_table = table;
+    plan_count = (table != NULL) ? count : 0;
+}
+
+const task_plan_entry_t* task_plan_find(const char* name) {
+    if (name == NULL) {
+        return NULL;
+    }
+    for (size_t i = 0; i < plan_count; i++) {
+        if (strcmp(plan_table[i].name, name) == 0) {
+            return &plan_table[i];
+        }
+    }
+    return NULL;
+}
+
+// 预留一条记录 (任务创建不能放在临界区内，先占位再创建)
+static task_record_t* reserve_record(void) {
+    task_record_t* record = NULL;
+    portENTER_CRITICAL(&task_records_mux);
+    for (int i = 0; i < TASK_PLAN_MAX_TASKS; i++) {
+        if (!task_records[i].in_use) {
+            record = &task_records[i];
+            memset(record, 0, sizeof(*record));
+            record->in_use = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&task_records_mux);
+    return record;
+}
+
+static void release_record(task_record_t* record) {
+    portENTER_CRITICAL(&task_records_mux);
+    record->handle = NULL;
+    record->in_use = false;
+    portEXIT_CRITICAL(&task_records_mux);
+}
+
+BaseType_t task_plan_create(TaskFunction_t task_code, const char* name, uint32_t stack_size, void* parameter,
+                            UBaseType_t priority, TaskHandle_t* handle, BaseType_t core_id) {
+    const task_plan_entry_t* entry = task_plan_find(name);
+    if (entry != NULL) {
+        stack_size = entry->stack_size;
+        priority = entry->priority;
+        core_id = entry->core_id;
+    } else {
+        if (stack_size == 0) {
+            stack_size = TASK_PLAN_DEFAULT_STACK_SIZE;
+            priority = TASK_PLAN_DEFAULT_PRIORITY;
+        }
+        ESP_LOGW(TAG, "Task '%s' is not in the task plan, using prio %d core %d", name ? name : "?",
+                 (int)priority, (int)core_id);
+    }
+
+    task_record_t* record = reserve_record();
+    if (record == NULL) {
+        ESP_LOGW(TAG, "Task record table full, '%s' will not be listed", name ? name : "?");
+    } else {
+        record->name = name;
+        record->stack_size = stack_size;
+        record->priority = priority;
+        record->core_id = core_id;
+        record->planned = (entry != NULL);
+    }
+
+    // 句柄在新任务开始运行前写入记录，任务立即调用 task_plan_delete(NULL) 时也能找到
+    TaskHandle_t created = NULL;
+    BaseType_t ret = xTaskCreatePinnedToCore(task_code, name, stack_size, parameter, priority,
+                                             record != NULL ? &record->handle : &created, core_id);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create task '%s'", name ? name : "?");
+        if (record != NULL) {
+            release_record(record);
+        }
+        return ret;
+    }
+    if (record != NULL) {
+        created = record->handle;
+    }
+    if (handle != NULL) {
+        *handle = created;
+    }
+    return pdPASS;
+}
+
+void task_plan_delete(TaskHandle_t handle) {
+    if (handle == NULL) {
+        handle = xTaskGetCurrentTaskHandle();
+    }
+    portENTER_CRITICAL(&task_records_mux);
+    for (int i = 0; i < TASK_PLAN_MAX_TASKS; i++) {
+        if (task_records[i].in_use && task_records[i].handle == handle) {
+            task_records[i].handle = NULL;
+            task_records[i].in_use = false;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&task_records_mux);
+    vTaskDelete(handle);
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+static const char* core_name(BaseType_t core_id, char* buffer, size_t size) {
+    if (core_id == tskNO_AFFINITY) {
+        return "any";
+    }
+    snprintf(buffer, size, "%d", (int)core_id);
+    return buffer;
+}
+
+// 打印当前记录的任务：规划参数 + 实时优先级和栈高水位 (剩余栈的历史最小值)
+// 在系统快照中查找任务 (已删除、等待空闲任务释放的任务视为不存在)
+static const TaskStatus_t* find_status(const TaskStatus_t* status, UBaseType_t count, TaskHandle_t handle) {
+    for (UBaseType_t i = 0; i < count; i++) {
+        if (status[i].xHandle == handle && status[i].eCurrentState != eDeleted) {
+            return &status[i];
+        }
+    }
+    return NULL;
+}
+
+static void handle_tasks(int argc, char *argv[]) {
+    char response[128];
+    char core_buffer[8];
+    int listed = 0;
+
+    // 栈高水位和优先级取自 uxTaskGetSystemState() 的快照 (在调度器挂起时生成)，
+    // 不直接用记录中的句柄查询：自行调用 task_plan_delete(NULL) 的任务随时可能被删除，句柄指向的 TCB 可能已释放
+    // 快照和记录副本共约 1.5KB，不放在命令处理任务的栈上 (命令也可能从网络任务调用，不用静态缓冲区)
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 4;
+    task_record_t* records = (task_record_t*)malloc(sizeof(task_record_t) * TASK_PLAN_MAX_TASKS +
+                                                    sizeof(TaskStatus_t) * capacity);
+    if (records == NULL) {
+        uart_parser_put_string("Error: Out of memory\r\n");
+        return;
+    }
+    TaskStatus_t* status = (TaskStatus_t*)(records + TASK_PLAN_MAX_TASKS);
+    UBaseType_t status_count = uxTaskGetSystemState(status, capacity, NULL);
+
+    // 记录整体复制后在临界区外格式化 (快照之后才删除的任务仍然列出，数据来自快照)
+    portENTER_CRITICAL(&task_records_mux);
+    memcpy(records, task_records, sizeof(task_records));
+    portEXIT_CRITICAL(&task_records_mux);
+
+    uart_parser_put_string("Task                  Core  Prio  Stack  MinFree  Used\r\n");
+    for (int i = 0; i < TASK_PLAN_MAX_TASKS; i++) {
+        const task_record_t* record = &records[i];
+        if (!record->in_use || record->handle == NULL) {
+            continue;
+        }
+        const TaskStatus_t* task = find_status(status, status_count, record->handle);
+        if (task == NULL) {
+            continue;
+        }
+
+        uint32_t min_free = task->usStackHighWaterMark;   // ESP32 上单位为字节
+        uint32_t used_pct = record->stack_size > 0 ? (record->stack_size - min_free) * 100 / record->stack_size : 0;
+        snprintf(response, sizeof(response), "%c%-20s  %4s  %4u  %5lu  %7lu  %3lu%%\r\n",
+                 record->planned ? ' ' : '*', record->name,
+                 core_name(record->core_id, core_buffer, sizeof(core_buffer)),
+                 (unsigned)task->uxCurrentPriority, (unsigned long)record->stack_size,
+                 (unsigned long)min_free, (unsigned long)used_pct);
+        uart_parser_put_string(response);
+        listed++;
+    }
+
+    // 规划表中尚未启动的任务 (使用同一份记录副本)
+    for (size_t i = 0; i < plan_count; i++) {
+        bool running = false;
+        for (int j = 0; j < TASK_PLAN_MAX_TASKS && !running; j++) {
+            running = records[j].in_use && records[j].handle != NULL &&
+                      find_status(status, status_count, records[j].handle) != NULL &&
+                      strcmp(records[j].name, plan_table[i].name) == 0;
+        }
+        if (!running) {
+            snprintf(response, sizeof(response), " %-20s  %4s  %4u  %5lu  (not running)\r\n",
+                     plan_table[i].name, core_name(plan_table[i].core_id, core_buffer, sizeof(core_buffer)),
+                     (unsigned)plan_table[i].priority, (unsigned long)plan_table[i].stack_size);
+            uart_parser_put_string(response);
+        }
+    }
+
+    snprintf(response, sizeof(response), "%d task(s) running, %u total in system. * = not in task plan\r\n",
+             listed, (unsigned)status_count);
+    uart_parser_put_string(response);
+    free(records);
+}
+
+static const command_t task_plan_commands[] = {
+    {"tasks", handle_tasks, "列出任务规划表 (核心/优先级/栈) 及各任务的实时栈高水位。"},
+};
+
+void task_plan_register_commands(void) {
+    uart_parser_register_commands(task_plan_commands,
+                                  sizeof(task_plan_commands) / sizeof(task_plan_commands[0]));
+}
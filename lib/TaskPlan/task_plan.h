@@ -0,0 +1,81 @@
+#ifndef TASK_PLAN_H
+#define TASK_PLAN_H
+
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 核心分配
+ * @details ESP32 的 WiFi/lwIP 协议栈和 esp_timer 任务运行在核心0 (PRO_CPU)，
+ *          采样、控制等对时序敏感的任务放在核心1 (APP_CPU)，避免 WiFi 突发流量带来的调度抖动。
+ */
+#define TASK_PLAN_CORE_NETWORK    0
+#define TASK_PLAN_CORE_REALTIME   1
+
+/**
+ * @brief 最多可记录的任务数 (规划表中的任务 + 未列入规划表的任务)
+ * @note 启动时并行初始化的工作任务 (Boot_Worker) 同时占用记录，完成后释放
+ */
+#ifndef TASK_PLAN_MAX_TASKS
+#define TASK_PLAN_MAX_TASKS       20
+#endif
+
+/**
+ * @brief 规划表和调用方都未给出参数时使用的默认值
+ */
+#define TASK_PLAN_DEFAULT_STACK_SIZE   2048
+#define TASK_PLAN_DEFAULT_PRIORITY     (tskIDLE_PRIORITY + 1)
+
+// 任务规划表项
+typedef struct {
+    const char* name;            // 任务名 (与创建任务时的名称一致)
+    uint32_t stack_size;         // 任务栈大小 (字节)
+    UBaseType_t priority;        // 任务优先级
+    BaseType_t core_id;          // 绑定的核心 (TASK_PLAN_CORE_*，tskNO_AFFINITY = 不绑定)
+} task_plan_entry_t;
+
+/**
+ * @brief 设置任务规划表 (在创建任何任务之前调用)
+ * @param table 规划表，必须在程序运行期间一直有效
+ * @param count 表项数量
+ */
+void task_plan_init(const task_plan_entry_t* table, size_t count);
+
+/**
+ * @brief 按规划表创建任务，参数顺序与 xTaskCreatePinnedToCore() 相同
+ * @details 任务名在规划表中时使用表中的栈大小、优先级和核心，传入的参数只作为
+ *          未列入规划表时的默认值 (stack_size 为 0 时使用 TASK_PLAN_DEFAULT_*)。
+ *          创建成功的任务都会被记录，供 'tasks' 串口命令查看。
+ * @return pdPASS 成功
+ */
+BaseType_t task_plan_create(TaskFunction_t task_code, const char* name, uint32_t stack_size, void* parameter,
+                            UBaseType_t priority, TaskHandle_t* handle, BaseType_t core_id);
+
+/**
+ * @brief 删除任务并清除记录 (handle 为 NULL 时删除当前任务)
+ * @details 由 task_plan_create() 创建的任务必须用它代替 vTaskDelete()，
+ *          否则 'tasks' 命令会查询已经释放的任务句柄。
+ */
+void task_plan_delete(TaskHandle_t handle);
+
+/**
+ * @brief 查找任务的规划表项
+ * @return 表项指针，未列入规划表返回 NULL
+ */
+const task_plan_entry_t* task_plan_find(const char* name);
+
+/**
+ * @brief 注册 'tasks' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void task_plan_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_PLAN_H
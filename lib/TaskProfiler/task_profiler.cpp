@@ -0,0 +1,273 @@
+#include "task_profiler.h"
+#include "data_service.h"
+#include "task_plan.h"
+#include "uart_parser.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "TASK_PROFILER";
+
+// 全局变量
+static TaskHandle_t profiler_task = NULL;
+static volatile uint32_t profiler_window_ms = TASK_PROFILER_DEFAULT_WINDOW_MS;
+static volatile bool profiler_export = TASK_PROFILER_EXPORT_DEFAULT;
+static volatile uint32_t profiler_cost_us = 0;      // 最近一个窗口的剖析耗时
+
+#if configUSE_TRACE_FACILITY
+// 两份快照交替使用：上一个窗口结束时的快照与本窗口结束时的快照
+static TaskStatus_t snapshot_buffers[2][TASK_PROFILER_MAX_TASKS];
+#endif
+
+static bool window_is_valid(uint32_t window_ms) {
+    return window_ms >= TASK_PROFILER_MIN_WINDOW_MS && window_ms <= TASK_PROFILER_MAX_WINDOW_MS;
+}
+
+#if configUSE_TRACE_FACILITY
+// 按 CPU 占用降序插入，只保留前 DATA_SERVICE_PROFILE_MAX_TASKS 个
+static void insert_sorted(system_profile_t* profile, const task_profile_t* entry) {
+    int pos = profile->task_count;
+    while (pos > 0 && profile->tasks[pos - 1].cpu_permille < entry->cpu_permille) {
+        pos--;
+    }
+    if (pos >= DATA_SERVICE_PROFILE_MAX_TASKS) {
+        return;
+    }
+    int last = (profile->task_count < DATA_SERVICE_PROFILE_MAX_TASKS) ? profile->task_count
+                                                                     : DATA_SERVICE_PROFILE_MAX_TASKS - 1;
+    memmove(&profile->tasks[pos + 1], &profile->tasks[pos], (last - pos) * sizeof(task_profile_t));
+    profile->tasks[pos] = *entry;
+    if (profile->task_count < DATA_SERVICE_PROFILE_MAX_TASKS) {
+        profile->task_count++;
+    }
+}
+#endif
+
+// 剖析任务：每个窗口结束时生成一次系统负载快照
+static void task_profiler_task(void* parameter) {
+    static system_profile_t profile;    // 约 0.5KB，放在静态区而不是任务栈上
+    int64_t last_window_us = esp_timer_get_time();
+#if configUSE_TRACE_FACILITY
+    TaskStatus_t* prev = snapshot_buffers[0];
+    TaskStatus_t* curr = snapshot_buffers[1];
+    uint32_t prev_total = 0;
+    UBaseType_t prev_count = uxTaskGetSystemState(prev, TASK_PROFILER_MAX_TASKS, &prev_total);
+#endif
+
+    ESP_LOGI(TAG, "Task profiler started, window %lu ms", (unsigned long)profiler_window_ms);
+
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(profiler_window_ms));
+
+        int64_t start_us = esp_timer_get_time();
+        memset(&profile, 0, sizeof(profile));
+        profile.window_ms = (uint32_t)((start_us - last_window_us) / 1000);
+        last_window_us = start_us;
+
+#if configUSE_TRACE_FACILITY
+        uint32_t total = 0;
+        UBaseType_t count = uxTaskGetSystemState(curr, TASK_PROFILER_MAX_TASKS, &total);
+        profile.total_tasks = (uint8_t)uxTaskGetNumberOfTasks();
+        if (count == 0 || profile.total_tasks > TASK_PROFILER_MAX_TASKS) {
+            profile.flags |= PROFILE_FLAG_TRUNCATED;
+        }
+#if configGENERATE_RUN_TIME_STATS
+        // 运行时间计数器按单个核心计时，各任务占用相对于一个核心的时间
+        uint32_t total_delta = total - prev_total;
+        if (total_delta > 0 && prev_count > 0) {
+            profile.flags |= PROFILE_FLAG_CPU_VALID;
+        }
+#endif
+
+        for (UBaseType_t i = 0; i < count; i++) {
+            const TaskStatus_t* status = &curr[i];
+            task_profile_t entry;
+            memset(&entry, 0, sizeof(entry));
+            strncpy(entry.name, status->pcTaskName, sizeof(entry.name) - 1);
+            entry.priority = (uint8_t)status->uxCurrentPriority;
+            entry.stack_free = status->usStackHighWaterMark;   // ESP32 上单位为字节
+#if configTASKLIST_INCLUDE_COREID
+            entry.core = (status->xCoreID == tskNO_AFFINITY) ? 0xFF : (uint8_t)status->xCoreID;
+#else
+            entry.core = 0xFF;
+#endif
+
+#if configGENERATE_RUN_TIME_STATS
+            if (profile.flags & PROFILE_FLAG_CPU_VALID) {
+                // 本窗口内新建的任务没有上一次快照，按创建以来的全部运行时间计算
+                uint32_t run_delta = status->ulRunTimeCounter;
+                for (UBaseType_t j = 0; j < prev_count; j++) {
+                    if (prev[j].xHandle == status->xHandle) {
+                        run_delta = status->ulRunTimeCounter - prev[j].ulRunTimeCounter;
+                        break;
+                    }
+                }
+                uint32_t permille = (uint32_t)((uint64_t)run_delta * 1000 / total_delta);
+                entry.cpu_permille = (uint16_t)(permille > 1000 ? 1000 : permille);
+
+                // 核心负载 = 1000 - 该核心空闲任务的占用
+                for (int core = 0; core < portNUM_PROCESSORS && core < 2; core++) {
+                    if (status->xHandle == xTaskGetIdleTaskHandleForCPU(core)) {
+                        profile.core_load_permille[core] = (uint16_t)(1000 - entry.cpu_permille);
+                    }
+                }
+            }
+#endif
+            insert_sorted(&profile, &entry);
+        }
+
+        TaskStatus_t* swap = prev;
+        prev = curr;
+        curr = swap;
+        prev_count = count;
+        prev_total = total;
+#endif
+
+        profile.heap_free = esp_get_free_heap_size();
+        profile.heap_min_free = esp_get_minimum_free_heap_size();
+        profile.timestamp = xTaskGetTickCount();
+        data_service_update_profile(&profile);
+
+        profiler_cost_us = (uint32_t)(esp_timer_get_time() - start_us);
+    }
+}
+
+esp_err_t task_profiler_init(uint32_t window_ms) {
+    if (!window_is_valid(window_ms)) {
+        ESP_LOGE(TAG, "Invalid window %lu ms", (unsigned long)window_ms);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (profiler_task != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+#if !configGENERATE_RUN_TIME_STATS
+    ESP_LOGW(TAG, "configGENERATE_RUN_TIME_STATS disabled, only stack and heap are reported");
+#endif
+
+    profiler_window_ms = window_ms;
+    if (task_plan_create(task_profiler_task, "Profiler", 3072, NULL, tskIDLE_PRIORITY + 1,
+                         &profiler_task, TASK_PLAN_CORE_NETWORK) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create profiler task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t task_profiler_set_window(uint32_t window_ms) {
+    if (!window_is_valid(window_ms)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    profiler_window_ms = window_ms;
+    return ESP_OK;
+}
+
+uint32_t task_profiler_get_window(void) {
+    return profiler_window_ms;
+}
+
+void task_profiler_set_export(bool enabled) {
+    profiler_export = enabled;
+    ESP_LOGI(TAG, "Profile telemetry export %s", enabled ? "enabled" : "disabled");
+}
+
+bool task_profiler_get_export(void) {
+    return profiler_export;
+}
+
+/* -------------------- 串口命令 -------------------- */
+
+// 千分比格式化为 "12.3"
+static const char* format_permille(uint16_t permille, char* buffer, size_t size) {
+    snprintf(buffer, size, "%u.%u", (unsigned)(permille / 10), (unsigned)(permille % 10));
+    return buffer;
+}
+
+static void print_profile(void) {
+    char response[128];
+    char load0[8], load1[8], cpu[8];
+    system_profile_t profile;
+
+    if (data_service_get_profile(&profile) == 0) {
+        uart_parser_put_string("No profile window completed yet.\r\n");
+        return;
+    }
+
+    if (profile.flags & PROFILE_FLAG_CPU_VALID) {
+        snprintf(response, sizeof(response), "CPU load (%lu ms window): core0 %5s%%  core1 %5s%%\r\n",
+                 (unsigned long)profile.window_ms,
+                 format_permille(profile.core_load_permille[0], load0, sizeof(load0)),
+                 format_permille(profile.core_load_permille[1], load1, sizeof(load1)));
+    } else {
+        snprintf(response, sizeof(response), "CPU load unavailable (FreeRTOS run-time stats disabled)\r\n");
+    }
+    uart_parser_put_string(response);
+
+    snprintf(response, sizeof(response), "Heap: free %lu B  min free %lu B  tasks %u%s  profiler cost %lu us\r\n",
+             (unsigned long)profile.heap_free, (unsigned long)profile.heap_min_free,
+             (unsigned)profile.total_tasks, (profile.flags & PROFILE_FLAG_TRUNCATED) ? " (truncated)" : "",
+             (unsigned long)profiler_cost_us);
+    uart_parser_put_string(response);
+
+    uart_parser_put_string("Task              Core  Prio   CPU%  MinFree\r\n");
+    for (int i = 0; i < profile.task_count; i++) {
+        const task_profile_t* task = &profile.tasks[i];
+        char core[4];
+        if (task->core == 0xFF) {
+            strcpy(core, "-");
+        } else {
+            snprintf(core, sizeof(core), "%u", (unsigned)task->core);
+        }
+        snprintf(response, sizeof(response), " %-16s  %4s  %4u  %5s  %7lu\r\n",
+                 task->name, core, (unsigned)task->priority,
+                 format_permille(task->cpu_permille, cpu, sizeof(cpu)), (unsigned long)task->stack_free);
+        uart_parser_put_string(response);
+    }
+}
+
+static void handle_top(int argc, char *argv[]) {
+    if (profiler_task == NULL) {
+        uart_parser_put_string("Task profiler not initialized.\r\n");
+        return;
+    }
+
+    if (argc >= 2) {
+        if (strcmp(argv[1], "export") == 0) {
+            if (argc >= 3 && strcmp(argv[2], "on") == 0) {
+                task_profiler_set_export(true);
+            } else if (argc >= 3 && strcmp(argv[2], "off") == 0) {
+                task_profiler_set_export(false);
+            } else if (argc >= 3) {
+                uart_parser_put_string("Usage: top export [on|off]\r\n");
+                return;
+            }
+            uart_parser_put_string(task_profiler_get_export() ? "Profile export: on\r\n" : "Profile export: off\r\n");
+            return;
+        }
+
+        char *end = NULL;
+        long window_ms = strtol(argv[1], &end, 10);
+        if (end == argv[1] || *end != '\0' || task_profiler_set_window((uint32_t)window_ms) != ESP_OK) {
+            char response[96];
+            snprintf(response, sizeof(response), "Error: window must be %d-%d ms.\r\n",
+                     TASK_PROFILER_MIN_WINDOW_MS, TASK_PROFILER_MAX_WINDOW_MS);
+            uart_parser_put_string(response);
+            return;
+        }
+        uart_parser_put_string("Profile window updated.\r\n");
+        return;
+    }
+
+    print_profile();
+}
+
+static const command_t task_profiler_commands[] = {
+    {"top", handle_top, "top [window_ms | export on|off]: 查看各任务CPU占用、栈高水位和堆信息。"},
+};
+
+void task_profiler_register_commands(void) {
+    uart_parser_register_commands(task_profiler_commands,
+                                  sizeof(task_profiler_commands) / sizeof(task_profiler_commands[0]));
+}
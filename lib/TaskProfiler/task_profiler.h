@@ -0,0 +1,74 @@
+#ifndef TASK_PROFILER_H
+#define TASK_PROFILER_H
+
+#include "Arduino.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 剖析窗口长度范围 (毫秒)
+ */
+#define TASK_PROFILER_DEFAULT_WINDOW_MS   1000
+#define TASK_PROFILER_MIN_WINDOW_MS       100
+#define TASK_PROFILER_MAX_WINDOW_MS       10000
+
+/**
+ * @brief 快照数组容量，必须不小于系统中的任务总数 (否则 uxTaskGetSystemState() 不返回任何任务)
+ */
+#ifndef TASK_PROFILER_MAX_TASKS
+#define TASK_PROFILER_MAX_TASKS           40
+#endif
+
+/**
+ * @brief 上电时是否通过数据发布任务周期性发送剖析帧，可通过 build_flags 覆盖
+ */
+#ifndef TASK_PROFILER_EXPORT_DEFAULT
+#define TASK_PROFILER_EXPORT_DEFAULT      0
+#endif
+
+/**
+ * @brief 启动剖析任务
+ * @details 每个窗口结束时对比两次 FreeRTOS 运行时间统计快照，得到各任务在窗口内的
+ *          CPU 占用，连同栈高水位和堆信息写入 DataPlatform (BIT_EVENT_PROFILE_UPDATED)。
+ *          每个窗口只调用一次 uxTaskGetSystemState()，不分配内存。
+ * @param window_ms 窗口长度 (TASK_PROFILER_MIN_WINDOW_MS 到 TASK_PROFILER_MAX_WINDOW_MS)
+ * @return ESP_OK 成功
+ */
+esp_err_t task_profiler_init(uint32_t window_ms);
+
+/**
+ * @brief 修改窗口长度 (下一个窗口生效)
+ * @return ESP_OK 成功；ESP_ERR_INVALID_ARG 超出范围
+ */
+esp_err_t task_profiler_set_window(uint32_t window_ms);
+
+/**
+ * @brief 获取窗口长度 (毫秒)
+ */
+uint32_t task_profiler_get_window(void);
+
+/**
+ * @brief 启用/停用剖析结果的遥测导出 (由数据发布任务发送)
+ */
+void task_profiler_set_export(bool enabled);
+
+/**
+ * @brief 剖析结果是否导出到遥测
+ */
+bool task_profiler_get_export(void);
+
+/**
+ * @brief 注册 'top' 串口命令 (在 uart_parser 任务创建后调用)
+ */
+void task_profiler_register_commands(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_PROFILER_H
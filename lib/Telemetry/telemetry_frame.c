@@ -0,0 +1,408 @@
+/**
+ * @file telemetry_frame.c
+ * @brief 遥测帧编码模块实现
+ *
+ * @details
+ * 二进制帧路径只做整数运算和内存拷贝；magnitude / angle 直接使用
+ * joystick_data_t 中的定点字段，避免 snprintf 的浮点格式化开销。
+ * JSON 路径保留旧格式，仅用于调试。
+ */
+
+#include "telemetry_frame.h"
+#include <stdio.h>
+#include <string.h>
+
+_Static_assert(sizeof(telemetry_encoder_payload_t) == 13, "encoder payload layout changed");
+_Static_assert(sizeof(telemetry_joystick_payload_t) == 13, "joystick payload layout changed");
+_Static_assert(sizeof(telemetry_keypad_payload_t) == 6, "keypad payload layout changed");
+_Static_assert(sizeof(telemetry_servo_payload_t) == 18, "servo payload layout changed");
+_Static_assert(sizeof(telemetry_session_payload_t) == 10, "session payload layout changed");
+_Static_assert(sizeof(telemetry_record_header_t) + TELEMETRY_RECORD_CHUNK_SIZE <= TELEMETRY_FRAME_MAX_PAYLOAD,
+               "record chunk too large");
+_Static_assert(sizeof(telemetry_profile_header_t) == 16, "profile header layout changed");
+_Static_assert(sizeof(telemetry_profile_task_t) == 16, "profile task layout changed");
+_Static_assert(sizeof(telemetry_profile_header_t) + TELEMETRY_PROFILE_MAX_TASKS * sizeof(telemetry_profile_task_t)
+               <= TELEMETRY_FRAME_MAX_PAYLOAD, "profile payload too large");
+_Static_assert(sizeof(telemetry_latency_payload_t) <= TELEMETRY_FRAME_MAX_PAYLOAD, "latency payload too large");
+
+/*============================================================================*/
+/* 静态变量                                                                    */
+/*============================================================================*/
+
+// 每种帧类型独立的序列号 (按 type 取模索引)
+#define TELEMETRY_SEQ_SLOTS 32
+static uint32_t s_sequence[TELEMETRY_SEQ_SLOTS];
+
+static volatile telemetry_format_t s_format = TELEMETRY_DEFAULT_FORMAT;
+
+// CRC16-CCITT 半字节查找表 (多项式 0x1021)
+static const uint16_t s_crc16_nibble_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+/*============================================================================*/
+/* 公共API实现                                                                 */
+/*============================================================================*/
+
+void telemetry_set_format(telemetry_format_t format) {
+    s_format = format;
+}
+
+telemetry_format_t telemetry_get_format(void) {
+    return s_format;
+}
+
+uint16_t telemetry_crc16(const uint8_t *data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 4) ^ s_crc16_nibble_table[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ s_crc16_nibble_table[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+size_t telemetry_frame_build(uint8_t type, const void *payload, size_t payload_len,
+                             uint8_t *buf, size_t size) {
+    if (buf == NULL || (payload == NULL && payload_len > 0) ||
+        payload_len > TELEMETRY_FRAME_MAX_PAYLOAD || size < payload_len + TELEMETRY_FRAME_OVERHEAD) {
+        return 0;
+    }
+
+    uint16_t seq = (uint16_t)__atomic_fetch_add(&s_sequence[type % TELEMETRY_SEQ_SLOTS], 1,
+                                                __ATOMIC_RELAXED);
+    return telemetry_frame_build_seq(type, seq, payload, payload_len, buf, size);
+}
+
+size_t telemetry_frame_build_seq(uint8_t type, uint16_t seq, const void *payload, size_t payload_len,
+                                 uint8_t *buf, size_t size) {
+    if (buf == NULL || (payload == NULL && payload_len > 0) ||
+        payload_len > TELEMETRY_FRAME_MAX_PAYLOAD) {
+        return 0;
+    }
+    size_t frame_len = payload_len + TELEMETRY_FRAME_OVERHEAD;
+    if (size < frame_len) {
+        return 0;
+    }
+
+    buf[0] = TELEMETRY_FRAME_SYNC;
+    buf[1] = type;
+    buf[2] = (uint8_t)payload_len;
+    buf[3] = (uint8_t)(seq & 0xFF);
+    buf[4] = (uint8_t)(seq >> 8);
+    if (payload_len > 0) {
+        memcpy(&buf[TELEMETRY_FRAME_HEADER_SIZE], payload, payload_len);
+    }
+
+    // CRC 覆盖 type 到 payload 末尾
+    uint16_t crc = telemetry_crc16(&buf[1], TELEMETRY_FRAME_HEADER_SIZE - 1 + payload_len);
+    buf[frame_len - 2] = (uint8_t)(crc & 0xFF);
+    buf[frame_len - 1] = (uint8_t)(crc >> 8);
+
+    return frame_len;
+}
+
+void telemetry_pack_encoder(const encoder_data_t *p_data, telemetry_encoder_payload_t *p_payload) {
+    p_payload->position = p_data->position;
+    p_payload->delta = p_data->delta;
+    p_payload->flags = p_data->button_pressed ? TELEMETRY_ENCODER_FLAG_BUTTON : 0;
+    p_payload->timestamp = p_data->timestamp;
+}
+
+void telemetry_pack_joystick(const joystick_data_t *p_data, telemetry_joystick_payload_t *p_payload) {
+    uint8_t flags = 0;
+    if (p_data->button_pressed) flags |= TELEMETRY_JOYSTICK_FLAG_BUTTON;
+    if (p_data->in_deadzone)    flags |= TELEMETRY_JOYSTICK_FLAG_DEADZONE;
+
+    p_payload->x = p_data->x;
+    p_payload->y = p_data->y;
+    p_payload->magnitude = p_data->magnitude_q15;
+    p_payload->angle = p_data->angle_cdeg;
+    p_payload->flags = flags;
+    p_payload->timestamp = p_data->timestamp;
+}
+
+void telemetry_pack_keypad(const keypad_data_t *p_data, telemetry_keypad_payload_t *p_payload) {
+    p_payload->key = p_data->key_code;
+    p_payload->flags = p_data->pressed ? TELEMETRY_KEYPAD_FLAG_PRESSED : 0;
+    p_payload->timestamp = p_data->timestamp;
+}
+
+void telemetry_pack_servo(const servo_data_t *p_data, telemetry_servo_payload_t *p_payload) {
+    p_payload->id = p_data->id;
+    p_payload->flags = p_data->flags;
+    p_payload->temperature = p_data->temperature;
+    p_payload->position = (int16_t)(p_data->position * 100.0f);
+    p_payload->target = (int16_t)(p_data->target * 100.0f);
+    p_payload->voltage = (uint16_t)(p_data->voltage * 1000.0f);
+    p_payload->timeouts = p_data->timeouts;
+    p_payload->timestamp = p_data->timestamp;
+}
+
+void telemetry_pack_latency(telemetry_latency_payload_t *p_payload) {
+    latency_histogram_t histogram;
+    p_payload->stage_count = LATENCY_STAGE_COUNT;
+    p_payload->bucket_count = LATENCY_BUCKET_COUNT;
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        latency_get_histogram((latency_stage_t)i, &histogram);
+        p_payload->stages[i].count = histogram.count;
+        p_payload->stages[i].max_us = histogram.max_us;
+        p_payload->stages[i].mean_us = histogram.count > 0 ? (uint32_t)(histogram.sum_us / histogram.count) : 0;
+        memcpy(p_payload->stages[i].buckets, histogram.buckets, sizeof(p_payload->stages[i].buckets));
+    }
+}
+
+// JSON 中的实例号字段 (实例 0 不输出，与旧格式相同)
+static const char *json_instance(uint8_t instance, char *field, size_t size) {
+    if (instance == 0) {
+        return "";
+    }
+    snprintf(field, size, ",\"ch\":%u", instance);
+    return field;
+}
+
+static size_t json_encoder(const encoder_data_t *p_data, uint8_t instance, uint8_t *buf, size_t size) {
+    char field[12];
+    int n = snprintf((char *)buf, size,
+                     "ENCODER:{\"pos\":%ld,\"delta\":%ld,\"btn\":%s,\"ts\":%lu%s}\n",
+                     (long)p_data->position,
+                     (long)p_data->delta,
+                     p_data->button_pressed ? "true" : "false",
+                     (unsigned long)p_data->timestamp,
+                     json_instance(instance, field, sizeof(field)));
+    return (n > 0 && (size_t)n < size) ? (size_t)n : 0;
+}
+
+static size_t json_joystick(const joystick_data_t *p_data, uint8_t instance, uint8_t *buf, size_t size) {
+    char field[12];
+    int n = snprintf((char *)buf, size,
+                     "JOYSTICK:{\"x\":%d,\"y\":%d,\"mag\":%.2f,\"ang\":%.1f,\"btn\":%s,\"dz\":%s,\"ts\":%lu%s}\n",
+                     p_data->x,
+                     p_data->y,
+                     p_data->magnitude,
+                     p_data->angle,
+                     p_data->button_pressed ? "true" : "false",
+                     p_data->in_deadzone ? "true" : "false",
+                     (unsigned long)p_data->timestamp,
+                     json_instance(instance, field, sizeof(field)));
+    return (n > 0 && (size_t)n < size) ? (size_t)n : 0;
+}
+
+static size_t json_keypad(const keypad_data_t *p_data, uint8_t instance, uint8_t *buf, size_t size) {
+    char field[12];
+    int n = snprintf((char *)buf, size,
+                     "KEYPAD:{\"key\":%u,\"pressed\":%s,\"ts\":%lu%s}\n",
+                     p_data->key_code,
+                     p_data->pressed ? "true" : "false",
+                     (unsigned long)p_data->timestamp,
+                     json_instance(instance, field, sizeof(field)));
+    return (n > 0 && (size_t)n < size) ? (size_t)n : 0;
+}
+
+size_t telemetry_json_encoder(const encoder_data_t *p_data, uint8_t *buf, size_t size) {
+    return json_encoder(p_data, 0, buf, size);
+}
+
+size_t telemetry_json_joystick(const joystick_data_t *p_data, uint8_t *buf, size_t size) {
+    return json_joystick(p_data, 0, buf, size);
+}
+
+// 封装传感器样本帧：实例号不为 0 时追加在载荷之后
+static size_t build_sample_frame(uint8_t type, const void *payload, size_t payload_len, uint8_t instance,
+                                 uint8_t *buf, size_t size) {
+    uint8_t data[16];   // 传感器样本载荷不超过 13 字节
+    if (instance == 0) {
+        return telemetry_frame_build(type, payload, payload_len, buf, size);
+    }
+    if (payload_len + TELEMETRY_INSTANCE_SIZE > sizeof(data)) {
+        return 0;
+    }
+    memcpy(data, payload, payload_len);
+    data[payload_len] = instance;
+    return telemetry_frame_build(type, data, payload_len + TELEMETRY_INSTANCE_SIZE, buf, size);
+}
+
+size_t telemetry_encode_encoder(const encoder_data_t *p_data, uint8_t *buf, size_t size) {
+    if (p_data == NULL || buf == NULL) {
+        return 0;
+    }
+
+    if (s_format == TELEMETRY_FORMAT_JSON) {
+        return telemetry_json_encoder(p_data, buf, size);
+    }
+
+    telemetry_encoder_payload_t payload;
+    telemetry_pack_encoder(p_data, &payload);
+    return telemetry_frame_build(TELEMETRY_FRAME_ENCODER, &payload, sizeof(payload), buf, size);
+}
+
+size_t telemetry_encode_joystick(const joystick_data_t *p_data, uint8_t *buf, size_t size) {
+    if (p_data == NULL || buf == NULL) {
+        return 0;
+    }
+
+    if (s_format == TELEMETRY_FORMAT_JSON) {
+        return telemetry_json_joystick(p_data, buf, size);
+    }
+
+    telemetry_joystick_payload_t payload;
+    telemetry_pack_joystick(p_data, &payload);
+    return telemetry_frame_build(TELEMETRY_FRAME_JOYSTICK, &payload, sizeof(payload), buf, size);
+}
+
+size_t telemetry_encode_sample(const data_channel_info_t *p_info, const void *p_sample, uint8_t *buf, size_t size) {
+    if (p_info == NULL || p_sample == NULL || buf == NULL) {
+        return 0;
+    }
+    bool json = s_format == TELEMETRY_FORMAT_JSON;
+
+    switch (p_info->kind) {
+        case DATA_KIND_ENCODER: {
+            if (json) {
+                return json_encoder((const encoder_data_t *)p_sample, p_info->instance, buf, size);
+            }
+            telemetry_encoder_payload_t payload;
+            telemetry_pack_encoder((const encoder_data_t *)p_sample, &payload);
+            return build_sample_frame(TELEMETRY_FRAME_ENCODER, &payload, sizeof(payload), p_info->instance, buf, size);
+        }
+        case DATA_KIND_JOYSTICK: {
+            if (json) {
+                return json_joystick((const joystick_data_t *)p_sample, p_info->instance, buf, size);
+            }
+            telemetry_joystick_payload_t payload;
+            telemetry_pack_joystick((const joystick_data_t *)p_sample, &payload);
+            return build_sample_frame(TELEMETRY_FRAME_JOYSTICK, &payload, sizeof(payload), p_info->instance, buf, size);
+        }
+        case DATA_KIND_KEYPAD: {
+            if (json) {
+                return json_keypad((const keypad_data_t *)p_sample, p_info->instance, buf, size);
+            }
+            telemetry_keypad_payload_t payload;
+            telemetry_pack_keypad((const keypad_data_t *)p_sample, &payload);
+            return build_sample_frame(TELEMETRY_FRAME_KEYPAD, &payload, sizeof(payload), p_info->instance, buf, size);
+        }
+        default:
+            return 0;
+    }
+}
+
+size_t telemetry_encode_profile(const system_profile_t *p_profile, uint8_t *buf, size_t size) {
+    if (p_profile == NULL || buf == NULL) {
+        return 0;
+    }
+
+    if (s_format == TELEMETRY_FORMAT_JSON) {
+        int n = snprintf((char *)buf, size,
+                         "PROFILE:{\"win\":%lu,\"load\":[%u,%u],\"heap\":%lu,\"heap_min\":%lu,\"tasks\":[",
+                         (unsigned long)p_profile->window_ms,
+                         p_profile->core_load_permille[0],
+                         p_profile->core_load_permille[1],
+                         (unsigned long)p_profile->heap_free,
+                         (unsigned long)p_profile->heap_min_free);
+        if (n <= 0 || (size_t)n >= size) {
+            return 0;
+        }
+        size_t len = (size_t)n;
+        // 逐个追加任务项，放不下时停止 (保留 "]}\n" 的空间)
+        for (uint8_t i = 0; i < p_profile->task_count; i++) {
+            const task_profile_t *task = &p_profile->tasks[i];
+            char item[48];
+            int m = snprintf(item, sizeof(item), "%s[\"%s\",%u,%lu]", i > 0 ? "," : "",
+                             task->name, task->cpu_permille, (unsigned long)task->stack_free);
+            if (m <= 0 || len + (size_t)m + 3 >= size) {
+                break;
+            }
+            memcpy(&buf[len], item, (size_t)m);
+            len += (size_t)m;
+        }
+        if (len + 3 >= size) {
+            return 0;
+        }
+        memcpy(&buf[len], "]}\n", 3);
+        return len + 3;
+    }
+
+    uint8_t payload[sizeof(telemetry_profile_header_t) + TELEMETRY_PROFILE_MAX_TASKS * sizeof(telemetry_profile_task_t)];
+    telemetry_profile_header_t *p_header = (telemetry_profile_header_t *)payload;
+    uint8_t count = p_profile->task_count < TELEMETRY_PROFILE_MAX_TASKS ? p_profile->task_count
+                                                                         : TELEMETRY_PROFILE_MAX_TASKS;
+
+    p_header->window_ms = (uint16_t)(p_profile->window_ms > 0xFFFF ? 0xFFFF : p_profile->window_ms);
+    p_header->core_load[0] = p_profile->core_load_permille[0];
+    p_header->core_load[1] = p_profile->core_load_permille[1];
+    p_header->heap_free = p_profile->heap_free;
+    p_header->heap_min_free = p_profile->heap_min_free;
+    p_header->flags = p_profile->flags;
+    p_header->task_count = count;
+
+    telemetry_profile_task_t *p_tasks = (telemetry_profile_task_t *)&payload[sizeof(telemetry_profile_header_t)];
+    for (uint8_t i = 0; i < count; i++) {
+        const task_profile_t *task = &p_profile->tasks[i];
+        memset(&p_tasks[i], 0, sizeof(p_tasks[i]));
+        strncpy(p_tasks[i].name, task->name, sizeof(p_tasks[i].name));
+        p_tasks[i].core = task->core;
+        p_tasks[i].priority = task->priority;
+        p_tasks[i].cpu_permille = task->cpu_permille;
+        p_tasks[i].stack_free = (uint16_t)(task->stack_free > 0xFFFF ? 0xFFFF : task->stack_free);
+    }
+
+    size_t payload_len = sizeof(telemetry_profile_header_t) + count * sizeof(telemetry_profile_task_t);
+    return telemetry_frame_build(TELEMETRY_FRAME_PROFILE, payload, payload_len, buf, size);
+}
+
+size_t telemetry_encode_latency(uint8_t *buf, size_t size) {
+    if (buf == NULL) {
+        return 0;
+    }
+
+    if (s_format == TELEMETRY_FORMAT_JSON) {
+        latency_histogram_t histograms[LATENCY_STAGE_COUNT];
+        for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+            latency_get_histogram((latency_stage_t)i, &histograms[i]);
+        }
+
+        // 四个数组依次为样本数、p50、p99、最大值，按 latency_stage_t 顺序排列
+        static const char *const keys[] = {"n", "p50", "p99", "max"};
+        size_t len = 0;
+        int n = snprintf((char *)buf, size, "LATENCY:{");
+        if (n <= 0 || (size_t)n >= size) {
+            return 0;
+        }
+        len = (size_t)n;
+        for (int k = 0; k < 4; k++) {
+            n = snprintf((char *)&buf[len], size - len, "%s\"%s\":[", k > 0 ? "," : "", keys[k]);
+            if (n <= 0 || (size_t)n >= size - len) {
+                return 0;
+            }
+            len += (size_t)n;
+            for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+                uint32_t value;
+                switch (k) {
+                    case 0:  value = histograms[i].count; break;
+                    case 1:  value = latency_percentile_us(&histograms[i], 50); break;
+                    case 2:  value = latency_percentile_us(&histograms[i], 99); break;
+                    default: value = histograms[i].max_us; break;
+                }
+                n = snprintf((char *)&buf[len], size - len, "%s%lu", i > 0 ? "," : "", (unsigned long)value);
+                if (n <= 0 || (size_t)n >= size - len) {
+                    return 0;
+                }
+                len += (size_t)n;
+            }
+            n = snprintf((char *)&buf[len], size - len, "]");
+            if (n <= 0 || (size_t)n >= size - len) {
+                return 0;
+            }
+            len += (size_t)n;
+        }
+        n = snprintf((char *)&buf[len], size - len, "}\n");
+        if (n <= 0 || (size_t)n >= size - len) {
+            return 0;
+        }
+        return len + (size_t)n;
+    }
+
+    telemetry_latency_payload_t payload;
+    telemetry_pack_latency(&payload);
+    return telemetry_frame_build(TELEMETRY_FRAME_LATENCY, &payload, sizeof(payload), buf, size);
+}
@@ -0,0 +1,359 @@
+/**
+ * @file telemetry_frame.h
+ * @brief 遥测帧编码模块公共头文件
+ *
+ * @details
+ * 将 DataPlatform 中的传感器数据 (encoder_data_t / joystick_data_t) 编码为
+ * 可直接通过网络发送的字节流。支持两种格式：
+ *  - JSON 文本格式：便于调试，与旧版 "ENCODER:{...}\n" 格式完全兼容；
+ *  - 二进制帧格式：定长紧凑布局，带同步字节、序列号和 CRC 校验，
+ *    不涉及任何浮点格式化，适合高频率发送。
+ *
+ * 二进制帧布局 (所有多字节字段均为小端序)：
+ * @code
+ * +------+------+-----+---------+-------------+---------+
+ * | sync | type | len | seq     | payload     | crc16   |
+ * | 0xA5 | u8   | u8  | u16     | len 字节    | u16     |
+ * +------+------+-----+---------+-------------+---------+
+ * @endcode
+ * CRC16 使用 CCITT-FALSE 算法 (多项式 0x1021，初值 0xFFFF)，
+ * 计算范围为 type 到 payload 末尾 (不含 sync 字节与 CRC 本身)。
+ * 每种帧类型维护独立的序列号，上位机可据此统计丢包与乱序。
+ *
+ * 上位机解码器参见 example/upper_usage.py。
+ */
+
+#ifndef TELEMETRY_FRAME_H
+#define TELEMETRY_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "data_service.h"
+#include "latency_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*============================================================================*/
+/* 帧格式定义                                                                  */
+/*============================================================================*/
+
+#define TELEMETRY_FRAME_SYNC          0xA5  // 帧同步字节
+#define TELEMETRY_FRAME_HEADER_SIZE   5     // sync + type + len + seq
+#define TELEMETRY_FRAME_CRC_SIZE      2     // CRC16
+#define TELEMETRY_FRAME_OVERHEAD      (TELEMETRY_FRAME_HEADER_SIZE + TELEMETRY_FRAME_CRC_SIZE)
+#define TELEMETRY_FRAME_MAX_PAYLOAD   255   // len 字段为 u8
+
+/**
+ * @brief 帧类型定义
+ */
+typedef enum {
+    TELEMETRY_FRAME_ENCODER  = 0x01,  // 旋转编码器数据
+    TELEMETRY_FRAME_JOYSTICK = 0x02,  // 摇杆数据
+    TELEMETRY_FRAME_SERVO    = 0x03,  // 总线舵机状态 (飞行记录仪)
+    TELEMETRY_FRAME_KEYPAD   = 0x04,  // 矩阵键盘按键事件
+    TELEMETRY_FRAME_PROFILE  = 0x10,  // 任务剖析 (CPU 占用 / 栈 / 堆)，变长
+    TELEMETRY_FRAME_LATENCY  = 0x11,  // 热路径各阶段延迟直方图
+    TELEMETRY_FRAME_RECORD   = 0x12,  // 飞行记录仪下载分块 (载荷为记录中的原始字节)
+    TELEMETRY_FRAME_SESSION  = 0x13,  // 飞行记录仪中每次启动的第一帧
+    TELEMETRY_FRAME_REQUEST  = 0x20,  // 串口机器模式请求 (上位机 -> 设备)，seq 为请求ID
+    TELEMETRY_FRAME_RESPONSE = 0x21,  // 串口机器模式响应 (设备 -> 上位机)
+} telemetry_frame_type_t;
+
+/**
+ * @brief 编码器帧 flags 位定义
+ */
+#define TELEMETRY_ENCODER_FLAG_BUTTON     (1 << 0)  // 按钮按下
+
+/**
+ * @brief 摇杆帧 flags 位定义
+ */
+#define TELEMETRY_JOYSTICK_FLAG_BUTTON    (1 << 0)  // 按钮按下
+#define TELEMETRY_JOYSTICK_FLAG_DEADZONE  (1 << 1)  // 处于死区内
+
+/**
+ * @brief 键盘帧 flags 位定义
+ */
+#define TELEMETRY_KEYPAD_FLAG_PRESSED     (1 << 0)  // 按下 (清零为释放)
+
+/**
+ * @brief 传感器样本帧 (编码器/摇杆/键盘) 末尾的实例号长度
+ * @details 实例 0 不带实例号，帧与旧格式完全相同；其他实例在载荷后追加 1 字节实例号。
+ */
+#define TELEMETRY_INSTANCE_SIZE           1
+
+/**
+ * @brief 编码器帧载荷 (13 字节)
+ */
+typedef struct __attribute__((packed)) {
+    int32_t  position;   // 编码器位置
+    int32_t  delta;      // 位置变化量
+    uint8_t  flags;      // TELEMETRY_ENCODER_FLAG_*
+    uint32_t timestamp;  // 时间戳 (FreeRTOS tick)
+} telemetry_encoder_payload_t;
+
+/**
+ * @brief 摇杆帧载荷 (13 字节)
+ */
+typedef struct __attribute__((packed)) {
+    int16_t  x;          // X轴值 (-512 到 +512)
+    int16_t  y;          // Y轴值 (-512 到 +512)
+    uint16_t magnitude;  // 偏移量, Q15 定点 (0-32767 对应 0.0-1.0)
+    uint16_t angle;      // 角度, 单位 0.01 度 (0-35999)
+    uint8_t  flags;      // TELEMETRY_JOYSTICK_FLAG_*
+    uint32_t timestamp;  // 时间戳 (FreeRTOS tick)
+} telemetry_joystick_payload_t;
+
+/**
+ * @brief 键盘帧载荷 (6 字节)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  key;        // 按键代码 (从 1 开始)
+    uint8_t  flags;      // TELEMETRY_KEYPAD_FLAG_*
+    uint32_t timestamp;  // 时间戳 (FreeRTOS tick)
+} telemetry_keypad_payload_t;
+
+/**
+ * @brief 舵机帧载荷 (18 字节)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  id;             // 舵机ID
+    uint8_t  flags;          // SERVO_STATE_FLAG_*
+    int16_t  temperature;    // 温度 (°C)
+    int16_t  position;       // 当前角度, 单位 0.01 度
+    int16_t  target;         // 目标角度, 单位 0.01 度
+    uint16_t voltage;        // 电压 (mV)
+    uint32_t timeouts;       // 累计读取失败次数
+    uint32_t timestamp;      // 时间戳 (FreeRTOS tick)
+} telemetry_servo_payload_t;
+
+/**
+ * @brief 剖析帧中最多携带的任务数 (按 CPU 占用降序)
+ */
+#define TELEMETRY_PROFILE_MAX_TASKS  14
+
+/**
+ * @brief 剖析帧载荷头 (16 字节)，后跟 task_count 个 telemetry_profile_task_t
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t window_ms;           // 窗口长度
+    uint16_t core_load[2];        // 各核心负载 (千分比)
+    uint32_t heap_free;           // 当前空闲堆
+    uint32_t heap_min_free;       // 最小空闲堆
+    uint8_t  flags;               // PROFILE_FLAG_*
+    uint8_t  task_count;          // 后续任务项数
+} telemetry_profile_header_t;
+
+/**
+ * @brief 剖析帧任务项 (16 字节)
+ */
+typedef struct __attribute__((packed)) {
+    char     name[10];            // 任务名 (截断，不足补 0)
+    uint8_t  core;                // 绑定的核心 (0xFF = 不绑定)
+    uint8_t  priority;            // 当前优先级
+    uint16_t cpu_permille;        // 窗口内 CPU 占用 (千分比)
+    uint16_t stack_free;          // 栈高水位 (字节，超过 65535 时截断)
+} telemetry_profile_task_t;
+
+/**
+ * @brief 延迟帧中单个阶段的统计 (60 字节)，桶上界见 latency_bucket_bounds_us
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t count;                           // 样本数
+    uint32_t max_us;                          // 最大值
+    uint32_t mean_us;                         // 均值
+    uint32_t buckets[LATENCY_BUCKET_COUNT];   // 各桶计数
+} telemetry_latency_stage_t;
+
+/**
+ * @brief 延迟帧载荷 (242 字节)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  stage_count;                     // LATENCY_STAGE_COUNT
+    uint8_t  bucket_count;                    // LATENCY_BUCKET_COUNT
+    telemetry_latency_stage_t stages[LATENCY_STAGE_COUNT];
+} telemetry_latency_payload_t;
+
+/**
+ * @brief 下载分块中最多携带的记录字节数
+ */
+#define TELEMETRY_RECORD_CHUNK_SIZE  240
+
+/**
+ * @brief 下载分块载荷头 (4 字节)，后跟最多 TELEMETRY_RECORD_CHUNK_SIZE 字节的记录数据
+ * @details 不带数据的分块表示下载结束，offset 为总字节数
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t offset;         // 本块在下载流中的偏移 (覆盖写入跳过的数据计入偏移，上位机据此发现缺口)
+} telemetry_record_header_t;
+
+/**
+ * @brief 启动记录帧载荷 (10 字节)
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t session;        // 启动序号 (每次启动加 1)
+    uint32_t timestamp;      // 时间戳 (FreeRTOS tick)
+    uint8_t  reset_reason;   // esp_reset_reason_t
+    uint8_t  version;        // 记录格式版本
+} telemetry_session_payload_t;
+
+/*============================================================================*/
+/* 输出格式选择                                                                */
+/*============================================================================*/
+
+/**
+ * @brief 遥测输出格式
+ */
+typedef enum {
+    TELEMETRY_FORMAT_JSON = 0,  // JSON 文本 (调试用)
+    TELEMETRY_FORMAT_BINARY,    // 二进制帧
+} telemetry_format_t;
+
+/**
+ * @brief 上电默认的输出格式，可通过 build_flags 覆盖
+ */
+#ifndef TELEMETRY_DEFAULT_FORMAT
+#define TELEMETRY_DEFAULT_FORMAT TELEMETRY_FORMAT_JSON
+#endif
+
+/**
+ * @brief 设置遥测输出格式 (运行时切换)
+ * @param[in] format 新的输出格式
+ */
+void telemetry_set_format(telemetry_format_t format);
+
+/**
+ * @brief 获取当前遥测输出格式
+ * @return 当前输出格式
+ */
+telemetry_format_t telemetry_get_format(void);
+
+/*============================================================================*/
+/* 编码接口                                                                    */
+/*============================================================================*/
+
+/**
+ * @brief 按当前输出格式编码编码器数据
+ * @param[in]  p_data 编码器数据
+ * @param[out] buf    输出缓冲区
+ * @param[in]  size   输出缓冲区大小
+ * @return 写入的字节数，缓冲区不足或参数无效时返回 0
+ */
+size_t telemetry_encode_encoder(const encoder_data_t *p_data, uint8_t *buf, size_t size);
+
+/**
+ * @brief 按当前输出格式编码摇杆数据
+ * @param[in]  p_data 摇杆数据
+ * @param[out] buf    输出缓冲区
+ * @param[in]  size   输出缓冲区大小
+ * @return 写入的字节数，缓冲区不足或参数无效时返回 0
+ */
+size_t telemetry_encode_joystick(const joystick_data_t *p_data, uint8_t *buf, size_t size);
+
+/**
+ * @brief 与当前输出格式无关地编码为 JSON 文本行 (telemetry_encode_encoder/joystick 的 JSON 分支)
+ * @return 写入的字节数 (不含结尾 '\0')，缓冲区不足时返回 0
+ */
+size_t telemetry_json_encoder(const encoder_data_t *p_data, uint8_t *buf, size_t size);
+size_t telemetry_json_joystick(const joystick_data_t *p_data, uint8_t *buf, size_t size);
+
+/**
+ * @brief 按当前输出格式编码一个 DataPlatform 通道的样本
+ * @details 数据发布任务按通道表逐个通道调用。实例号不为 0 时二进制帧在载荷后追加实例号，
+ *          JSON 增加 "ch" 字段；实例 0 的输出与 telemetry_encode_encoder/joystick 相同。
+ * @param[in]  p_info   通道描述 (data_channel_get_info())
+ * @param[in]  p_sample 样本 (类型由通道类别决定)
+ * @param[out] buf      输出缓冲区
+ * @param[in]  size     输出缓冲区大小
+ * @return 写入的字节数，该类别没有遥测格式、缓冲区不足或参数无效时返回 0
+ */
+size_t telemetry_encode_sample(const data_channel_info_t *p_info, const void *p_sample, uint8_t *buf, size_t size);
+
+/**
+ * @brief 按当前输出格式编码任务剖析结果
+ * @details 二进制帧最多携带 TELEMETRY_PROFILE_MAX_TASKS 个任务；
+ *          JSON 格式下在缓冲区允许的范围内尽量多地输出任务。
+ * @param[in]  p_profile 剖析结果
+ * @param[out] buf       输出缓冲区
+ * @param[in]  size      输出缓冲区大小
+ * @return 写入的字节数，缓冲区不足或参数无效时返回 0
+ */
+size_t telemetry_encode_profile(const system_profile_t *p_profile, uint8_t *buf, size_t size);
+
+/**
+ * @brief 按当前输出格式编码各阶段的延迟直方图 (数据取自 latency_get_histogram())
+ * @details JSON 格式只输出样本数、p50、p99 和最大值，二进制帧包含完整的桶计数。
+ * @param[out] buf  输出缓冲区
+ * @param[in]  size 输出缓冲区大小
+ * @return 写入的字节数，缓冲区不足时返回 0
+ */
+size_t telemetry_encode_latency(uint8_t *buf, size_t size);
+
+/**
+ * @brief 将编码器数据转换为二进制帧载荷
+ * @param[in]  p_data    编码器数据
+ * @param[out] p_payload 输出载荷
+ */
+void telemetry_pack_encoder(const encoder_data_t *p_data, telemetry_encoder_payload_t *p_payload);
+
+/**
+ * @brief 将摇杆数据转换为二进制帧载荷
+ * @param[in]  p_data    摇杆数据
+ * @param[out] p_payload 输出载荷
+ */
+void telemetry_pack_joystick(const joystick_data_t *p_data, telemetry_joystick_payload_t *p_payload);
+
+/**
+ * @brief 将键盘按键事件转换为二进制帧载荷
+ * @param[in]  p_data    按键事件
+ * @param[out] p_payload 输出载荷
+ */
+void telemetry_pack_keypad(const keypad_data_t *p_data, telemetry_keypad_payload_t *p_payload);
+
+/**
+ * @brief 将舵机状态转换为二进制帧载荷
+ * @param[in]  p_data    舵机状态
+ * @param[out] p_payload 输出载荷
+ */
+void telemetry_pack_servo(const servo_data_t *p_data, telemetry_servo_payload_t *p_payload);
+
+/**
+ * @brief 将各阶段的延迟直方图 (latency_get_histogram()) 转换为二进制帧载荷
+ * @param[out] p_payload 输出载荷
+ */
+void telemetry_pack_latency(telemetry_latency_payload_t *p_payload);
+
+/**
+ * @brief 将任意载荷封装为二进制帧
+ * @details 自动填充同步字节、长度、该类型的下一个序列号以及 CRC。
+ * @param[in]  type        帧类型
+ * @param[in]  payload     载荷数据
+ * @param[in]  payload_len 载荷长度 (不超过 TELEMETRY_FRAME_MAX_PAYLOAD)
+ * @param[out] buf         输出缓冲区
+ * @param[in]  size        输出缓冲区大小
+ * @return 整帧字节数，缓冲区不足或参数无效时返回 0
+ */
+size_t telemetry_frame_build(uint8_t type, const void *payload, size_t payload_len,
+                             uint8_t *buf, size_t size);
+
+/**
+ * @brief 使用调用方给出的序列号封装二进制帧
+ * @details 不占用该类型的实时序列号 (例如飞行记录仪写入 flash 的帧)，其余与 telemetry_frame_build() 相同。
+ */
+size_t telemetry_frame_build_seq(uint8_t type, uint16_t seq, const void *payload, size_t payload_len,
+                                 uint8_t *buf, size_t size);
+
+/**
+ * @brief 计算 CRC16-CCITT-FALSE
+ * @param[in] data 数据
+ * @param[in] len  数据长度
+ * @return CRC 值
+ */
+uint16_t telemetry_crc16(const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELEMETRY_FRAME_H
@@ -0,0 +1,137 @@
+#include "uart_command_index.h"
+#include <string.h>
+#include <stdio.h>
+
+#include "freertos/FreeRTOS.h"
+
+/* 命令哈希索引：开放寻址 + 线性探测，cmd 为 NULL 表示空槽 */
+typedef struct {
+    uint32_t hash;
+    const command_t *volatile cmd;
+} command_slot_t;
+
+static command_slot_t command_index[UART_PARSER_HASH_SLOTS];
+static size_t command_index_used = 0;
+static portMUX_TYPE command_index_mux = portMUX_INITIALIZER_UNLOCKED;
+
+
+/**
+ * @brief 在哈希索引中查找命令 (不加锁，只读)。
+ * @return 命令条目，未找到返回 NULL。
+ */
+const command_t *uart_command_lookup(const char *name)
+{
+    uint32_t hash = uart_parser_hash(name);
+    for (size_t probe = 0; probe < UART_PARSER_HASH_SLOTS; probe++) {
+        const command_slot_t *slot = &command_index[(hash + probe) & (UART_PARSER_HASH_SLOTS - 1)];
+        const command_t *cmd = slot->cmd;
+        if (cmd == NULL) {
+            return NULL;
+        }
+        if (slot->hash == hash && strcmp(cmd->name, name) == 0) {
+            return cmd;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 把一张命令表的条目插入哈希索引。
+ * @return 成功插入的条目数，重复或索引已满的条目被跳过。
+ */
+size_t uart_command_index_insert(const command_t *table, size_t count)
+{
+    size_t inserted = 0;
+    
+    taskENTER_CRITICAL(&command_index_mux);
+    for (size_t i = 0; i < count; i++) {
+        // 负载因子不超过 1/2，保证探测链较短
+        if (command_index_used >= UART_PARSER_HASH_SLOTS / 2) {
+            break;
+        }
+        uint32_t hash = uart_parser_hash(table[i].name);
+        for (size_t probe = 0; probe < UART_PARSER_HASH_SLOTS; probe++) {
+            command_slot_t *slot = &command_index[(hash + probe) & (UART_PARSER_HASH_SLOTS - 1)];
+            if (slot->cmd == NULL) {
+                // 先写哈希再发布条目指针，无锁读者看到指针时哈希已有效
+                slot->hash = hash;
+                __sync_synchronize();
+                slot->cmd = &table[i];
+                command_index_used++;
+                inserted++;
+                break;
+            }
+            if (slot->hash == hash && strcmp(slot->cmd->name, table[i].name) == 0) {
+                break; // 重复命令，跳过
+            }
+        }
+    }
+    taskEXIT_CRITICAL(&command_index_mux);
+    
+    return inserted;
+}
+
+/**
+ * @brief 可重入的原地分词器。
+ * @details 以空白字符分隔参数，双引号括起的参数可以包含空格 (引号本身被去掉)。
+ * 直接在 line 中写入 '\0'，不使用任何静态状态。
+ * @return 参数个数，超过 max_args 的部分被忽略。
+ */
+int uart_command_tokenize(char *line, char *argv[], int max_args)
+{
+    int argc = 0;
+    char *p = line;
+    
+    while (*p != '\0' && argc < max_args) {
+        // 跳过分隔符
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+            p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        
+        if (*p == '"') {
+            argv[argc++] = ++p;
+            while (*p != '\0' && *p != '"') {
+                p++;
+            }
+        } else {
+            argv[argc++] = p;
+            while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') {
+                p++;
+            }
+        }
+        if (*p != '\0') {
+            *p++ = '\0';
+        }
+    }
+    return argc;
+}
+
+/**
+ * @brief 解析并执行命令。
+ * @param cmd_string 原始命令字符串 (会被原地修改)。
+ */
+void uart_command_execute(char *cmd_string)
+{
+    char *argv[UART_PARSER_MAX_ARGS];
+    char response_buffer[128]; // 用于格式化输出
+
+    int argc = uart_command_tokenize(cmd_string, argv, UART_PARSER_MAX_ARGS);
+    if (argc == 0) {
+        return; // 空命令，直接忽略
+    }
+
+    // 哈希索引查找命令
+    const command_t *cmd = uart_command_lookup(argv[0]);
+    if (cmd != NULL) {
+        // 找到命令，调用其处理函数
+        cmd->handler(argc, argv);
+        return;
+    }
+
+    // 未找到命令
+    snprintf(response_buffer, sizeof(response_buffer), "Error: Unknown command '%s'. Type 'help' for a list.\r\n", argv[0]);
+    uart_parser_put_string(response_buffer);
+}
@@ -0,0 +1,55 @@
+#ifndef UART_COMMAND_INDEX_H
+#define UART_COMMAND_INDEX_H
+/**
+ * @file uart_command_index.h
+ * @brief 命令哈希索引与分词器 (uart_parser 内部接口)
+ *
+ * @details
+ * 从 uart_parser.cpp 中分离出来的分派核心：不依赖队列、串口和网络，
+ * 只用到临界区，因此可以在 native 环境 (lib/NativeHost) 中单独编译，
+ * 在主机上测量分派开销 (test/test_parser)。
+ * 固件中由 uart_parser.cpp 调用，其他模块仍然使用 uart_parser_register_commands()。
+ */
+
+#include "uart_parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 每条命令支持的最大参数数量 (含命令本身)，超出部分被忽略。
+ */
+#define UART_PARSER_MAX_ARGS        8
+
+/**
+ * @brief 把一张命令表的条目插入哈希索引 (可与 uart_command_lookup() 并发)。
+ * @return 成功插入的条目数，重复或索引已满 (超过 UART_PARSER_HASH_SLOTS 的一半) 的条目被跳过。
+ */
+size_t uart_command_index_insert(const command_t *table, size_t count);
+
+/**
+ * @brief 在哈希索引中查找命令 (不加锁，只读)。
+ * @return 命令条目，未找到返回 NULL。
+ */
+const command_t *uart_command_lookup(const char *name);
+
+/**
+ * @brief 可重入的原地分词器。
+ * @details 以空白字符分隔参数，双引号括起的参数可以包含空格 (引号本身被去掉)。
+ * 直接在 line 中写入 '\0'，不使用任何静态状态。
+ * @return 参数个数，超过 max_args 的部分被忽略。
+ */
+int uart_command_tokenize(char *line, char *argv[], int max_args);
+
+/**
+ * @brief 分词、查找并执行一条命令，未知命令输出错误提示 (uart_parser_put_string())。
+ * @param line 以 '\0' 结尾的命令行 (会被原地修改)。
+ */
+void uart_command_execute(char *line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_COMMAND_INDEX_H */
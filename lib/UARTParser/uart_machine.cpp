@@ -0,0 +1,344 @@
+#include "uart_machine.h"
+#include "uart_parser.h"
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+#include "Arduino.h"
+#include "wifi_task.h"
+#include "data_service.h"
+#include "telemetry_frame.h"
+#include "sampler.h"
+
+/* 宏定义 */
+#define UART_MACHINE_MAX_FRAME      (TELEMETRY_FRAME_OVERHEAD + TELEMETRY_FRAME_MAX_PAYLOAD)
+#define UART_MACHINE_RESPONSE_DATA  (TELEMETRY_FRAME_MAX_PAYLOAD - sizeof(uart_machine_response_header_t))
+#define UART_MACHINE_ESCAPE_CHAR    '+'
+#define UART_MACHINE_ESCAPE_COUNT   3
+#define UART_MACHINE_RX_TIMEOUT_MS  20    // 帧内字节间隔上限 (115200 波特率下约 200 个字符时间)，超过则丢弃未完成的帧
+
+/* 帧接收状态 */
+typedef enum {
+    RX_WAIT_SYNC = 0,   // 等待同步字节
+    RX_HEADER,          // 接收 type + len + seq
+    RX_BODY,            // 接收 payload + crc
+} rx_state_t;
+
+static volatile bool machine_active = false;
+static volatile bool rx_restart = false;   // 进入机器模式时置位，由接收上下文复位帧接收器
+
+/* 帧接收器状态 (仅由 uart_machine_feed 访问，运行在串口接收回调中) */
+static rx_state_t rx_state = RX_WAIT_SYNC;
+static uint8_t rx_frame[UART_MACHINE_MAX_FRAME];
+static size_t rx_count = 0;       // rx_frame 中已接收的字节数
+static size_t rx_expected = 0;    // 当前帧的总字节数 (收到 len 后确定)
+static uint8_t escape_count = 0;  // 空闲时连续收到的 '+' 个数
+static uint32_t rx_last_ms = 0;   // 收到上一个字节的时刻 (毫秒)
+
+/* 统计：帧接收器 (串口接收回调) 和请求执行 (uart_parser_task) 都会更新 */
+static uart_machine_stats_t machine_stats;
+static portMUX_TYPE machine_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void stats_add_dropped(size_t bytes)
+{
+    taskENTER_CRITICAL(&machine_stats_mux);
+    machine_stats.bytes_dropped += bytes;
+    taskEXIT_CRITICAL(&machine_stats_mux);
+}
+
+/* -------------------- 1. 响应发送 -------------------- */
+
+/**
+ * @brief 封装并发送一个响应帧。
+ */
+static void send_response(uint16_t req_id, uint8_t cmd_id, uint8_t status,
+                          const void *data, size_t data_len)
+{
+    uint8_t payload[TELEMETRY_FRAME_MAX_PAYLOAD];
+    uint8_t frame[UART_MACHINE_MAX_FRAME];
+
+    uart_machine_response_header_t header = {
+        .req_id = req_id,
+        .cmd_id = cmd_id,
+        .status = status,
+    };
+    if (data_len > UART_MACHINE_RESPONSE_DATA) {
+        data_len = UART_MACHINE_RESPONSE_DATA;
+    }
+    memcpy(payload, &header, sizeof(header));
+    if (data_len > 0) {
+        memcpy(payload + sizeof(header), data, data_len);
+    }
+
+    size_t frame_len = telemetry_frame_build(TELEMETRY_FRAME_RESPONSE, payload,
+                                             sizeof(header) + data_len, frame, sizeof(frame));
+    if (frame_len > 0) {
+        uart_parser_put_bytes(frame, frame_len);
+    }
+}
+
+/* -------------------- 2. 命令分派 -------------------- */
+
+/**
+ * @brief 执行一条请求并发送响应。
+ * @param req_id 请求ID (请求帧的 seq)。
+ * @param args   cmd_id 之后的参数。
+ * @param arg_len 参数长度。
+ * @param serial  请求是否来自串口 (网络请求不会切换串口的机器模式)。
+ */
+static void dispatch_request(uint16_t req_id, uint8_t cmd_id, const uint8_t *args, size_t arg_len, bool serial)
+{
+    switch (cmd_id) {
+        case UART_MACHINE_CMD_PING:
+            send_response(req_id, cmd_id, UART_MACHINE_STATUS_OK, args, arg_len);
+            break;
+
+        case UART_MACHINE_CMD_EXIT:
+            // 先回复再退出，确保响应仍以二进制帧发出
+            send_response(req_id, cmd_id, UART_MACHINE_STATUS_OK, NULL, 0);
+            if (serial) {
+                machine_active = false;
+                uart_parser_put_string("\r\n> ");
+            }
+            break;
+
+        case UART_MACHINE_CMD_GET_SYS_INFO: {
+            uart_machine_sys_info_t info = {
+                .uptime_ms = (uint32_t)millis(),
+                .free_heap = esp_get_free_heap_size(),
+                .cpu_mhz = (uint16_t)getCpuFrequencyMhz(),
+                .wifi_connected = (uint8_t)is_wifi_connected(),
+                .network_connected = (uint8_t)is_network_connected(),
+            };
+            send_response(req_id, cmd_id, UART_MACHINE_STATUS_OK, &info, sizeof(info));
+            break;
+        }
+
+        case UART_MACHINE_CMD_GET_ENCODER: {
+            encoder_data_t data;
+            struct __attribute__((packed)) {
+                uint32_t version;
+                telemetry_encoder_payload_t encoder;
+            } reply;
+            reply.version = data_service_get_encoder(&data);
+            telemetry_pack_encoder(&data, &reply.encoder);
+            send_response(req_id, cmd_id, UART_MACHINE_STATUS_OK, &reply, sizeof(reply));
+            break;
+        }
+
+        case UART_MACHINE_CMD_GET_JOYSTICK: {
+            joystick_data_t data;
+            struct __attribute__((packed)) {
+                uint32_t version;
+                telemetry_joystick_payload_t joystick;
+            } reply;
+            reply.version = data_service_get_joystick(&data);
+            telemetry_pack_joystick(&data, &reply.joystick);
+            send_response(req_id, cmd_id, UART_MACHINE_STATUS_OK, &reply, sizeof(reply));
+            break;
+        }
+
+        case UART_MACHINE_CMD_GET_NETWORK_TX: {
+            network_tx_stats_t stats;
+            network_tx_get_stats(&stats);
+            uart_machine_network_tx_t reply = {
+                .frames_sent = stats.frames_sent,
+                .flushes = stats.flushes,
+                .bytes_sent = stats.bytes_sent,
+                .send_failures = stats.send_failures,
+                .pool_exhausted = stats.pool_exhausted,
+                .client_drops = stats.client_drops,
+                .flush_interval_ms = (uint16_t)network_tx_get_flush_interval(),
+                .client_count = (uint8_t)network_get_client_count(),
+            };
+            send_response(req_id, cmd_id, UART_MACHINE_STATUS_OK, &reply, sizeof(reply));
+            break;
+        }
+
+        case UART_MACHINE_CMD_GET_SAMPLER: {
+            if (arg_len != 1) {
+                send_response(req_id, cmd_id, UART_MACHINE_STATUS_BAD_LENGTH, NULL, 0);
+                break;
+            }
+            sampler_stats_t stats;
+            if (sampler_get_stats(args[0], &stats) != ESP_OK) {
+                send_response(req_id, cmd_id, UART_MACHINE_STATUS_BAD_ARG, NULL, 0);
+                break;
+            }
+            uart_machine_sampler_t reply = {
+                .id = args[0],
+                .rate_hz = (uint16_t)stats.rate_hz,
+                .samples = stats.samples,
+                .min_period_us = stats.min_period_us,
+                .max_period_us = stats.max_period_us,
+                .mean_period_us = stats.mean_period_us,
+                .max_exec_us = stats.max_exec_us,
+                .missed = stats.missed,
+            };
+            send_response(req_id, cmd_id, UART_MACHINE_STATUS_OK, &reply, sizeof(reply));
+            break;
+        }
+
+        case UART_MACHINE_CMD_SET_SAMPLER_RATE: {
+            if (arg_len != 3) {
+                send_response(req_id, cmd_id, UART_MACHINE_STATUS_BAD_LENGTH, NULL, 0);
+                break;
+            }
+            uint16_t rate_hz = (uint16_t)(args[1] | (args[2] << 8));
+            esp_err_t ret = sampler_set_rate(args[0], rate_hz);
+            send_response(req_id, cmd_id,
+                          ret == ESP_OK ? UART_MACHINE_STATUS_OK :
+                          ret == ESP_ERR_INVALID_ARG ? UART_MACHINE_STATUS_BAD_ARG : UART_MACHINE_STATUS_FAILED,
+                          NULL, 0);
+            break;
+        }
+
+        case UART_MACHINE_CMD_SET_TELEMETRY_FMT: {
+            if (arg_len != 1) {
+                send_response(req_id, cmd_id, UART_MACHINE_STATUS_BAD_LENGTH, NULL, 0);
+                break;
+            }
+            if (args[0] != TELEMETRY_FORMAT_JSON && args[0] != TELEMETRY_FORMAT_BINARY) {
+                send_response(req_id, cmd_id, UART_MACHINE_STATUS_BAD_ARG, NULL, 0);
+                break;
+            }
+            telemetry_set_format((telemetry_format_t)args[0]);
+            send_response(req_id, cmd_id, UART_MACHINE_STATUS_OK, NULL, 0);
+            break;
+        }
+
+        case UART_MACHINE_CMD_GET_STATS: {
+            uart_machine_stats_t stats;
+            taskENTER_CRITICAL(&machine_stats_mux);
+            stats = machine_stats;
+            taskEXIT_CRITICAL(&machine_stats_mux);
+            send_response(req_id, cmd_id, UART_MACHINE_STATUS_OK, &stats, sizeof(stats));
+            break;
+        }
+
+        default:
+            send_response(req_id, cmd_id, UART_MACHINE_STATUS_UNKNOWN_CMD, NULL, 0);
+            break;
+    }
+}
+
+/* -------------------- 3. 帧接收 -------------------- */
+
+/**
+ * @brief 校验一个完整的请求帧并分派。
+ */
+static void handle_frame(const uint8_t *frame, bool serial)
+{
+    uint8_t len = frame[2];
+    const uint8_t *crc_pos = &frame[TELEMETRY_FRAME_HEADER_SIZE + len];
+    uint16_t crc = (uint16_t)(crc_pos[0] | (crc_pos[1] << 8));
+
+    // CRC 覆盖 type 到 payload 末尾
+    if (telemetry_crc16(&frame[1], TELEMETRY_FRAME_HEADER_SIZE - 1 + len) != crc) {
+        taskENTER_CRITICAL(&machine_stats_mux);
+        machine_stats.crc_errors++;
+        taskEXIT_CRITICAL(&machine_stats_mux);
+        return;
+    }
+    if (frame[1] != TELEMETRY_FRAME_REQUEST || len == 0) {
+        return; // 非请求帧或缺少命令ID，忽略
+    }
+
+    taskENTER_CRITICAL(&machine_stats_mux);
+    machine_stats.requests++;
+    taskEXIT_CRITICAL(&machine_stats_mux);
+    uint16_t req_id = (uint16_t)(frame[3] | (frame[4] << 8));
+    const uint8_t *payload = &frame[TELEMETRY_FRAME_HEADER_SIZE];
+    dispatch_request(req_id, payload[0], payload + 1, len - 1, serial);
+}
+
+void uart_machine_process_frame(const uint8_t *frame, size_t len, bool serial)
+{
+    if (frame == NULL || len < TELEMETRY_FRAME_OVERHEAD || frame[0] != TELEMETRY_FRAME_SYNC ||
+        len != (size_t)TELEMETRY_FRAME_OVERHEAD + frame[2]) {
+        stats_add_dropped(len);
+        return;
+    }
+    if (serial && !machine_active) {
+        // 排队期间已经退出机器模式 (EXIT 或 '+++')，不再在文本命令行上输出二进制响应
+        stats_add_dropped(len);
+        return;
+    }
+    handle_frame(frame, serial);
+}
+
+void uart_machine_enter(void)
+{
+    // 帧接收器由接收上下文复位，这里只做标记
+    rx_restart = true;
+    machine_active = true;
+}
+
+bool uart_machine_is_active(void)
+{
+    return machine_active;
+}
+
+void uart_machine_feed(const uint8_t *data, size_t len)
+{
+    // 接收到一半的帧之后长时间没有数据 (例如误收到一个 0xA5)：丢弃已接收的部分重新等待同步字节，
+    // 否则下一条请求会被当作这一帧的剩余部分吞掉
+    if (rx_restart) {
+        rx_restart = false;
+        rx_state = RX_WAIT_SYNC;
+        rx_count = 0;
+        escape_count = 0;
+    }
+    uint32_t now_ms = millis();
+    if (rx_state != RX_WAIT_SYNC && len > 0 && machine_active &&
+        now_ms - rx_last_ms > UART_MACHINE_RX_TIMEOUT_MS) {
+        stats_add_dropped(rx_count);
+        rx_state = RX_WAIT_SYNC;
+        rx_count = 0;
+    }
+    rx_last_ms = now_ms;
+
+    for (size_t i = 0; i < len && machine_active; i++) {
+        uint8_t byte = data[i];
+
+        switch (rx_state) {
+            case RX_WAIT_SYNC:
+                if (byte == TELEMETRY_FRAME_SYNC) {
+                    rx_frame[0] = byte;
+                    rx_count = 1;
+                    rx_state = RX_HEADER;
+                    escape_count = 0;
+                } else if (byte == UART_MACHINE_ESCAPE_CHAR) {
+                    if (++escape_count >= UART_MACHINE_ESCAPE_COUNT) {
+                        machine_active = false;
+                        uart_parser_put_string("\r\nMachine mode exited.\r\n> ");
+                    }
+                } else {
+                    escape_count = 0;
+                    stats_add_dropped(1);
+                }
+                break;
+
+            case RX_HEADER:
+                rx_frame[rx_count++] = byte;
+                if (rx_count == TELEMETRY_FRAME_HEADER_SIZE) {
+                    rx_expected = TELEMETRY_FRAME_OVERHEAD + rx_frame[2];
+                    rx_state = RX_BODY;
+                }
+                break;
+
+            case RX_BODY:
+                rx_frame[rx_count++] = byte;
+                if (rx_count == rx_expected) {
+                    // 接收回调只负责组帧，请求与文本命令一样在 uart_parser_task 中执行
+                    if (uart_parser_queue_serial_frame(rx_frame, rx_count) != pdPASS) {
+                        stats_add_dropped(rx_count);
+                    }
+                    rx_state = RX_WAIT_SYNC;
+                    rx_count = 0;
+                }
+                break;
+        }
+    }
+}
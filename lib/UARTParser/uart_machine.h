@@ -0,0 +1,155 @@
+#ifndef UART_MACHINE_H
+#define UART_MACHINE_H
+/**
+ * @file uart_machine.h
+ * @brief UART 机器模式 (二进制请求/响应协议)
+ *
+ * @details
+ * 与人机交互的文本命令行并存，用 'machine_mode' 命令切换进入。
+ * 请求与响应都使用 lib/Telemetry 的二进制帧格式：
+ * @code
+ * +------+------+-----+---------+-------------+---------+
+ * | sync | type | len | seq     | payload     | crc16   |
+ * | 0xA5 | u8   | u8  | u16     | len 字节    | u16     |
+ * +------+------+-----+---------+-------------+---------+
+ * @endcode
+ *  - 请求: type = TELEMETRY_FRAME_REQUEST, seq = 请求ID (由上位机分配),
+ *          payload = cmd_id (u8) + 参数
+ *  - 响应: type = TELEMETRY_FRAME_RESPONSE,
+ *          payload = req_id (u16) + cmd_id (u8) + status (u8) + 数据 (紧凑结构体)
+ * 上位机可以连续发送多条请求 (流水线)，用 req_id 匹配响应。
+ * CRC 错误的请求直接丢弃，不产生响应。
+ * 帧内字节间隔超过 20ms 时丢弃未完成的帧，重新等待同步字节。
+ * 在空闲状态连续收到 "+++" 也会退出机器模式，便于手动恢复。
+ * 网络连接上收到的请求帧 (lib/Wifi 的网络接收任务) 不需要切换模式，响应回到原连接。
+ * 串口和网络的请求都在 uart_parser_task 中执行，请求帧不超过 UART_PARSER_LINE_SIZE 字节，
+ * 超长或解析队列已满的帧被丢弃 (计入 bytes_dropped)。
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 机器模式命令ID
+ */
+typedef enum {
+    UART_MACHINE_CMD_PING               = 0x00,  // 原样返回参数
+    UART_MACHINE_CMD_EXIT               = 0x01,  // 退出机器模式，回到文本命令行
+    UART_MACHINE_CMD_GET_SYS_INFO       = 0x02,  // 返回 uart_machine_sys_info_t
+    UART_MACHINE_CMD_GET_ENCODER        = 0x03,  // 返回 u32 version + telemetry_encoder_payload_t
+    UART_MACHINE_CMD_GET_JOYSTICK       = 0x04,  // 返回 u32 version + telemetry_joystick_payload_t
+    UART_MACHINE_CMD_GET_NETWORK_TX     = 0x05,  // 返回 uart_machine_network_tx_t
+    UART_MACHINE_CMD_GET_SAMPLER        = 0x06,  // 参数 u8 id，返回 uart_machine_sampler_t
+    UART_MACHINE_CMD_SET_SAMPLER_RATE   = 0x07,  // 参数 u8 id + u16 rate_hz
+    UART_MACHINE_CMD_SET_TELEMETRY_FMT  = 0x08,  // 参数 u8 (0 = JSON, 1 = 二进制)
+    UART_MACHINE_CMD_GET_STATS          = 0x09,  // 返回 uart_machine_stats_t
+} uart_machine_cmd_t;
+
+/**
+ * @brief 响应状态码
+ */
+typedef enum {
+    UART_MACHINE_STATUS_OK          = 0,
+    UART_MACHINE_STATUS_UNKNOWN_CMD = 1,  // 未知命令ID
+    UART_MACHINE_STATUS_BAD_LENGTH  = 2,  // 参数长度错误
+    UART_MACHINE_STATUS_BAD_ARG     = 3,  // 参数值无效
+    UART_MACHINE_STATUS_FAILED      = 4,  // 执行失败
+} uart_machine_status_t;
+
+/**
+ * @brief 响应载荷头 (4 字节)，后接命令相关的数据
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t req_id;   // 对应请求的 seq
+    uint8_t  cmd_id;   // 对应请求的命令ID
+    uint8_t  status;   // uart_machine_status_t
+} uart_machine_response_header_t;
+
+/**
+ * @brief GET_SYS_INFO 响应数据
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t uptime_ms;
+    uint32_t free_heap;
+    uint16_t cpu_mhz;
+    uint8_t  wifi_connected;
+    uint8_t  network_connected;
+} uart_machine_sys_info_t;
+
+/**
+ * @brief GET_NETWORK_TX 响应数据
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t frames_sent;
+    uint32_t flushes;
+    uint32_t bytes_sent;
+    uint32_t send_failures;
+    uint32_t pool_exhausted;
+    uint32_t client_drops;
+    uint16_t flush_interval_ms;
+    uint8_t  client_count;
+} uart_machine_network_tx_t;
+
+/**
+ * @brief GET_SAMPLER 响应数据 (周期单位: 微秒)
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t  id;
+    uint16_t rate_hz;
+    uint32_t samples;
+    uint32_t min_period_us;
+    uint32_t max_period_us;
+    uint32_t mean_period_us;
+    uint32_t max_exec_us;
+    uint32_t missed;
+} uart_machine_sampler_t;
+
+/**
+ * @brief GET_STATS 响应数据
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t requests;     // 收到的有效请求数
+    uint32_t crc_errors;   // CRC 校验失败的帧数
+    uint32_t bytes_dropped; // 同步过程中丢弃的字节数
+} uart_machine_stats_t;
+
+/**
+ * @brief 进入机器模式 (由 'machine_mode' 文本命令调用)
+ */
+void uart_machine_enter(void);
+
+/**
+ * @brief 当前是否处于机器模式
+ */
+bool uart_machine_is_active(void);
+
+/**
+ * @brief 机器模式下的字节流入口 (由 uart_parser_feed 转发)
+ * @details 只负责组帧：完整的请求帧用 uart_parser_queue_serial_frame 送入解析队列，
+ *          与文本命令和网络请求在同一个任务中执行。
+ * @param data 接收到的字节
+ * @param len  字节数
+ */
+void uart_machine_feed(const uint8_t *data, size_t len);
+
+/**
+ * @brief 处理一个完整的请求帧 (在 uart_parser_task 中执行)
+ * @details 串口请求由 uart_machine_feed 组帧后经解析队列送来；其他传输提交的请求不要求处于机器模式，
+ *          响应通过 uart_parser_put_bytes 输出，由 uart_parser 交给请求的来源；EXIT 只回复 OK，
+ *          不影响串口的机器模式。
+ * @param frame  以同步字节开头的完整帧
+ * @param len    帧长度，必须等于 TELEMETRY_FRAME_OVERHEAD + len 字段
+ * @param serial 请求是否来自串口 (排队期间已退出机器模式的串口请求被丢弃)
+ */
+void uart_machine_process_frame(const uint8_t *frame, size_t len, bool serial);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UART_MACHINE_H */
@@ -1,4 +1,6 @@
 #include "uart_parser.h"
+#include "uart_command_index.h"
+#include "uart_machine.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -10,17 +12,41 @@
 // 包含 ESP-IDF 和项目相关的头文件
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "soc/soc.h"  // 包含 CPU 频率相关函数
 #include "wifi_task.h" // 包含用于获取WiFi状态的函数
 #include "Arduino.h" // 包含 Arduino 功能，如 WiFi.localIP()
+#include "telemetry_frame.h" // 遥测输出格式切换
 
 /* 宏定义 */
-#define UART_PARSER_QUEUE_LENGTH    8      // 命令队列深度
-#define UART_PARSER_MAX_CMD_LEN     64     // 支持的最大命令长度
-#define UART_PARSER_MAX_ARGS        8      // 支持的最大参数数量
+#define UART_PARSER_QUEUE_LENGTH    UART_PARSER_POOL_SIZE  // 命令队列深度 (与缓冲池大小一致，入队不会失败)
+#define UART_PARSER_RX_CHUNK_SIZE   64     // 串口接收回调每次读取的字节数
 
 /* FreeRTOS 相关的句柄 */
 static QueueHandle_t uart_command_queue = NULL; // 用于接收命令字符串指针的消息队列
+static QueueHandle_t uart_free_queue = NULL;    // 命令缓冲池的空闲缓冲区指针
+
+/* 命令缓冲池：每条排队中的命令独占一个缓冲区，解析完成后归还 */
+static char uart_line_pool[UART_PARSER_POOL_SIZE][UART_PARSER_LINE_SIZE];
+
+/* 行组装器状态 (仅由 uart_parser_feed 访问) */
+static char *rx_line = NULL;      // 正在组装的命令缓冲区，NULL 表示尚未分配
+static size_t rx_length = 0;      // 当前已组装的字符数
+static bool rx_discarding = false; // 缓冲池耗尽，丢弃当前行剩余部分
+
+/* 每个缓冲区的来源信息 (与 uart_line_pool 下标对应)，串口命令和串口请求帧的 reply 为 NULL */
+static uart_parser_origin_t uart_line_origin[UART_PARSER_POOL_SIZE];
+static uint16_t uart_line_frame_len[UART_PARSER_POOL_SIZE];  // 机器模式请求帧长度，0 表示文本命令
+static uint32_t uart_line_submit_us[UART_PARSER_POOL_SIZE];  // 入队时刻
+
+/* 正在执行的远程命令的输出收集 (仅由 uart_parser_task 访问) */
+static TaskHandle_t parser_task_handle = NULL;
+static const uart_parser_origin_t *reply_origin = NULL;
+static uint8_t reply_buffer[UART_PARSER_REPLY_BUFFER_SIZE];
+static size_t reply_length = 0;
+
+static uart_parser_submit_stats_t submit_stats;
+static portMUX_TYPE submit_stats_mux = portMUX_INITIALIZER_UNLOCKED;
 
 /* -------------------- 1. 命令处理函数的实现 -------------------- */
 // 在这里添加您的命令处理函数。
@@ -108,11 +134,47 @@ static void handle_wifi_reconnect(int argc, char *argv[]);
  */
 static void handle_network_reconnect(int argc, char *argv[]);
 
+/**
+ * @brief 'network_tx' 命令的处理函数。
+ * 用法: network_tx [flush_interval_ms]
+ */
+static void handle_network_tx(int argc, char *argv[]);
+
+/**
+ * @brief 'network_udp' 命令的处理函数。
+ * 用法: network_udp [discover]
+ */
+static void handle_network_udp(int argc, char *argv[]);
+
+/**
+ * @brief 'network_rx' 命令的处理函数。
+ * 用法: network_rx
+ */
+static void handle_network_rx(int argc, char *argv[]);
+
+/**
+ * @brief 'network_link' 命令的处理函数。
+ * 用法: network_link
+ */
+static void handle_network_link(int argc, char *argv[]);
+
+/**
+ * @brief 'telemetry_format' 命令的处理函数。
+ * 用法: telemetry_format [json|binary]
+ */
+static void handle_telemetry_format(int argc, char *argv[]);
+
+/**
+ * @brief 'machine_mode' 命令的处理函数。
+ * 用法: machine_mode
+ */
+static void handle_machine_mode(int argc, char *argv[]);
+
 
 /* -------------------- 2. 命令分派表 -------------------- */
 // 在这里将您的命令和处理函数关联起来。
 
-static const command_t command_table[] = {
+static constexpr command_t command_table[] = {
     /* 命令名           处理函数指针              帮助信息字符串 */
     {"help",            handle_help,            "help: 显示所有可用命令。"},
     {"reboot",          handle_reboot,          "reboot: 重启设备。"},
@@ -132,6 +194,17 @@ static const command_t command_table[] = {
     {"network_config",     handle_network_config,     "network_config: 显示当前网络配置信息。"},
     {"network_send",       handle_network_send,       "network_send <message>: 通过网络发送消息。"},
     {"network_reconnect",  handle_network_reconnect,  "network_reconnect: 使用当前配置重新连接网络。"},
+    {"network_tx",         handle_network_tx,         "network_tx [flush_interval_ms]: 查看发送聚合统计或设置刷新时间窗。"},
+    {"network_udp",        handle_network_udp,        "network_udp [discover]: 查看 UDP 每秒发送/失败计数，或重新发现地面站。"},
+    {"network_rx",         handle_network_rx,         "network_rx: 查看网络下行命令的接收统计与分派延迟。"},
+    {"network_link",       handle_network_link,       "network_link: 查看连接管理状态、退避与重连计数。"},
+    
+    /* 遥测控制命令 */
+    {"telemetry_format",   handle_telemetry_format,   "telemetry_format [json|binary]: 查看或切换遥测输出格式。"},
+    
+    /* 上位机接口 */
+    {"machine_mode",       handle_machine_mode,       "machine_mode: 切换到二进制请求/响应模式 (EXIT 命令或 '+++' 返回)。"},
+
     /* --- 您可以在此行下方添加您的新命令 --- */
     
 };
@@ -139,54 +212,221 @@ static const command_t command_table[] = {
 // 计算命令表中的命令总数
 static const int num_commands = sizeof(command_table) / sizeof(command_t);
 
+// 编译期检查：内置命令的哈希互不相同，分派时每条命令最多只需一次 strcmp 确认
+static constexpr bool command_hash_unique_with(int i, int j)
+{
+    return j >= (int)(sizeof(command_table) / sizeof(command_t)) ||
+           (uart_parser_hash(command_table[i].name) != uart_parser_hash(command_table[j].name) &&
+            command_hash_unique_with(i, j + 1));
+}
+
+static constexpr bool command_hashes_unique(int i)
+{
+    return i >= (int)(sizeof(command_table) / sizeof(command_t)) ||
+           (command_hash_unique_with(i, i + 1) && command_hashes_unique(i + 1));
+}
+
+static_assert(command_hashes_unique(0), "duplicate command name or FNV-1a hash collision in command_table");
+
+/* 其他模块注册的命令表 (按注册顺序，供 'help' 列出) */
+typedef struct {
+    const command_t *table;
+    size_t count;
+} command_table_ref_t;
+
+static command_table_ref_t registered_tables[UART_PARSER_MAX_COMMAND_TABLES];
+static volatile size_t registered_table_count = 0;
+
+static bool builtin_commands_indexed = false;
+static portMUX_TYPE registered_tables_mux = portMUX_INITIALIZER_UNLOCKED;
+
 
 /* -------------------- 3. 核心解析与分派逻辑 -------------------- */
 
 /**
- * @brief 解析并执行命令。
- * @param cmd_string 从队列中接收到的原始命令字符串。
+ * @brief 确保内置命令表已加入索引 (首次注册或解析任务启动时调用)。
  */
-static void process_command(char *cmd_string)
+static void command_index_init_builtin(void)
 {
-    char *argv[UART_PARSER_MAX_ARGS];
-    int argc = 0;
-    char response_buffer[128]; // 用于格式化输出
+    if (!builtin_commands_indexed) {
+        builtin_commands_indexed = true;
+        uart_command_index_insert(command_table, num_commands);
+    }
+}
 
-    // 使用strtok来分割字符串。注意：strtok会修改原字符串。
-    char *token = strtok(cmd_string, " \t\n\r"); // 以空格、制表符、换行符、回车符作为分隔符
-    while (token != NULL && argc < UART_PARSER_MAX_ARGS) {
-        argv[argc++] = token;
-        token = strtok(NULL, " \t\n\r");
+int uart_parser_register_commands(const command_t *table, size_t count)
+{
+    if (table == NULL || count == 0) {
+        return pdFAIL;
     }
+    
+    command_index_init_builtin();
+    
+    taskENTER_CRITICAL(&registered_tables_mux);
+    size_t slot = registered_table_count;
+    if (slot < UART_PARSER_MAX_COMMAND_TABLES) {
+        registered_tables[slot].table = table;
+        registered_tables[slot].count = count;
+        registered_table_count = slot + 1;
+    }
+    taskEXIT_CRITICAL(&registered_tables_mux);
+    
+    if (slot >= UART_PARSER_MAX_COMMAND_TABLES) {
+        ESP_LOGE("UART_PARSER", "Command table limit reached, '%s' not registered", table[0].name);
+        return pdFAIL;
+    }
+    
+    size_t inserted = uart_command_index_insert(table, count);
+    if (inserted != count) {
+        ESP_LOGW("UART_PARSER", "%u of %u commands from '%s' table skipped (duplicate or index full)",
+                 (unsigned)(count - inserted), (unsigned)count, table[0].name);
+        return pdFAIL;
+    }
+    return pdPASS;
+}
+
+/* -------------------- 4. FreeRTOS 任务与队列接口 -------------------- */
 
-    if (argc == 0) {
-        return; // 空命令，直接忽略
+/**
+ * @brief 创建命令队列与命令缓冲池。
+ * @return pdPASS 成功，pdFAIL 内存不足。
+ */
+static BaseType_t uart_parser_init_queues(void)
+{
+    uart_free_queue = xQueueCreate(UART_PARSER_POOL_SIZE, sizeof(char *));
+    uart_command_queue = xQueueCreate(UART_PARSER_QUEUE_LENGTH, sizeof(char *));
+    if (uart_free_queue == NULL || uart_command_queue == NULL) {
+        return pdFAIL;
+    }
+    
+    for (int i = 0; i < UART_PARSER_POOL_SIZE; i++) {
+        char *p_buffer = uart_line_pool[i];
+        xQueueSend(uart_free_queue, &p_buffer, 0);
     }
+    return pdPASS;
+}
 
-    // 在命令表中查找匹配的命令
-    for (int i = 0; i < num_commands; i++) {
-        if (strcmp(argv[0], command_table[i].name) == 0) {
-            // 找到命令，调用其处理函数
-            command_table[i].handler(argc, argv);
-            return;
-        }
+/**
+ * @brief 从缓冲池取一个空闲缓冲区 (不阻塞)。
+ * @return 缓冲区指针，缓冲池耗尽或尚未初始化时返回 NULL。
+ */
+static char *uart_parser_buffer_alloc(void)
+{
+    char *p_buffer = NULL;
+    if (uart_free_queue == NULL || xQueueReceive(uart_free_queue, &p_buffer, 0) != pdPASS) {
+        return NULL;
+    }
+    // 默认是来自串口的文本命令
+    size_t index = (size_t)(p_buffer - uart_line_pool[0]) / UART_PARSER_LINE_SIZE;
+    uart_line_origin[index].reply = NULL;
+    uart_line_frame_len[index] = 0;
+    return p_buffer;
+}
+
+/**
+ * @brief 归还缓冲区到缓冲池。
+ */
+static void uart_parser_buffer_free(char *p_buffer)
+{
+    if (p_buffer != NULL) {
+        xQueueSend(uart_free_queue, &p_buffer, 0);
     }
+}
 
-    // 如果循环结束仍未找到命令
-    snprintf(response_buffer, sizeof(response_buffer), "Error: Unknown command '%s'. Type 'help' for a list.\r\n", argv[0]);
-    uart_parser_put_string(response_buffer);
+/**
+ * @brief 把收集到的输出交给命令来源。
+ */
+static void reply_flush(void)
+{
+    if (reply_origin != NULL && reply_length > 0) {
+        reply_origin->reply(reply_buffer, reply_length, reply_origin->context);
+    }
+    reply_length = 0;
 }
 
+/**
+ * @brief 收集远程命令的输出，尽量不把一行文本或一个响应帧拆到两次回复中。
+ */
+static void reply_append(const uint8_t *data, size_t len)
+{
+    if (reply_length + len > sizeof(reply_buffer)) {
+        reply_flush();
+    }
+    while (len > 0) {
+        size_t n = sizeof(reply_buffer) - reply_length;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(&reply_buffer[reply_length], data, n);
+        reply_length += n;
+        data += n;
+        len -= n;
+        if (reply_length == sizeof(reply_buffer)) {
+            reply_flush();
+        }
+    }
+}
 
-/* -------------------- 4. FreeRTOS 任务与队列接口 -------------------- */
+/**
+ * @brief 当前输出是否属于正在执行的远程命令 (其他任务的输出仍然写到串口)。
+ */
+static bool reply_is_routed(void)
+{
+    return reply_origin != NULL && xTaskGetCurrentTaskHandle() == parser_task_handle;
+}
+
+/**
+ * @brief 执行一个缓冲区中的命令 (文本命令或远程提交的机器模式请求帧)。
+ */
+static void execute_buffer(char *p_buffer)
+{
+    size_t index = (size_t)(p_buffer - uart_line_pool[0]) / UART_PARSER_LINE_SIZE;
+    const uart_parser_origin_t *origin = &uart_line_origin[index];
+    
+    if (origin->reply == NULL) {
+        if (uart_line_frame_len[index] > 0) {
+            // 串口机器模式请求：响应直接写到串口，不输出提示符
+            uart_machine_process_frame((const uint8_t *)p_buffer, uart_line_frame_len[index], true);
+            return;
+        }
+        uart_command_execute(p_buffer);
+        // 提示符 (机器模式下不输出，避免混入二进制流)
+        if (!uart_machine_is_active()) {
+            uart_parser_put_string("> ");
+        }
+        return;
+    }
+    
+    uint32_t wait_us = (uint32_t)esp_timer_get_time() - uart_line_submit_us[index];
+    taskENTER_CRITICAL(&submit_stats_mux);
+    submit_stats.last_wait_us = wait_us;
+    submit_stats.total_wait_us += wait_us;
+    if (wait_us > submit_stats.max_wait_us) {
+        submit_stats.max_wait_us = wait_us;
+    }
+    taskEXIT_CRITICAL(&submit_stats_mux);
+    
+    reply_origin = origin;
+    reply_length = 0;
+    if (uart_line_frame_len[index] > 0) {
+        uart_machine_process_frame((const uint8_t *)p_buffer, uart_line_frame_len[index], false);
+    } else {
+        uart_command_execute(p_buffer);
+    }
+    reply_flush();
+    reply_origin = NULL;
+}
 
 void uart_parser_task(void *argument)
 {
-    // 创建消息队列
-    // 队列中存储的是指向命令字符串缓冲区的指针
-    uart_command_queue = xQueueCreate(UART_PARSER_QUEUE_LENGTH, sizeof(char *));
+    parser_task_handle = xTaskGetCurrentTaskHandle();
     
-    if (uart_command_queue == NULL) {
+    // 建立内置命令的哈希索引
+    command_index_init_builtin();
+    
+    // 创建消息队列与命令缓冲池
+    // 队列中存储的是指向命令缓冲区的指针
+    if (uart_parser_init_queues() != pdPASS) {
         // 队列创建失败，可以在这里处理错误，例如打印日志或进入死循环
         uart_parser_put_string("Fatal Error: Failed to create command queue!\r\n");
         while(1);
@@ -201,15 +441,10 @@ void uart_parser_task(void *argument)
         if (xQueueReceive(uart_command_queue, &p_command_buffer, portMAX_DELAY) == pdPASS) {
             if (p_command_buffer != NULL) {
                 // 处理接收到的命令
-                process_command(p_command_buffer);
-                
-                // 提示符
-                uart_parser_put_string("> ");
-
-                // 重要：在这里释放用于存储命令字符串的内存。
-                // 假设这块内存是在接收端（如UART中断）动态分配的。
-                // 如果使用静态缓冲区，则不需要释放。
-                // free(p_command_buffer); 
+                execute_buffer(p_command_buffer);
+
+                // 命令处理完毕，归还缓冲区
+                uart_parser_buffer_free(p_command_buffer);
             }
         }
     }
@@ -217,22 +452,195 @@ void uart_parser_task(void *argument)
 
 int uart_parser_send_command_to_queue(char *cmd_string)
 {
-    if (uart_command_queue == NULL) {
+    if (uart_command_queue == NULL || cmd_string == NULL) {
         return pdFAIL;
     }
     
-    // 注意：这里只是将指针发送到队列，而不是整个字符串。
-    // 这要求指针指向的内存在被 uart_parser_task 处理之前必须是有效的。
-    // 在ISR中调用时，应使用 xQueueSendFromISR。
-    // 这里提供一个任务上下文的版本。
-    if (xQueueSend(uart_command_queue, &cmd_string, (TickType_t)0) != pdPASS) {
+    // 复制到缓冲池中的缓冲区，调用者的缓冲区可以立即复用
+    char *p_buffer = uart_parser_buffer_alloc();
+    if (p_buffer == NULL) {
+        // 缓冲池已满
+        return errQUEUE_FULL;
+    }
+    strncpy(p_buffer, cmd_string, UART_PARSER_LINE_SIZE - 1);
+    p_buffer[UART_PARSER_LINE_SIZE - 1] = '\0';
+    
+    if (xQueueSend(uart_command_queue, &p_buffer, (TickType_t)0) != pdPASS) {
         // 队列已满
+        uart_parser_buffer_free(p_buffer);
+        return errQUEUE_FULL;
+    }
+
+    return pdPASS;
+}
+
+int uart_parser_submit(const uint8_t *data, size_t len, const uart_parser_origin_t *origin)
+{
+    if (uart_command_queue == NULL || data == NULL || len == 0 || origin == NULL || origin->reply == NULL) {
+        return pdFAIL;
+    }
+    
+    bool frame = (data[0] == TELEMETRY_FRAME_SYNC);
+    if (frame && len > UART_PARSER_LINE_SIZE) {
+        taskENTER_CRITICAL(&submit_stats_mux);
+        submit_stats.rejected++;
+        taskEXIT_CRITICAL(&submit_stats_mux);
+        return pdFAIL;
+    }
+    
+    char *p_buffer = uart_parser_buffer_alloc();
+    if (p_buffer == NULL) {
+        taskENTER_CRITICAL(&submit_stats_mux);
+        submit_stats.rejected++;
+        taskEXIT_CRITICAL(&submit_stats_mux);
         return errQUEUE_FULL;
     }
+    
+    size_t index = (size_t)(p_buffer - uart_line_pool[0]) / UART_PARSER_LINE_SIZE;
+    if (frame) {
+        memcpy(p_buffer, data, len);
+        uart_line_frame_len[index] = (uint16_t)len;
+    } else {
+        // 去掉行尾的换行，超长部分截断
+        while (len > 0 && (data[len - 1] == '\r' || data[len - 1] == '\n')) {
+            len--;
+        }
+        if (len > UART_PARSER_LINE_SIZE - 1) {
+            len = UART_PARSER_LINE_SIZE - 1;
+        }
+        memcpy(p_buffer, data, len);
+        p_buffer[len] = '\0';
+    }
+    uart_line_origin[index] = *origin;
+    uart_line_submit_us[index] = (uint32_t)esp_timer_get_time();
+    
+    // 队列深度等于缓冲池大小，入队不会失败
+    xQueueSend(uart_command_queue, &p_buffer, 0);
+    
+    taskENTER_CRITICAL(&submit_stats_mux);
+    submit_stats.submitted++;
+    taskEXIT_CRITICAL(&submit_stats_mux);
+    return pdPASS;
+}
 
+int uart_parser_queue_serial_frame(const uint8_t *frame, size_t len)
+{
+    if (uart_command_queue == NULL || frame == NULL || len == 0 || len > UART_PARSER_LINE_SIZE) {
+        return pdFAIL;
+    }
+    
+    char *p_buffer = uart_parser_buffer_alloc();
+    if (p_buffer == NULL) {
+        return errQUEUE_FULL;
+    }
+    size_t index = (size_t)(p_buffer - uart_line_pool[0]) / UART_PARSER_LINE_SIZE;
+    memcpy(p_buffer, frame, len);
+    uart_line_frame_len[index] = (uint16_t)len;
+    
+    // 队列深度等于缓冲池大小，入队不会失败
+    xQueueSend(uart_command_queue, &p_buffer, 0);
     return pdPASS;
 }
 
+void uart_parser_get_submit_stats(uart_parser_submit_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    taskENTER_CRITICAL(&submit_stats_mux);
+    *stats = submit_stats;
+    taskEXIT_CRITICAL(&submit_stats_mux);
+}
+
+int uart_parser_command_is_remote(void)
+{
+    return reply_is_routed();
+}
+
+void uart_parser_dispatch(char *line)
+{
+    command_index_init_builtin();
+    uart_command_execute(line);
+}
+
+void uart_parser_feed(const uint8_t *data, size_t len)
+{
+    // 机器模式：不回显，字节流直接交给帧接收器；丢弃切换前未完成的命令行
+    if (uart_machine_is_active()) {
+        if (rx_line != NULL) {
+            uart_parser_buffer_free(rx_line);
+            rx_line = NULL;
+        }
+        rx_length = 0;
+        rx_discarding = false;
+        uart_machine_feed(data, len);
+        return;
+    }
+    
+    // 回显缓冲区：退格最多展开为3个字符
+    char echo[UART_PARSER_RX_CHUNK_SIZE * 3 + 1];
+    size_t echo_len = 0;
+    
+    for (size_t i = 0; i < len; i++) {
+        char received_char = (char)data[i];
+        
+        // 回显缓冲区将满时先输出
+        if (echo_len + 3 >= sizeof(echo)) {
+            echo[echo_len] = '\0';
+            uart_parser_put_string(echo);
+            echo_len = 0;
+        }
+        
+        // 判断是否是命令结束符 (回车或换行)
+        if (received_char == '\r' || received_char == '\n') {
+            echo[echo_len++] = received_char;
+            if (rx_line != NULL && rx_length > 0) {
+                // 命令接收完毕，整块送入解析队列；队列深度等于缓冲池大小，入队不会失败
+                rx_line[rx_length] = '\0';
+                xQueueSend(uart_command_queue, &rx_line, 0);
+                rx_line = NULL;
+            } else if (rx_discarding) {
+                echo[echo_len] = '\0';
+                uart_parser_put_string(echo);
+                echo_len = 0;
+                uart_parser_put_string("\r\nError: Parser busy, command dropped.\r\n");
+            }
+            rx_length = 0;
+            rx_discarding = false;
+        } else if (received_char == '\b' || received_char == 127) { // 处理退格键
+            if (rx_length > 0) {
+                rx_length--;
+                // 在终端上回显退格、空格、退格，以实现删除效果
+                echo[echo_len++] = '\b';
+                echo[echo_len++] = ' ';
+                echo[echo_len++] = '\b';
+            }
+        } else {
+            echo[echo_len++] = received_char;
+            if (rx_discarding) {
+                continue;
+            }
+            // 每行第一个字符到达时才从缓冲池取缓冲区
+            if (rx_line == NULL) {
+                rx_line = uart_parser_buffer_alloc();
+                if (rx_line == NULL) {
+                    rx_discarding = true;
+                    continue;
+                }
+            }
+            // 将字符存入缓冲区，超长部分截断
+            if (rx_length < UART_PARSER_LINE_SIZE - 1) {
+                rx_line[rx_length++] = received_char;
+            }
+        }
+    }
+    
+    if (echo_len > 0) {
+        echo[echo_len] = '\0';
+        uart_parser_put_string(echo);
+    }
+}
+
 /* -------------------- 5. 命令处理函数的具体实现 -------------------- */
 
 static void handle_help(int argc, char *argv[])
@@ -243,6 +651,13 @@ static void handle_help(int argc, char *argv[])
         snprintf(buffer, sizeof(buffer), "  - %s\r\n", command_table[i].help_string);
         uart_parser_put_string(buffer);
     }
+    // 其他模块注册的命令
+    for (size_t t = 0; t < registered_table_count; t++) {
+        for (size_t i = 0; i < registered_tables[t].count; i++) {
+            snprintf(buffer, sizeof(buffer), "  - %s\r\n", registered_tables[t].table[i].help_string);
+            uart_parser_put_string(buffer);
+        }
+    }
 }
 
 static void handle_reboot(int argc, char *argv[])
@@ -289,7 +704,7 @@ static void handle_get_wifi_status(int argc, char *argv[])
 static void handle_wifi_disconnect(int argc, char *argv[])
 {
     if (wifi_disconnect()) {
-        uart_parser_put_string("WiFi disconnected successfully.\r\n");
+        uart_parser_put_string("WiFi disconnect requested.\r\n");
     } else {
         uart_parser_put_string("Failed to disconnect WiFi.\r\n");
     }
@@ -307,17 +722,12 @@ static void handle_wifi_connect(int argc, char *argv[])
     const char* ssid = argv[1];
     const char* password = (argc >= 3) ? argv[2] : NULL;
     
-    snprintf(response, sizeof(response), "Connecting to WiFi: %s...\r\n", ssid);
-    uart_parser_put_string(response);
-    
+    // 连接在网络任务中进行，进度以 "[link] ..." 行异步输出
     if (wifi_connect_new(ssid, password, 15000)) {
-        snprintf(response, sizeof(response), 
-                "WiFi connected successfully!\r\n"
-                "IP Address: %s\r\n", 
-                WiFi.localIP().toString().c_str());
+        snprintf(response, sizeof(response), "Connecting to WiFi: %s (progress follows)...\r\n", ssid);
         uart_parser_put_string(response);
     } else {
-        uart_parser_put_string("Failed to connect to WiFi.\r\n");
+        uart_parser_put_string("Error: WiFi is not initialized in STA mode.\r\n");
     }
 }
 
@@ -363,7 +773,7 @@ static void handle_network_status(int argc, char *argv[])
 static void handle_network_disconnect(int argc, char *argv[])
 {
     if (network_disconnect()) {
-        uart_parser_put_string("Network disconnected successfully.\r\n");
+        uart_parser_put_string("Network disconnect requested.\r\n");
     } else {
         uart_parser_put_string("Failed to disconnect network.\r\n");
     }
@@ -386,13 +796,11 @@ static void handle_tcp_connect(int argc, char *argv[])
         return;
     }
     
-    snprintf(response, sizeof(response), "Connecting to TCP server %s:%d...\r\n", host, port);
-    uart_parser_put_string(response);
-    
     if (network_connect_tcp_client(host, port, 10000)) {
-        uart_parser_put_string("TCP connection established successfully!\r\n");
+        snprintf(response, sizeof(response), "Connecting to TCP server %s:%d (progress follows)...\r\n", host, port);
+        uart_parser_put_string(response);
     } else {
-        uart_parser_put_string("Failed to connect to TCP server.\r\n");
+        uart_parser_put_string("Error: WiFi is not initialized in STA mode.\r\n");
     }
 }
 
@@ -455,9 +863,9 @@ static void handle_network_send(int argc, char *argv[])
     }
     strcat(message, "\n");
     
-    int result = network_send_string(message);
+    int result = network_send_async((const uint8_t*)message, strlen(message));
     if (result > 0) {
-        snprintf(response, sizeof(response), "Message sent successfully (%d bytes).\r\n", result);
+        snprintf(response, sizeof(response), "Message queued successfully (%d bytes).\r\n", result);
         uart_parser_put_string(response);
     } else {
         uart_parser_put_string("Failed to send message. Check network connection.\r\n");
@@ -475,27 +883,17 @@ static void handle_wifi_reconnect(int argc, char *argv[])
         return;
     }
     
-    snprintf(response, sizeof(response), "Reconnecting to WiFi: %s...\r\n", config.ssid);
-    uart_parser_put_string(response);
-    
-    // 断开当前连接并重新连接
-    wifi_disconnect();
-    vTaskDelay(pdMS_TO_TICKS(1000)); // 等待断开完成
-    
-    if (wifi_connect_new(config.ssid, config.password, 15000)) {
-        snprintf(response, sizeof(response), 
-                "WiFi reconnected successfully!\r\n"
-                "IP Address: %s\r\n", 
-                WiFi.localIP().toString().c_str());
+    // 断开和重新关联都在网络任务中进行，不阻塞命令解析
+    if (wifi_reconnect()) {
+        snprintf(response, sizeof(response), "Reconnecting to WiFi: %s (progress follows)...\r\n", config.ssid);
         uart_parser_put_string(response);
     } else {
-        uart_parser_put_string("Failed to reconnect to WiFi.\r\n");
+        uart_parser_put_string("Error: WiFi is not initialized in STA mode.\r\n");
     }
 }
 
 static void handle_network_reconnect(int argc, char *argv[])
 {
-    char response[128];
     network_config_t config;
     
     // 获取当前网络配置
@@ -510,41 +908,252 @@ static void handle_network_reconnect(int argc, char *argv[])
         return;
     }
     
-    uart_parser_put_string("Reconnecting to network...\r\n");
+    // 所有协议都由网络任务关闭后按当前配置重新建立
+    if (network_reconnect()) {
+        uart_parser_put_string("Reconnecting to network (progress follows)...\r\n");
+    } else {
+        uart_parser_put_string("Error: WiFi is not initialized in STA mode.\r\n");
+    }
+}
+
+static void handle_network_tx(int argc, char *argv[])
+{
+    char response[320];
     
-    // 断开当前网络连接
-    network_disconnect();
-    vTaskDelay(pdMS_TO_TICKS(500)); // 等待断开完成
+    if (argc >= 2) {
+        char *end = NULL;
+        long interval_ms = strtol(argv[1], &end, 10);
+        if (end == argv[1] || *end != '\0' || interval_ms < 0 || interval_ms > 1000) {
+            uart_parser_put_string("Usage: network_tx [flush_interval_ms] (0-1000)\r\n");
+            return;
+        }
+        network_tx_set_flush_interval((uint32_t)interval_ms);
+    }
     
-    // 根据协议类型重新连接
-    switch (config.protocol) {
-        case NETWORK_PROTOCOL_TCP_CLIENT:
-            if (network_connect_tcp_client(config.remote_host, config.remote_port, 10000)) {
-                uart_parser_put_string("Network reconnected successfully!\r\n");
-            } else {
-                uart_parser_put_string("Failed to reconnect to network.\r\n");
-            }
-            break;
-            
-        case NETWORK_PROTOCOL_TCP_SERVER:
-        case NETWORK_PROTOCOL_UDP:
-            uart_parser_put_string("Note: Server/UDP modes don't require active reconnection.\r\n");
-            // 对于服务器模式和UDP，可以考虑重新初始化
-            break;
-            
-        default:
-            uart_parser_put_string("Error: Unsupported protocol for reconnection.\r\n");
-            break;
+    network_tx_stats_t stats;
+    network_tx_get_stats(&stats);
+    snprintf(response, sizeof(response),
+             "Network TX Aggregator:\r\n"
+             "  Flush Interval: %lu ms\r\n"
+             "  Batch Size: %d bytes\r\n"
+             "  Frames Sent: %lu\r\n"
+             "  Flushes: %lu\r\n"
+             "  Bytes Sent: %lu\r\n"
+             "  Send Failures: %lu\r\n"
+             "  Pool Exhausted: %lu\r\n"
+             "  Client Drops: %lu\r\n"
+             "  Outage Buffer: %lu buffered, %lu replayed, %lu dropped\r\n",
+             (unsigned long)network_tx_get_flush_interval(),
+             NETWORK_TX_BATCH_SIZE,
+             (unsigned long)stats.frames_sent,
+             (unsigned long)stats.flushes,
+             (unsigned long)stats.bytes_sent,
+             (unsigned long)stats.send_failures,
+             (unsigned long)stats.pool_exhausted,
+             (unsigned long)stats.client_drops,
+             (unsigned long)stats.outage_buffered,
+             (unsigned long)stats.outage_replayed,
+             (unsigned long)stats.outage_dropped);
+    uart_parser_put_string(response);
+}
+
+static void handle_network_udp(int argc, char *argv[])
+{
+    char response[320];
+    
+    if (argc >= 2) {
+        if (strcmp(argv[1], "discover") != 0) {
+            uart_parser_put_string("Usage: network_udp [discover]\r\n");
+            return;
+        }
+        if (network_udp_rediscover()) {
+            uart_parser_put_string("UDP discovery restarted.\r\n");
+        } else {
+            uart_parser_put_string("Error: UDP discovery is not active.\r\n");
+        }
+        return;
+    }
+    
+    network_udp_stats_t stats;
+    network_udp_get_stats(&stats);
+    char remote[24] = "none";
+    if (stats.remote_valid) {
+        const uint8_t* ip = (const uint8_t*)&stats.remote_ip;
+        snprintf(remote, sizeof(remote), "%u.%u.%u.%u:%u", ip[0], ip[1], ip[2], ip[3], stats.remote_port);
     }
+    snprintf(response, sizeof(response),
+             "UDP Fast Path:\r\n"
+             "  Remote: %s\r\n"
+             "  Discovery: %s (beacons %lu)\r\n"
+             "  Last Second: %lu pkt/s, %lu B/s, %lu fail/s\r\n"
+             "  Packets Sent: %lu\r\n"
+             "  Bytes Sent: %lu\r\n"
+             "  Send Failures: %lu\r\n",
+             remote,
+             stats.discovery ? "on" : "off",
+             (unsigned long)stats.beacons_sent,
+             (unsigned long)stats.packets_per_s,
+             (unsigned long)stats.bytes_per_s,
+             (unsigned long)stats.failures_per_s,
+             (unsigned long)stats.packets_sent,
+             (unsigned long)stats.bytes_sent,
+             (unsigned long)stats.send_failures);
+    uart_parser_put_string(response);
+}
+
+static void handle_network_rx(int argc, char *argv[])
+{
+    char response[320];
+    
+    network_rx_stats_t rx;
+    uart_parser_submit_stats_t submit;
+    network_rx_get_stats(&rx);
+    uart_parser_get_submit_stats(&submit);
+    uint32_t mean_wait_us = submit.submitted > 0 ? (uint32_t)(submit.total_wait_us / submit.submitted) : 0;
+    
+    snprintf(response, sizeof(response),
+             "Network RX (commands):\r\n"
+             "  Bytes Received: %lu\r\n"
+             "  Text Commands: %lu\r\n"
+             "  Request Frames: %lu\r\n"
+             "  Dropped: %lu (parser rejected %lu)\r\n"
+             "  Reply Bytes: %lu\r\n"
+             "  Reply Failures: %lu\r\n"
+             "  Dispatch Wait: last %lu us, mean %lu us, max %lu us\r\n",
+             (unsigned long)rx.bytes_received,
+             (unsigned long)rx.lines,
+             (unsigned long)rx.frames,
+             (unsigned long)rx.dropped,
+             (unsigned long)submit.rejected,
+             (unsigned long)rx.reply_bytes,
+             (unsigned long)rx.reply_failures,
+             (unsigned long)submit.last_wait_us,
+             (unsigned long)mean_wait_us,
+             (unsigned long)submit.max_wait_us);
+    uart_parser_put_string(response);
+}
+
+static void handle_network_link(int argc, char *argv[])
+{
+    char response[448];
+    
+    network_link_status_t status;
+    network_link_get_status(&status);
+    char bssid[24] = "none";
+    if (status.bssid_cached) {
+        snprintf(bssid, sizeof(bssid), "%02X:%02X:%02X:%02X:%02X:%02X",
+                 status.bssid[0], status.bssid[1], status.bssid[2],
+                 status.bssid[3], status.bssid[4], status.bssid[5]);
+    }
+    
+    snprintf(response, sizeof(response),
+             "Connection Manager:\r\n"
+             "  State: %s (%lu ms)\r\n"
+             "  Attempts: WiFi %lu, network %lu (next backoff %lu ms)\r\n"
+             "  WiFi Connects: %lu (fast %lu)\r\n"
+             "  Cached AP: %s, channel %ld\r\n"
+             "  Network Connects: %lu, losses %lu\r\n"
+             "  Last Outage: %lu ms\r\n"
+             "  Last Error: %d\r\n"
+             "  Outage Buffer: %u frames pending\r\n",
+             network_link_state_name(status.state), (unsigned long)status.state_ms,
+             (unsigned long)status.wifi_attempts, (unsigned long)status.net_attempts,
+             (unsigned long)status.backoff_ms,
+             (unsigned long)status.wifi_connects, (unsigned long)status.fast_connects,
+             bssid, status.bssid_cached ? (long)status.channel : 0L,
+             (unsigned long)status.net_connects, (unsigned long)status.net_losses,
+             (unsigned long)status.last_outage_ms,
+             status.last_error,
+             (unsigned)status.outage_frames);
+    uart_parser_put_string(response);
+}
+
+static void handle_telemetry_format(int argc, char *argv[])
+{
+    char response[64];
+    
+    if (argc >= 2) {
+        if (strcmp(argv[1], "json") == 0) {
+            telemetry_set_format(TELEMETRY_FORMAT_JSON);
+        } else if (strcmp(argv[1], "binary") == 0) {
+            telemetry_set_format(TELEMETRY_FORMAT_BINARY);
+        } else {
+            uart_parser_put_string("Usage: telemetry_format [json|binary]\r\n");
+            return;
+        }
+    }
+    
+    snprintf(response, sizeof(response), "Telemetry format: %s\r\n",
+             telemetry_get_format() == TELEMETRY_FORMAT_BINARY ? "binary" : "json");
+    uart_parser_put_string(response);
+}
+
+static void handle_machine_mode(int argc, char *argv[])
+{
+    // 网络连接上直接发送请求帧即可，不能把串口切换到机器模式
+    if (uart_parser_command_is_remote()) {
+        uart_parser_put_string("Error: machine_mode is serial only, send request frames directly.\r\n");
+        return;
+    }
+    // 上位机收到这一行后即可开始发送请求帧
+    uart_parser_put_string("Machine mode on.\r\n");
+    uart_machine_enter();
 }
 
 /* -------------------- 6. 平台相关的硬件接口 (需要用户实现) -------------------- */
 
+/**
+ * @brief Arduino Serial 接收事件回调：整块读取接收缓冲区并交给行组装器。
+ * @note  运行在 HardwareSerial 的串口事件任务中。
+ */
+static void uart_parser_serial_on_receive(void)
+{
+    uint8_t chunk[UART_PARSER_RX_CHUNK_SIZE];
+    int available;
+    while ((available = Serial.available()) > 0) {
+        size_t n = Serial.read(chunk, (size_t)available < sizeof(chunk) ? (size_t)available : sizeof(chunk));
+        if (n == 0) {
+            break;
+        }
+        uart_parser_feed(chunk, n);
+    }
+}
+
+void uart_parser_begin_serial_rx(void)
+{
+    // onlyOnTimeout = false: FIFO 达到阈值或接收超时都会触发回调
+    Serial.onReceive(uart_parser_serial_on_receive, false);
+}
+
+void uart_parser_put_string(const char *str)
+{
+    if (str == NULL) {
+        return;
+    }
+    if (reply_is_routed()) {
+        reply_append((const uint8_t *)str, strlen(str));
+        return;
+    }
+    uart_parser_port_put_string(str);
+}
+
+void uart_parser_put_bytes(const uint8_t *data, size_t len)
+{
+    if (data == NULL || len == 0) {
+        return;
+    }
+    if (reply_is_routed()) {
+        reply_append(data, len);
+        return;
+    }
+    uart_parser_port_put_bytes(data, len);
+}
+
 /**
  * @brief 这是一个需要您在项目中具体实现的函数。
  * 它的作用是通过UART发送一个字符串。
  */
-__attribute__((weak)) void uart_parser_put_string(const char *str)
+__attribute__((weak)) void uart_parser_port_put_string(const char *str)
 {
     // 示例实现 (基于STM32 HAL库):
     // extern UART_HandleTypeDef huart1;
@@ -553,3 +1162,12 @@ __attribute__((weak)) void uart_parser_put_string(const char *str)
     // 如果没有实现，这个弱定义函数将什么也不做，避免链接错误。
     (void)str;
 }
+
+/**
+ * @brief 二进制输出的弱定义，未实现时什么也不做。
+ */
+__attribute__((weak)) void uart_parser_port_put_bytes(const uint8_t *data, size_t len)
+{
+    (void)data;
+    (void)len;
+}
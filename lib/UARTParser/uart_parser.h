@@ -8,6 +8,7 @@
  */
 
 #include <stdint.h>
+#include <stddef.h>
 
 /* * 为了兼容C++工程，使用 extern "C" 宏。
  * 在C++编译器下，它会告诉编译器以C语言的方式来链接这些函数。
@@ -17,6 +18,21 @@
 extern "C" {
 #endif
 
+/**
+ * @brief 单条命令缓冲区的大小 (含字符串结束符)。
+ */
+#define UART_PARSER_LINE_SIZE       128
+
+/**
+ * @brief 命令缓冲池中的缓冲区数量，即最多可排队等待解析的命令数。
+ */
+#define UART_PARSER_POOL_SIZE       8
+
+/**
+ * @brief 其他传输提交的命令在执行期间的输出缓冲区大小，满或命令执行完毕时交给来源的回复函数。
+ */
+#define UART_PARSER_REPLY_BUFFER_SIZE   512
+
 /**
  * @brief 定义命令处理函数的函数指针类型。
  * @param argc 参数个数 (包括命令本身)。
@@ -34,11 +50,88 @@ typedef struct {
 } command_t;
 
 
+/**
+ * @brief 命令来源的回复函数：把命令的输出写回它来自的传输 (例如网络连接)。
+ * @note  在 uart_parser_task 中调用，不应长时间阻塞。
+ * @param data    输出数据 (文本或机器模式响应帧)。
+ * @param len     字节数。
+ * @param context uart_parser_origin_t::context。
+ */
+typedef void (*uart_parser_reply_t)(const uint8_t *data, size_t len, uint64_t context);
+
+/**
+ * @brief 命令来源。
+ */
+typedef struct {
+    uart_parser_reply_t reply;  /**< 回复函数，NULL 表示串口 */
+    uint64_t context;           /**< 来源自定义的标识 (例如 UDP 对端地址、TCP 客户端编号) */
+} uart_parser_origin_t;
+
+/**
+ * @brief 其他传输提交的命令统计。
+ */
+typedef struct {
+    uint32_t submitted;     /**< 成功入队的命令数 */
+    uint32_t rejected;      /**< 缓冲池已满或帧过长被拒绝的命令数 */
+    uint32_t max_wait_us;   /**< 入队到开始执行的最大等待时间 */
+    uint32_t last_wait_us;  /**< 最近一条命令的等待时间 */
+    uint64_t total_wait_us; /**< 等待时间总和 (除以 submitted 得到均值) */
+} uart_parser_submit_stats_t;
+
+
+/**
+ * @brief 命令哈希索引的槽位数 (必须是2的幂)，所有已注册命令总数不应超过其一半。
+ */
+#define UART_PARSER_HASH_SLOTS          128
+
+/**
+ * @brief 除内置命令表外，最多可注册的命令表数量。
+ */
+#define UART_PARSER_MAX_COMMAND_TABLES  8
+
+
+/* FNV-1a 32位哈希，C++ 中为 constexpr，可在编译期计算命令名的哈希 */
+#ifdef __cplusplus
+#define UART_PARSER_CONSTEXPR constexpr
+#else
+#define UART_PARSER_CONSTEXPR
+#endif
+
+static inline UART_PARSER_CONSTEXPR uint32_t uart_parser_hash_step(const char *str, uint32_t hash)
+{
+    return *str ? uart_parser_hash_step(str + 1, (hash ^ (uint8_t)*str) * 16777619u) : hash;
+}
+
+/**
+ * @brief 计算命令名的 FNV-1a 哈希。
+ * @param str 以 '\0' 结尾的命令名。
+ * @return 32位哈希值。
+ */
+static inline UART_PARSER_CONSTEXPR uint32_t uart_parser_hash(const char *str)
+{
+    return uart_parser_hash_step(str, 2166136261u);
+}
+
+
+/**
+ * @brief 注册一张命令表 (供其他模块添加自己的命令，无需修改 uart_parser.cpp)。
+ *
+ * @note  命令表必须在整个运行期间有效 (通常为 static const 数组)。
+ * 命令名与已注册命令重复的条目会被跳过。一般在初始化阶段调用，
+ * 注册完成后命令即可被分派，'help' 会按注册顺序列出。
+ *
+ * @param table 命令表。
+ * @param count 命令表中的条目数。
+ * @return int 全部条目注册成功返回 pdPASS；命令表或哈希索引已满、或有重复条目时返回 pdFAIL。
+ */
+int uart_parser_register_commands(const command_t *table, size_t count);
+
+
 /**
  * @brief FreeRTOS 任务函数，用于处理UART命令解析。
  *
  * @note  这个任务会持续等待从串口接收到的命令，然后解析并分派给对应的处理函数。
- * 它依赖于一个消息队列来从UART中断服务程序(ISR)接收命令字符串。
+ * 它依赖于一个消息队列来接收命令缓冲区，处理完后把缓冲区归还给缓冲池。
  * @param argument 传递给任务的参数 (未使用)。
  */
 void uart_parser_task(void *argument);
@@ -47,17 +140,110 @@ void uart_parser_task(void *argument);
 /**
  * @brief 将从UART接收到的完整命令字符串发送到解析任务。
  *
- * @note  这个函数应该在UART接收中断中被调用，当检测到一个完整的命令
- * (例如，以换行符 '\n' 结尾)时。
- * 为了线程安全，尤其是在ISR中使用时，它应该通过线程安全的方式
- * (如FreeRTOS的消息队列)将数据发送给 uart_parser_task。
+ * @note  命令字符串会被复制到命令缓冲池的一个缓冲区中再入队，
+ * 调用返回后 cmd_string 即可复用。只能在任务上下文中调用。
+ * 串口输入请直接使用 uart_parser_feed()。
  *
- * @param cmd_string 指向包含完整命令的字符串缓冲区的指针。
- * @return int 如果成功发送到队列，返回 pdPASS，否则返回 errQUEUE_FULL。
+ * @param cmd_string 指向包含完整命令的字符串，超出 UART_PARSER_LINE_SIZE 的部分被截断。
+ * @return int 如果成功发送到队列，返回 pdPASS；缓冲池或队列已满返回 errQUEUE_FULL。
  */
 int uart_parser_send_command_to_queue(char *cmd_string);
 
 
+/**
+ * @brief 从串口以外的传输 (网络等) 提交一条命令行或一个机器模式请求帧。
+ *
+ * @note  以 0xA5 (遥测帧同步字节) 开头的数据按完整的机器模式请求帧处理，无需先进入
+ * 'machine_mode'；否则按一行文本命令处理 (行尾的 '\r' / '\n' 被去掉)。
+ * 命令在 uart_parser_task 中与串口命令经过同一个分派路径执行，执行期间的
+ * uart_parser_put_string / uart_parser_put_bytes 输出被收集后交给 origin->reply，
+ * 不会写到串口。只能在任务上下文中调用，不阻塞。
+ *
+ * @param data   命令行或请求帧，请求帧不超过 UART_PARSER_LINE_SIZE 字节，文本超出部分被截断。
+ * @param len    字节数。
+ * @param origin 命令来源，reply 不能为 NULL；内容被复制，调用返回后即可复用。
+ * @return int 成功返回 pdPASS；缓冲池已满返回 errQUEUE_FULL；参数错误或帧过长返回 pdFAIL。
+ */
+int uart_parser_submit(const uint8_t *data, size_t len, const uart_parser_origin_t *origin);
+
+/**
+ * @brief 把串口上收到的一个完整机器模式请求帧送入解析队列 (由 uart_machine_feed 调用)。
+ *
+ * @note  与串口命令行共用命令缓冲池，请求在 uart_parser_task 中执行，响应写到串口。
+ * 与 uart_parser_feed 在同一个接收上下文中调用，不阻塞。
+ *
+ * @param frame 以 0xA5 开头的完整请求帧。
+ * @param len   帧长度，不超过 UART_PARSER_LINE_SIZE。
+ * @return int 成功返回 pdPASS；缓冲池已满返回 errQUEUE_FULL；帧过长返回 pdFAIL。
+ */
+int uart_parser_queue_serial_frame(const uint8_t *frame, size_t len);
+
+/**
+ * @brief 获取其他传输提交的命令统计。
+ */
+void uart_parser_get_submit_stats(uart_parser_submit_stats_t *stats);
+
+/**
+ * @brief 当前正在执行的命令是否来自串口以外的传输 (供命令处理函数判断)。
+ */
+int uart_parser_command_is_remote(void);
+
+/**
+ * @brief 在调用方任务中直接分词、查找并执行一条命令 (不经过队列和缓冲池)。
+ *
+ * @note  与解析任务执行同一条分派路径，用于测量分派开销 (bench micro parser)。
+ * 处理函数的输出按调用方当前的输出路由发送。line 会被原地修改。
+ *
+ * @param line 以 '\0' 结尾的命令行。
+ */
+void uart_parser_dispatch(char *line);
+
+
+/**
+ * @brief 行组装器入口：送入一段从串口收到的原始字节。
+ *
+ * @note  按 '\r' / '\n' 切分命令行，处理退格并回显，每条完整的命令行
+ * 存放在一个命令缓冲池的缓冲区中送入解析队列，uart_parser_task 处理完
+ * 后归还缓冲区。因此连续发送的多条命令互不覆盖。
+ * 缓冲池耗尽时该行被丢弃并输出错误提示。
+ * 该函数不可重入，只能由一个接收上下文调用 (例如串口接收事件回调)。
+ *
+ * @param data 接收到的字节。
+ * @param len  字节数。
+ */
+void uart_parser_feed(const uint8_t *data, size_t len);
+
+
+/**
+ * @brief 平台相关：启动基于串口驱动接收事件的命令接收 (Arduino Serial)。
+ *
+ * @note  在 Serial.begin() 之后调用一次。每当串口收到数据 (FIFO 阈值或
+ * 接收超时)，在驱动的事件任务中整块读取并交给 uart_parser_feed()，
+ * 不再需要在 loop() 中逐字节轮询。
+ */
+void uart_parser_begin_serial_rx(void);
+
+
+/**
+ * @brief 命令处理函数的输出函数。
+ *
+ * @note  在 uart_parser_task 中执行来自其他传输的命令时，输出交给该命令来源的回复函数；
+ * 其他情况 (串口命令、其他任务的输出) 调用 uart_parser_port_put_string 写到串口。
+ *
+ * @param str 要发送的字符串。
+ */
+void uart_parser_put_string(const char *str);
+
+
+/**
+ * @brief 二进制输出函数 (机器模式使用)，路由规则与 uart_parser_put_string 相同。
+ *
+ * @param data 要发送的数据。
+ * @param len  字节数。
+ */
+void uart_parser_put_bytes(const uint8_t *data, size_t len);
+
+
 /**
  * @brief 平台相关的UART输出函数 (需要用户实现)。
  *
@@ -67,7 +253,18 @@ int uart_parser_send_command_to_queue(char *cmd_string);
  *
  * @param str 要发送的字符串。
  */
-void uart_parser_put_string(const char *str);
+void uart_parser_port_put_string(const char *str);
+
+
+/**
+ * @brief 平台相关的UART二进制输出函数 (需要用户实现，机器模式使用)。
+ *
+ * @note  与 uart_parser_port_put_string 相同，只是数据中可能包含 '\0'。
+ *
+ * @param data 要发送的数据。
+ * @param len  字节数。
+ */
+void uart_parser_port_put_bytes(const uint8_t *data, size_t len);
 
 
 #ifdef __cplusplus
@@ -0,0 +1,105 @@
+#ifndef NETWORK_FRAME_H
+#define NETWORK_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 遥测发送路径的帧池接口 (生产者一侧)
+ * 固件中由 wifi_task.cpp 实现；native 环境中由 lib/NativeHost 的网络模拟实现，
+ * 数据发布路径的编码和提交代码可以在主机上原样运行。
+ */
+
+/**
+ * @brief 帧池中的帧数量
+ */
+#ifndef NETWORK_FRAME_POOL_SIZE
+#define NETWORK_FRAME_POOL_SIZE         16
+#endif
+
+/**
+ * @brief 单个帧的最大数据长度 (字节)
+ */
+#ifndef NETWORK_FRAME_DATA_SIZE
+#define NETWORK_FRAME_DATA_SIZE         256
+#endif
+
+#define NETWORK_FRAME_FLAG_URGENT       (1 << 0)  /*!< 立即刷新发送聚合缓冲区 */
+
+#define NETWORK_FRAME_CLIENT_TCP_CLIENT (-2)      /*!< client: 只在 client_generation 对应的 TCP 客户端连接上发送 */
+
+/**
+ * @brief 预分配的网络帧
+ *
+ * @note 由 network_frame_alloc() 从静态帧池中取出，生产者直接在 data 中写入数据，
+ *       再交给 network_frame_submit()；发送任务发送后自动归还到帧池。
+ */
+typedef struct {
+    uint16_t len;                           /*!< 有效数据长度 */
+    uint8_t flags;                          /*!< NETWORK_FRAME_FLAG_* */
+    uint32_t sample_us;                     /*!< 帧内样本的采样时刻 (0 = 不统计延迟)，见 latency_stats.h */
+    uint32_t wake_us;                       /*!< 数据发布任务被唤醒的时刻 */
+    int8_t client;                          /*!< TCP 服务端模式下只发给该客户端 (-1 = 所有客户端，
+                                                 NETWORK_FRAME_CLIENT_TCP_CLIENT = TCP 客户端连接上的命令回复) */
+    uint8_t client_generation;              /*!< 该客户端表项 (或 TCP 客户端连接) 的连接代数，连接已更换时丢弃 */
+    uint8_t data[NETWORK_FRAME_DATA_SIZE];  /*!< 帧数据 */
+} network_frame_t;
+
+/**
+ * @brief 从帧池中分配一个空闲帧 (不阻塞)
+ *
+ * @return 
+ *      - 帧指针: 成功
+ *      - NULL: 帧池已耗尽或网络发送任务未初始化
+ */
+network_frame_t* network_frame_alloc(void);
+
+/**
+ * @brief 将未提交的帧归还到帧池
+ *
+ * @param frame 由 network_frame_alloc() 分配的帧
+ */
+void network_frame_free(network_frame_t* frame);
+
+/**
+ * @brief 将已填好数据的帧交给网络发送任务 (不阻塞，零拷贝)
+ *
+ * @details 调用后帧的所有权转移给发送任务，调用方不能再访问该帧；
+ *          提交失败时帧会被自动归还到帧池。
+ *          连接管理正在重连时帧同样被接收，发送任务把它存入断线缓冲区，连接恢复后补发。
+ *
+ * @param frame 由 network_frame_alloc() 分配并填好 len/data/flags 的帧
+ * @return 
+ *      - 提交的字节数: 成功
+ *      - -1: 失败 (网络未连接)
+ */
+int network_frame_submit(network_frame_t* frame);
+
+/**
+ * @brief 网络发送路径当前是否接收帧
+ *
+ * @return 
+ *      - true: 网络已连接，或连接管理正在重连 (帧进入断线缓冲区)
+ *      - false: 网络未启用或已被 network_disconnect() / wifi_disconnect() 关闭
+ */
+bool network_tx_accepting(void);
+
+/**
+ * @brief 检查网络连接状态
+ *
+ * @return 
+ *      - true: 网络连接正常
+ *      - false: 网络连接断开
+ */
+bool is_network_connected(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NETWORK_FRAME_H
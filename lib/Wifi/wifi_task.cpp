@@ -1,5 +1,15 @@
 #include "wifi_task.h"
 #include "WiFi.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+#include "task_plan.h"
+#include "latency_stats.h"
+#include "uart_parser.h"
+#include "uart_machine.h"
+#include "telemetry_frame.h"
+#include "deferred_log.h"
+#include <stdarg.h>
 
 #define WIFI_TASK_TAG "WIFI_TASK"
 #define NETWORK_TASK_TAG "NETWORK_TASK"
@@ -9,13 +19,125 @@ static bool s_is_connected = false;
 static bool s_network_connected = false;
 
 // 网络对象
-static WiFiClient* s_tcp_client = NULL;
+static volatile int s_tcp_client_fd = -1;         // 已连接的 TCP 客户端 socket (由网络任务建立和关闭)
+static volatile uint8_t s_tcp_client_generation = 0; // 每建立一个 TCP 客户端连接加 1 (lwIP 重连后通常复用同一个 fd)
 static WiFiServer* s_tcp_server = NULL;
-static WiFiUDP* s_udp = NULL;
 static char s_network_info[256] = {0};
 
+// UDP 快速路径: 常驻 socket，目标地址只解析一次，发送任务直接从聚合缓冲区 sendto()
+static volatile int s_udp_fd = -1;
+static struct sockaddr_in s_udp_remote;           // 当前发送目标 (s_udp_mux 保护)
+static bool s_udp_remote_valid = false;
+static struct sockaddr_in s_udp_discovery_addr;   // 发现模式下信标的目的地址 (广播或组播)
+static volatile bool s_udp_discovery = false;
+static volatile bool s_udp_rediscover = false;
+static network_udp_stats_t s_udp_stats = {0};
+static portMUX_TYPE s_udp_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t s_udp_last_beacon_ms = 0;
+static uint32_t s_udp_window_start_ms = 0;        // 每秒计数窗口的起点与起点时的累计计数
+static uint32_t s_udp_window_packets = 0, s_udp_window_bytes = 0, s_udp_window_failures = 0;
+
+// 连接管理 (网络任务): 由 WiFi 事件和命令请求驱动的状态机，负责关联、建立连接和断线重连
+#define LINK_EVENT_WIFI_UP          (1 << 0)  // 获得 IP
+#define LINK_EVENT_WIFI_DOWN        (1 << 1)  // STA 断开，包括一次连接尝试失败
+#define LINK_EVENT_NET_DOWN         (1 << 2)  // TCP 客户端连接被对端关闭、出错或 keepalive 超时
+#define LINK_EVENT_WIFI_REQUEST     (1 << 3)  // 重新连接 WiFi (配置可能已更新)
+#define LINK_EVENT_WIFI_STOP        (1 << 4)
+#define LINK_EVENT_NET_REQUEST      (1 << 5)  // 重新建立网络连接 (配置可能已更新)
+#define LINK_EVENT_NET_STOP         (1 << 6)
+
+static TaskHandle_t s_link_task = NULL;
+static network_link_status_t s_link = {};         // 只由网络任务修改
+static portMUX_TYPE s_link_mux = portMUX_INITIALIZER_UNLOCKED;  // 保护请求修改的 s_wifi_config 字段
+static bool s_wifi_wanted = false;                // 是否保持 WiFi 连接
+static bool s_net_wanted = false;                 // 获得 IP 后是否建立网络连接
+static bool s_link_fast_attempt = false;          // 当前 WiFi 尝试使用了缓存的 BSSID/信道
+static uint32_t s_link_state_since_ms = 0;
+static uint32_t s_link_deadline_ms = 0;           // 本次连接尝试超时或退避结束的时刻
+static bool s_link_deadline_armed = false;
+static uint32_t s_link_down_since_ms = 0;         // 离开在线状态的时刻 (0 = 未断线)
+static volatile bool s_link_buffering = false;    // 重连期间发送任务把帧存入断线缓冲区
+static volatile bool s_link_report = false;       // 命令发起的请求: 完成前把进度输出到串口
+static volatile bool s_link_forget_bssid = false; // 新的 SSID: 下一次连接不使用缓存的 BSSID/信道
+static network_link_callback_t s_link_callback = NULL;
+
+// 网络接收任务: select() 等待所有连接，收到的命令行/请求帧交给 uart_parser 执行
+typedef struct {
+    int fd;                                 // 对应的 socket，变化时重置组装状态
+    uint8_t buf[UART_PARSER_LINE_SIZE];     // 正在组装的命令行或请求帧
+    size_t len;
+    size_t skip;                            // 正在丢弃的超长请求帧剩余字节数
+    bool eof;                               // 对端已关闭，等待网络任务清理，不再加入监听集合
+    uint8_t generation;                     // 连接代数 (TCP 服务端为客户端表项的代数)
+} rx_stream_t;
+
+static TaskHandle_t s_rx_task = NULL;
+static rx_stream_t s_rx_client_stream;                                   // TCP 客户端连接
+static rx_stream_t s_rx_server_streams[NETWORK_TCP_SERVER_MAX_CLIENTS];  // TCP 服务端的各个客户端
+static uint8_t s_rx_buffer[NETWORK_TX_BATCH_SIZE];
+static network_rx_stats_t s_rx_stats = {0};
+
+// 回复上下文的高 8 位为来源类型；TCP 为 socket << 8 | 表项索引 (服务端另有连接代数 << 40)，UDP 为 源地址 << 16 | 源端口
+#define RX_ORIGIN_UDP           1ULL
+#define RX_ORIGIN_TCP_CLIENT    2ULL
+#define RX_ORIGIN_TCP_SERVER    3ULL
+#define RX_ORIGIN_SHIFT         56
+
+// 网络发送任务与帧池
+static TaskHandle_t s_tx_task = NULL;
+static QueueHandle_t s_tx_queue = NULL;           // 待发送的帧指针
+static QueueHandle_t s_frame_free_queue = NULL;   // 空闲的帧指针
+static network_frame_t s_frame_pool[NETWORK_FRAME_POOL_SIZE];
+
+// 发送聚合缓冲区 (仅由发送任务访问)
+static uint8_t s_tx_buffer[NETWORK_TX_BATCH_SIZE];
+static size_t s_tx_len = 0;
+static uint32_t s_tx_first_us = 0;  // 缓冲区中最早一帧的入队时间
+
+// 聚合缓冲区中各帧的延迟时间戳，发送完成后记录到延迟直方图
+typedef struct {
+    uint32_t sample_us;
+    uint32_t wake_us;
+} tx_stamp_t;
+static tx_stamp_t s_tx_stamps[NETWORK_TX_MAX_STAMPS];
+static size_t s_tx_stamp_count = 0;
+
+// 断线缓冲区 (仅由发送任务访问): 记录按 [长度 u16][帧数据] 环形存放
+static uint8_t s_outage_buffer[NETWORK_OUTAGE_BUFFER_SIZE];
+static size_t s_outage_head = 0;        // 最早一条记录的位置
+static size_t s_outage_used = 0;        // 已用字节数
+static volatile uint16_t s_outage_frames = 0;
+static volatile uint32_t s_tx_flush_interval_ms = NETWORK_TX_FLUSH_INTERVAL_MS;
+static network_tx_stats_t s_tx_stats = {0};
+
+// TCP 服务端的客户端表
+typedef struct {
+    WiFiClient client;
+    bool in_use;
+    uint8_t generation;       // 每接受一个新连接加 1，命令回复据此识别表项是否已被复用
+    uint8_t queue[NETWORK_TCP_CLIENT_QUEUE_DEPTH][NETWORK_TX_BATCH_SIZE];  // 待发送批次
+    uint16_t queue_len[NETWORK_TCP_CLIENT_QUEUE_DEPTH];
+    uint8_t queue_head;       // 最早的批次
+    uint8_t queue_count;      // 批次数量
+    uint16_t head_offset;     // 最早批次中已发送的字节数
+    uint32_t dropped_batches; // 因接收过慢被丢弃的批次数
+} tcp_server_client_t;
+
+static tcp_server_client_t s_server_clients[NETWORK_TCP_SERVER_MAX_CLIENTS];
+static SemaphoreHandle_t s_server_mutex = NULL;  // 保护 s_tcp_server 与客户端表
+static int s_server_client_count = 0;
+
 // 网络任务处理函数声明
-static void my_network_task(void *pvParameters);
+static void network_link_task(void *pvParameters);
+static void network_link_notify(uint32_t events);
+static void wifi_event_handler(arduino_event_id_t event, arduino_event_info_t info);
+static void network_tx_task(void *pvParameters);
+static BaseType_t network_tx_init(void);
+static int tcp_server_broadcast(const uint8_t* data, size_t len);
+static bool tcp_server_service_clients(void);
+static void network_rx_task(void *pvParameters);
+static void network_rx_wake(void);
+static int tcp_server_send_to(int index, uint8_t generation, const uint8_t* data, size_t len);
 
 // WiFi 初始化配置函数
 BaseType_t wifi_init_config(wifi_task_config_t *config)
@@ -29,22 +151,33 @@ BaseType_t wifi_init_config(wifi_task_config_t *config)
     memcpy(&task_config, config, sizeof(wifi_task_config_t));
     s_wifi_config = &task_config;
 
+    // 创建网络发送任务
+    if (network_tx_init() != pdPASS) {
+        return pdFAIL;
+    }
+
     return pdPASS;
 }
 
-// WiFi 处理函数 (不再是任务函数)
+// WiFi 处理函数 (不再是任务函数): 完成一次性的设置后立即返回，连接由网络任务管理
 void wifi_handler(void)
 {
     static bool wifi_initialized = false;
     
-    if (!wifi_initialized && s_wifi_config != NULL) {
-        // A small delay to help prevent brownout if power supply is marginal
-        vTaskDelay(pdMS_TO_TICKS(200));
+    if (wifi_initialized || s_wifi_config == NULL) {
+        return;
+    }
+    wifi_initialized = true;
+
+    // A small delay to help prevent brownout if power supply is marginal
+    if (WIFI_STARTUP_DELAY_MS > 0) {
+        vTaskDelay(pdMS_TO_TICKS(WIFI_STARTUP_DELAY_MS));
+    }
 
-        ESP_LOGI(WIFI_TASK_TAG, "Starting WiFi initialization...");
+    ESP_LOGI(WIFI_TASK_TAG, "Starting WiFi initialization...");
 
-        // Set WiFi Mode
-        WiFi.mode(s_wifi_config->wifi_mode);
+    // Set WiFi Mode
+    WiFi.mode(s_wifi_config->wifi_mode);
     ESP_LOGI(WIFI_TASK_TAG, "WiFi mode set to: %d", s_wifi_config->wifi_mode);
 
     // Set power save mode
@@ -57,129 +190,1398 @@ void wifi_handler(void)
     WiFi.setTxPower(s_wifi_config->tx_power);
     ESP_LOGI(WIFI_TASK_TAG, "TX Power set to: %d", (int)s_wifi_config->tx_power);
 
+    if (s_wifi_config->wifi_mode == WIFI_AP || s_wifi_config->wifi_mode == WIFI_AP_STA) {
+        ESP_LOGI(WIFI_TASK_TAG, "Starting AP: %s", s_wifi_config->ap_ssid);
+        WiFi.softAP(s_wifi_config->ap_ssid, s_wifi_config->ap_password);
+        IPAddress myIP = WiFi.softAPIP();
+        ESP_LOGI(WIFI_TASK_TAG, "AP IP address: %s", myIP.toString().c_str());
+    }
+
+    if (s_wifi_config->wifi_mode != WIFI_STA && s_wifi_config->wifi_mode != WIFI_AP_STA) {
+        ESP_LOGW(WIFI_TASK_TAG, "Not in STA mode, network connection disabled.");
+        return;
+    }
+
+    // 重连由网络任务按退避策略完成，关闭驱动自带的立即重连
+    WiFi.setAutoReconnect(false);
+    WiFi.onEvent(wifi_event_handler, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    WiFi.onEvent(wifi_event_handler, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+
+    s_wifi_wanted = true;
+    // 配置了网络协议且需要自动连接时，获得 IP 后由网络任务建立连接
+    s_net_wanted = s_wifi_config->network_config.protocol != NETWORK_PROTOCOL_NONE &&
+                   s_wifi_config->network_config.auto_connect;
 
-    if (s_wifi_config->wifi_mode == WIFI_STA || s_wifi_config->wifi_mode == WIFI_AP_STA) {
-        ESP_LOGI(WIFI_TASK_TAG, "Connecting to STA: %s", s_wifi_config->ssid);
-        WiFi.begin(s_wifi_config->ssid, s_wifi_config->password);
+    ESP_LOGI(WIFI_TASK_TAG, "Starting network task...");
+    if (task_plan_create(network_link_task, "network_task", 4096, NULL, 4, &s_link_task,
+                         TASK_PLAN_CORE_NETWORK) != pdPASS) {
+        ESP_LOGE(WIFI_TASK_TAG, "Failed to create network task");
+        s_link_task = NULL;
+    }
+}
+
+bool is_wifi_connected(void)
+{
+    // For STA mode, we can rely on WiFi.isConnected()
+    s_is_connected = WiFi.isConnected();
+    return s_is_connected;
+}
+
+/* -------------------- TCP 客户端 -------------------- */
+
+// 小帧低延迟: 关闭 Nagle 算法；keepalive 在链路空闲时也能尽快发现对端掉线
+static void tcp_tune_socket(int fd)
+{
+    int one = 1;
+    int idle_s = NETWORK_TCP_KEEPALIVE_IDLE_S;
+    int interval_s = NETWORK_TCP_KEEPALIVE_INTERVAL_S;
+    int count = NETWORK_TCP_KEEPALIVE_COUNT;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle_s, sizeof(idle_s));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval_s, sizeof(interval_s));
+    setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+}
+
+// 连接 TCP 服务器: 非阻塞 connect() 后用 select() 等待完成，最长 connect_timeout_ms
+// 返回已连接的 socket (恢复为阻塞模式并设置发送超时)；失败返回 -1 并设置 errno
+static int tcp_client_open(const network_config_t* net_config)
+{
+    IPAddress ip;
+    if (!WiFi.hostByName(net_config->remote_host, ip)) {
+        ESP_LOGE(NETWORK_TASK_TAG, "Failed to resolve TCP server %s", net_config->remote_host);
+        errno = EHOSTUNREACH;
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) {
+        return -1;
+    }
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(net_config->remote_port);
+    addr.sin_addr.s_addr = (uint32_t)ip;
+
+    int error = 0;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        if (errno != EINPROGRESS) {
+            error = errno;
+        } else {
+            uint32_t timeout_ms = net_config->connect_timeout_ms > 0 ? net_config->connect_timeout_ms : 5000;
+            struct timeval timeout = {(time_t)(timeout_ms / 1000), (suseconds_t)((timeout_ms % 1000) * 1000)};
+            fd_set writefds;
+            FD_ZERO(&writefds);
+            FD_SET(fd, &writefds);
+            int ready = select(fd + 1, NULL, &writefds, NULL, &timeout);
+            if (ready == 0) {
+                error = ETIMEDOUT;
+            } else if (ready < 0) {
+                error = errno;
+            } else {
+                socklen_t error_len = sizeof(error);
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &error_len);
+            }
+        }
+    }
+    if (error != 0) {
+        close(fd);
+        errno = error;
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+    tcp_tune_socket(fd);
+    struct timeval send_timeout = {NETWORK_TCP_SEND_TIMEOUT_MS / 1000, (NETWORK_TCP_SEND_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+    return fd;
+}
+
+static void tcp_client_close(int fd)
+{
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
+}
+
+// 发送任务调用: 写完整个批次；一个字节都没写出的发送超时只丢弃这一批次，
+// 写出一部分后超时 (流中留下半个帧) 或连接错误交给网络任务重连
+static int tcp_client_send(const uint8_t* data, size_t len)
+{
+    int fd = s_tcp_client_fd;
+    if (fd < 0) {
+        return -1;
+    }
+    size_t sent = 0;
+    while (sent < len) {
+        int n = send(fd, data + sent, len - sent, 0);
+        if (n > 0) {
+            sent += n;
+            continue;
+        }
+        bool timeout = (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+        if ((!timeout || sent > 0) && fd == s_tcp_client_fd) {
+            network_link_notify(LINK_EVENT_NET_DOWN);
+        }
+        return -1;
+    }
+    return (int)len;
+}
+
+/* -------------------- TCP 服务端 -------------------- */
+
+// 重置客户端表项 (调用前必须持有 s_server_mutex)
+static void tcp_server_release_client(tcp_server_client_t* slot)
+{
+    slot->client.stop();
+    slot->client = WiFiClient();
+    slot->in_use = false;
+    slot->queue_head = 0;
+    slot->queue_count = 0;
+    slot->head_offset = 0;
+    s_server_client_count--;
+}
+
+// 尽可能多地发送客户端队列中的数据，不阻塞 (调用前必须持有 s_server_mutex)
+// 返回 false 表示连接已失效
+static bool tcp_server_drain_client(tcp_server_client_t* slot)
+{
+    int fd = slot->client.fd();
+    while (slot->queue_count > 0) {
+        uint8_t idx = slot->queue_head;
+        const uint8_t* p = slot->queue[idx] + slot->head_offset;
+        size_t remaining = slot->queue_len[idx] - slot->head_offset;
+        
+        ssize_t n = send(fd, p, remaining, MSG_DONTWAIT);
+        if (n < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+        
+        slot->head_offset += n;
+        if (slot->head_offset < slot->queue_len[idx]) {
+            return true;  // 发送窗口已满，剩余部分下次再发
+        }
+        slot->head_offset = 0;
+        slot->queue_head = (idx + 1) % NETWORK_TCP_CLIENT_QUEUE_DEPTH;
+        slot->queue_count--;
+    }
+    return true;
+}
+
+// 将一个批次放入客户端队列末尾 (调用前必须持有 s_server_mutex)
+static void tcp_server_enqueue(tcp_server_client_t* slot, const uint8_t* data, size_t len)
+{
+    if (slot->queue_count == NETWORK_TCP_CLIENT_QUEUE_DEPTH) {
+        // 队列已满：丢弃最早的未开始发送的批次 (正在发送的批次不能打断)
+        uint8_t head = slot->queue_head;
+        uint8_t next = (head + 1) % NETWORK_TCP_CLIENT_QUEUE_DEPTH;
+        if (slot->head_offset > 0) {
+            // 把正在发送的批次移到被丢弃的位置上，保持发送进度
+            memcpy(slot->queue[next], slot->queue[head], slot->queue_len[head]);
+            slot->queue_len[next] = slot->queue_len[head];
+        }
+        slot->queue_head = next;
+        slot->queue_count--;
+        slot->dropped_batches++;
+        s_tx_stats.client_drops++;
+    }
+    uint8_t tail = (slot->queue_head + slot->queue_count) % NETWORK_TCP_CLIENT_QUEUE_DEPTH;
+    memcpy(slot->queue[tail], data, len);
+    slot->queue_len[tail] = (uint16_t)len;
+    slot->queue_count++;
+}
+
+// 将一个批次放入每个客户端的队列并尝试发送 (data 为 NULL 时只重试已排队的数据)
+// 返回值: data 非 NULL 时为成功排队的字节数 (无客户端时为 -1)；
+//         data 为 NULL 时为仍有待发送数据的客户端数量
+static int tcp_server_broadcast(const uint8_t* data, size_t len)
+{
+    if (s_server_mutex == NULL || len > NETWORK_TX_BATCH_SIZE) {
+        return -1;
+    }
+    
+    int queued = 0;
+    int pending_clients = 0;
+    
+    xSemaphoreTake(s_server_mutex, portMAX_DELAY);
+    for (int i = 0; i < NETWORK_TCP_SERVER_MAX_CLIENTS; i++) {
+        tcp_server_client_t* slot = &s_server_clients[i];
+        if (!slot->in_use) {
+            continue;
+        }
+        
+        if (data != NULL) {
+            tcp_server_enqueue(slot, data, len);
+            queued = (int)len;
+        }
+        
+        if (!tcp_server_drain_client(slot)) {
+            ESP_LOGI(NETWORK_TASK_TAG, "TCP client %d write error, closing", i);
+            tcp_server_release_client(slot);
+            continue;
+        }
+        if (slot->queue_count > 0) {
+            pending_clients++;
+        }
+    }
+    xSemaphoreGive(s_server_mutex);
+    
+    if (data == NULL) {
+        return pending_clients;
+    }
+    return (queued > 0) ? queued : -1;
+}
+
+// 只发给一个客户端 (命令回复)，返回排队的字节数，客户端已断开或表项已被新连接复用时返回 -1
+static int tcp_server_send_to(int index, uint8_t generation, const uint8_t* data, size_t len)
+{
+    if (s_server_mutex == NULL || index < 0 || index >= NETWORK_TCP_SERVER_MAX_CLIENTS ||
+        len > NETWORK_TX_BATCH_SIZE) {
+        return -1;
+    }
+    
+    int result = -1;
+    xSemaphoreTake(s_server_mutex, portMAX_DELAY);
+    tcp_server_client_t* slot = &s_server_clients[index];
+    if (slot->in_use && slot->generation == generation) {
+        tcp_server_enqueue(slot, data, len);
+        if (tcp_server_drain_client(slot)) {
+            result = (int)len;
+        } else {
+            ESP_LOGI(NETWORK_TASK_TAG, "TCP client %d write error, closing", index);
+            tcp_server_release_client(slot);
+        }
+    }
+    xSemaphoreGive(s_server_mutex);
+    return result;
+}
 
-        uint32_t start_time = millis();
-        while (WiFi.status() != WL_CONNECTED) {
-            vTaskDelay(pdMS_TO_TICKS(500));
-            ESP_LOGI(WIFI_TASK_TAG, ".");
-            if (millis() - start_time > s_wifi_config->sta_connect_timeout_ms) {
-                ESP_LOGE(WIFI_TASK_TAG, "Connection Timeout!");
+// 接受新客户端、清理已断开的客户端 (由网络任务周期性调用)
+// 返回 false 表示服务端已被关闭
+static bool tcp_server_service_clients(void)
+{
+    xSemaphoreTake(s_server_mutex, portMAX_DELAY);
+    if (s_tcp_server == NULL) {
+        xSemaphoreGive(s_server_mutex);
+        return false;
+    }
+    
+    bool changed = false;
+    
+    // 清理已断开的客户端
+    for (int i = 0; i < NETWORK_TCP_SERVER_MAX_CLIENTS; i++) {
+        tcp_server_client_t* slot = &s_server_clients[i];
+        if (slot->in_use && !slot->client.connected()) {
+            ESP_LOGI(NETWORK_TASK_TAG, "TCP client %d disconnected (dropped batches: %lu)",
+                     i, (unsigned long)slot->dropped_batches);
+            tcp_server_release_client(slot);
+            changed = true;
+        }
+    }
+    
+    // 接受新客户端
+    while (s_tcp_server->hasClient()) {
+        WiFiClient client = s_tcp_server->accept();
+        if (!client) {
+            break;
+        }
+        
+        int free_slot = -1;
+        for (int i = 0; i < NETWORK_TCP_SERVER_MAX_CLIENTS; i++) {
+            if (!s_server_clients[i].in_use) {
+                free_slot = i;
                 break;
             }
         }
+        if (free_slot < 0) {
+            ESP_LOGW(NETWORK_TASK_TAG, "Client table full, rejecting %s",
+                     client.remoteIP().toString().c_str());
+            client.stop();
+            continue;
+        }
+        
+        tcp_tune_socket(client.fd());
+        tcp_server_client_t* slot = &s_server_clients[free_slot];
+        slot->client = client;
+        slot->in_use = true;
+        slot->generation++;
+        slot->queue_head = 0;
+        slot->queue_count = 0;
+        slot->head_offset = 0;
+        slot->dropped_batches = 0;
+        s_server_client_count++;
+        changed = true;
+        ESP_LOGI(NETWORK_TASK_TAG, "TCP client %d connected from %s",
+                 free_slot, client.remoteIP().toString().c_str());
+        network_rx_wake();
     }
+    
+    if (changed && s_wifi_config != NULL) {
+        snprintf(s_network_info, sizeof(s_network_info), 
+                "TCP Server listening on port %d, %d clients",
+                s_wifi_config->network_config.local_port, s_server_client_count);
+    }
+    
+    xSemaphoreGive(s_server_mutex);
+    return true;
+}
 
-    if (s_wifi_config->wifi_mode == WIFI_AP || s_wifi_config->wifi_mode == WIFI_AP_STA) {
-        ESP_LOGI(WIFI_TASK_TAG, "Starting AP: %s", s_wifi_config->ap_ssid);
-        WiFi.softAP(s_wifi_config->ap_ssid, s_wifi_config->ap_password);
-        IPAddress myIP = WiFi.softAPIP();
-        ESP_LOGI(WIFI_TASK_TAG, "AP IP address: %s", myIP.toString().c_str());
+// 启动 TCP 服务端 (网络任务在建立连接时调用)
+static bool tcp_server_start(uint16_t local_port)
+{
+    ESP_LOGI(NETWORK_TASK_TAG, "Initializing TCP Server mode on port %d", local_port);
+    xSemaphoreTake(s_server_mutex, portMAX_DELAY);
+    s_tcp_server = new WiFiServer(local_port, NETWORK_TCP_SERVER_MAX_CLIENTS);
+    s_tcp_server->begin();
+    s_tcp_server->setNoDelay(true);
+    bool listening = (bool)*s_tcp_server;
+    if (!listening) {
+        delete s_tcp_server;
+        s_tcp_server = NULL;
+    }
+    xSemaphoreGive(s_server_mutex);
+    if (!listening) {
+        ESP_LOGE(NETWORK_TASK_TAG, "Failed to listen on port %d", local_port);
+        return false;
+    }
+    ESP_LOGI(NETWORK_TASK_TAG, "TCP Server started successfully");
+    snprintf(s_network_info, sizeof(s_network_info), 
+            "TCP Server listening on port %d, 0 clients", local_port);
+    return true;
+}
+
+static void tcp_server_stop(void)
+{
+    if (s_tcp_server == NULL) {
+        return;
+    }
+    xSemaphoreTake(s_server_mutex, portMAX_DELAY);
+    for (int i = 0; i < NETWORK_TCP_SERVER_MAX_CLIENTS; i++) {
+        if (s_server_clients[i].in_use) {
+            tcp_server_release_client(&s_server_clients[i]);
+        }
+    }
+    s_tcp_server->end();
+    delete s_tcp_server;
+    s_tcp_server = NULL;
+    xSemaphoreGive(s_server_mutex);
+    ESP_LOGI(NETWORK_TASK_TAG, "TCP Server stopped");
+}
+
+/* -------------------- UDP 快速路径 -------------------- */
+
+static bool ipv4_is_multicast(uint32_t addr_n)
+{
+    return (ntohl(addr_n) & 0xF0000000UL) == 0xE0000000UL;
+}
+
+// 设置发送目标 (网络任务调用，发送任务在 s_udp_mux 下读取)
+static void udp_set_remote(const struct sockaddr_in* remote)
+{
+    portENTER_CRITICAL(&s_udp_mux);
+    s_udp_remote = *remote;
+    s_udp_remote_valid = true;
+    s_udp_stats.remote_valid = true;
+    s_udp_stats.remote_ip = remote->sin_addr.s_addr;
+    s_udp_stats.remote_port = ntohs(remote->sin_port);
+    portEXIT_CRITICAL(&s_udp_mux);
+
+    char ip[16];
+    inet_ntop(AF_INET, &remote->sin_addr, ip, sizeof(ip));
+    snprintf(s_network_info, sizeof(s_network_info), "UDP port %d -> %s:%d%s",
+             s_wifi_config->network_config.local_port, ip, ntohs(remote->sin_port),
+             s_udp_discovery ? " (discovered)" : "");
+}
+
+static void udp_clear_remote(void)
+{
+    portENTER_CRITICAL(&s_udp_mux);
+    s_udp_remote_valid = false;
+    s_udp_stats.remote_valid = false;
+    s_udp_stats.remote_ip = 0;
+    s_udp_stats.remote_port = 0;
+    portEXIT_CRITICAL(&s_udp_mux);
+}
+
+// 解析一次 remote_host: 单播地址/域名直接作为发送目标，空地址、广播或组播地址进入发现模式
+static bool udp_resolve_target(network_config_t* net_config, int fd)
+{
+    struct sockaddr_in target = {};
+    target.sin_family = AF_INET;
+    target.sin_port = htons(net_config->remote_port);
+
+    if (net_config->remote_host[0] == '\0') {
+        target.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+    } else {
+        IPAddress ip;
+        if (!WiFi.hostByName(net_config->remote_host, ip)) {
+            ESP_LOGE(NETWORK_TASK_TAG, "Failed to resolve UDP remote %s", net_config->remote_host);
+            return false;
+        }
+        target.sin_addr.s_addr = (uint32_t)ip;
+    }
+
+    uint32_t addr_n = target.sin_addr.s_addr;
+    bool broadcast = addr_n == htonl(INADDR_BROADCAST) || addr_n == (uint32_t)WiFi.broadcastIP();
+    if (broadcast || ipv4_is_multicast(addr_n)) {
+        if (ipv4_is_multicast(addr_n)) {
+            // 信标只在本地网段内传播
+            uint8_t ttl = 1;
+            setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+        }
+        s_udp_discovery_addr = target;
+        s_udp_discovery = true;
+        s_udp_stats.discovery = true;
+        snprintf(s_network_info, sizeof(s_network_info), "UDP port %d, discovering via %s:%d",
+                 net_config->local_port, broadcast ? "broadcast" : net_config->remote_host,
+                 net_config->remote_port);
+        ESP_LOGI(NETWORK_TASK_TAG, "UDP discovery via %s:%d",
+                 broadcast ? "broadcast" : net_config->remote_host, net_config->remote_port);
+    } else {
+        s_udp_discovery = false;
+        s_udp_stats.discovery = false;
+        udp_set_remote(&target);
+        ESP_LOGI(NETWORK_TASK_TAG, "UDP remote resolved: %s", s_network_info);
+    }
+    return true;
+}
+
+static int udp_open_socket(uint16_t local_port)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0) {
+        ESP_LOGE(NETWORK_TASK_TAG, "Failed to create UDP socket: errno %d", errno);
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+
+    struct sockaddr_in local = {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(local_port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr*)&local, sizeof(local)) < 0) {
+        ESP_LOGE(NETWORK_TASK_TAG, "Failed to bind UDP port %d: errno %d", local_port, errno);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void udp_send_beacon(int fd, uint16_t local_port)
+{
+    char beacon[32];
+    int len = snprintf(beacon, sizeof(beacon), NETWORK_UDP_DISCOVERY_BEACON " %u\n", (unsigned)local_port);
+    if (sendto(fd, beacon, len, MSG_DONTWAIT, (struct sockaddr*)&s_udp_discovery_addr,
+               sizeof(s_udp_discovery_addr)) == len) {
+        s_udp_stats.beacons_sent++;
+    }
+}
+
+// 收到发现应答 (由网络接收任务调用): 把应答的源地址作为发送目标
+static void udp_handle_discovery_reply(const struct sockaddr_in* from)
+{
+    if (!s_udp_discovery) {
+        return;
+    }
+    // 发送目标由网络任务修改 (断线/重连时清除)，在 s_udp_mux 下读取
+    portENTER_CRITICAL(&s_udp_mux);
+    bool changed = !s_udp_remote_valid || s_udp_remote.sin_addr.s_addr != from->sin_addr.s_addr ||
+                   s_udp_remote.sin_port != from->sin_port;
+    portEXIT_CRITICAL(&s_udp_mux);
+    if (changed) {
+        udp_set_remote(from);
+        ESP_LOGI(NETWORK_TASK_TAG, "Ground station discovered: %s", s_network_info);
+    }
+}
+
+// 打开 UDP socket 并解析目标 (网络任务在建立连接时调用)
+static bool udp_start(network_config_t* net_config)
+{
+    ESP_LOGI(NETWORK_TASK_TAG, "Initializing UDP mode on port %d", net_config->local_port);
+    int fd = udp_open_socket(net_config->local_port);
+    if (fd < 0) {
+        return false;
+    }
+    if (!udp_resolve_target(net_config, fd)) {
+        close(fd);
+        return false;
+    }
+
+    s_udp_last_beacon_ms = millis() - NETWORK_UDP_DISCOVERY_INTERVAL_MS;
+    s_udp_window_start_ms = millis();
+    portENTER_CRITICAL(&s_udp_mux);
+    s_udp_window_packets = s_udp_stats.packets_sent;
+    s_udp_window_bytes = s_udp_stats.bytes_sent;
+    s_udp_window_failures = s_udp_stats.send_failures;
+    portEXIT_CRITICAL(&s_udp_mux);
+    s_udp_fd = fd;
+    return true;
+}
+
+// UDP 模式的周期服务 (网络任务每个服务周期调用): 发送发现信标、更新每秒计数
+// (socket 上的接收，包括发现应答，由网络接收任务完成)
+static void udp_service(uint16_t local_port)
+{
+    int fd = s_udp_fd;
+    if (fd < 0) {
+        return;
+    }
+    uint32_t now_ms = millis();
+
+    if (s_udp_discovery) {
+        if (s_udp_rediscover) {
+            s_udp_rediscover = false;
+            udp_clear_remote();
+            s_udp_last_beacon_ms = now_ms - NETWORK_UDP_DISCOVERY_INTERVAL_MS;
+        }
+        // 找到地面站之前按间隔发送信标，找到后停止 (rediscover 可重新开始)
+        if (!s_udp_remote_valid && now_ms - s_udp_last_beacon_ms >= NETWORK_UDP_DISCOVERY_INTERVAL_MS) {
+            udp_send_beacon(fd, local_port);
+            s_udp_last_beacon_ms = now_ms;
+        }
+    }
+
+    // 每秒边界把累计计数差分为每秒计数
+    if (now_ms - s_udp_window_start_ms >= 1000) {
+        portENTER_CRITICAL(&s_udp_mux);
+        s_udp_stats.packets_per_s = s_udp_stats.packets_sent - s_udp_window_packets;
+        s_udp_stats.bytes_per_s = s_udp_stats.bytes_sent - s_udp_window_bytes;
+        s_udp_stats.failures_per_s = s_udp_stats.send_failures - s_udp_window_failures;
+        s_udp_window_packets = s_udp_stats.packets_sent;
+        s_udp_window_bytes = s_udp_stats.bytes_sent;
+        s_udp_window_failures = s_udp_stats.send_failures;
+        portEXIT_CRITICAL(&s_udp_mux);
+        s_udp_window_start_ms = now_ms;
+    }
+}
+
+static void udp_stop(void)
+{
+    int fd = s_udp_fd;
+    if (fd < 0) {
+        return;
+    }
+    s_udp_fd = -1;
+    close(fd);
+    udp_clear_remote();
+    s_udp_discovery = false;
+    s_udp_stats.discovery = false;
+    s_udp_stats.packets_per_s = 0;
+    s_udp_stats.bytes_per_s = 0;
+    s_udp_stats.failures_per_s = 0;
+    ESP_LOGI(NETWORK_TASK_TAG, "UDP stopped");
+}
+
+// 发送任务调用: 目标地址已预先解析，直接从调用方缓冲区 sendto()，不经过 WiFiUDP 的内部缓冲
+static int udp_send(const uint8_t* data, size_t len)
+{
+    int fd = s_udp_fd;
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct sockaddr_in remote;
+    bool remote_valid;
+    portENTER_CRITICAL(&s_udp_mux);
+    remote = s_udp_remote;
+    remote_valid = s_udp_remote_valid;
+    portEXIT_CRITICAL(&s_udp_mux);
+
+    int result = -1;
+    if (remote_valid) {
+        result = sendto(fd, data, len, MSG_DONTWAIT, (struct sockaddr*)&remote, sizeof(remote));
+    }
+
+    portENTER_CRITICAL(&s_udp_mux);
+    if (result == (int)len) {
+        s_udp_stats.packets_sent++;
+        s_udp_stats.bytes_sent += len;
+    } else {
+        s_udp_stats.send_failures++;
+    }
+    portEXIT_CRITICAL(&s_udp_mux);
+
+    return result == (int)len ? result : -1;
+}
+
+void network_udp_get_stats(network_udp_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    portENTER_CRITICAL(&s_udp_mux);
+    memcpy(stats, &s_udp_stats, sizeof(network_udp_stats_t));
+    portEXIT_CRITICAL(&s_udp_mux);
+}
+
+bool network_udp_rediscover(void)
+{
+    if (s_udp_fd < 0 || !s_udp_discovery) {
+        return false;
+    }
+    s_udp_rediscover = true;
+    return true;
+}
+
+/* -------------------- 连接管理 -------------------- */
+
+static const char* const s_link_state_names[] = {
+    "idle", "wifi_connecting", "wifi_backoff", "wifi_only", "net_connecting", "net_backoff", "online",
+};
+
+static void network_link_notify(uint32_t events)
+{
+    if (s_link_task != NULL) {
+        xTaskNotify(s_link_task, events, eSetBits);
+    }
+}
+
+// WiFi 事件回调 (在 Arduino 的 WiFi 事件任务中执行)：只转发给网络任务
+static void wifi_event_handler(arduino_event_id_t event, arduino_event_info_t info)
+{
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        network_link_notify(LINK_EVENT_WIFI_UP);
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+        network_link_notify(LINK_EVENT_WIFI_DOWN);
+    }
+}
+
+// 输出连接进度：始终写日志；命令发起的请求完成前同时输出到串口 (机器模式下不输出，避免插入二进制流)
+static void link_report(const char* fmt, ...)
+{
+    char line[160];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    
+    ESP_LOGI(NETWORK_TASK_TAG, "%s", line);
+    if (s_link_report && !uart_machine_is_active()) {
+        char output[sizeof(line) + 16];
+        snprintf(output, sizeof(output), "[link] %s\r\n", line);
+        uart_parser_put_string(output);
+    }
+}
+
+// 仍需要网络连接但尚未在线时，发送任务把帧存入断线缓冲区
+static void link_update_buffering(void)
+{
+    network_link_state_t state = s_link.state;
+    s_link_buffering = NETWORK_OUTAGE_BUFFER_FRAMES > 0 && s_wifi_wanted && s_net_wanted &&
+                       state != NETWORK_LINK_IDLE && state != NETWORK_LINK_ONLINE;
+}
+
+static void link_set_state(network_link_state_t state)
+{
+    if (s_link.state == NETWORK_LINK_ONLINE && state != NETWORK_LINK_ONLINE) {
+        s_link_down_since_ms = millis();
+    }
+    bool changed = s_link.state != state;
+    s_link.state = state;
+    s_link_state_since_ms = millis();
+    s_link_deadline_armed = false;
+    link_update_buffering();
+    
+    network_link_callback_t callback = s_link_callback;
+    if (changed && callback != NULL) {
+        callback(state);
+    }
+}
+
+static void link_arm_deadline(uint32_t delay_ms)
+{
+    s_link_deadline_ms = millis() + delay_ms;
+    s_link_deadline_armed = true;
+}
+
+// 进入退避状态：等待当前的退避时间，下一次失败的退避时间翻倍
+static void link_backoff(network_link_state_t state)
+{
+    uint32_t delay_ms = s_link.backoff_ms;
+    link_set_state(state);
+    link_arm_deadline(delay_ms);
+    s_link.backoff_ms = delay_ms * 2 < NETWORK_LINK_BACKOFF_MAX_MS ? delay_ms * 2 : NETWORK_LINK_BACKOFF_MAX_MS;
+}
+
+// 关闭所有网络连接 (不改变是否需要重连)
+static void link_close_net(void)
+{
+    s_network_connected = false;
+    int fd = s_tcp_client_fd;
+    if (fd >= 0) {
+        s_tcp_client_fd = -1;
+        tcp_client_close(fd);
+    }
+    tcp_server_stop();
+    udp_stop();
+    memset(s_network_info, 0, sizeof(s_network_info));
+}
+
+// 开始一次 WiFi 连接尝试：有缓存时直接关联上次的 AP (跳过全信道扫描)
+static void link_wifi_begin(void)
+{
+    char ssid[sizeof(s_wifi_config->ssid)];
+    char password[sizeof(s_wifi_config->password)];
+    uint32_t timeout_ms;
+    portENTER_CRITICAL(&s_link_mux);
+    memcpy(ssid, s_wifi_config->ssid, sizeof(ssid));
+    memcpy(password, s_wifi_config->password, sizeof(password));
+    timeout_ms = s_wifi_config->sta_connect_timeout_ms;
+    portEXIT_CRITICAL(&s_link_mux);
+    
+    if (s_link_forget_bssid) {
+        s_link_forget_bssid = false;
+        s_link.bssid_cached = false;
+    }
+    
+    s_link.wifi_attempts++;
+    s_link_fast_attempt = s_link.bssid_cached;
+    const char* passphrase = password[0] != '\0' ? password : NULL;
+    if (s_link_fast_attempt) {
+        link_report("WiFi connecting to %s (cached BSSID, channel %ld)", ssid, (long)s_link.channel);
+        WiFi.begin(ssid, passphrase, s_link.channel, s_link.bssid);
+        timeout_ms = NETWORK_LINK_FAST_CONNECT_TIMEOUT_MS;
+    } else {
+        link_report("WiFi connecting to %s (attempt %lu)", ssid, (unsigned long)s_link.wifi_attempts);
+        WiFi.begin(ssid, passphrase);
+    }
+    link_set_state(NETWORK_LINK_WIFI_CONNECTING);
+    link_arm_deadline(timeout_ms > 0 ? timeout_ms : 15000);
+}
+
+// 一次 WiFi 连接尝试失败 (断开事件或超时)
+static void link_wifi_failed(const char* reason)
+{
+    if (s_link_fast_attempt) {
+        // AP 可能已换信道或被替换：清除缓存，等驱动停止后按 SSID 全信道扫描重试 (不计入退避)
+        s_link.bssid_cached = false;
+        link_report("Fast reconnect failed (%s), scanning all channels", reason);
+        link_set_state(NETWORK_LINK_WIFI_BACKOFF);
+        link_arm_deadline(NETWORK_LINK_BACKOFF_MIN_MS);
+        return;
+    }
+    link_report("WiFi connect failed (%s), retry in %lu ms", reason, (unsigned long)s_link.backoff_ms);
+    link_backoff(NETWORK_LINK_WIFI_BACKOFF);
+}
+
+// 建立当前配置的网络连接 (TCP 客户端在这里等待连接完成，最长 connect_timeout_ms)
+static void link_net_begin(void)
+{
+    network_config_t net_config;
+    portENTER_CRITICAL(&s_link_mux);
+    memcpy(&net_config, &s_wifi_config->network_config, sizeof(net_config));
+    portEXIT_CRITICAL(&s_link_mux);
+    
+    link_set_state(NETWORK_LINK_NET_CONNECTING);
+    s_link.net_attempts++;
+    
+    bool connected = false;
+    switch (net_config.protocol) {
+        case NETWORK_PROTOCOL_TCP_CLIENT:
+        {
+            link_report("Connecting to TCP server %s:%d", net_config.remote_host, net_config.remote_port);
+            int fd = tcp_client_open(&net_config);
+            if (fd >= 0) {
+                s_tcp_client_generation++;   // 先更新代数，接收任务看到新 fd 时读到的是新代数
+                s_tcp_client_fd = fd;
+                snprintf(s_network_info, sizeof(s_network_info), 
+                        "TCP Client connected to %s:%d", 
+                        net_config.remote_host, net_config.remote_port);
+                connected = true;
+            }
+            break;
+        }
+        
+        case NETWORK_PROTOCOL_TCP_SERVER:
+            connected = tcp_server_start(net_config.local_port);
+            break;
+            
+        case NETWORK_PROTOCOL_UDP:
+            connected = udp_start(&net_config);
+            break;
+            
+        default:
+            ESP_LOGW(NETWORK_TASK_TAG, "Unknown network protocol");
+            s_net_wanted = false;
+            link_set_state(NETWORK_LINK_WIFI_ONLY);
+            s_link_report = false;
+            return;
+    }
+    
+    if (!connected) {
+        s_link.last_error = errno;
+        link_report("Network connect failed (errno %d), retry in %lu ms",
+                    s_link.last_error, (unsigned long)s_link.backoff_ms);
+        link_backoff(NETWORK_LINK_NET_BACKOFF);
+        return;
+    }
+    
+    s_network_connected = true;
+    s_link.net_connects++;
+    s_link.net_attempts = 0;
+    s_link.last_error = 0;
+    s_link.backoff_ms = NETWORK_LINK_BACKOFF_MIN_MS;
+    if (s_link_down_since_ms != 0) {
+        s_link.last_outage_ms = millis() - s_link_down_since_ms;
+        s_link_down_since_ms = 0;
+    }
+    link_set_state(NETWORK_LINK_ONLINE);
+    network_rx_wake();
+    // 唤醒发送任务补发断线缓冲区 (帧池耗尽说明发送任务正忙，处理下一帧前同样会补发)
+    network_tx_flush();
+    link_report("Online: %s", s_network_info);
+    s_link_report = false;
+}
+
+static void link_wifi_up(void)
+{
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid != NULL) {
+        memcpy(s_link.bssid, bssid, sizeof(s_link.bssid));
+        s_link.channel = WiFi.channel();
+        s_link.bssid_cached = true;
+    }
+    s_is_connected = true;
+    s_link.wifi_connects++;
+    if (s_link_fast_attempt) {
+        s_link.fast_connects++;
+    }
+    s_link.wifi_attempts = 0;
+    s_link.backoff_ms = NETWORK_LINK_BACKOFF_MIN_MS;
+    link_report("WiFi connected in %lu ms, IP %s, channel %ld%s",
+                (unsigned long)(millis() - s_link_state_since_ms), WiFi.localIP().toString().c_str(),
+                (long)s_link.channel, s_link_fast_attempt ? " (fast)" : "");
+    
+    if (s_net_wanted) {
+        s_link.net_attempts = 0;
+        link_net_begin();
+    } else {
+        link_set_state(NETWORK_LINK_WIFI_ONLY);
+        s_link_report = false;
+    }
+}
+
+static void link_wifi_down(void)
+{
+    if (WiFi.isConnected()) {
+        return;  // 过时的事件
+    }
+    switch (s_link.state) {
+        case NETWORK_LINK_WIFI_CONNECTING:
+            link_wifi_failed("disconnected");
+            break;
+            
+        case NETWORK_LINK_WIFI_ONLY:
+        case NETWORK_LINK_NET_CONNECTING:
+        case NETWORK_LINK_NET_BACKOFF:
+        case NETWORK_LINK_ONLINE:
+            if (s_link.state == NETWORK_LINK_ONLINE) {
+                s_link.net_losses++;
+            }
+            s_is_connected = false;
+            link_close_net();
+            link_report("WiFi lost, reconnecting");
+            // 立即重连，优先使用缓存的 BSSID/信道
+            link_wifi_begin();
+            break;
+            
+        default:
+            // 退避中或未启用：忽略 (包括主动断开产生的事件)
+            break;
+    }
+}
+
+static void link_net_lost(void)
+{
+    s_link.net_losses++;
+    link_close_net();
+    link_report("Connection lost, reconnecting in %lu ms", (unsigned long)s_link.backoff_ms);
+    link_backoff(NETWORK_LINK_NET_BACKOFF);
+}
+
+// 连接尝试超时或退避结束
+static void link_deadline(void)
+{
+    switch (s_link.state) {
+        case NETWORK_LINK_WIFI_CONNECTING:
+            // 停止本次关联，随后的断开事件在退避状态下被忽略
+            WiFi.disconnect();
+            link_wifi_failed("timeout");
+            break;
+            
+        case NETWORK_LINK_WIFI_BACKOFF:
+            link_wifi_begin();
+            break;
+            
+        case NETWORK_LINK_NET_BACKOFF:
+            if (WiFi.isConnected()) {
+                link_net_begin();
+            } else {
+                link_wifi_begin();
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
+// 处理命令发起的请求 (停止请求先于连接请求处理)
+static void link_handle_requests(uint32_t events)
+{
+    if (events & LINK_EVENT_WIFI_STOP) {
+        s_wifi_wanted = false;
+        link_close_net();
+        WiFi.disconnect();
+        s_is_connected = false;
+        link_set_state(NETWORK_LINK_IDLE);
+        s_link_down_since_ms = 0;
+        link_report("WiFi disconnected");
+        s_link_report = false;
+    }
+    
+    if (events & LINK_EVENT_WIFI_REQUEST) {
+        s_wifi_wanted = true;
+        link_close_net();
+        WiFi.disconnect();
+        s_is_connected = false;
+        s_link.wifi_attempts = 0;
+        s_link.backoff_ms = NETWORK_LINK_BACKOFF_MIN_MS;
+        // 等驱动处理完断开再关联 (退避状态下忽略随后的断开事件)
+        link_set_state(NETWORK_LINK_WIFI_BACKOFF);
+        link_arm_deadline(NETWORK_LINK_BACKOFF_MIN_MS);
+    }
+    
+    if (events & LINK_EVENT_NET_STOP) {
+        s_net_wanted = false;
+        link_close_net();
+        if (s_link.state == NETWORK_LINK_NET_CONNECTING || s_link.state == NETWORK_LINK_NET_BACKOFF ||
+            s_link.state == NETWORK_LINK_ONLINE) {
+            link_set_state(NETWORK_LINK_WIFI_ONLY);
+        } else {
+            link_update_buffering();
+        }
+        s_link_down_since_ms = 0;
+        link_report("Network disconnected");
+        s_link_report = false;
+    }
+    
+    if (events & LINK_EVENT_NET_REQUEST) {
+        s_net_wanted = true;
+        link_close_net();
+        s_link.net_attempts = 0;
+        s_link.backoff_ms = NETWORK_LINK_BACKOFF_MIN_MS;
+        switch (s_link.state) {
+            case NETWORK_LINK_WIFI_ONLY:
+            case NETWORK_LINK_NET_CONNECTING:
+            case NETWORK_LINK_NET_BACKOFF:
+            case NETWORK_LINK_ONLINE:
+                link_net_begin();
+                break;
+                
+            case NETWORK_LINK_IDLE:
+                // WiFi 已被主动断开：先重新连接 WiFi
+                s_wifi_wanted = true;
+                link_wifi_begin();
+                break;
+                
+            default:
+                // WiFi 正在连接，获得 IP 后自动建立网络连接
+                link_update_buffering();
+                link_report("Waiting for WiFi");
+                break;
+        }
+    }
+}
+
+// 网络任务 (连接管理): 等待 WiFi 事件、命令请求或超时，不轮询连接状态
+// 在线的 TCP 服务端/UDP 模式下按服务周期接受客户端、发送发现信标
+static void network_link_task(void *pvParameters)
+{
+    ESP_LOGI(NETWORK_TASK_TAG, "Starting network task...");
+    
+    s_link.backoff_ms = NETWORK_LINK_BACKOFF_MIN_MS;
+    link_set_state(NETWORK_LINK_IDLE);
+    if (s_wifi_wanted) {
+        link_wifi_begin();
+    }
+    
+    for (;;) {
+        TickType_t wait_ticks = portMAX_DELAY;
+        if (s_link.state == NETWORK_LINK_ONLINE && (s_tcp_server != NULL || s_udp_fd >= 0)) {
+            wait_ticks = pdMS_TO_TICKS(NETWORK_UDP_SERVICE_PERIOD_MS);
+        }
+        if (s_link_deadline_armed) {
+            int32_t remaining_ms = (int32_t)(s_link_deadline_ms - millis());
+            TickType_t deadline_ticks = remaining_ms > 0 ? pdMS_TO_TICKS(remaining_ms) : 0;
+            if (deadline_ticks < wait_ticks) {
+                wait_ticks = deadline_ticks;
+            }
+        }
+        
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, wait_ticks);
+        
+        link_handle_requests(events);
+        if (events & LINK_EVENT_WIFI_DOWN) {
+            link_wifi_down();
+        }
+        if ((events & LINK_EVENT_WIFI_UP) && s_link.state == NETWORK_LINK_WIFI_CONNECTING && WiFi.isConnected()) {
+            link_wifi_up();
+        }
+        if ((events & LINK_EVENT_NET_DOWN) && s_link.state == NETWORK_LINK_ONLINE) {
+            link_net_lost();
+        }
+        if (s_link_deadline_armed && (int32_t)(millis() - s_link_deadline_ms) >= 0) {
+            s_link_deadline_armed = false;
+            link_deadline();
+        }
+        
+        if (s_link.state == NETWORK_LINK_ONLINE) {
+            if (s_tcp_server != NULL) {
+                tcp_server_service_clients();
+            }
+            if (s_udp_fd >= 0) {
+                udp_service(s_wifi_config->network_config.local_port);
+            }
+        }
+    }
+}
+
+void network_link_get_status(network_link_status_t* status)
+{
+    if (status == NULL) {
+        return;
+    }
+    memcpy(status, &s_link, sizeof(network_link_status_t));
+    status->state_ms = millis() - s_link_state_since_ms;
+    status->outage_frames = s_outage_frames;
+}
+
+const char* network_link_state_name(network_link_state_t state)
+{
+    if ((unsigned)state >= sizeof(s_link_state_names) / sizeof(s_link_state_names[0])) {
+        return "?";
+    }
+    return s_link_state_names[state];
+}
+
+void network_link_set_callback(network_link_callback_t callback)
+{
+    s_link_callback = callback;
+}
+
+void network_link_set_cached_ap(const uint8_t* bssid, int32_t channel)
+{
+    if (bssid == NULL || channel <= 0 || s_link_task != NULL) {
+        return;  // 网络任务启动后 s_link 只由它修改
+    }
+    memcpy(s_link.bssid, bssid, sizeof(s_link.bssid));
+    s_link.channel = channel;
+    s_link.bssid_cached = true;
+}
+
+/* -------------------- 网络接收 (下行命令) -------------------- */
+
+// 有新的连接/socket 时唤醒接收任务 (无连接时接收任务阻塞在任务通知上)
+static void network_rx_wake(void)
+{
+    if (s_rx_task != NULL) {
+        xTaskNotifyGive(s_rx_task);
+    }
+}
+
+// 从帧池取一个帧，最多等待 wait_ticks (回复路径使用，遥测路径从不等待)
+static network_frame_t* network_frame_alloc_wait(TickType_t wait_ticks)
+{
+    network_frame_t* frame = NULL;
+    if (s_frame_free_queue == NULL ||
+        xQueueReceive(s_frame_free_queue, &frame, wait_ticks) != pdPASS) {
+        return NULL;
+    }
+    frame->len = 0;
+    frame->flags = 0;
+    frame->sample_us = 0;
+    frame->wake_us = 0;
+    frame->client = -1;
+    frame->client_generation = 0;
+    return frame;
+}
+
+// TCP 回复经过网络发送任务，保证不会插进正在发送的遥测批次中间
+static void network_reply_via_tx(const uint8_t* data, size_t len, int client, uint8_t generation)
+{
+    while (len > 0) {
+        network_frame_t* frame = network_frame_alloc_wait(pdMS_TO_TICKS(NETWORK_RX_REPLY_TIMEOUT_MS));
+        if (frame == NULL) {
+            s_rx_stats.reply_failures++;
+            return;
+        }
+        size_t n = len < sizeof(frame->data) ? len : sizeof(frame->data);
+        memcpy(frame->data, data, n);
+        frame->len = (uint16_t)n;
+        frame->flags = NETWORK_FRAME_FLAG_URGENT;
+        frame->client = (int8_t)client;
+        frame->client_generation = generation;
+        if (network_frame_submit(frame) < 0) {
+            s_rx_stats.reply_failures++;
+            return;
+        }
+        s_rx_stats.reply_bytes += n;
+        data += n;
+        len -= n;
+    }
+}
+
+// uart_parser 的回复函数 (在 uart_parser_task 中调用)：回复发回命令来自的连接
+static void network_rx_reply(const uint8_t* data, size_t len, uint64_t context)
+{
+    uint64_t kind = context >> RX_ORIGIN_SHIFT;
+    
+    if (kind == RX_ORIGIN_UDP) {
+        // 单独的报文，可以直接发送，不会与遥测报文交错
+        int fd = s_udp_fd;
+        struct sockaddr_in to = {};
+        to.sin_family = AF_INET;
+        to.sin_addr.s_addr = (uint32_t)(context >> 16);
+        to.sin_port = (uint16_t)context;
+        if (fd < 0 || sendto(fd, data, len, 0, (struct sockaddr*)&to, sizeof(to)) != (int)len) {
+            s_rx_stats.reply_failures++;
+            return;
+        }
+        s_rx_stats.reply_bytes += len;
+        return;
+    }
+    
+    int fd = (int)(uint32_t)(context >> 8);
+    if (kind == RX_ORIGIN_TCP_CLIENT) {
+        // 重连后新连接通常分配到同一个 fd，同时核对连接代数；发送任务发送时再核对一次
+        uint8_t generation = (uint8_t)(context >> 40);
+        if (fd != s_tcp_client_fd || generation != s_tcp_client_generation) {
+            s_rx_stats.reply_failures++;  // 命令执行期间连接已更换
+            return;
+        }
+        network_reply_via_tx(data, len, NETWORK_FRAME_CLIENT_TCP_CLIENT, generation);
+    } else if (kind == RX_ORIGIN_TCP_SERVER) {
+        // 表项在命令执行期间可能已被关闭并分配给新连接：在 s_server_mutex 下核对连接代数，
+        // 发送任务发送时再核对一次 (帧排队期间也可能被复用)
+        int index = (int)(context & 0xFF);
+        uint8_t generation = (uint8_t)(context >> 40);
+        xSemaphoreTake(s_server_mutex, portMAX_DELAY);
+        bool same_client = s_server_clients[index].in_use && s_server_clients[index].generation == generation;
+        xSemaphoreGive(s_server_mutex);
+        if (!same_client) {
+            s_rx_stats.reply_failures++;
+            return;
+        }
+        network_reply_via_tx(data, len, index, generation);
+    }
+}
+
+static void rx_submit(const uint8_t* data, size_t len, uint64_t context, bool frame)
+{
+    uart_parser_origin_t origin = {network_rx_reply, context};
+    if (uart_parser_submit(data, len, &origin) == pdPASS) {
+        if (frame) {
+            s_rx_stats.frames++;
+        } else {
+            s_rx_stats.lines++;
+        }
+    } else {
+        s_rx_stats.dropped++;
     }
+}
+
+static void rx_stream_reset(rx_stream_t* stream, int fd)
+{
+    stream->fd = fd;
+    stream->len = 0;
+    stream->skip = 0;
+    stream->eof = false;
+}
 
-    if (WiFi.status() == WL_CONNECTED) {
-        s_is_connected = true;
-        ESP_LOGI(WIFI_TASK_TAG, "WiFi Connected. IP Address: %s", WiFi.localIP().toString().c_str());
+// 组装命令: 以同步字节开头的是机器模式请求帧 (按 len 字段确定长度)，否则是以换行结尾的文本行
+static void rx_stream_feed(rx_stream_t* stream, const uint8_t* data, size_t len, uint64_t context)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+        
+        if (stream->skip > 0) {
+            stream->skip--;
+            continue;
+        }
+        
+        if ((stream->len == 0 && byte == TELEMETRY_FRAME_SYNC) ||
+            (stream->len > 0 && stream->buf[0] == TELEMETRY_FRAME_SYNC)) {
+            stream->buf[stream->len++] = byte;
+            if (stream->len < TELEMETRY_FRAME_HEADER_SIZE) {
+                continue;
+            }
+            size_t expected = TELEMETRY_FRAME_OVERHEAD + stream->buf[2];
+            if (expected > sizeof(stream->buf)) {
+                // 请求帧超过解析器缓冲区，丢弃整帧以保持同步
+                stream->skip = expected - stream->len;
+                stream->len = 0;
+                s_rx_stats.dropped++;
+            } else if (stream->len == expected) {
+                rx_submit(stream->buf, stream->len, context, true);
+                stream->len = 0;
+            }
+            continue;
+        }
         
-        // 如果配置了网络协议且需要自动连接，启动网络任务
-        if (s_wifi_config->network_config.protocol != NETWORK_PROTOCOL_NONE && 
-            s_wifi_config->network_config.auto_connect) {
-            ESP_LOGI(WIFI_TASK_TAG, "Starting network task...");
-            if (xTaskCreate(my_network_task, "network_task", 4096, NULL, 4, NULL) != pdPASS) {
-                ESP_LOGE(WIFI_TASK_TAG, "Failed to create network task");
+        if (byte == '\r' || byte == '\n') {
+            if (stream->len > 0) {
+                rx_submit(stream->buf, stream->len, context, false);
+                stream->len = 0;
             }
+        } else if (stream->len < sizeof(stream->buf) - 1) {
+            stream->buf[stream->len++] = byte;  // 超长部分截断
         }
-        wifi_initialized = true;
-    } else if (!wifi_initialized) {
-        s_is_connected = false;
-        ESP_LOGW(WIFI_TASK_TAG, "WiFi connection failed or not in STA mode.");
-        wifi_initialized = true; // 标记已尝试初始化，避免重复
     }
-    } // 关闭 if (!wifi_initialized && s_wifi_config != NULL) 的大括号
 }
 
-bool is_wifi_connected(void)
+// 读取一个 TCP 连接，对端关闭或出错时标记 eof
+static void rx_read_tcp(rx_stream_t* stream, uint64_t context)
 {
-    // For STA mode, we can rely on WiFi.isConnected()
-    s_is_connected = WiFi.isConnected();
-    return s_is_connected;
+    ssize_t n = recv(stream->fd, s_rx_buffer, sizeof(s_rx_buffer), MSG_DONTWAIT);
+    if (n > 0) {
+        s_rx_stats.bytes_received += n;
+        rx_stream_feed(stream, s_rx_buffer, (size_t)n, context);
+    } else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        stream->eof = true;
+    }
 }
 
-// 网络任务处理函数
-static void my_network_task(void *pvParameters)
+// 读取一个 UDP 报文：发现应答交给发现逻辑，其余按命令处理 (每个报文是一个完整单元)
+static void rx_read_udp(int fd)
 {
-    ESP_LOGI(NETWORK_TASK_TAG, "Starting network task...");
+    struct sockaddr_in from = {};
+    socklen_t from_len = sizeof(from);
+    ssize_t n = recvfrom(fd, s_rx_buffer, sizeof(s_rx_buffer), MSG_DONTWAIT, (struct sockaddr*)&from, &from_len);
+    if (n <= 0) {
+        return;
+    }
     
-    network_config_t* net_config = &s_wifi_config->network_config;
+    size_t reply_len = strlen(NETWORK_UDP_DISCOVERY_REPLY);
+    if ((size_t)n >= reply_len && memcmp(s_rx_buffer, NETWORK_UDP_DISCOVERY_REPLY, reply_len) == 0) {
+        udp_handle_discovery_reply(&from);
+        return;
+    }
     
-    switch (net_config->protocol) {
-        case NETWORK_PROTOCOL_TCP_CLIENT:
-        {
-            ESP_LOGI(NETWORK_TASK_TAG, "Initializing TCP Client mode");
-            s_tcp_client = new WiFiClient();
-            
-            uint32_t start_time = millis();
-            while (!s_tcp_client->connected()) {
-                ESP_LOGI(NETWORK_TASK_TAG, "Connecting to TCP server %s:%d", 
-                         net_config->remote_host, net_config->remote_port);
-                
-                if (s_tcp_client->connect(net_config->remote_host, net_config->remote_port)) {
-                    s_network_connected = true;
-                    ESP_LOGI(NETWORK_TASK_TAG, "TCP Client connected successfully");
-                    snprintf(s_network_info, sizeof(s_network_info), 
-                            "TCP Client connected to %s:%d", 
-                            net_config->remote_host, net_config->remote_port);
-                    break;
-                } else {
-                    ESP_LOGW(NETWORK_TASK_TAG, "TCP connection failed, retrying...");
-                    vTaskDelay(pdMS_TO_TICKS(1000));
+    s_rx_stats.bytes_received += n;
+    uint64_t context = (RX_ORIGIN_UDP << RX_ORIGIN_SHIFT) |
+                       ((uint64_t)from.sin_addr.s_addr << 16) | from.sin_port;
+    rx_stream_t stream;
+    rx_stream_reset(&stream, fd);
+    rx_stream_feed(&stream, s_rx_buffer, (size_t)n, context);
+    // 报文末尾没有换行的文本也是一条完整命令
+    if (stream.len > 0 && stream.buf[0] != TELEMETRY_FRAME_SYNC) {
+        rx_submit(stream.buf, stream.len, context, false);
+    }
+}
+
+// 网络接收任务: 阻塞在 select() 上，数据到达即读取，不轮询
+static void network_rx_task(void *pvParameters)
+{
+    ESP_LOGI(NETWORK_TASK_TAG, "Network RX task started");
+    
+    for (;;) {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        int max_fd = -1;
+        
+        int client_fd = s_tcp_client_fd;
+        uint8_t client_generation = s_tcp_client_generation;   // 在 fd 之后读取 (网络任务先更新代数)
+        if (client_fd != s_rx_client_stream.fd || client_generation != s_rx_client_stream.generation) {
+            rx_stream_reset(&s_rx_client_stream, client_fd);
+            s_rx_client_stream.generation = client_generation;
+        }
+        if (client_fd >= 0 && !s_rx_client_stream.eof) {
+            FD_SET(client_fd, &readfds);
+            max_fd = client_fd;
+        }
+        
+        if (s_tcp_server != NULL) {
+            xSemaphoreTake(s_server_mutex, portMAX_DELAY);
+            for (int i = 0; i < NETWORK_TCP_SERVER_MAX_CLIENTS; i++) {
+                rx_stream_t* stream = &s_rx_server_streams[i];
+                int fd = s_server_clients[i].in_use ? s_server_clients[i].client.fd() : -1;
+                uint8_t generation = s_server_clients[i].generation;
+                if (fd != stream->fd || generation != stream->generation) {
+                    rx_stream_reset(stream, fd);
+                    stream->generation = generation;
                 }
-                
-                if (millis() - start_time > net_config->connect_timeout_ms) {
-                    ESP_LOGE(NETWORK_TASK_TAG, "TCP connection timeout!");
-                    break;
+                if (fd >= 0 && !stream->eof) {
+                    FD_SET(fd, &readfds);
+                    if (fd > max_fd) max_fd = fd;
                 }
             }
-            break;
+            xSemaphoreGive(s_server_mutex);
         }
         
-        case NETWORK_PROTOCOL_TCP_SERVER:
-        {
-            ESP_LOGI(NETWORK_TASK_TAG, "Initializing TCP Server mode on port %d", net_config->local_port);
-            s_tcp_server = new WiFiServer(net_config->local_port);
-            s_tcp_server->begin();
-            s_network_connected = true;
-            ESP_LOGI(NETWORK_TASK_TAG, "TCP Server started successfully");
-            snprintf(s_network_info, sizeof(s_network_info), 
-                    "TCP Server listening on port %d", net_config->local_port);
-            break;
+        int udp_fd = s_udp_fd;
+        if (udp_fd >= 0) {
+            FD_SET(udp_fd, &readfds);
+            if (udp_fd > max_fd) max_fd = udp_fd;
         }
         
-        case NETWORK_PROTOCOL_UDP:
-        {
-            ESP_LOGI(NETWORK_TASK_TAG, "Initializing UDP mode on port %d", net_config->local_port);
-            s_udp = new WiFiUDP();
-            if (s_udp->begin(net_config->local_port)) {
-                s_network_connected = true;
-                ESP_LOGI(NETWORK_TASK_TAG, "UDP initialized successfully");
-                snprintf(s_network_info, sizeof(s_network_info), 
-                        "UDP listening on port %d", net_config->local_port);
-            } else {
-                ESP_LOGE(NETWORK_TASK_TAG, "Failed to initialize UDP");
-            }
-            break;
+        if (max_fd < 0) {
+            // 没有任何连接：等待网络任务建立连接后通知
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
         }
         
-        default:
-            ESP_LOGW(NETWORK_TASK_TAG, "Unknown network protocol");
-            break;
+        struct timeval timeout = {0, NETWORK_RX_SELECT_TIMEOUT_MS * 1000};
+        int ready = select(max_fd + 1, &readfds, NULL, NULL, &timeout);
+        if (ready < 0) {
+            // 某个 socket 刚被关闭，稍后用新的集合重试
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+        if (ready == 0) {
+            continue;
+        }
+        
+        if (client_fd >= 0 && FD_ISSET(client_fd, &readfds)) {
+            rx_read_tcp(&s_rx_client_stream,
+                        (RX_ORIGIN_TCP_CLIENT << RX_ORIGIN_SHIFT) |
+                        ((uint64_t)s_rx_client_stream.generation << 40) | ((uint64_t)(uint32_t)client_fd << 8));
+            if (s_rx_client_stream.eof && client_fd == s_tcp_client_fd) {
+                // 对端关闭、连接出错或 keepalive 超时：交给网络任务重连
+                network_link_notify(LINK_EVENT_NET_DOWN);
+            }
+        }
+        for (int i = 0; i < NETWORK_TCP_SERVER_MAX_CLIENTS; i++) {
+            rx_stream_t* stream = &s_rx_server_streams[i];
+            if (stream->fd >= 0 && !stream->eof && FD_ISSET(stream->fd, &readfds)) {
+                rx_read_tcp(stream, (RX_ORIGIN_TCP_SERVER << RX_ORIGIN_SHIFT) |
+                                    ((uint64_t)stream->generation << 40) |
+                                    ((uint64_t)(uint32_t)stream->fd << 8) | (uint64_t)i);
+            }
+        }
+        if (udp_fd >= 0 && FD_ISSET(udp_fd, &readfds)) {
+            rx_read_udp(udp_fd);
+        }
     }
-    
-    // 网络任务完成初始化后删除自己
-    vTaskDelete(NULL);
+}
+
+void network_rx_get_stats(network_rx_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    memcpy(stats, &s_rx_stats, sizeof(network_rx_stats_t));
+}
+
+int network_get_client_count(void)
+{
+    return s_server_client_count;
 }
 
 int network_send_data(const uint8_t* data, size_t len)
@@ -192,29 +1594,14 @@ int network_send_data(const uint8_t* data, size_t len)
     
     switch (net_config->protocol) {
         case NETWORK_PROTOCOL_TCP_CLIENT:
-            if (s_tcp_client && s_tcp_client->connected()) {
-                return s_tcp_client->write(data, len);
-            }
-            break;
+            return tcp_client_send(data, len);
             
         case NETWORK_PROTOCOL_TCP_SERVER:
-            // TCP 服务器模式下，需要向所有连接的客户端发送数据
-            if (s_tcp_server) {
-                WiFiClient client = s_tcp_server->available();
-                if (client) {
-                    return client.write(data, len);
-                }
-            }
-            break;
+            // TCP 服务器模式下，向所有连接的客户端广播
+            return tcp_server_broadcast(data, len);
             
         case NETWORK_PROTOCOL_UDP:
-            if (s_udp) {
-                s_udp->beginPacket(net_config->remote_host, net_config->remote_port);
-                int result = s_udp->write(data, len);
-                s_udp->endPacket();
-                return result;
-            }
-            break;
+            return udp_send(data, len);
             
         default:
             break;
@@ -231,6 +1618,357 @@ int network_send_string(const char* str)
     return network_send_data((const uint8_t*)str, strlen(str));
 }
 
+// 发送聚合缓冲区 (仅在发送任务中调用)
+static void network_tx_flush_buffer(void)
+{
+    if (s_tx_len == 0) {
+        return;
+    }
+    
+    int result = network_send_data(s_tx_buffer, s_tx_len);
+    s_tx_stats.flushes++;
+    if (result > 0) {
+        s_tx_stats.bytes_sent += result;
+        // 写入完成时刻即为该批次所有帧的上线时刻
+        uint32_t wire_us = latency_now_us();
+        for (size_t i = 0; i < s_tx_stamp_count; i++) {
+            latency_record(LATENCY_STAGE_WAKE_TO_WIRE, s_tx_stamps[i].wake_us, wire_us);
+            latency_record(LATENCY_STAGE_SAMPLE_TO_WIRE, s_tx_stamps[i].sample_us, wire_us);
+        }
+    } else {
+        s_tx_stats.send_failures++;
+        DLOGD(DLOG_MODULE_NETWORK, "TX flush failed, %u bytes dropped", (unsigned)s_tx_len);
+    }
+    s_tx_len = 0;
+    s_tx_stamp_count = 0;
+}
+
+/* 断线缓冲区 (仅在发送任务中调用) */
+
+static void outage_copy_in(size_t pos, const uint8_t* data, size_t len)
+{
+    size_t first = NETWORK_OUTAGE_BUFFER_SIZE - pos;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(s_outage_buffer + pos, data, first);
+    memcpy(s_outage_buffer, data + first, len - first);
+}
+
+static void outage_copy_out(size_t pos, uint8_t* data, size_t len)
+{
+    size_t first = NETWORK_OUTAGE_BUFFER_SIZE - pos;
+    if (first > len) {
+        first = len;
+    }
+    memcpy(data, s_outage_buffer + pos, first);
+    memcpy(data + first, s_outage_buffer, len - first);
+}
+
+// 最早一帧的长度 (缓冲区为空时返回 0)
+static size_t outage_peek_len(void)
+{
+    if (s_outage_frames == 0) {
+        return 0;
+    }
+    uint8_t header[2];
+    outage_copy_out(s_outage_head, header, sizeof(header));
+    return header[0] | ((size_t)header[1] << 8);
+}
+
+// 取出最早的一帧 (data 为 NULL 时直接丢弃)，返回帧长度
+static size_t outage_pop(uint8_t* data)
+{
+    size_t len = outage_peek_len();
+    if (s_outage_frames == 0) {
+        return 0;
+    }
+    if (data != NULL) {
+        outage_copy_out((s_outage_head + 2) % NETWORK_OUTAGE_BUFFER_SIZE, data, len);
+    }
+    s_outage_head = (s_outage_head + 2 + len) % NETWORK_OUTAGE_BUFFER_SIZE;
+    s_outage_used -= 2 + len;
+    s_outage_frames--;
+    return len;
+}
+
+// 存入一帧，帧数或空间不足时丢弃最早的帧
+static void outage_push(const uint8_t* data, size_t len)
+{
+    size_t record_len = 2 + len;
+    if (NETWORK_OUTAGE_BUFFER_FRAMES == 0 || record_len > NETWORK_OUTAGE_BUFFER_SIZE) {
+        s_tx_stats.outage_dropped++;
+        return;
+    }
+    while (s_outage_frames >= NETWORK_OUTAGE_BUFFER_FRAMES ||
+           s_outage_used + record_len > NETWORK_OUTAGE_BUFFER_SIZE) {
+        outage_pop(NULL);
+        s_tx_stats.outage_dropped++;
+    }
+    size_t tail = (s_outage_head + s_outage_used) % NETWORK_OUTAGE_BUFFER_SIZE;
+    uint8_t header[2] = {(uint8_t)len, (uint8_t)(len >> 8)};
+    outage_copy_in(tail, header, sizeof(header));
+    outage_copy_in((tail + 2) % NETWORK_OUTAGE_BUFFER_SIZE, data, len);
+    s_outage_used += record_len;
+    s_outage_frames++;
+    s_tx_stats.outage_buffered++;
+}
+
+// 连接恢复后按原顺序补发断线缓冲区中的帧 (在新的帧之前)
+// 补发的帧不计入延迟直方图：它们的延迟主要是断线时长
+static void network_tx_replay_outage(void)
+{
+    network_tx_flush_buffer();
+    uint32_t replayed = 0;
+    while (s_outage_frames > 0) {
+        size_t len = outage_peek_len();
+        if (s_tx_len + len > sizeof(s_tx_buffer)) {
+            network_tx_flush_buffer();
+        }
+        outage_pop(s_tx_buffer + s_tx_len);
+        s_tx_len += len;
+        s_tx_stats.outage_replayed++;
+        replayed++;
+    }
+    network_tx_flush_buffer();
+    ESP_LOGI(NETWORK_TASK_TAG, "Replayed %lu frames buffered during outage", (unsigned long)replayed);
+}
+
+// 网络发送任务: 唯一调用 network_send_data() 的地方, 负责聚合与按时间窗刷新
+static void network_tx_task(void *pvParameters)
+{
+    ESP_LOGI(NETWORK_TASK_TAG, "Network TX task started");
+    
+    for (;;) {
+        // 缓冲区为空时永久等待; 否则最多等到刷新时间窗到期
+        // TCP 服务端有客户端尚未发完的数据时，定期重试发送
+        TickType_t wait_ticks = portMAX_DELAY;
+        if (s_tcp_server != NULL && tcp_server_broadcast(NULL, 0) > 0) {
+            wait_ticks = pdMS_TO_TICKS(5);
+        }
+        if (s_tx_len > 0) {
+            uint32_t elapsed_us = micros() - s_tx_first_us;
+            uint32_t window_us = s_tx_flush_interval_ms * 1000;
+            if (elapsed_us >= window_us) {
+                network_tx_flush_buffer();
+                continue;
+            }
+            // 向上取整，避免提前醒来后空转
+            TickType_t window_ticks = pdMS_TO_TICKS((window_us - elapsed_us + 999) / 1000);
+            if (window_ticks == 0) {
+                window_ticks = 1;
+            }
+            if (window_ticks < wait_ticks) {
+                wait_ticks = window_ticks;
+            }
+        }
+        
+        network_frame_t* frame = NULL;
+        if (xQueueReceive(s_tx_queue, &frame, wait_ticks) != pdPASS || frame == NULL) {
+            continue;
+        }
+        
+        // 连接恢复后先补发断线期间缓冲的帧，再处理新的帧 (网络任务上线时提交刷新请求唤醒这里)
+        if (s_outage_frames > 0 && is_network_connected()) {
+            network_tx_replay_outage();
+        }
+        
+        if (frame->client == NETWORK_FRAME_CLIENT_TCP_CLIENT) {
+            // TCP 客户端连接上的命令回复：排队期间已重连时丢弃，否则与遥测一样进入聚合缓冲区
+            if (frame->client_generation != s_tcp_client_generation || s_tcp_client_fd < 0) {
+                s_rx_stats.reply_failures++;
+                network_frame_free(frame);
+                continue;
+            }
+        } else if (frame->client >= 0) {
+            // 只发给一个 TCP 服务端客户端的命令回复：先发出已聚合的数据，保持先后顺序
+            network_tx_flush_buffer();
+            if (s_tcp_server != NULL && tcp_server_send_to(frame->client, frame->client_generation, frame->data, frame->len) < 0) {
+                s_rx_stats.reply_failures++;
+            }
+            network_frame_free(frame);
+            continue;
+        }
+        
+        if (!is_network_connected()) {
+            // 重连期间帧存入断线缓冲区 (不再重连时直接丢弃)
+            if (frame->len > 0 && s_link_buffering) {
+                outage_push(frame->data, frame->len);
+            }
+            network_frame_free(frame);
+            continue;
+        }
+        
+        if (frame->len > 0) {
+            // 按大小刷新：放不下新帧时先发送
+            if (s_tx_len + frame->len > sizeof(s_tx_buffer)) {
+                network_tx_flush_buffer();
+            }
+            if (s_tx_len == 0) {
+                s_tx_first_us = micros();
+            }
+            memcpy(s_tx_buffer + s_tx_len, frame->data, frame->len);
+            s_tx_len += frame->len;
+            s_tx_stats.frames_sent++;
+            if (frame->sample_us != 0 && s_tx_stamp_count < NETWORK_TX_MAX_STAMPS) {
+                s_tx_stamps[s_tx_stamp_count].sample_us = frame->sample_us;
+                s_tx_stamps[s_tx_stamp_count].wake_us = frame->wake_us;
+                s_tx_stamp_count++;
+            }
+        }
+        
+        // 紧急帧、刷新请求或时间窗为 0 时立即发送
+        bool flush_now = (frame->flags & NETWORK_FRAME_FLAG_URGENT) ||
+                         s_tx_flush_interval_ms == 0 ||
+                         s_tx_len == sizeof(s_tx_buffer);
+        
+        // 帧数据已复制到聚合缓冲区，归还到帧池
+        network_frame_free(frame);
+        
+        if (flush_now) {
+            network_tx_flush_buffer();
+        }
+    }
+}
+
+// 创建帧池、发送队列与发送任务
+static BaseType_t network_tx_init(void)
+{
+    if (s_tx_task != NULL) {
+        return pdPASS;
+    }
+    
+    s_server_mutex = xSemaphoreCreateMutex();
+    if (s_server_mutex == NULL) {
+        ESP_LOGE(NETWORK_TASK_TAG, "Failed to create server mutex");
+        return pdFAIL;
+    }
+    
+    s_frame_free_queue = xQueueCreate(NETWORK_FRAME_POOL_SIZE, sizeof(network_frame_t*));
+    s_tx_queue = xQueueCreate(NETWORK_FRAME_POOL_SIZE, sizeof(network_frame_t*));
+    if (s_frame_free_queue == NULL || s_tx_queue == NULL) {
+        ESP_LOGE(NETWORK_TASK_TAG, "Failed to create TX queues");
+        return pdFAIL;
+    }
+    
+    for (int i = 0; i < NETWORK_FRAME_POOL_SIZE; i++) {
+        network_frame_t* frame = &s_frame_pool[i];
+        xQueueSend(s_frame_free_queue, &frame, 0);
+    }
+    
+    if (task_plan_create(network_tx_task, "network_tx_task", 3072, NULL, 4, &s_tx_task,
+                         TASK_PLAN_CORE_NETWORK) != pdPASS) {
+        ESP_LOGE(NETWORK_TASK_TAG, "Failed to create network TX task");
+        s_tx_task = NULL;
+        return pdFAIL;
+    }
+    
+    rx_stream_reset(&s_rx_client_stream, -1);
+    for (int i = 0; i < NETWORK_TCP_SERVER_MAX_CLIENTS; i++) {
+        rx_stream_reset(&s_rx_server_streams[i], -1);
+    }
+    if (task_plan_create(network_rx_task, "network_rx_task", 3072, NULL, 4, &s_rx_task,
+                         TASK_PLAN_CORE_NETWORK) != pdPASS) {
+        ESP_LOGE(NETWORK_TASK_TAG, "Failed to create network RX task");
+        s_rx_task = NULL;
+        return pdFAIL;
+    }
+    
+    return pdPASS;
+}
+
+network_frame_t* network_frame_alloc(void)
+{
+    network_frame_t* frame = network_frame_alloc_wait(0);
+    if (frame == NULL) {
+        s_tx_stats.pool_exhausted++;
+    }
+    return frame;
+}
+
+void network_frame_free(network_frame_t* frame)
+{
+    if (frame != NULL && s_frame_free_queue != NULL) {
+        xQueueSend(s_frame_free_queue, &frame, 0);
+    }
+}
+
+int network_frame_submit(network_frame_t* frame)
+{
+    if (frame == NULL) {
+        return -1;
+    }
+    if (s_tx_queue == NULL || !(s_network_connected || s_link_buffering) || frame->len > sizeof(frame->data)) {
+        network_frame_free(frame);
+        return -1;
+    }
+    
+    int len = frame->len;
+    // 发送队列与帧池容量相同，已分配的帧一定能放入队列，不会阻塞
+    if (xQueueSend(s_tx_queue, &frame, 0) != pdPASS) {
+        network_frame_free(frame);
+        return -1;
+    }
+    return len;
+}
+
+int network_send_async(const uint8_t* data, size_t len)
+{
+    return network_tx_enqueue(data, len, false);
+}
+
+int network_tx_enqueue(const uint8_t* data, size_t len, bool urgent)
+{
+    if (data == NULL || len == 0 || len > NETWORK_FRAME_DATA_SIZE || !(s_network_connected || s_link_buffering)) {
+        return -1;
+    }
+    
+    network_frame_t* frame = network_frame_alloc();
+    if (frame == NULL) {
+        return -1;
+    }
+    
+    memcpy(frame->data, data, len);
+    frame->len = (uint16_t)len;
+    frame->flags = urgent ? NETWORK_FRAME_FLAG_URGENT : 0;
+    return network_frame_submit(frame);
+}
+
+int network_tx_flush(void)
+{
+    // 发送一个空的紧急帧作为刷新请求
+    network_frame_t* frame = network_frame_alloc();
+    if (frame == NULL) {
+        return -1;
+    }
+    frame->flags = NETWORK_FRAME_FLAG_URGENT;
+    return network_frame_submit(frame);
+}
+
+void network_tx_set_flush_interval(uint32_t interval_ms)
+{
+    s_tx_flush_interval_ms = interval_ms;
+    ESP_LOGI(NETWORK_TASK_TAG, "TX flush interval set to %lu ms", (unsigned long)interval_ms);
+}
+
+uint32_t network_tx_get_flush_interval(void)
+{
+    return s_tx_flush_interval_ms;
+}
+
+void network_tx_get_stats(network_tx_stats_t* stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    memcpy(stats, &s_tx_stats, sizeof(network_tx_stats_t));
+}
+
+bool network_tx_accepting(void)
+{
+    return s_tx_queue != NULL && (s_link_buffering || is_network_connected());
+}
+
 bool is_network_connected(void)
 {
     if (!s_network_connected) {
@@ -241,13 +1979,14 @@ bool is_network_connected(void)
     
     switch (net_config->protocol) {
         case NETWORK_PROTOCOL_TCP_CLIENT:
-            return (s_tcp_client && s_tcp_client->connected());
+            return (s_tcp_client_fd >= 0);
             
         case NETWORK_PROTOCOL_TCP_SERVER:
             return (s_tcp_server != NULL);
             
         case NETWORK_PROTOCOL_UDP:
-            return (s_udp != NULL);
+            // 发现模式下找到地面站之前视为未连接，发布任务不会为此占用帧池
+            return (s_udp_fd >= 0 && s_udp_remote_valid);
             
         default:
             return false;
@@ -262,8 +2001,13 @@ const char* get_network_info(void)
 bool wifi_disconnect(void)
 {
     ESP_LOGI(WIFI_TASK_TAG, "Disconnecting WiFi...");
-    WiFi.disconnect();
-    s_is_connected = false;
+    if (s_link_task == NULL) {
+        WiFi.disconnect();
+        s_is_connected = false;
+        return true;
+    }
+    s_link_report = true;
+    network_link_notify(LINK_EVENT_WIFI_STOP);
     return true;
 }
 
@@ -273,46 +2017,41 @@ bool wifi_connect_new(const char* ssid, const char* password, uint32_t timeout_m
         ESP_LOGE(WIFI_TASK_TAG, "SSID cannot be NULL");
         return false;
     }
+    if (s_wifi_config == NULL || s_link_task == NULL) {
+        ESP_LOGE(WIFI_TASK_TAG, "WiFi is not initialized in STA mode");
+        return false;
+    }
     
     ESP_LOGI(WIFI_TASK_TAG, "Connecting to new WiFi: %s", ssid);
     
-    // 断开当前连接
-    WiFi.disconnect();
-    vTaskDelay(pdMS_TO_TICKS(500));
-    
-    // 连接新网络
-    if (password && strlen(password) > 0) {
-        WiFi.begin(ssid, password);
+    // 更新配置，由网络任务断开当前连接后重新关联
+    portENTER_CRITICAL(&s_link_mux);
+    strncpy(s_wifi_config->ssid, ssid, sizeof(s_wifi_config->ssid) - 1);
+    s_wifi_config->ssid[sizeof(s_wifi_config->ssid) - 1] = '\0';
+    if (password) {
+        strncpy(s_wifi_config->password, password, sizeof(s_wifi_config->password) - 1);
+        s_wifi_config->password[sizeof(s_wifi_config->password) - 1] = '\0';
     } else {
-        WiFi.begin(ssid);
-    }
-    
-    uint32_t start_time = millis();
-    while (WiFi.status() != WL_CONNECTED) {
-        vTaskDelay(pdMS_TO_TICKS(500));
-        if (millis() - start_time > timeout_ms) {
-            ESP_LOGE(WIFI_TASK_TAG, "WiFi connection timeout");
-            s_is_connected = false;
-            return false;
-        }
+        s_wifi_config->password[0] = '\0';
     }
+    s_wifi_config->sta_connect_timeout_ms = timeout_ms;
+    portEXIT_CRITICAL(&s_link_mux);
     
-    s_is_connected = true;
-    ESP_LOGI(WIFI_TASK_TAG, "WiFi connected successfully. IP: %s", WiFi.localIP().toString().c_str());
-    
-    // 更新配置
-    if (s_wifi_config) {
-        strncpy(s_wifi_config->ssid, ssid, sizeof(s_wifi_config->ssid) - 1);
-        s_wifi_config->ssid[sizeof(s_wifi_config->ssid) - 1] = '\0';
-        
-        if (password) {
-            strncpy(s_wifi_config->password, password, sizeof(s_wifi_config->password) - 1);
-            s_wifi_config->password[sizeof(s_wifi_config->password) - 1] = '\0';
-        } else {
-            s_wifi_config->password[0] = '\0';
-        }
+    s_link_forget_bssid = true;
+    s_link_report = true;
+    network_link_notify(LINK_EVENT_WIFI_REQUEST);
+    return true;
+}
+
+bool wifi_reconnect(void)
+{
+    if (s_wifi_config == NULL || s_link_task == NULL) {
+        ESP_LOGE(WIFI_TASK_TAG, "WiFi is not initialized in STA mode");
+        return false;
     }
-    
+    ESP_LOGI(WIFI_TASK_TAG, "Reconnecting WiFi...");
+    s_link_report = true;
+    network_link_notify(LINK_EVENT_WIFI_REQUEST);
     return true;
 }
 
@@ -322,36 +2061,20 @@ bool get_current_wifi_config(wifi_task_config_t* config)
         return false;
     }
     
+    portENTER_CRITICAL(&s_link_mux);
     memcpy(config, s_wifi_config, sizeof(wifi_task_config_t));
+    portEXIT_CRITICAL(&s_link_mux);
     return true;
 }
 
 bool network_disconnect(void)
 {
     ESP_LOGI(NETWORK_TASK_TAG, "Disconnecting network...");
-    
-    if (s_tcp_client) {
-        s_tcp_client->stop();
-        delete s_tcp_client;
-        s_tcp_client = NULL;
-    }
-    
-    if (s_tcp_server) {
-        s_tcp_server->end();
-        delete s_tcp_server;
-        s_tcp_server = NULL;
-    }
-    
-    if (s_udp) {
-        s_udp->stop();
-        delete s_udp;
-        s_udp = NULL;
+    if (s_link_task == NULL) {
+        return true;  // 没有网络任务时不会建立任何连接
     }
-    
-    s_network_connected = false;
-    memset(s_network_info, 0, sizeof(s_network_info));
-    
-    ESP_LOGI(NETWORK_TASK_TAG, "Network disconnected");
+    s_link_report = true;
+    network_link_notify(LINK_EVENT_NET_STOP);
     return true;
 }
 
@@ -361,44 +2084,38 @@ bool network_connect_tcp_client(const char* remote_host, uint16_t remote_port, u
         ESP_LOGE(NETWORK_TASK_TAG, "Remote host cannot be NULL");
         return false;
     }
-    
-    // 断开当前连接
-    network_disconnect();
+    if (s_wifi_config == NULL || s_link_task == NULL) {
+        ESP_LOGE(NETWORK_TASK_TAG, "WiFi is not initialized in STA mode");
+        return false;
+    }
     
     ESP_LOGI(NETWORK_TASK_TAG, "Connecting TCP client to %s:%d", remote_host, remote_port);
     
-    s_tcp_client = new WiFiClient();
+    // 更新配置，由网络任务关闭当前连接后按新配置连接
+    portENTER_CRITICAL(&s_link_mux);
+    network_config_t* net_config = &s_wifi_config->network_config;
+    net_config->protocol = NETWORK_PROTOCOL_TCP_CLIENT;
+    strncpy(net_config->remote_host, remote_host, sizeof(net_config->remote_host) - 1);
+    net_config->remote_host[sizeof(net_config->remote_host) - 1] = '\0';
+    net_config->remote_port = remote_port;
+    net_config->connect_timeout_ms = timeout_ms;
+    portEXIT_CRITICAL(&s_link_mux);
     
-    uint32_t start_time = millis();
-    while (!s_tcp_client->connected()) {
-        if (s_tcp_client->connect(remote_host, remote_port)) {
-            s_network_connected = true;
-            ESP_LOGI(NETWORK_TASK_TAG, "TCP Client connected successfully");
-            snprintf(s_network_info, sizeof(s_network_info), 
-                    "TCP Client connected to %s:%d", remote_host, remote_port);
-            
-            // 更新配置
-            if (s_wifi_config) {
-                s_wifi_config->network_config.protocol = NETWORK_PROTOCOL_TCP_CLIENT;
-                strncpy(s_wifi_config->network_config.remote_host, remote_host, 
-                       sizeof(s_wifi_config->network_config.remote_host) - 1);
-                s_wifi_config->network_config.remote_host[sizeof(s_wifi_config->network_config.remote_host) - 1] = '\0';
-                s_wifi_config->network_config.remote_port = remote_port;
-            }
-            
-            return true;
-        } else {
-            vTaskDelay(pdMS_TO_TICKS(1000));
-            if (millis() - start_time > timeout_ms) {
-                ESP_LOGE(NETWORK_TASK_TAG, "TCP connection timeout");
-                delete s_tcp_client;
-                s_tcp_client = NULL;
-                return false;
-            }
-        }
+    s_link_report = true;
+    network_link_notify(LINK_EVENT_NET_REQUEST);
+    return true;
+}
+
+bool network_reconnect(void)
+{
+    if (s_wifi_config == NULL || s_link_task == NULL ||
+        s_wifi_config->network_config.protocol == NETWORK_PROTOCOL_NONE) {
+        return false;
     }
-    
-    return false;
+    ESP_LOGI(NETWORK_TASK_TAG, "Reconnecting network...");
+    s_link_report = true;
+    network_link_notify(LINK_EVENT_NET_REQUEST);
+    return true;
 }
 
 bool get_current_network_config(network_config_t* config)
@@ -407,6 +2124,8 @@ bool get_current_network_config(network_config_t* config)
         return false;
     }
     
+    portENTER_CRITICAL(&s_link_mux);
     memcpy(config, &s_wifi_config->network_config, sizeof(network_config_t));
+    portEXIT_CRITICAL(&s_link_mux);
     return true;
 }
@@ -8,11 +8,154 @@
 #include "WiFiClient.h"
 #include "WiFiServer.h"
 #include "WiFiUdp.h"
+#include "network_frame.h"   // 帧池与零拷贝发送接口
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief 发送聚合缓冲区大小 (字节)
+ * @note 默认取 lwIP 的 TCP MSS (1436)，一次刷新正好填满一个 TCP 段 / 一个 UDP 报文
+ */
+#ifndef NETWORK_TX_BATCH_SIZE
+#define NETWORK_TX_BATCH_SIZE           1436
+#endif
+
+/**
+ * @brief 默认的发送聚合刷新时间窗 (ms)
+ * @note 缓冲区中最早的数据等待超过该时间后会被发送出去；0 表示不聚合，立即发送
+ */
+#ifndef NETWORK_TX_FLUSH_INTERVAL_MS
+#define NETWORK_TX_FLUSH_INTERVAL_MS    3
+#endif
+
+/**
+ * @brief 一个聚合批次中最多记录延迟时间戳的帧数 (超出的帧不计入延迟直方图)
+ */
+#ifndef NETWORK_TX_MAX_STAMPS
+#define NETWORK_TX_MAX_STAMPS           64
+#endif
+
+/**
+ * @brief TCP 服务端模式下同时服务的最大客户端数量
+ */
+#ifndef NETWORK_TCP_SERVER_MAX_CLIENTS
+#define NETWORK_TCP_SERVER_MAX_CLIENTS  4
+#endif
+
+/**
+ * @brief TCP 服务端模式下每个客户端的待发送批次队列深度
+ * @note 客户端接收过慢导致队列已满时，丢弃最早的未发送批次，不影响其他客户端
+ */
+#ifndef NETWORK_TCP_CLIENT_QUEUE_DEPTH
+#define NETWORK_TCP_CLIENT_QUEUE_DEPTH  3
+#endif
+
+/**
+ * @brief 网络接收任务 select() 的超时 (ms)
+ * @note 数据到达时 select() 立即返回；该超时只决定新建立的连接/新接入的客户端
+ *       最迟多久被加入监听集合
+ */
+#ifndef NETWORK_RX_SELECT_TIMEOUT_MS
+#define NETWORK_RX_SELECT_TIMEOUT_MS    100
+#endif
+
+/**
+ * @brief 命令回复等待帧池空闲帧的最长时间 (ms)，超时后该段回复被丢弃
+ */
+#ifndef NETWORK_RX_REPLY_TIMEOUT_MS
+#define NETWORK_RX_REPLY_TIMEOUT_MS     20
+#endif
+
+/**
+ * @brief 连接建立后网络任务的服务周期 (ms)
+ * @note UDP 模式下以该周期发送发现信标，并在每秒边界更新每秒发送/失败计数；
+ *       TCP 服务端模式下以该周期接受新客户端、清理已断开的客户端
+ */
+#ifndef NETWORK_UDP_SERVICE_PERIOD_MS
+#define NETWORK_UDP_SERVICE_PERIOD_MS   100
+#endif
+
+/**
+ * @brief UDP 地面站发现信标的发送间隔 (ms)
+ */
+#ifndef NETWORK_UDP_DISCOVERY_INTERVAL_MS
+#define NETWORK_UDP_DISCOVERY_INTERVAL_MS 1000
+#endif
+
+/**
+ * @brief UDP 地面站发现报文前缀
+ * @details remote_host 为空 (广播) 或组播地址 (224.0.0.0/4) 时，设备周期性地向
+ *          <remote_host 或 255.255.255.255>:remote_port 发送 "RC_DISCOVER <local_port>\n"；
+ *          地面站回复以 "RC_HERE" 开头的报文后，设备把回复的源地址/端口作为遥测目标。
+ */
+#define NETWORK_UDP_DISCOVERY_BEACON    "RC_DISCOVER"
+#define NETWORK_UDP_DISCOVERY_REPLY     "RC_HERE"
+
+/**
+ * @brief 启动射频前的等待时间 (ms)
+ * @note 错开射频启动的电流峰值，电源余量不足时可避免掉电复位；只延迟 WiFi 初始化本身，
+ *       并行启动时其他外设不受影响。电源可靠的板子可以设为 0
+ */
+#ifndef WIFI_STARTUP_DELAY_MS
+#define WIFI_STARTUP_DELAY_MS           200
+#endif
+
+/**
+ * @brief 连接管理的重试退避时间 (ms)
+ * @note 每次失败后翻倍直到上限，WiFi 获得 IP / 网络连接建立后复位为最小值
+ */
+#ifndef NETWORK_LINK_BACKOFF_MIN_MS
+#define NETWORK_LINK_BACKOFF_MIN_MS     250
+#endif
+#ifndef NETWORK_LINK_BACKOFF_MAX_MS
+#define NETWORK_LINK_BACKOFF_MAX_MS     30000
+#endif
+
+/**
+ * @brief 使用缓存的 BSSID/信道快速重连时等待获得 IP 的超时 (ms)
+ * @note 超时后清除缓存，立即按 SSID 全信道扫描重试
+ */
+#ifndef NETWORK_LINK_FAST_CONNECT_TIMEOUT_MS
+#define NETWORK_LINK_FAST_CONNECT_TIMEOUT_MS 3000
+#endif
+
+/**
+ * @brief TCP 客户端连接的 keepalive 参数
+ * @note 空闲 IDLE 秒后开始探测，每 INTERVAL 秒一次，连续 COUNT 次无应答即判定断线
+ *       (默认约 8 秒发现对端掉线，而不是等到下一次发送超时)
+ */
+#ifndef NETWORK_TCP_KEEPALIVE_IDLE_S
+#define NETWORK_TCP_KEEPALIVE_IDLE_S      5
+#endif
+#ifndef NETWORK_TCP_KEEPALIVE_INTERVAL_S
+#define NETWORK_TCP_KEEPALIVE_INTERVAL_S  1
+#endif
+#ifndef NETWORK_TCP_KEEPALIVE_COUNT
+#define NETWORK_TCP_KEEPALIVE_COUNT       3
+#endif
+
+/**
+ * @brief TCP 客户端 socket 的发送超时 (ms)
+ * @note 发送窗口长时间不打开时放弃这一批次，发送任务不会被卡住的连接无限期阻塞；
+ *       批次已写出一部分时流中留下半个帧，此时断开连接重连
+ */
+#ifndef NETWORK_TCP_SEND_TIMEOUT_MS
+#define NETWORK_TCP_SEND_TIMEOUT_MS     500
+#endif
+
+/**
+ * @brief 断线缓冲区容量：重连期间保留最近的帧，连接恢复后先补发
+ * @note 帧数或字节数任一超出时丢弃最早的帧；帧数为 0 表示不缓冲 (断线期间直接丢弃)
+ */
+#ifndef NETWORK_OUTAGE_BUFFER_FRAMES
+#define NETWORK_OUTAGE_BUFFER_FRAMES    64
+#endif
+#ifndef NETWORK_OUTAGE_BUFFER_SIZE
+#define NETWORK_OUTAGE_BUFFER_SIZE      4096
+#endif
+
 /**
  * @brief 网络协议类型
  */
@@ -28,7 +171,7 @@ typedef enum {
  */
 typedef struct {
     network_protocol_t protocol;    /*!< 网络协议类型 */
-    char remote_host[64];           /*!< 远程主机 IP 地址或域名 (客户端模式使用) */
+    char remote_host[64];           /*!< 远程主机 IP 地址或域名 (客户端模式使用；UDP 模式下为空或组播地址时启用发现) */
     uint16_t remote_port;           /*!< 远程端口 (客户端模式使用) */
     uint16_t local_port;            /*!< 本地端口 (服务端模式或 UDP 使用) */
     bool auto_connect;              /*!< WiFi 连接成功后是否自动开始网络连接 */
@@ -50,6 +193,45 @@ typedef struct {
     network_config_t network_config;    /*!< 网络协议配置 */
 } wifi_task_config_t;
 
+/**
+ * @brief 连接管理状态
+ */
+typedef enum {
+    NETWORK_LINK_IDLE = 0,          /*!< 未启用 (非 STA 模式或已调用 wifi_disconnect()) */
+    NETWORK_LINK_WIFI_CONNECTING,   /*!< 等待 WiFi 关联并获得 IP */
+    NETWORK_LINK_WIFI_BACKOFF,      /*!< WiFi 连接失败，等待退避时间后重试 */
+    NETWORK_LINK_WIFI_ONLY,         /*!< WiFi 已连接，未启用网络连接 */
+    NETWORK_LINK_NET_CONNECTING,    /*!< 正在建立 TCP/UDP 连接 */
+    NETWORK_LINK_NET_BACKOFF,       /*!< 网络连接失败或断开，等待退避时间后重试 */
+    NETWORK_LINK_ONLINE,            /*!< 网络连接已建立 */
+} network_link_state_t;
+
+/**
+ * @brief 连接管理状态与计数
+ */
+typedef struct {
+    network_link_state_t state;     /*!< 当前状态 */
+    uint32_t state_ms;              /*!< 在当前状态停留的时间 (ms) */
+    uint32_t backoff_ms;            /*!< 下一次失败后的退避时间 (ms) */
+    uint32_t wifi_attempts;         /*!< 本轮 WiFi 连接尝试次数 (获得 IP 后清零) */
+    uint32_t net_attempts;          /*!< 本轮网络连接尝试次数 (连接建立后清零) */
+    uint32_t wifi_connects;         /*!< 累计获得 IP 的次数 */
+    uint32_t fast_connects;         /*!< 其中使用缓存的 BSSID/信道完成的次数 */
+    uint32_t net_connects;          /*!< 累计建立网络连接的次数 */
+    uint32_t net_losses;            /*!< 在线时意外断开的次数 (对端关闭、keepalive 超时或 WiFi 断线) */
+    uint32_t last_outage_ms;        /*!< 最近一次从断线到恢复在线的时长 (ms) */
+    int last_error;                 /*!< 最近一次网络连接失败的 errno (0 = 无) */
+    bool bssid_cached;              /*!< 是否已缓存 AP 的 BSSID/信道 */
+    uint8_t bssid[6];               /*!< 缓存的 BSSID */
+    int32_t channel;                /*!< 缓存的信道 */
+    uint16_t outage_frames;         /*!< 断线缓冲区中等待补发的帧数 */
+} network_link_status_t;
+
+/**
+ * @brief 连接管理状态变化回调 (在网络任务中调用，不要阻塞)
+ */
+typedef void (*network_link_callback_t)(network_link_state_t state);
+
 /**
  * @brief 初始化 WiFi 配置 (不创建任务)
  *
@@ -61,7 +243,10 @@ typedef struct {
 BaseType_t wifi_init_config(wifi_task_config_t *config);
 
 /**
- * @brief WiFi 处理函数 (在 RTOS 任务中调用)
+ * @brief WiFi 处理函数 (在 RTOS 任务中调用一次)
+ *
+ * @details 设置 WiFi 模式/功率并启动 AP (如配置)；STA 模式下创建常驻的网络任务
+ *          (连接管理)，由它根据 WiFi 事件完成关联、网络连接和断线重连，本函数不等待连接结果。
  */
 void wifi_handler(void);
 
@@ -75,7 +260,10 @@ void wifi_handler(void);
 bool is_wifi_connected(void);
 
 /**
- * @brief 发送数据 (TCP 或 UDP)
+ * @brief 同步发送数据 (TCP 或 UDP)
+ *
+ * @note 该函数会阻塞直到数据写入协议栈，由网络发送任务使用；
+ *       其他任务请使用 network_send_async() / network_tx_enqueue()。
  *
  * @param data 要发送的数据
  * @param len 数据长度
@@ -96,13 +284,139 @@ int network_send_data(const uint8_t* data, size_t len);
 int network_send_string(const char* str);
 
 /**
- * @brief 检查网络连接状态
+ * @brief 发送统计信息
+ */
+typedef struct {
+    uint32_t frames_sent;       /*!< 进入聚合缓冲区的帧数 */
+    uint32_t flushes;           /*!< 实际执行的网络发送次数 */
+    uint32_t bytes_sent;        /*!< 成功发送的字节数 */
+    uint32_t send_failures;     /*!< 发送失败 (数据被丢弃) 的次数 */
+    uint32_t pool_exhausted;    /*!< 帧池耗尽导致分配失败的次数 */
+    uint32_t client_drops;      /*!< TCP 服务端模式下因客户端接收过慢而丢弃的批次数 */
+    uint32_t outage_buffered;   /*!< 重连期间存入断线缓冲区的帧数 */
+    uint32_t outage_replayed;   /*!< 连接恢复后补发的帧数 */
+    uint32_t outage_dropped;    /*!< 断线缓冲区已满而丢弃的最早帧数 */
+} network_tx_stats_t;
+
+/**
+ * @brief 网络接收 (下行命令) 统计信息
+ */
+typedef struct {
+    uint32_t bytes_received;    /*!< 收到的字节数 (不含发现应答) */
+    uint32_t lines;             /*!< 提交给命令解析器的文本命令数 */
+    uint32_t frames;            /*!< 提交给命令解析器的机器模式请求帧数 */
+    uint32_t dropped;           /*!< 解析器缓冲池已满或请求帧过长而丢弃的命令数 */
+    uint32_t reply_bytes;       /*!< 已交给发送路径的回复字节数 */
+    uint32_t reply_failures;    /*!< 回复失败 (帧池持续耗尽或连接已断开) 的次数 */
+} network_rx_stats_t;
+
+/**
+ * @brief UDP 模式统计信息
+ */
+typedef struct {
+    uint32_t packets_sent;      /*!< 成功发送的报文数 */
+    uint32_t bytes_sent;        /*!< 成功发送的字节数 */
+    uint32_t send_failures;     /*!< sendto 失败或尚无目标地址的次数 */
+    uint32_t packets_per_s;     /*!< 最近一秒发送的报文数 */
+    uint32_t bytes_per_s;       /*!< 最近一秒发送的字节数 */
+    uint32_t failures_per_s;    /*!< 最近一秒的发送失败次数 */
+    uint32_t beacons_sent;      /*!< 已发送的发现信标数 */
+    bool discovery;             /*!< 是否处于发现模式 (广播/组播) */
+    bool remote_valid;          /*!< 是否已有发送目标 */
+    uint32_t remote_ip;         /*!< 发送目标 IPv4 地址 (网络字节序) */
+    uint16_t remote_port;       /*!< 发送目标端口 */
+} network_udp_stats_t;
+
+/**
+ * @brief 异步发送数据 (不阻塞)
+ *
+ * @details 将数据复制到帧池中的一个帧并交给网络发送任务，立即返回。
+ *          适合在传感器、串口命令等不能被网络阻塞的任务中使用。
+ *
+ * @param data 要发送的数据
+ * @param len 数据长度 (不超过 NETWORK_FRAME_DATA_SIZE)
+ * @return 
+ *      - 提交的字节数: 成功
+ *      - -1: 失败 (帧池耗尽、数据过长或网络未连接)
+ */
+int network_send_async(const uint8_t* data, size_t len);
+
+/**
+ * @brief 异步发送一帧数据，可指定是否立即刷新 (不阻塞)
+ *
+ * @details 数据由网络发送任务合并发送，满足以下任一条件时刷新：
+ *          - 聚合缓冲区放不下新的帧 (按大小刷新)；
+ *          - 最早的数据等待超过刷新时间窗；
+ *          - urgent 为 true (例如按键事件，需要立即送达)。
+ *
+ * @param data 帧数据
+ * @param len 帧长度 (不超过 NETWORK_FRAME_DATA_SIZE)
+ * @param urgent 是否立即刷新
+ * @return 
+ *      - 提交的字节数: 成功
+ *      - -1: 失败 (帧池耗尽、数据过长或网络未连接)
+ */
+int network_tx_enqueue(const uint8_t* data, size_t len, bool urgent);
+
+/**
+ * @brief 请求网络发送任务立即发送聚合缓冲区中的数据 (不阻塞)
  *
  * @return 
- *      - true: 网络连接正常
- *      - false: 网络连接断开
+ *      - 0: 请求已提交
+ *      - -1: 失败
+ */
+int network_tx_flush(void);
+
+/**
+ * @brief 设置发送聚合刷新时间窗
+ *
+ * @param interval_ms 时间窗 (ms)，0 表示不聚合
  */
-bool is_network_connected(void);
+void network_tx_set_flush_interval(uint32_t interval_ms);
+
+/**
+ * @brief 获取发送聚合刷新时间窗
+ *
+ * @return 时间窗 (ms)
+ */
+uint32_t network_tx_get_flush_interval(void);
+
+/**
+ * @brief 获取发送统计信息
+ *
+ * @param stats 用于存储统计信息的结构体指针
+ */
+void network_tx_get_stats(network_tx_stats_t* stats);
+
+/**
+ * @brief 获取网络接收 (下行命令) 统计信息
+ *
+ * @param stats 用于存储统计信息的结构体指针
+ */
+void network_rx_get_stats(network_rx_stats_t* stats);
+
+/**
+ * @brief 获取 UDP 模式统计信息 (包括每秒发送/失败计数)
+ *
+ * @param stats 用于存储统计信息的结构体指针
+ */
+void network_udp_get_stats(network_udp_stats_t* stats);
+
+/**
+ * @brief 丢弃已发现的地面站地址并重新发送发现信标 (仅发现模式有效)
+ *
+ * @return 
+ *      - true: 已重新开始发现
+ *      - false: 不是 UDP 发现模式或 UDP 未初始化
+ */
+bool network_udp_rediscover(void);
+
+/**
+ * @brief 获取 TCP 服务端模式下当前连接的客户端数量
+ *
+ * @return 客户端数量 (非服务端模式返回 0)
+ */
+int network_get_client_count(void);
 
 /**
  * @brief 获取网络连接信息
@@ -112,26 +426,73 @@ bool is_network_connected(void);
 const char* get_network_info(void);
 
 /**
- * @brief 断开当前 WiFi 连接
+ * @brief 断开当前 WiFi 连接并停止自动重连 (不阻塞)
  *
  * @return 
- *      - true: 成功断开
+ *      - true: 请求已提交
  *      - false: 断开失败
  */
 bool wifi_disconnect(void);
 
 /**
- * @brief 使用新的 SSID 和密码连接 WiFi
+ * @brief 使用新的 SSID 和密码连接 WiFi (不阻塞)
+ *
+ * @details 更新配置后交给连接管理处理并立即返回；新网络不使用缓存的 BSSID/信道。
+ *          连接进度输出到串口，也可以用 network_link_get_status() 查询。
+ *          连接失败时按指数退避持续重试，直到连接成功或调用 wifi_disconnect()。
  *
  * @param ssid 新的 WiFi SSID
  * @param password 新的 WiFi 密码
- * @param timeout_ms 连接超时时间 (ms)
+ * @param timeout_ms 每次连接尝试等待获得 IP 的超时 (ms)
  * @return 
- *      - true: 连接成功
- *      - false: 连接失败
+ *      - true: 请求已提交
+ *      - false: 参数错误或 WiFi 未以 STA 模式初始化
  */
 bool wifi_connect_new(const char* ssid, const char* password, uint32_t timeout_ms);
 
+/**
+ * @brief 使用当前配置重新连接 WiFi (不阻塞)
+ *
+ * @details 保留缓存的 BSSID/信道，优先快速重连；网络连接在获得 IP 后自动重新建立。
+ *
+ * @return 
+ *      - true: 请求已提交
+ *      - false: WiFi 未以 STA 模式初始化
+ */
+bool wifi_reconnect(void);
+
+/**
+ * @brief 获取连接管理的状态与计数
+ *
+ * @param status 用于存储状态的结构体指针
+ */
+void network_link_get_status(network_link_status_t* status);
+
+/**
+ * @brief 获取连接管理状态的名称
+ *
+ * @param state 连接管理状态
+ * @return 状态名称字符串
+ */
+const char* network_link_state_name(network_link_state_t state);
+
+/**
+ * @brief 设置连接管理状态变化回调
+ *
+ * @param callback 回调函数，NULL 表示取消
+ */
+void network_link_set_callback(network_link_callback_t callback);
+
+/**
+ * @brief 预置上次连接的 AP 的 BSSID/信道 (例如从 NVS 恢复)，第一次连接直接走快速重连
+ *
+ * @details 必须在 wifi_handler() 之前调用；AP 已更换信道时快速连接失败一次后自动回退到全信道扫描。
+ *
+ * @param bssid AP 的 BSSID (6 字节)
+ * @param channel AP 所在信道
+ */
+void network_link_set_cached_ap(const uint8_t* bssid, int32_t channel);
+
 /**
  * @brief 获取当前 WiFi 配置信息
  *
@@ -143,26 +504,40 @@ bool wifi_connect_new(const char* ssid, const char* password, uint32_t timeout_m
 bool get_current_wifi_config(wifi_task_config_t* config);
 
 /**
- * @brief 断开当前网络连接 (TCP/UDP)
+ * @brief 断开当前网络连接 (TCP/UDP) 并停止自动重连 (不阻塞)
+ *
+ * @details 由网络任务关闭 socket；断线缓冲区不再接收新的帧。
  *
  * @return 
- *      - true: 成功断开
+ *      - true: 请求已提交
  *      - false: 断开失败
  */
 bool network_disconnect(void);
 
 /**
- * @brief 配置 TCP 客户端参数并连接
+ * @brief 配置 TCP 客户端参数并连接 (不阻塞)
+ *
+ * @details 更新网络配置后交给连接管理处理并立即返回，连接进度输出到串口；
+ *          WiFi 未连接时在获得 IP 后自动连接，连接失败时按指数退避持续重试。
  *
- * @param remote_host 远程主机 IP 地址
+ * @param remote_host 远程主机 IP 地址或域名
  * @param remote_port 远程主机端口
- * @param timeout_ms 连接超时时间 (ms)
+ * @param timeout_ms 每次连接尝试的超时时间 (ms)
  * @return 
- *      - true: 连接成功
- *      - false: 连接失败
+ *      - true: 请求已提交
+ *      - false: 参数错误或 WiFi 未以 STA 模式初始化
  */
 bool network_connect_tcp_client(const char* remote_host, uint16_t remote_port, uint32_t timeout_ms);
 
+/**
+ * @brief 使用当前网络配置重新建立连接 (不阻塞，适用于所有协议)
+ *
+ * @return 
+ *      - true: 请求已提交
+ *      - false: 未配置网络协议或 WiFi 未以 STA 模式初始化
+ */
+bool network_reconnect(void);
+
 /**
  * @brief 获取当前网络配置信息
  *
@@ -2,9 +2,10 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "wifi_task.h"
+#include "boot_sequencer.h" // 启动阶段计时与并行初始化
+#include "config_store.h"   // NVS 中的引脚/WiFi/网络配置
 #include "esp_log.h"
 #include <string.h>
-#include "serial_servo.h"  // 添加SerialServo库
 
 // 包含 uart_parser 模块的头文件
 extern "C" {
@@ -13,385 +14,608 @@ extern "C" {
 #include "joystick_driver.h"
 #include "data_service.h"
 #include "matrix_keypad.h"  // 添加矩阵键盘头文件
+#include "telemetry_frame.h" // 遥测帧编码 (JSON / 二进制)
+#include "sampler.h"         // 定时器驱动的固定频率采样
+#include "servo_bus.h"       // 串口舵机总线管理
+#include "servo_control.h"   // 摇杆/编码器到舵机的本地控制
+#include "task_plan.h"       // 任务核心/优先级规划表
+#include "task_profiler.h"   // 任务 CPU 占用剖析
+#include "latency_stats.h"   // 采样到网络发送的延迟直方图
+#include "bench.h"           // 合成样本压测网络链路
+#include "flight_recorder.h" // flash 飞行记录仪
+#include "deferred_log.h"    // 热路径日志延迟格式化
+#include "hal_io.h"          // 输入模拟 (硬件在环测试)
 }
 
 #define MAIN_TASK_TAG "MAIN"
 
-// Example WiFi credentials
-#define EXAMPLE_ESP_WIFI_SSID      "opti_track_xiaomi"
-#define EXAMPLE_ESP_WIFI_PASS      "sysu_opti_track"
-
-// 串口舵机配置
-#define SERVO_UART_NUM     2         // 使用Serial2
-#define SERVO_RX_PIN       16        // 舵机串口RX引脚
-#define SERVO_TX_PIN       17        // 舵机串口TX引脚
-#define SERVO_BAUD_RATE    115200    // 舵机串口波特率
-#define SERVO_ID           1         // 默认舵机ID
-
-// 创建串口舵机对象
-SerialServo* servo_controller = nullptr;
+// 引脚、WiFi/网络和舵机总线配置保存在 NVS 中 (默认值见 lib/Config/config_store.cpp)，可用 'config' 命令修改
+
+// 串口舵机配置 (Serial2 由 servo_bus 独占)
+#define SERVO_RESPONSE_TIMEOUT_MS  20  // 单次读取的应答超时
+#define SERVO_POLL_BUDGET_HZ       30  // 状态轮询占用的总线事务数/秒 (所有舵机合计)
+#define SERVO_CONTROL_RATE_HZ      50  // 本地控制周期频率
+
+// 传感器采样频率 (Hz)，运行时可通过串口命令 sampler 修改
+#define ENCODER_SAMPLE_RATE_HZ   100
+#define JOYSTICK_SAMPLE_RATE_HZ  50
+#define KEYPAD_SAMPLE_RATE_HZ    66
+
+// 任务规划表：所有任务经 task_plan_create() 创建，核心/优先级/栈大小统一在这里配置
+// 核心1：采样和控制，不与 WiFi/lwIP 协议栈 (核心0，优先级 18-23) 争抢 CPU
+// 核心0：网络、数据发布和串口命令，WiFi 突发流量只影响这些任务
+// Arduino loop() 任务运行在核心1，优先级 1
+static const task_plan_entry_t task_plan_table[] = {
+    // name                   stack  priority               core
+    {"Joystick_ADC",          2048,  tskIDLE_PRIORITY + 6,  TASK_PLAN_CORE_REALTIME},  // 及时取走 DMA 数据，避免溢出
+    {"encoder",               2048,  tskIDLE_PRIORITY + 5,  TASK_PLAN_CORE_REALTIME},
+    {"joystick",              2048,  tskIDLE_PRIORITY + 5,  TASK_PLAN_CORE_REALTIME},
+    {"bench",                 2048,  tskIDLE_PRIORITY + 5,  TASK_PLAN_CORE_REALTIME},  // 压测时代替 encoder/joystick
+    {"keypad",                2048,  tskIDLE_PRIORITY + 4,  TASK_PLAN_CORE_REALTIME},
+    {"Servo_Control",         3072,  tskIDLE_PRIORITY + 4,  TASK_PLAN_CORE_REALTIME},
+    {"Servo_Bus",             4096,  tskIDLE_PRIORITY + 3,  TASK_PLAN_CORE_REALTIME},
+    {"Servo_Task",            2048,  tskIDLE_PRIORITY + 1,  TASK_PLAN_CORE_REALTIME},
+    {"network_tx_task",       3072,  tskIDLE_PRIORITY + 4,  TASK_PLAN_CORE_NETWORK},
+    {"network_rx_task",       3072,  tskIDLE_PRIORITY + 4,  TASK_PLAN_CORE_NETWORK},  // 下行命令，数据到达即唤醒
+    {"network_task",          4096,  tskIDLE_PRIORITY + 4,  TASK_PLAN_CORE_NETWORK},  // 连接管理，由 WiFi 事件和命令请求唤醒
+    {"Data_Publisher_Task",   4096,  tskIDLE_PRIORITY + 3,  TASK_PLAN_CORE_NETWORK},
+    {"UART_Parser_Task",      4096,  tskIDLE_PRIORITY + 2,  TASK_PLAN_CORE_NETWORK},
+    {"Boot_Worker",           4096,  tskIDLE_PRIORITY + 3,  tskNO_AFFINITY},          // 启动时并行初始化外设/WiFi，完成后退出
+    {"Profiler",              3072,  tskIDLE_PRIORITY + 1,  TASK_PLAN_CORE_NETWORK},
+    {"Recorder",              4096,  tskIDLE_PRIORITY + 1,  TASK_PLAN_CORE_NETWORK},  // flash 写入/擦除期间 cache 暂停，放在最低优先级
+    {"DLog",                  3072,  tskIDLE_PRIORITY + 1,  TASK_PLAN_CORE_NETWORK},  // 热路径日志的格式化与输出
+    {"bench_micro",           4096,  tskIDLE_PRIORITY + 2,  TASK_PLAN_CORE_REALTIME},  // 'bench micro' 临时任务，与采样任务同核心
+    {"bench_reader",          2048,  tskIDLE_PRIORITY + 1,  TASK_PLAN_CORE_NETWORK},  // 'bench micro data' 的并发读者
+};
 
 // 为 uart_parser 模块实现串口发送函数
-// uart_parser.c 中的 uart_parser_put_string 是弱函数，我们在这里提供强实现
-extern "C" void uart_parser_put_string(const char *str)
+// uart_parser.cpp 中的 uart_parser_port_put_string 是弱函数，我们在这里提供强实现
+// (来自网络的命令的输出由 uart_parser 直接交给网络回复函数，不经过这里)
+extern "C" void uart_parser_port_put_string(const char *str)
 {
     Serial.print(str);
 }
 
+// 机器模式的二进制响应输出
+extern "C" void uart_parser_port_put_bytes(const uint8_t *data, size_t len)
+{
+    Serial.write(data, len);
+}
+
+// 数据发布任务参数
+#define PUBLISHER_BATCH_SIZE      8     // 每次从环形缓冲区取出的最大样本数
+
+// 启动里程碑：网络在线后第一个提交的遥测帧 (进入断线缓冲区等待补发的帧不算)
+static inline void mark_first_frame(void) {
+    if (boot_milestone_us(BOOT_MILESTONE_FIRST_FRAME) == 0 && is_network_connected()) {
+        boot_mark(BOOT_MILESTONE_FIRST_FRAME);
+    }
+}
+
+// 将一个通道样本编码到帧池的帧中并提交发送
+static void publish_sample(const data_channel_info_t* info, const void* sample, uint32_t sample_us,
+                           bool urgent, bool connected, uint32_t wake_us) {
+    if (!connected) {
+        return;
+    }
+    network_frame_t* frame = network_frame_alloc();
+    if (frame == NULL) {
+        DLOGD(DLOG_MODULE_PUBLISHER, "Frame pool exhausted, %s sample dropped", info->name);
+        return;
+    }
+    frame->len = telemetry_encode_sample(info, sample, frame->data, sizeof(frame->data));
+    frame->flags = urgent ? NETWORK_FRAME_FLAG_URGENT : 0;
+    frame->sample_us = sample_us;
+    frame->wake_us = wake_us;
+    if (frame->len == 0) {
+        network_frame_free(frame);
+        return;
+    }
+    if (network_frame_submit(frame) > 0) {
+        mark_first_frame();
+    }
+}
+
+// 发布任务处理的通道类别 (带环形缓冲区的输入设备)
+static bool is_published_channel(const data_channel_info_t* info) {
+    if (info == NULL || info->ring_capacity == 0) {
+        return false;
+    }
+    return info->kind == DATA_KIND_ENCODER || info->kind == DATA_KIND_JOYSTICK || info->kind == DATA_KIND_KEYPAD;
+}
+
+// 将最近一个剖析窗口的结果编码后提交发送 (周期等于剖析窗口)
+static void publish_profile(bool connected) {
+    static system_profile_t profile;    // 约 0.5KB，不放在任务栈上
+    if (!connected || !task_profiler_get_export()) {
+        return;
+    }
+    network_frame_t* frame = network_frame_alloc();
+    if (frame == NULL) {
+        DLOGD(DLOG_MODULE_PUBLISHER, "Frame pool exhausted, profile dropped");
+        return;
+    }
+    data_service_get_profile(&profile);
+    frame->len = telemetry_encode_profile(&profile, frame->data, sizeof(frame->data));
+    frame->flags = 0;
+    if (frame->len == 0) {
+        network_frame_free(frame);
+        return;
+    }
+    network_frame_submit(frame);
+}
+
+// 将各阶段的延迟直方图编码后提交发送
+static void publish_latency(void) {
+    network_frame_t* frame = network_frame_alloc();
+    if (frame == NULL) {
+        DLOGD(DLOG_MODULE_PUBLISHER, "Frame pool exhausted, latency histogram dropped");
+        return;
+    }
+    frame->len = telemetry_encode_latency(frame->data, sizeof(frame->data));
+    frame->flags = 0;
+    if (frame->len == 0) {
+        network_frame_free(frame);
+        return;
+    }
+    network_frame_submit(frame);
+}
+
 // 数据发布任务 - 监听DataPlatform事件并通过网络发送
 extern "C" void data_publisher_task(void* parameter) {
-    EventGroupHandle_t event_group = data_service_get_event_group_handle();
-    if (event_group == NULL) {
-        ESP_LOGE(MAIN_TASK_TAG, "Failed to get event group handle");
-        vTaskDelete(NULL);
+    // 订阅通道表中全部输入设备通道 (同一类别的实例共用一个事件位)
+    EventBits_t topics = BIT_EVENT_PROFILE_UPDATED;
+    for (int ch = 0; ch < DATA_CHANNEL_COUNT; ch++) {
+        const data_channel_info_t* info = data_channel_get_info((data_channel_t)ch);
+        if (is_published_channel(info)) {
+            topics |= info->topic;
+        }
+    }
+    
+    // 独立订阅：与本地舵机控制等其他消费者各自拥有通知和环形缓冲区读游标
+    const int subscriber = data_service_subscribe(topics);
+    if (subscriber < 0) {
+        ESP_LOGE(MAIN_TASK_TAG, "Failed to subscribe to DataPlatform");
+        task_plan_delete(NULL);
         return;
     }
     
-    const EventBits_t bits_to_wait = BIT_EVENT_ENCODER_UPDATED | BIT_EVENT_JOYSTICK_UPDATED;
-    system_state_t system_state;
+    union {
+        encoder_data_t encoder[PUBLISHER_BATCH_SIZE];
+        joystick_data_t joystick[PUBLISHER_BATCH_SIZE];
+        keypad_data_t keypad[PUBLISHER_BATCH_SIZE];
+    } batch;
+    bool last_button[DATA_CHANNEL_COUNT] = {};
+    uint32_t last_latency_export_us = latency_now_us();
     
     ESP_LOGI(MAIN_TASK_TAG, "Data publisher task started");
     
     while (1) {
-        // 等待任意一个传感器数据更新事件
-        EventBits_t bits = xEventGroupWaitBits(
-            event_group,
-            bits_to_wait,
-            pdTRUE,  // 清除事件位
-            pdFALSE, // 等待任意一个事件
-            portMAX_DELAY
-        );
+        // 等待任意一个订阅的数据更新事件
+        EventBits_t bits = data_service_wait(subscriber, portMAX_DELAY);
         
-        // 获取最新的系统状态
-        data_service_get_system_state(&system_state);
+        // 检查网络发送路径是否接收帧 (已连接, 或正在重连: 帧进入断线缓冲区, 恢复后补发最近的 N 帧)
+        // 不接收时仍然取出样本, 避免重连后发送过期数据
+        bool connected = network_tx_accepting();
         
-        // 检查网络连接状态
-        if (!is_wifi_connected() || !is_network_connected()) {
-            continue;
+        if (bits & BIT_EVENT_PROFILE_UPDATED) {
+            publish_profile(connected);
         }
         
-        // 发送编码器数据
-        if (bits & BIT_EVENT_ENCODER_UPDATED) {
-            char buffer[128];
-            snprintf(buffer, sizeof(buffer), 
-                    "ENCODER:{\"pos\":%ld,\"delta\":%ld,\"btn\":%s,\"ts\":%lu}\n",
-                    system_state.encoder_data.position,
-                    system_state.encoder_data.delta,
-                    system_state.encoder_data.button_pressed ? "true" : "false",
-                    system_state.encoder_data.timestamp);
-            
-            int result = network_send_string(buffer);
-            if (result > 0) {
-                ESP_LOGD(MAIN_TASK_TAG, "Encoder data sent: %d bytes", result);
+        // 延迟直方图按固定周期导出 (传感器事件足够频繁，不需要单独的定时器)
+        uint32_t now_us = latency_now_us();
+        if (now_us - last_latency_export_us >= LATENCY_EXPORT_INTERVAL_MS * 1000UL) {
+            last_latency_export_us = now_us;
+            if (connected && latency_get_export()) {
+                publish_latency();
             }
         }
         
-        // 发送摇杆数据
-        if (bits & BIT_EVENT_JOYSTICK_UPDATED) {
-            char buffer[256];
-            snprintf(buffer, sizeof(buffer), 
-                    "JOYSTICK:{\"x\":%d,\"y\":%d,\"mag\":%.2f,\"ang\":%.1f,\"btn\":%s,\"dz\":%s,\"ts\":%lu}\n",
-                    system_state.joystick_data.x,
-                    system_state.joystick_data.y,
-                    system_state.joystick_data.magnitude,
-                    system_state.joystick_data.angle,
-                    system_state.joystick_data.button_pressed ? "true" : "false",
-                    system_state.joystick_data.in_deadzone ? "true" : "false",
-                    system_state.joystick_data.timestamp);
-            
-            int result = network_send_string(buffer);
-            if (result > 0) {
-                ESP_LOGD(MAIN_TASK_TAG, "Joystick data sent: %d bytes", result);
+        // 按通道表逐个取出环形缓冲区中的全部样本, 直接编码到帧池的帧中交给网络发送任务 (不阻塞)
+        // 按键状态变化和键盘事件属于优先事件, 立即刷新发送
+        // 每次取出样本前记录时间戳，作为这一批样本的 "发布任务唤醒" 时刻
+        bool more;
+        do {
+            more = false;
+            uint32_t wake_us = latency_now_us();
+            for (int ch = 0; ch < DATA_CHANNEL_COUNT; ch++) {
+                const data_channel_info_t* info = data_channel_get_info((data_channel_t)ch);
+                if (!is_published_channel(info) || !(bits & info->topic)) {
+                    continue;
+                }
+                size_t count = data_channel_drain(subscriber, (data_channel_t)ch, &batch,
+                                                  info->sample_size, PUBLISHER_BATCH_SIZE);
+                if (count == PUBLISHER_BATCH_SIZE) {
+                    more = true;
+                }
+                if (count > 0) {
+                    boot_mark(BOOT_MILESTONE_FIRST_SAMPLE);
+                }
+                for (size_t i = 0; i < count; i++) {
+                    const void* sample;
+                    uint32_t sample_us, publish_us;
+                    bool urgent;
+                    switch (info->kind) {
+                        case DATA_KIND_ENCODER:
+                            sample = &batch.encoder[i];
+                            sample_us = batch.encoder[i].sample_us;
+                            publish_us = batch.encoder[i].publish_us;
+                            urgent = batch.encoder[i].button_pressed != last_button[ch];
+                            last_button[ch] = batch.encoder[i].button_pressed;
+                            break;
+                        case DATA_KIND_JOYSTICK:
+                            sample = &batch.joystick[i];
+                            sample_us = batch.joystick[i].sample_us;
+                            publish_us = batch.joystick[i].publish_us;
+                            urgent = batch.joystick[i].button_pressed != last_button[ch];
+                            last_button[ch] = batch.joystick[i].button_pressed;
+                            break;
+                        default:
+                            sample = &batch.keypad[i];
+                            sample_us = batch.keypad[i].sample_us;
+                            publish_us = batch.keypad[i].publish_us;
+                            urgent = true;
+                            break;
+                    }
+                    
+                    latency_record(LATENCY_STAGE_SAMPLE_TO_PUBLISH, sample_us, publish_us);
+                    latency_record(LATENCY_STAGE_PUBLISH_TO_WAKE, publish_us, wake_us);
+                    publish_sample(info, sample, sample_us, urgent, connected, wake_us);
+                }
             }
-        }
-        
-        // 短暂延时避免过于频繁的网络发送
-        vTaskDelay(pdMS_TO_TICKS(10));
+        } while (more);
     }
 }
 
-// 保留简化的回调函数用于调试
+// 保留简化的回调函数用于调试 (在采样任务中调用，经延迟日志输出，用 'log encoder debug' 等打开)
 extern "C" void encoder_position_changed(int32_t position, int32_t delta) {
-    ESP_LOGD(MAIN_TASK_TAG, "编码器位置: %ld, 变化量: %ld", position, delta);
+    DLOGD(DLOG_MODULE_ENCODER, "编码器位置: %ld, 变化量: %ld", position, delta);
 }
 
 extern "C" void encoder_button_changed(bool pressed) {
-    ESP_LOGD(MAIN_TASK_TAG, "编码器按钮: %s", pressed ? "按下" : "释放");
+    DLOGD(DLOG_MODULE_ENCODER, "编码器按钮: %s", pressed ? "按下" : "释放");
 }
 
 // 摇杆数据回调函数（简化版，用于调试）
 extern "C" void joystick_data_changed(const joystick_data_t* data) {
     if (!data->in_deadzone) {
-        ESP_LOGD(MAIN_TASK_TAG, "摇杆位置: X=%d, Y=%d, 幅度=%.2f, 角度=%.1f°", 
-                 data->x, data->y, data->magnitude, data->angle);
+        DLOGD(DLOG_MODULE_JOYSTICK, "摇杆位置: X=%d, Y=%d, 幅度=%.2f, 角度=%.1f°",
+              data->x, data->y, data->magnitude, data->angle);
     }
 }
 
 extern "C" void joystick_button_changed(bool pressed) {
-    ESP_LOGD(MAIN_TASK_TAG, "摇杆按钮: %s", pressed ? "按下" : "释放");
+    DLOGD(DLOG_MODULE_JOYSTICK, "摇杆按钮: %s", pressed ? "按下" : "释放");
 }
 
 // 矩阵键盘按键回调函数
 extern "C" void keypad_key_changed(uint8_t key, bool pressed) {
-    ESP_LOGI(MAIN_TASK_TAG, "矩阵键盘: 按键 %d %s", key, pressed ? "按下" : "释放");
+    DLOGI(DLOG_MODULE_KEYPAD, "矩阵键盘: 按键 %d %s", key, pressed ? "按下" : "释放");
 }
 
-// FreeRTOS 矩阵键盘任务
-extern "C" void my_keypad_task(void* parameter) {
-    ESP_LOGI(MAIN_TASK_TAG, "Keypad RTOS task started");
+// 传感器采样器配置
+// 采样周期由 esp_timer 产生，处理函数的执行时间不会累积为周期漂移
+// 采样任务的栈大小/优先级/核心见 task_plan_table
+static const sampler_config_t encoder_sampler_config = {
+    .name = "encoder",
+    .handler = encoder_handler,
+    .rate_hz = ENCODER_SAMPLE_RATE_HZ,
+};
+
+static const sampler_config_t joystick_sampler_config = {
+    .name = "joystick",
+    .handler = joystick_handler,
+    .rate_hz = JOYSTICK_SAMPLE_RATE_HZ,
+};
+
+static const sampler_config_t keypad_sampler_config = {
+    .name = "keypad",
+    .handler = keypad_handler,
+    .rate_hz = KEYPAD_SAMPLE_RATE_HZ,
+};
+
+// FreeRTOS 串口舵机演示任务
+// 只向舵机总线排队命令，不直接访问串口，也不会因总线事务而阻塞
+extern "C" void my_servo_task(void* parameter) {
+    ESP_LOGI(MAIN_TASK_TAG, "Servo RTOS task started");
+    
+    static const float demo_angles[] = {100, 120, 140, 160};
+    uint32_t servo_demo_step = 0;
     
     while (1) {
-        // 调用键盘处理函数
-        keypad_handler();
+        float target_angle = demo_angles[servo_demo_step % 4];
+        ESP_LOGI(MAIN_TASK_TAG, "Moving servo to %.0f degrees", target_angle);
+
+        // 控制舵机移动，执行时间4000ms
+        // 多个舵机需要同时动作时使用 servo_bus_group_move()
+        if (servo_bus_move(config_get()->servo.servo_id, target_angle, 4000) != ESP_OK) {
+            ESP_LOGW(MAIN_TASK_TAG, "Failed to queue servo command");
+        }
         
-        // 任务延时，释放CPU给其他任务
-        vTaskDelay(pdMS_TO_TICKS(15)); // 15ms 间隔，约66Hz 扫描频率
+        // 位置/温度/电压由总线轮询器按预算读取，结果写入 DataPlatform (BIT_EVENT_SERVO_UPDATED)
+        
+        servo_demo_step++;
+        vTaskDelay(pdMS_TO_TICKS(3000)); // 3秒间隔
     }
 }
 
-// FreeRTOS 编码器任务
-extern "C" void my_encoder_task(void* parameter) {
-    ESP_LOGI(MAIN_TASK_TAG, "Encoder RTOS task started");
-    
-    while (1) {
-        // 调用编码器处理函数
-        encoder_handler();
-        
-        // 任务延时，释放CPU给其他任务
-        vTaskDelay(pdMS_TO_TICKS(10)); // 10ms 间隔，100Hz 更新频率
+// WiFi 连接成功后由 loop() 写回当前配置 (回调在网络任务中执行，不在那里写 flash)
+static volatile bool wifi_config_pending = false;
+
+// 连接管理状态变化回调 (网络任务中执行)：记录启动里程碑
+static void network_link_changed(network_link_state_t state) {
+    if (state == NETWORK_LINK_WIFI_ONLY || state == NETWORK_LINK_NET_CONNECTING) {
+        boot_mark(BOOT_MILESTONE_WIFI_CONNECTED);
+    }
+    if (state == NETWORK_LINK_ONLINE) {
+        boot_mark(BOOT_MILESTONE_NETWORK_ONLINE);
+    }
+    if (state == NETWORK_LINK_WIFI_ONLY || state == NETWORK_LINK_ONLINE) {
+        wifi_config_pending = true;
     }
 }
 
-// FreeRTOS 摇杆任务
-extern "C" void my_joystick_task(void* parameter) {
-    ESP_LOGI(MAIN_TASK_TAG, "Joystick RTOS task started");
-    
-    while (1) {
-        // 调用摇杆处理函数
-        joystick_handler();
-        
-        // 任务延时，释放CPU给其他任务
-        vTaskDelay(pdMS_TO_TICKS(20)); // 20ms 间隔，50Hz 更新频率
+// 把最近一次可用的 WiFi/网络配置和 AP 的 BSSID/信道写回配置存储 (内容未变化时不写 flash)
+static void save_wifi_config(void) {
+    static wifi_task_config_t wifi_config;
+    network_link_status_t link;
+    if (!get_current_wifi_config(&wifi_config)) {
+        return;
     }
+    network_link_get_status(&link);
+
+    app_config_t* config = config_begin_update();
+    bool changed = memcmp(&config->wifi, &wifi_config, sizeof(wifi_config)) != 0;
+    config->wifi = wifi_config;
+    if (link.bssid_cached && (config->ap_channel != link.channel ||
+                              memcmp(config->ap_bssid, link.bssid, sizeof(config->ap_bssid)) != 0)) {
+        memcpy(config->ap_bssid, link.bssid, sizeof(config->ap_bssid));
+        config->ap_channel = link.channel;
+        changed = true;
+    }
+    config_end_update(changed);
 }
 
-// FreeRTOS WiFi 任务
-extern "C" void my_wifi_task(void* parameter) {
-    ESP_LOGI(MAIN_TASK_TAG, "WiFi RTOS task started");
-    
-    // 调用一次 WiFi 处理函数进行初始化
+// 启动步骤：WiFi
+static esp_err_t boot_init_wifi(void) {
+    static wifi_task_config_t wifi_config;
+    const app_config_t* config = config_get();
+    wifi_config = config->wifi;
+
+    // 初始化 WiFi 配置
+    if (wifi_init_config(&wifi_config) != pdPASS) {
+        ESP_LOGE(MAIN_TASK_TAG, "Failed to initialize WiFi config");
+        return ESP_FAIL;
+    }
+    // 上次连接的 AP：第一次连接直接关联，跳过全信道扫描
+    if (config->ap_channel > 0) {
+        network_link_set_cached_ap(config->ap_bssid, config->ap_channel);
+    }
+    network_link_set_callback(network_link_changed);
+
+    // 一次性设置并启动网络任务，不等待连接结果
     wifi_handler();
+    ESP_LOGI(MAIN_TASK_TAG, "WiFi initialization completed");
+    return ESP_OK;
+}
+
+// 启动步骤：编码器
+static esp_err_t boot_init_encoder(void) {
+    esp_err_t ret = encoder_init(&config_get()->encoder);
+    if (ret != ESP_OK) {
+        ESP_LOGE(MAIN_TASK_TAG, "编码器初始化失败");
+        return ret;
+    }
+    ESP_LOGI(MAIN_TASK_TAG, "编码器初始化成功");
+    // encoder_set_callback(encoder_position_changed);
+    // encoder_set_button_callback(encoder_button_changed);
     
-    // WiFi 任务完成后删除自己
-    ESP_LOGI(MAIN_TASK_TAG, "WiFi initialization completed, deleting task");
-    vTaskDelete(NULL);
+    // 创建编码器采样器 (固定 100Hz)
+    if (sampler_create(&encoder_sampler_config) < 0) {
+        ESP_LOGE(MAIN_TASK_TAG, "Failed to create encoder sampler");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(MAIN_TASK_TAG, "Encoder sampler created successfully");
+    return ESP_OK;
 }
 
-// FreeRTOS 串口舵机任务
-extern "C" void my_servo_task(void* parameter) {
-    ESP_LOGI(MAIN_TASK_TAG, "Servo RTOS task started");
+// 启动步骤：串口舵机总线 (D16/D17 与按键引脚冲突，默认不启用)
+static esp_err_t boot_init_servo(void) {
+    const config_servo_t* servo = &config_get()->servo;
+    servo_bus_config_t servo_bus_config = {
+        .rx_pin = servo->rx_pin,
+        .tx_pin = servo->tx_pin,
+        .baud_rate = servo->baud_rate,
+        .servo_ids = {servo->servo_id},
+        .servo_count = 1,
+        .response_timeout_ms = SERVO_RESPONSE_TIMEOUT_MS,
+        .poll_budget_hz = SERVO_POLL_BUDGET_HZ,
+        .poll_fields = SERVO_BUS_READ_ALL,
+    };
     
-    static uint32_t servo_demo_step = 0;
-    static uint32_t last_servo_time = 0;
-    const uint32_t SERVO_DEMO_INTERVAL = 3000; // 3秒间隔
+    esp_err_t ret = servo_bus_init(&servo_bus_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(MAIN_TASK_TAG, "舵机总线初始化失败");
+        return ret;
+    }
+    // if (task_plan_create(my_servo_task, "Servo_Task", 0, NULL, 0, NULL, tskNO_AFFINITY) != pdPASS) {
+    //     ESP_LOGE(MAIN_TASK_TAG, "Failed to create servo task");
+    // }
     
-    while (1) {
-        uint32_t current_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-        
-        // 每3秒执行一次舵机演示动作
-        if (current_time - last_servo_time >= SERVO_DEMO_INTERVAL) {
-            if (servo_controller != nullptr) {
-                float target_angle = 0;
-                
-                switch (servo_demo_step % 4) {
-                    case 0:
-                        target_angle = 100;     // 100度
-                        ESP_LOGI(MAIN_TASK_TAG, "Moving servo to 100 degrees");
-                        break;
-                    case 1:
-                        target_angle = 120;    // 120度
-                        ESP_LOGI(MAIN_TASK_TAG, "Moving servo to 120 degrees");
-                        break;
-                    case 2:
-                        target_angle = 140;   // 140度
-                        ESP_LOGI(MAIN_TASK_TAG, "Moving servo to 140 degrees");
-                        break;
-                    case 3:
-                        target_angle = 160;    // 回到160度
-                        ESP_LOGI(MAIN_TASK_TAG, "Moving servo to 160 degrees");
-                        break;
-                }
+    // 本地控制：摇杆X轴直接驱动舵机，不经过网络 (与演示任务二选一)
+    servo_control_config_t servo_control_config = {
+        .mappings = {{
+            .servo_id = servo->servo_id,
+            .source = SERVO_CONTROL_SOURCE_JOYSTICK_X,
+            .center_deg = 120.0f,    // 摇杆居中时的角度
+            .scale_deg = 0.117f,     // 满偏 (+-512) 约 +-60 度
+            .min_deg = 60.0f,
+            .max_deg = 180.0f,
+            .max_rate_deg_s = 180.0f,
+            .smoothing = 0.5f,
+        }},
+        .mapping_count = 1,
+        .update_rate_hz = SERVO_CONTROL_RATE_HZ,
+        .deadband_deg = 0.5f,
+    };
+    ret = servo_control_init(&servo_control_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(MAIN_TASK_TAG, "Failed to start servo control");
+    }
+    return ret;
+}
 
-                // 控制舵机移动，增加执行时间到4000ms
-                t_FuncRet result = servo_controller->move_servo_immediate(SERVO_ID, target_angle, 4000);
-                if (result == Operation_Success) {
-                    ESP_LOGD(MAIN_TASK_TAG, "Servo command sent successfully (2000ms execution time)");
-                } else {
-                    ESP_LOGW(MAIN_TASK_TAG, "Failed to send servo command");
-                }
-                
-                // 读取舵机状态信息
-                float current_position = 0;
-                if (servo_controller->read_servo_position(SERVO_ID, current_position) == Operation_Success) {
-                    ESP_LOGD(MAIN_TASK_TAG, "Servo current position: %.1f degrees", current_position);
-                }
-                
-                int temperature = 0;
-                if (servo_controller->read_servo_temp(SERVO_ID, temperature) == Operation_Success) {
-                    ESP_LOGD(MAIN_TASK_TAG, "Servo temperature: %d°C", temperature);
-                }
-                
-                float voltage = 0;
-                if (servo_controller->read_servo_voltage(SERVO_ID, voltage) == Operation_Success) {
-                    ESP_LOGD(MAIN_TASK_TAG, "Servo voltage: %.2fV", voltage);
-                }
-            }
-            
-            servo_demo_step++;
-            last_servo_time = current_time;
+// 启动步骤：矩阵键盘
+static esp_err_t boot_init_keypad(void) {
+    esp_err_t ret = keypad_init(&config_get()->keypad);
+    if (ret != ESP_OK) {
+        ESP_LOGE(MAIN_TASK_TAG, "矩阵键盘初始化失败");
+        return ret;
+    }
+    ESP_LOGI(MAIN_TASK_TAG, "矩阵键盘初始化成功");
+    keypad_set_callback(keypad_key_changed);
+    
+    // 创建矩阵键盘采样器 (约66Hz 扫描频率)
+    if (sampler_create(&keypad_sampler_config) < 0) {
+        ESP_LOGE(MAIN_TASK_TAG, "Failed to create keypad sampler");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(MAIN_TASK_TAG, "Keypad sampler created successfully");
+    return ESP_OK;
+}
+
+// 启动步骤：摇杆
+// 中心值为 0 时校准一次 (要求摇杆居中静止) 并写回配置，之后的启动直接使用保存的中心值
+static esp_err_t boot_init_joystick(void) {
+    const joystick_config_t* joystick_config = &config_get()->joystick;
+    bool calibrated = joystick_config->center_x != 0 && joystick_config->center_y != 0;
+    
+    esp_err_t ret = joystick_init(joystick_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(MAIN_TASK_TAG, "摇杆初始化失败");
+        return ret;
+    }
+    ESP_LOGI(MAIN_TASK_TAG, "摇杆初始化成功");
+    
+    if (!calibrated) {
+        // DMA 后端等待后台采样的前几个块即可完成 (约 30ms)，不需要先固定等待
+        ESP_LOGI(MAIN_TASK_TAG, "正在校准摇杆中心位置...");
+        if (joystick_calibrate_center() == ESP_OK) {
+            app_config_t* config = config_begin_update();
+            joystick_get_center(&config->joystick.center_x, &config->joystick.center_y);
+            config_end_update(true);
         }
-        
-        // 任务延时
-        vTaskDelay(pdMS_TO_TICKS(100)); // 100ms间隔
     }
+    
+    // joystick_set_callback(joystick_data_changed);
+    // joystick_set_button_callback(joystick_button_changed);
+    
+    // 创建摇杆采样器 (固定 50Hz)
+    if (sampler_create(&joystick_sampler_config) < 0) {
+        ESP_LOGE(MAIN_TASK_TAG, "Failed to create joystick sampler");
+        return ESP_FAIL;
+    }
+    ESP_LOGI(MAIN_TASK_TAG, "Joystick sampler created successfully");
+    return ESP_OK;
+}
+
+// 启动步骤：飞行记录仪 (读取各扇区头找到上次的写入位置)
+static esp_err_t boot_init_recorder(void) {
+    const config_recorder_t* recorder = &config_get()->recorder;
+    recorder_config_t recorder_config = {
+        .enabled = true,
+        .rate_hz = {recorder->encoder_hz, recorder->joystick_hz, recorder->servo_hz},
+        .latency_interval_s = recorder->latency_s,
+    };
+    return recorder_init(&recorder_config);
+}
+
+// 按配置中启用的外设生成并行启动步骤 (互不依赖，各自在工作任务中初始化)
+static size_t build_boot_steps(boot_step_t* steps) {
+    const config_enable_t* enable = &config_get()->enable;
+    size_t count = 0;
+    if (enable->wifi)     steps[count++] = {"wifi",     boot_init_wifi};
+    if (enable->encoder)  steps[count++] = {"encoder",  boot_init_encoder};
+    if (enable->servo)    steps[count++] = {"servo",    boot_init_servo};
+    if (enable->keypad)   steps[count++] = {"keypad",   boot_init_keypad};
+    if (enable->joystick) steps[count++] = {"joystick", boot_init_joystick};
+    if (enable->recorder) steps[count++] = {"recorder", boot_init_recorder};
+    return count;
 }
 
 void setup() {
     Serial.begin(115200);
-    // 稍作延时，等待串口监视器连接
-    vTaskDelay(pdMS_TO_TICKS(1000)); 
+    // 不再固定等待串口监视器连接：掉电复位后尽快恢复遥测，各阶段耗时可随时用 'boot' 命令查看
 
     ESP_LOGI(MAIN_TASK_TAG, "ESP32 WiFi Task with Arduino");
 
-    // 初始化DataPlatform数据服务层
-    if (data_service_init() != pdPASS) {
+    // 在创建任何任务之前设置任务规划表
+    task_plan_init(task_plan_table, sizeof(task_plan_table) / sizeof(task_plan_table[0]));
+
+    // 延迟日志：热路径只写入无锁环形缓冲区，格式化在低优先级任务中进行 (先于所有外设启动)
+    if (dlog_init() != ESP_OK) {
+        ESP_LOGE(MAIN_TASK_TAG, "Failed to start deferred log task");
+    }
+
+    // 初始化DataPlatform数据服务层 (所有外设和发布任务都依赖它，顺序执行)
+    int stage = boot_stage_begin("data_service");
+    BaseType_t data_ready = data_service_init();
+    boot_stage_end(stage, data_ready == pdPASS ? ESP_OK : ESP_FAIL);
+    if (data_ready != pdPASS) {
         ESP_LOGE(MAIN_TASK_TAG, "Failed to initialize data service");
         return;
     }
     ESP_LOGI(MAIN_TASK_TAG, "DataPlatform initialized successfully");
 
+    // 读取 NVS 中的配置 (一次 blob 读取，决定启用哪些外设及其引脚)
+    stage = boot_stage_begin("config");
+    boot_stage_end(stage, config_load());
+
     // 创建 uart_parser 任务
-    if (xTaskCreate(uart_parser_task, "UART_Parser_Task", 4096, NULL, tskIDLE_PRIORITY + 2, NULL) != pdPASS) {
+    stage = boot_stage_begin("uart_parser");
+    if (task_plan_create(uart_parser_task, "UART_Parser_Task", 0, NULL, 0, NULL, tskNO_AFFINITY) != pdPASS) {
         ESP_LOGE(MAIN_TASK_TAG, "Failed to create UART Parser task");
     }
+    // 串口接收改为驱动事件回调，整块读取后按行送入解析任务
+    uart_parser_begin_serial_rx();
+    // 注册各模块的串口命令
+    task_plan_register_commands();
+    task_profiler_register_commands();
+    latency_register_commands();
+    sampler_register_commands();
+    bench_register_commands();
+    servo_bus_register_commands();
+    servo_control_register_commands();
+    boot_register_commands();
+    config_register_commands();
+    recorder_register_commands();
+    dlog_register_commands();
+    hal_register_commands();
+    boot_stage_end(stage, ESP_OK);
+
+    // 启动任务剖析 (每个窗口一次 uxTaskGetSystemState()，可在发布版本中常开)
+    stage = boot_stage_begin("publisher");
+    esp_err_t publisher_ret = task_profiler_init(TASK_PROFILER_DEFAULT_WINDOW_MS);
+    if (publisher_ret != ESP_OK) {
+        ESP_LOGE(MAIN_TASK_TAG, "Failed to start task profiler");
+    }
 
-    // Configure WiFi Task for STA mode with TCP client
-    // wifi_task_config_t wifi_config;
-    // memset(&wifi_config, 0, sizeof(wifi_task_config_t));
-
-    // wifi_config.wifi_mode = WIFI_STA;
-    // strncpy(wifi_config.ssid, EXAMPLE_ESP_WIFI_SSID, sizeof(wifi_config.ssid) - 1);
-    // strncpy(wifi_config.password, EXAMPLE_ESP_WIFI_PASS, sizeof(wifi_config.password) - 1);
-    
-    // wifi_config.power_save = false; // Disable power saving for best performance
-    // wifi_config.tx_power = WIFI_POWER_19_5dBm; // Set max power
-    // wifi_config.sta_connect_timeout_ms = 15000; // 15 seconds timeout
-
-    // // Configure network as TCP client
-    // wifi_config.network_config.protocol = NETWORK_PROTOCOL_TCP_CLIENT;
-    // strncpy(wifi_config.network_config.remote_host, "192.168.31.136", sizeof(wifi_config.network_config.remote_host) - 1); // 通常手机热点的网关IP
-    // wifi_config.network_config.remote_port = 2233; // 手机端TCP服务器端口，您可以根据实际情况修改
-    // wifi_config.network_config.auto_connect = true; // WiFi连接成功后自动开始TCP连接
-    // wifi_config.network_config.connect_timeout_ms = 10000; // 10 seconds timeout for TCP connection
-
-    // // 初始化 WiFi 配置
-    // if (wifi_init_config(&wifi_config) != pdPASS) {
-    //     ESP_LOGE(MAIN_TASK_TAG, "Failed to initialize WiFi config");
-    // } else {
-    //     // 创建 WiFi RTOS 任务
-    //     if (xTaskCreate(my_wifi_task, "WiFi_Task", 4096, NULL, tskIDLE_PRIORITY + 2, NULL) != pdPASS) {
-    //         ESP_LOGE(MAIN_TASK_TAG, "Failed to create WiFi RTOS task");
-    //     } else {
-    //         ESP_LOGI(MAIN_TASK_TAG, "WiFi RTOS task created successfully");
-    //     }
-    // }
-
-    // 创建数据发布任务
-    if (xTaskCreate(data_publisher_task, "Data_Publisher_Task", 4096, NULL, tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+    // 创建数据发布任务 (先于外设启动，第一个样本不需要等待)
+    if (task_plan_create(data_publisher_task, "Data_Publisher_Task", 0, NULL, 0, NULL, tskNO_AFFINITY) != pdPASS) {
         ESP_LOGE(MAIN_TASK_TAG, "Failed to create data publisher task");
+        publisher_ret = ESP_FAIL;
     } else {
         ESP_LOGI(MAIN_TASK_TAG, "Data publisher task created successfully");
     }
+    boot_stage_end(stage, publisher_ret);
 
-    // 初始化编码器
-    encoder_config_t encoder_config = {
-        .pin_a = 19,              // 编码器A相引脚
-        .pin_b = 18,              // 编码器B相引脚
-        .pin_button = 21,         // 编码器按钮引脚
-        .use_pullup = true,      // 使用内部上拉电阻
-        .steps_per_notch = 4     // 每个刻度4个步数（根据编码器型号调整）
-    };
-    
-    if (encoder_init(&encoder_config) == ESP_OK) {
-        ESP_LOGI(MAIN_TASK_TAG, "编码器初始化成功");
-        // encoder_set_callback(encoder_position_changed);
-        // encoder_set_button_callback(encoder_button_changed);
-        
-        // 创建编码器 RTOS 任务
-        if (xTaskCreate(my_encoder_task, "Encoder_Task", 2048, NULL, tskIDLE_PRIORITY + 3, NULL) != pdPASS) {
-            ESP_LOGE(MAIN_TASK_TAG, "Failed to create encoder RTOS task");
-        } else {
-            ESP_LOGI(MAIN_TASK_TAG, "Encoder RTOS task created successfully");
-        }
-    } else {
-        ESP_LOGE(MAIN_TASK_TAG, "编码器初始化失败");
+    // 外设和 WiFi 并行初始化：总耗时取决于最慢的一项，而不是各项之和
+    static boot_step_t boot_steps[6];
+    size_t boot_step_count = build_boot_steps(boot_steps);
+    if (boot_run_parallel(boot_steps, boot_step_count, BOOT_STEP_TIMEOUT_MS) != ESP_OK) {
+        ESP_LOGW(MAIN_TASK_TAG, "Some boot steps failed or are still running, see 'boot'");
     }
-    
-    // 初始化矩阵键盘
-    // keypad_config_t keypad_config = {
-    //     .row_pins = {13, 23, 22},      // 行引脚: R1=D13, R2=D23, R3=D22
-    //     .col_pins = {25, 26, 27},      // 列引脚: C1=D25, C2=D26, C3=D27
-    //     .use_pullup = true,            // 使用内部上拉电阻
-    //     .debounce_time_ms = 20         // 去抖时间20ms
-    // };
-    
-    // if (keypad_init(&keypad_config) == ESP_OK) {
-    //     ESP_LOGI(MAIN_TASK_TAG, "矩阵键盘初始化成功");
-    //     keypad_set_callback(keypad_key_changed);
-        
-    //     // 创建矩阵键盘 RTOS 任务
-    //     if (xTaskCreate(my_keypad_task, "Keypad_Task", 2048, NULL, tskIDLE_PRIORITY + 2, NULL) != pdPASS) {
-    //         ESP_LOGE(MAIN_TASK_TAG, "Failed to create keypad RTOS task");
-    //     } else {
-    //         ESP_LOGI(MAIN_TASK_TAG, "Keypad RTOS task created successfully");
-    //     }
-    // } else {
-    //     ESP_LOGE(MAIN_TASK_TAG, "矩阵键盘初始化失败");
-    // }
-
-    // 初始化摇杆
-    // joystick_config_t joystick_config = {
-    //     .pin_x = 33,             // X轴ADC引脚 (A0)
-    //     .pin_y = 32,             // Y轴ADC引脚 (A3)
-    //     .pin_button = 12,        // 摇杆按钮引脚
-    //     .use_pullup = true,      // 按钮使用内部上拉
-    //     .deadzone = 50,          // 死区大小
-    //     .invert_x = false,       // X轴不反转
-    //     .invert_y = true,        // Y轴反转（根据摇杆安装方向调整）
-    //     .center_x = 0,           // 自动检测中心值
-    //     .center_y = 0            // 自动检测中心值
-    // };
-    
-    // if (joystick_init(&joystick_config) == ESP_OK) {
-    //     ESP_LOGI(MAIN_TASK_TAG, "摇杆初始化成功");
-        
-    //     // 等待一下再校准中心位置
-    //     vTaskDelay(pdMS_TO_TICKS(1000));
-    //     ESP_LOGI(MAIN_TASK_TAG, "正在校准摇杆中心位置...");
-    //     joystick_calibrate_center();
-        
-    //     // joystick_set_callback(joystick_data_changed);
-    //     // joystick_set_button_callback(joystick_button_changed);
-        
-    //     // 创建摇杆 RTOS 任务
-    //     if (xTaskCreate(my_joystick_task, "Joystick_Task", 2048, NULL, tskIDLE_PRIORITY + 3, NULL) != pdPASS) {
-    //         ESP_LOGE(MAIN_TASK_TAG, "Failed to create joystick RTOS task");
-    //     } else {
-    //         ESP_LOGI(MAIN_TASK_TAG, "Joystick RTOS task created successfully");
-    //     }
-    // } else {
-    //     ESP_LOGE(MAIN_TASK_TAG, "摇杆初始化失败");
-    // }
+    boot_mark(BOOT_MILESTONE_SETUP_DONE);
 }
 
 void loop() { /* 类似 defaultTask */
@@ -400,50 +624,26 @@ void loop() { /* 类似 defaultTask */
     // 检查是否需要发送初始消息
     if (!message_sent && is_wifi_connected() && is_network_connected()) {
         ESP_LOGI(MAIN_TASK_TAG, "Sending hello message to TCP server...");
-        int result = network_send_string("hello misakaa from esp32\n");
+        const char* hello = "hello misakaa from esp32\n";
+        int result = network_send_async((const uint8_t*)hello, strlen(hello));
         if (result > 0) {
-            ESP_LOGI(MAIN_TASK_TAG, "Message sent successfully (%d bytes)", result);
+            ESP_LOGI(MAIN_TASK_TAG, "Message queued successfully (%d bytes)", result);
             message_sent = true;
         } else {
             ESP_LOGE(MAIN_TASK_TAG, "Failed to send message");
         }
     }
     
-    // 检查串口是否有数据输入
-    if (Serial.available() > 0) {
-        static char rx_buffer[128]; // 增加缓冲区大小以适应更长的命令
-        static uint8_t rx_counter = 0;
-        char received_char = Serial.read();
-
-        // 回显字符
-        Serial.write(received_char);
-
-        // 判断是否是命令结束符 (回车或换行)
-        if (received_char == '\r' || received_char == '\n') {
-            if (rx_counter > 0) {
-                // 命令接收完毕
-                rx_buffer[rx_counter] = '\0'; // 添加字符串结束符
-
-                // 将接收到的命令字符串发送到解析任务的队列
-                uart_parser_send_command_to_queue(rx_buffer);
-
-                // 重置计数器，准备接收下一条命令
-                rx_counter = 0;
-            }
-        } else if (received_char == '\b' || received_char == 127) { // 处理退格键
-            if (rx_counter > 0) {
-                rx_counter--;
-                // 在终端上回显退格、空格、退格，以实现删除效果
-                Serial.print("\b \b");
-            }
-        } else {
-            // 将字符存入缓冲区
-            if (rx_counter < sizeof(rx_buffer) - 1) {
-                rx_buffer[rx_counter++] = received_char;
-            }
-        }
+    // WiFi 连接成功后写回配置，下次启动直接使用
+    if (wifi_config_pending) {
+        wifi_config_pending = false;
+        save_wifi_config();
     }
+    // 合并写入配置修改 (写 flash 放在最低优先级的任务中)
+    config_service();
+    
+    // 串口命令由 uart_parser 的接收事件回调整块读取，这里不再轮询
     
     // 主循环可以执行其他低优先级或非阻塞的任务
-    vTaskDelay(pdMS_TO_TICKS(10));
+    vTaskDelay(pdMS_TO_TICKS(100));
 }
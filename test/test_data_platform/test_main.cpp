@@ -0,0 +1,216 @@
+#include <unity.h>
+#include <string.h>
+#include "native_host.h"
+#include "data_service.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+// DataPlatform 分段 (seqlock) 与环形缓冲区：单线程开销，以及另一个线程并发读写时的开销和一致性
+
+#define READER_TASK_NAME    "bench_reader"
+#define WRITER_TASK_NAME    "bench_writer"
+#define TASK_TIMEOUT_MS     10000
+
+// 热路径的读者 (与 'bench micro data' 相同)：每次读到的 IMU 样本六个字段必须来自同一次写入
+static volatile bool s_reader_run = false;
+static volatile uint32_t s_reader_reads = 0;
+static volatile uint32_t s_reader_torn = 0;
+static volatile int64_t s_reader_elapsed_us = 0;
+static SemaphoreHandle_t s_task_done = NULL;
+static int s_subscriber = -1;
+static int s_latest_subscriber = -1;     // 只读取最新值的订阅者 (与舵机控制任务相同)
+static volatile uint32_t s_sink = 0;
+
+static void imu_fill(imu_data_t *imu, float value) {
+    imu->accel_x = imu->accel_y = imu->accel_z = value;
+    imu->gyro_x = imu->gyro_y = imu->gyro_z = value;
+}
+
+static bool imu_consistent(const imu_data_t *imu) {
+    return imu->accel_y == imu->accel_x && imu->accel_z == imu->accel_x && imu->gyro_x == imu->accel_x &&
+           imu->gyro_y == imu->accel_x && imu->gyro_z == imu->accel_x;
+}
+
+static void reader_task(void *parameter) {
+    (void)parameter;
+    imu_data_t imu;
+    uint32_t reads = 0;
+    uint32_t torn = 0;
+    int64_t start_us = esp_timer_get_time();
+    while (s_reader_run) {
+        s_sink += data_service_get_imu(&imu);
+        torn += imu_consistent(&imu) ? 0 : 1;
+        reads++;
+    }
+    s_reader_elapsed_us = esp_timer_get_time() - start_us;
+    s_reader_reads = reads;
+    s_reader_torn = torn;
+    xSemaphoreGive(s_task_done);
+    vTaskDelete(NULL);
+}
+
+// 环形缓冲区的写入方：位置从 1 递增
+static void encoder_writer_task(void *parameter) {
+    uint32_t count = *(const uint32_t *)parameter;
+    encoder_data_t encoder;
+    memset(&encoder, 0, sizeof(encoder));
+    for (uint32_t i = 1; i <= count; i++) {
+        encoder.position = (int32_t)i;
+        encoder.delta = 1;
+        data_service_update_encoder(&encoder);
+    }
+    xSemaphoreGive(s_task_done);
+    vTaskDelete(NULL);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void test_imu_roundtrip(void) {
+    imu_data_t in, out;
+    imu_fill(&in, 1.5f);
+    in.gyro_z = -3.0f;
+    uint32_t before = data_service_get_imu(&out);
+    data_service_update_imu(&in);
+    TEST_ASSERT_EQUAL_UINT32(before + 1, data_service_get_imu(&out));
+    TEST_ASSERT_EQUAL_MEMORY(&in, &out, sizeof(in));
+}
+
+static void test_encoder_ring_in_order(void) {
+    encoder_data_t encoder;
+    encoder_data_t drained[DATA_SERVICE_ENCODER_RING_SIZE];
+    memset(&encoder, 0, sizeof(encoder));
+    for (int32_t i = 1; i <= 10; i++) {
+        encoder.position = i;
+        data_service_update_encoder(&encoder);
+    }
+    TEST_ASSERT_TRUE(data_service_wait(s_subscriber, 0) & BIT_EVENT_ENCODER_UPDATED);
+    size_t count = data_service_drain_encoder(s_subscriber, drained, DATA_SERVICE_ENCODER_RING_SIZE);
+    TEST_ASSERT_EQUAL_INT(10, count);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_INT32((int32_t)i + 1, drained[i].position);
+    }
+}
+
+static void test_latest_subscriber_has_no_ring(void) {
+    encoder_data_t encoder;
+    encoder_data_t drained[DATA_SERVICE_ENCODER_RING_SIZE];
+    memset(&encoder, 0, sizeof(encoder));
+    for (uint32_t i = 0; i < 2 * DATA_SERVICE_ENCODER_RING_SIZE; i++) {
+        encoder.position = (int32_t)i;
+        data_service_update_encoder(&encoder);
+    }
+    // 收到通知，但没有读游标：不能取出样本，也不计入积压和丢失
+    TEST_ASSERT_TRUE(data_service_wait(s_latest_subscriber, 0) & BIT_EVENT_ENCODER_UPDATED);
+    TEST_ASSERT_EQUAL_INT(0, data_service_drain_encoder(s_latest_subscriber, drained, DATA_SERVICE_ENCODER_RING_SIZE));
+    uint32_t pending = 1;
+    uint32_t dropped = 1;
+    data_service_get_ring_stats(s_latest_subscriber, BIT_EVENT_ENCODER_UPDATED, &pending, &dropped);
+    TEST_ASSERT_EQUAL_UINT32(0, pending);
+    TEST_ASSERT_EQUAL_UINT32(0, dropped);
+
+    // 汇总只反映有读游标的订阅者：取出后不再有积压
+    while (data_service_drain_encoder(s_subscriber, drained, DATA_SERVICE_ENCODER_RING_SIZE) > 0) {
+    }
+    data_service_get_ring_stats(DATA_SERVICE_ALL_SUBSCRIBERS, BIT_EVENT_ENCODER_UPDATED, &pending, NULL);
+    TEST_ASSERT_EQUAL_UINT32(0, pending);
+}
+
+static void test_bench_imu_contention(void) {
+    const uint32_t iterations = NATIVE_BENCH_ITERATIONS;
+    imu_data_t imu;
+    native_bench_header();
+
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        imu_fill(&imu, (float)i);
+        data_service_update_imu(&imu);
+    }
+    native_bench_report("imu write", iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        s_sink += data_service_get_imu(&imu);
+    }
+    native_bench_report("imu read", iterations, esp_timer_get_time() - start_us);
+
+    // 读者线程持续读取同一分段，写入方与读者的缓存行争用和读者重试都计入结果
+    s_reader_run = true;
+    TEST_ASSERT_EQUAL_INT(pdPASS, xTaskCreate(reader_task, READER_TASK_NAME, 2048, NULL, tskIDLE_PRIORITY + 1, NULL));
+    vTaskDelay(pdMS_TO_TICKS(2));
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        imu_fill(&imu, (float)i);
+        data_service_update_imu(&imu);
+    }
+    native_bench_report("imu write + reader", iterations, esp_timer_get_time() - start_us);
+    s_reader_run = false;
+    TEST_ASSERT_EQUAL_INT(pdTRUE, xSemaphoreTake(s_task_done, pdMS_TO_TICKS(TASK_TIMEOUT_MS)));
+    native_bench_report("imu read (concurrent)", s_reader_reads, s_reader_elapsed_us);
+
+    TEST_ASSERT_GREATER_THAN_UINT32(0, s_reader_reads);
+    TEST_ASSERT_EQUAL_UINT32(0, s_reader_torn);
+}
+
+static void test_bench_encoder_ring_contention(void) {
+    static uint32_t count = NATIVE_BENCH_ITERATIONS;
+    encoder_data_t drained[DATA_SERVICE_ENCODER_RING_SIZE];
+    uint32_t received = 0;
+    int32_t last = 0;
+    bool in_order = true;
+
+    // 先取走之前的样本，只统计本次写入
+    while (data_service_drain_encoder(s_subscriber, drained, DATA_SERVICE_ENCODER_RING_SIZE) > 0) {
+    }
+    uint32_t dropped_before = 0;
+    data_service_get_ring_stats(s_subscriber, BIT_EVENT_ENCODER_UPDATED, NULL, &dropped_before);
+
+    int64_t start_us = esp_timer_get_time();
+    TEST_ASSERT_EQUAL_INT(pdPASS, xTaskCreate(encoder_writer_task, WRITER_TASK_NAME, 2048, &count,
+                                              tskIDLE_PRIORITY + 2, NULL));
+    while (last != (int32_t)count) {
+        if (data_service_wait(s_subscriber, pdMS_TO_TICKS(TASK_TIMEOUT_MS)) == 0) {
+            break;
+        }
+        size_t n;
+        while ((n = data_service_drain_encoder(s_subscriber, drained, DATA_SERVICE_ENCODER_RING_SIZE)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                in_order = in_order && drained[i].position > last;
+                last = drained[i].position;
+            }
+            received += (uint32_t)n;
+        }
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    TEST_ASSERT_EQUAL_INT(pdTRUE, xSemaphoreTake(s_task_done, pdMS_TO_TICKS(TASK_TIMEOUT_MS)));
+
+    uint32_t pending = 0;
+    uint32_t dropped = 0;
+    data_service_get_ring_stats(s_subscriber, BIT_EVENT_ENCODER_UPDATED, &pending, &dropped);
+    native_bench_report("encoder write + drain", count, elapsed_us);
+    native_bench_report("encoder drained (concurrent)", received, elapsed_us);
+
+    // 落后超过容量的样本计入 dropped，其余按顺序全部取出
+    TEST_ASSERT_TRUE(in_order);
+    TEST_ASSERT_EQUAL_INT32((int32_t)count, last);
+    TEST_ASSERT_EQUAL_UINT32(0, pending);
+    TEST_ASSERT_EQUAL_UINT32(count, received + (dropped - dropped_before));
+}
+
+int main(void) {
+    data_service_init();
+    s_task_done = xSemaphoreCreateBinary();
+    s_subscriber = data_service_subscribe(BIT_EVENT_ENCODER_UPDATED);
+    s_latest_subscriber = data_service_subscribe_latest(BIT_EVENT_ENCODER_UPDATED);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_imu_roundtrip);
+    RUN_TEST(test_encoder_ring_in_order);
+    RUN_TEST(test_latest_subscriber_has_no_ring);
+    RUN_TEST(test_bench_imu_contention);
+    RUN_TEST(test_bench_encoder_ring_contention);
+    return UNITY_END();
+}
@@ -0,0 +1,178 @@
+#include <unity.h>
+#include <string.h>
+#include "native_host.h"
+#include "joystick_math.h"
+#include "hal_io.h"
+#include "esp_timer.h"
+
+// 摇杆换算：轨迹回放 -> hal_adc_read() / hal_gpio_read() -> joystick_process_raw()
+
+#ifndef NATIVE_TRACE_DIR
+#define NATIVE_TRACE_DIR "test/traces"
+#endif
+
+#define TRACE_PATH          NATIVE_TRACE_DIR "/joystick_circle.trace"
+#define TRACE_MAX_SAMPLES   512
+
+// 与 lib/Config 的默认配置和轨迹文件头部的说明一致
+#define PIN_X               33
+#define PIN_Y               32
+#define PIN_BUTTON          12
+#define CENTER              2048
+#define DEADZONE            50
+
+// 轨迹中满偏转一圈的时间段：t = CIRCLE_START_MS + 10 * 角度
+#define CIRCLE_START_MS     100
+#define CIRCLE_STEP_MS      10
+
+typedef struct {
+    uint32_t t_ms;
+    uint16_t raw_x;
+    uint16_t raw_y;
+    bool button_pressed;
+} trace_sample_t;
+
+typedef struct {
+    trace_sample_t samples[TRACE_MAX_SAMPLES];
+    size_t count;
+} trace_samples_t;
+
+static trace_samples_t s_trace;
+static volatile uint32_t s_sink = 0;
+
+// 每行轨迹命令执行后，像驱动一样经 hal_io.h 读取输入
+static void record_step(uint32_t t_ms, void *arg) {
+    trace_samples_t *trace = (trace_samples_t *)arg;
+    if (trace->count < TRACE_MAX_SAMPLES) {
+        trace_sample_t *sample = &trace->samples[trace->count++];
+        sample->t_ms = t_ms;
+        sample->raw_x = hal_adc_read(PIN_X);
+        sample->raw_y = hal_adc_read(PIN_Y);
+        sample->button_pressed = hal_gpio_read(PIN_BUTTON) == LOW;
+    }
+}
+
+static const trace_sample_t *sample_at(uint32_t t_ms) {
+    for (size_t i = s_trace.count; i > 0; i--) {
+        if (s_trace.samples[i - 1].t_ms == t_ms) {
+            return &s_trace.samples[i - 1];   // 同一时刻有多行时取最后一行之后的状态
+        }
+    }
+    return NULL;
+}
+
+void setUp(void) {
+    joystick_math_configure(CENTER, CENTER, DEADZONE, false, true);
+}
+
+void tearDown(void) {
+}
+
+static void test_replay_trace(void) {
+    s_trace.count = 0;
+    int lines = native_trace_replay(TRACE_PATH, record_step, &s_trace);
+    TEST_ASSERT_GREATER_THAN(360, lines);
+    TEST_ASSERT_EQUAL_INT(lines, s_trace.count);
+    // 最后一行 'hal off' 之后恢复读取"硬件"
+    TEST_ASSERT_TRUE(!hal_sim_active());
+    TEST_ASSERT_EQUAL_UINT16(NATIVE_ADC_IDLE_VALUE, hal_adc_read(PIN_X));
+}
+
+static void test_center_and_deadzone(void) {
+    joystick_data_t data;
+    for (uint32_t t_ms = 0; t_ms < CIRCLE_START_MS; t_ms += CIRCLE_STEP_MS) {
+        const trace_sample_t *sample = sample_at(t_ms);
+        if (sample == NULL) {
+            continue;
+        }
+        joystick_process_raw(sample->raw_x, sample->raw_y, &data);
+        TEST_ASSERT_TRUE(data.in_deadzone);
+        TEST_ASSERT_EQUAL_INT16(0, data.x);
+        TEST_ASSERT_EQUAL_INT16(0, data.y);
+        TEST_ASSERT_EQUAL_UINT16(0, data.magnitude_q15);
+    }
+}
+
+static void test_full_circle(void) {
+    joystick_data_t data;
+    for (uint32_t degree = 0; degree < 360; degree++) {
+        const trace_sample_t *sample = sample_at(CIRCLE_START_MS + degree * CIRCLE_STEP_MS);
+        TEST_ASSERT_NOT_NULL(sample);
+        joystick_process_raw(sample->raw_x, sample->raw_y, &data);
+        TEST_ASSERT_TRUE(!data.in_deadzone);
+        // 轨迹中的原始值取整到 ADC 读数，幅度和角度在取整误差内与理论值一致
+        TEST_ASSERT_INT_WITHIN(400, 32767, data.magnitude_q15);
+        int32_t error = (int32_t)data.angle_cdeg - (int32_t)(degree * 100);
+        error = error > 18000 ? error - 36000 : (error < -18000 ? error + 36000 : error);
+        TEST_ASSERT_INT_WITHIN(20, 0, error);
+    }
+
+    // 四个轴向的已知值
+    joystick_process_raw(4095, CENTER, &data);
+    TEST_ASSERT_INT_WITHIN(1, 512, data.x);
+    TEST_ASSERT_EQUAL_UINT16(0, data.angle_cdeg);
+    joystick_process_raw(CENTER, 0, &data);     // Y 轴反转：原始值减小为正方向
+    TEST_ASSERT_INT_WITHIN(1, 512, data.y);
+    TEST_ASSERT_EQUAL_UINT16(9000, data.angle_cdeg);
+    joystick_process_raw(0, CENTER, &data);
+    TEST_ASSERT_EQUAL_INT16(-512, data.x);
+    TEST_ASSERT_EQUAL_UINT16(18000, data.angle_cdeg);
+    joystick_process_raw(CENTER, 4095, &data);
+    TEST_ASSERT_INT_WITHIN(1, -512, data.y);
+    TEST_ASSERT_EQUAL_UINT16(27000, data.angle_cdeg);
+}
+
+static void test_button_from_trace(void) {
+    TEST_ASSERT_TRUE(!sample_at(CIRCLE_START_MS + 179 * CIRCLE_STEP_MS)->button_pressed);
+    TEST_ASSERT_TRUE(sample_at(CIRCLE_START_MS + 180 * CIRCLE_STEP_MS)->button_pressed);
+    TEST_ASSERT_TRUE(sample_at(CIRCLE_START_MS + 269 * CIRCLE_STEP_MS)->button_pressed);
+    TEST_ASSERT_TRUE(!sample_at(CIRCLE_START_MS + 270 * CIRCLE_STEP_MS)->button_pressed);
+}
+
+static void test_bench_joystick(void) {
+    const uint32_t iterations = NATIVE_BENCH_ITERATIONS;
+    joystick_data_t data;
+    native_bench_header();
+
+    // 前两项与 'bench micro joystick' 相同
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        joystick_process_raw((uint16_t)((i * 37) & 4095), (uint16_t)((i * 101 + 1024) & 4095), &data);
+        s_sink += data.angle_cdeg;
+    }
+    native_bench_report("joystick_process_raw (sweep)", iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        joystick_process_raw(CENTER, CENTER, &data);
+        s_sink += data.angle_cdeg;
+    }
+    native_bench_report("joystick_process_raw (center)", iterations, esp_timer_get_time() - start_us);
+
+    TEST_ASSERT_GREATER_THAN(0, s_trace.count);
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        const trace_sample_t *sample = &s_trace.samples[i % s_trace.count];
+        joystick_process_raw(sample->raw_x, sample->raw_y, &data);
+        s_sink += data.angle_cdeg;
+    }
+    native_bench_report("joystick_process_raw (trace)", iterations, esp_timer_get_time() - start_us);
+
+    // 回放本身：读文件 + 分派 'hal sim' 命令 + 修改模拟状态
+    s_trace.count = 0;
+    start_us = esp_timer_get_time();
+    int lines = native_trace_replay(TRACE_PATH, record_step, &s_trace);
+    native_bench_report("trace replay (per line)", (uint32_t)lines, esp_timer_get_time() - start_us);
+}
+
+int main(void) {
+    hal_register_commands();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_trace);
+    RUN_TEST(test_center_and_deadzone);
+    RUN_TEST(test_full_circle);
+    RUN_TEST(test_button_from_trace);
+    RUN_TEST(test_bench_joystick);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+#include <unity.h>
+#include <string.h>
+#include "native_host.h"
+#include "uart_parser.h"
+#include "uart_command_index.h"
+#include "hal_io.h"
+#include "latency_stats.h"
+#include "esp_timer.h"
+
+// 命令分派：分词 + 哈希查找 + 调用处理函数 (与 'bench micro parser' 相同的命令行)
+
+static int s_last_argc = 0;
+static char s_last_arg[UART_PARSER_LINE_SIZE];
+static volatile uint32_t s_sink = 0;
+
+static void handle_nop(int argc, char *argv[]) {
+    s_last_argc = argc;
+    strncpy(s_last_arg, argv[argc - 1], sizeof(s_last_arg) - 1);
+    s_sink += (uint32_t)argc;
+}
+
+static const command_t test_commands[] = {
+    {"nop", handle_nop, "nop [args...]: 不执行任何操作 (命令分派基准测试用)。"},
+};
+
+void setUp(void) {
+    native_console_clear();
+}
+
+void tearDown(void) {
+}
+
+static void test_tokenize_quoted_argument(void) {
+    char line[] = "nop  1\t2 \"a b\"";
+    char *argv[UART_PARSER_MAX_ARGS];
+    int argc = uart_command_tokenize(line, argv, UART_PARSER_MAX_ARGS);
+    TEST_ASSERT_EQUAL_INT(4, argc);
+    TEST_ASSERT_EQUAL_STRING("nop", argv[0]);
+    TEST_ASSERT_EQUAL_STRING("2", argv[2]);
+    TEST_ASSERT_EQUAL_STRING("a b", argv[3]);
+}
+
+static void test_tokenize_max_args(void) {
+    char line[] = "a 1 2 3 4 5 6 7 8 9";
+    char *argv[UART_PARSER_MAX_ARGS];
+    TEST_ASSERT_EQUAL_INT(UART_PARSER_MAX_ARGS, uart_command_tokenize(line, argv, UART_PARSER_MAX_ARGS));
+}
+
+static void test_dispatch_registered_command(void) {
+    char line[] = "nop 1 2 \"a b\"";
+    uart_command_execute(line);
+    TEST_ASSERT_EQUAL_INT(4, s_last_argc);
+    TEST_ASSERT_EQUAL_STRING("a b", s_last_arg);
+    TEST_ASSERT_EQUAL_STRING("", native_console_output());
+}
+
+static void test_duplicate_table_skipped(void) {
+    TEST_ASSERT_EQUAL_INT(pdFAIL, uart_parser_register_commands(test_commands, 1));
+    TEST_ASSERT_TRUE(uart_command_lookup("nop") == &test_commands[0]);
+}
+
+static void test_unknown_command(void) {
+    char line[] = "no_such_command x";
+    uart_command_execute(line);
+    TEST_ASSERT_NOT_NULL(strstr(native_console_output(), "Unknown command 'no_such_command'"));
+}
+
+static void bench_line(const char *name, const char *text, uint32_t iterations) {
+    char line[UART_PARSER_LINE_SIZE];
+    size_t len = strlen(text) + 1;
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        memcpy(line, text, len);   // 分词会原地修改命令行
+        uart_parser_dispatch(line);
+    }
+    native_bench_report(name, iterations, esp_timer_get_time() - start_us);
+}
+
+static void test_bench_dispatch(void) {
+    const uint32_t iterations = NATIVE_BENCH_ITERATIONS;
+    native_bench_header();
+    bench_line("dispatch 'nop'", "nop", iterations);
+    bench_line("dispatch 'nop 1 2 \"a b\"'", "nop 1 2 \"a b\"", iterations);
+
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        s_sink += uart_command_lookup((i & 1) ? "latency" : "hal") != NULL;
+    }
+    native_bench_report("lookup 'hal' / 'latency'", iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        s_sink += uart_command_lookup("missing") != NULL;
+    }
+    native_bench_report("lookup (miss)", iterations, esp_timer_get_time() - start_us);
+    TEST_ASSERT_EQUAL_INT(4, s_last_argc);
+}
+
+int main(void) {
+    // 与固件相同：各模块的命令表注册到同一个哈希索引
+    uart_parser_register_commands(test_commands, sizeof(test_commands) / sizeof(test_commands[0]));
+    hal_register_commands();
+    latency_register_commands();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_tokenize_quoted_argument);
+    RUN_TEST(test_tokenize_max_args);
+    RUN_TEST(test_dispatch_registered_command);
+    RUN_TEST(test_duplicate_table_skipped);
+    RUN_TEST(test_unknown_command);
+    RUN_TEST(test_bench_dispatch);
+    return UNITY_END();
+}
@@ -0,0 +1,206 @@
+#include <unity.h>
+#include <string.h>
+#include "native_host.h"
+#include "telemetry_frame.h"
+#include "data_service.h"
+#include "esp_timer.h"
+
+// 遥测编码：打包 + 帧头 + CRC、JSON，以及数据发布任务的 取帧 -> 编码 -> 提交 路径 (经网络替身)
+
+typedef struct {
+    uint32_t frames;
+    uint32_t bad_frames;
+    uint8_t last_type;
+    uint16_t last_seq;
+} frame_check_t;
+
+static frame_check_t s_check;
+static volatile uint32_t s_sink = 0;
+
+// 网络替身的接收回调：按上位机解码器的规则校验二进制帧
+static void check_frame(const network_frame_t *frame, void *arg) {
+    frame_check_t *check = (frame_check_t *)arg;
+    const uint8_t *data = frame->data;
+    check->frames++;
+    if (frame->len < TELEMETRY_FRAME_OVERHEAD || data[0] != TELEMETRY_FRAME_SYNC ||
+        frame->len != TELEMETRY_FRAME_OVERHEAD + data[2]) {
+        check->bad_frames++;
+        return;
+    }
+    size_t crc_offset = frame->len - TELEMETRY_FRAME_CRC_SIZE;
+    uint16_t crc = (uint16_t)(data[crc_offset] | (data[crc_offset + 1] << 8));
+    if (crc != telemetry_crc16(&data[1], crc_offset - 1)) {
+        check->bad_frames++;
+        return;
+    }
+    check->last_type = data[1];
+    check->last_seq = (uint16_t)(data[3] | (data[4] << 8));
+}
+
+// 与 src/main.cpp 的 publish_sample() 相同：样本直接编码进帧池的帧再提交
+static bool publish_sample(const data_channel_info_t *info, const void *sample) {
+    network_frame_t *frame = network_frame_alloc();
+    if (frame == NULL) {
+        return false;
+    }
+    frame->len = telemetry_encode_sample(info, sample, frame->data, sizeof(frame->data));
+    if (frame->len == 0) {
+        network_frame_free(frame);
+        return false;
+    }
+    return network_frame_submit(frame) > 0;
+}
+
+static void sample_encoder(encoder_data_t *encoder) {
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->position = -123456;
+    encoder->delta = 3;
+    encoder->button_pressed = true;
+    encoder->timestamp = 987654;
+}
+
+static void sample_joystick(joystick_data_t *joystick) {
+    memset(joystick, 0, sizeof(*joystick));
+    joystick->x = -317;
+    joystick->y = 402;
+    joystick->magnitude_q15 = 32767;
+    joystick->magnitude = 1.0f;
+    joystick->angle_cdeg = 12821;
+    joystick->angle = 128.21f;
+    joystick->timestamp = 987654;
+}
+
+void setUp(void) {
+    memset(&s_check, 0, sizeof(s_check));
+    native_network_reset_stats();
+    native_network_set_connected(true);
+    native_network_set_sink(check_frame, &s_check);
+    telemetry_set_format(TELEMETRY_FORMAT_BINARY);
+}
+
+void tearDown(void) {
+    native_network_set_sink(NULL, NULL);
+}
+
+static void test_crc16_check_value(void) {
+    // CRC-16/CCITT-FALSE 的标准校验值
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, telemetry_crc16((const uint8_t *)"123456789", 9));
+}
+
+static void test_encoder_frame_layout(void) {
+    encoder_data_t encoder;
+    uint8_t buf[TELEMETRY_FRAME_OVERHEAD + TELEMETRY_FRAME_MAX_PAYLOAD];
+    sample_encoder(&encoder);
+    telemetry_encoder_payload_t payload;
+    telemetry_pack_encoder(&encoder, &payload);
+    size_t len = telemetry_frame_build_seq(TELEMETRY_FRAME_ENCODER, 0x1234, &payload, sizeof(payload), buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(TELEMETRY_FRAME_OVERHEAD + sizeof(payload), len);
+    TEST_ASSERT_EQUAL_HEX8(TELEMETRY_FRAME_SYNC, buf[0]);
+    TEST_ASSERT_EQUAL_HEX8(TELEMETRY_FRAME_ENCODER, buf[1]);
+    TEST_ASSERT_EQUAL_INT(sizeof(payload), buf[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x34, buf[3]);
+    TEST_ASSERT_EQUAL_HEX8(0x12, buf[4]);
+    TEST_ASSERT_EQUAL_MEMORY(&payload, &buf[TELEMETRY_FRAME_HEADER_SIZE], sizeof(payload));
+}
+
+static void test_publish_through_network(void) {
+    encoder_data_t encoder;
+    joystick_data_t joystick;
+    sample_encoder(&encoder);
+    sample_joystick(&joystick);
+
+    TEST_ASSERT_TRUE(publish_sample(data_channel_get_info(DATA_CHANNEL_ENCODER_0), &encoder));
+    TEST_ASSERT_EQUAL_HEX8(TELEMETRY_FRAME_ENCODER, s_check.last_type);
+    TEST_ASSERT_TRUE(publish_sample(data_channel_get_info(DATA_CHANNEL_JOYSTICK_0), &joystick));
+    TEST_ASSERT_EQUAL_HEX8(TELEMETRY_FRAME_JOYSTICK, s_check.last_type);
+    TEST_ASSERT_EQUAL_UINT32(2, s_check.frames);
+    TEST_ASSERT_EQUAL_UINT32(0, s_check.bad_frames);
+
+    // 未连接时提交失败，帧归还到帧池
+    native_network_set_connected(false);
+    for (int i = 0; i < NETWORK_FRAME_POOL_SIZE + 1; i++) {
+        TEST_ASSERT_TRUE(!publish_sample(data_channel_get_info(DATA_CHANNEL_ENCODER_0), &encoder));
+    }
+    native_network_stats_t stats;
+    native_network_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(NETWORK_FRAME_POOL_SIZE + 1, stats.rejected);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pool_exhausted);
+}
+
+static void test_json_line(void) {
+    encoder_data_t encoder;
+    uint8_t buf[TELEMETRY_FRAME_OVERHEAD + TELEMETRY_FRAME_MAX_PAYLOAD];
+    sample_encoder(&encoder);
+    size_t len = telemetry_json_encoder(&encoder, buf, sizeof(buf));
+    buf[len] = '\0';
+    TEST_ASSERT_EQUAL_STRING("ENCODER:{\"pos\":-123456,\"delta\":3,\"btn\":true,\"ts\":987654}\n", (const char *)buf);
+}
+
+static void test_bench_encode(void) {
+    const uint32_t iterations = NATIVE_BENCH_ITERATIONS;
+    uint8_t buf[TELEMETRY_FRAME_OVERHEAD + TELEMETRY_FRAME_MAX_PAYLOAD];
+    encoder_data_t encoder;
+    joystick_data_t joystick;
+    sample_encoder(&encoder);
+    sample_joystick(&joystick);
+    native_bench_header();
+
+    // 前四项与 'bench micro encode' 相同 (使用独立的帧序号)
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        telemetry_encoder_payload_t payload;
+        encoder.position = (int32_t)i;
+        telemetry_pack_encoder(&encoder, &payload);
+        s_sink += telemetry_frame_build_seq(TELEMETRY_FRAME_ENCODER, (uint16_t)i, &payload, sizeof(payload),
+                                            buf, sizeof(buf));
+    }
+    native_bench_report("encoder binary", iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        encoder.position = (int32_t)i;
+        s_sink += telemetry_json_encoder(&encoder, buf, sizeof(buf));
+    }
+    native_bench_report("encoder json", iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        telemetry_joystick_payload_t payload;
+        joystick.x = (int16_t)(i & 511);
+        telemetry_pack_joystick(&joystick, &payload);
+        s_sink += telemetry_frame_build_seq(TELEMETRY_FRAME_JOYSTICK, (uint16_t)i, &payload, sizeof(payload),
+                                            buf, sizeof(buf));
+    }
+    native_bench_report("joystick binary", iterations, esp_timer_get_time() - start_us);
+
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        joystick.x = (int16_t)(i & 511);
+        s_sink += telemetry_json_joystick(&joystick, buf, sizeof(buf));
+    }
+    native_bench_report("joystick json", iterations, esp_timer_get_time() - start_us);
+
+    // 发布路径：帧池取帧 + 按通道编码 + 提交 (接收回调校验 CRC，校验耗时计入结果)
+    const data_channel_info_t *info = data_channel_get_info(DATA_CHANNEL_ENCODER_0);
+    start_us = esp_timer_get_time();
+    for (uint32_t i = 0; i < iterations; i++) {
+        encoder.position = (int32_t)i;
+        s_sink += publish_sample(info, &encoder);
+    }
+    native_bench_report("encoder publish + crc check", iterations, esp_timer_get_time() - start_us);
+
+    TEST_ASSERT_EQUAL_UINT32(iterations, s_check.frames);
+    TEST_ASSERT_EQUAL_UINT32(0, s_check.bad_frames);
+}
+
+int main(void) {
+    data_service_init();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_encoder_frame_layout);
+    RUN_TEST(test_publish_through_network);
+    RUN_TEST(test_json_line);
+    RUN_TEST(test_bench_encode);
+    return UNITY_END();
+}